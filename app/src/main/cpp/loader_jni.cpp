@@ -2,73 +2,91 @@
 // Copyright © 2020 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
 #include "skyline/common/logger.h"
-#include "skyline/crypto/key_store.h"
-#include "skyline/vfs/nca.h"
-#include "skyline/vfs/os_backing.h"
-#include "skyline/loader/nro.h"
-#include "skyline/loader/nso.h"
-#include "skyline/loader/nca.h"
-#include "skyline/loader/xci.h"
-#include "skyline/loader/nsp.h"
+#include "skyline/common/worker_pool.h"
+#include "skyline/loader/metadata_cache.h"
 #include "skyline/jvm.h"
 
-extern "C" JNIEXPORT jint JNICALL Java_emu_skyline_loader_RomFile_populate(JNIEnv *env, jobject thiz, jint jformat, jint fd, jstring appFilesPathJstring, jint systemLanguage) {
-    skyline::signal::ScopedStackBlocker stackBlocker;
-
-    skyline::loader::RomFormat format{static_cast<skyline::loader::RomFormat>(jformat)};
+/**
+ * @return The metadata cache of the process, this is shared across all calls to amortize the cost of parsing the key files
+ */
+static skyline::loader::MetadataCache &GetMetadataCache(const std::string &appFilesPath) {
+    static skyline::loader::MetadataCache metadataCache{appFilesPath + "cache/metadata/", appFilesPath + "keys/"};
+    return metadataCache;
+}
 
-    skyline::Logger::SetContext(&skyline::Logger::LoaderContext);
+/**
+ * @return The workers that ROMs are parsed on, these are shared across all batches to avoid spawning threads for every batch
+ * @note The pool must be locked with the returned mutex while it's being used as batches may be populated from multiple threads
+ */
+static std::pair<skyline::WorkerPool &, std::mutex &> GetWorkerPool() {
+    static skyline::WorkerPool workerPool{std::max(std::thread::hardware_concurrency(), 1U) - 1, "Sky-Loader", [] {
+        skyline::Logger::SetContext(&skyline::Logger::LoaderContext);
+    }};
+    static std::mutex workerPoolMutex;
+    return {workerPool, workerPoolMutex};
+}
 
-    auto keyStore{std::make_shared<skyline::crypto::KeyStore>(skyline::JniString(env, appFilesPathJstring))};
-    std::unique_ptr<skyline::loader::Loader> loader;
-    try {
-        auto backing{std::make_shared<skyline::vfs::OsBacking>(fd)};
-
-        switch (format) {
-            case skyline::loader::RomFormat::NRO:
-                loader = std::make_unique<skyline::loader::NroLoader>(backing);
-                break;
-            case skyline::loader::RomFormat::NSO:
-                loader = std::make_unique<skyline::loader::NsoLoader>(backing);
-                break;
-            case skyline::loader::RomFormat::NCA:
-                loader = std::make_unique<skyline::loader::NcaLoader>(backing, keyStore);
-                break;
-            case skyline::loader::RomFormat::XCI:
-                loader = std::make_unique<skyline::loader::XciLoader>(backing, keyStore);
-                break;
-            case skyline::loader::RomFormat::NSP:
-                loader = std::make_unique<skyline::loader::NspLoader>(backing, keyStore);
-                break;
-            default:
-                return static_cast<jint>(skyline::loader::LoaderResult::ParsingError);
-        }
-    } catch (const skyline::loader::loader_exception &e) {
-        return static_cast<jint>(e.error);
-    } catch (const std::exception &e) {
-        return static_cast<jint>(skyline::loader::LoaderResult::ParsingError);
-    }
+/**
+ * @brief Writes the supplied metadata into the fields of a RomFile object
+ */
+static void SetRomFileFields(JNIEnv *env, jobject romFile, const skyline::loader::RomMetadata &metadata) {
+    if (metadata.result != skyline::loader::LoaderResult::Success || !metadata.hasControlData)
+        return;
 
-    jclass clazz{env->GetObjectClass(thiz)};
+    jclass clazz{env->GetObjectClass(romFile)};
     jfieldID applicationNameField{env->GetFieldID(clazz, "applicationName", "Ljava/lang/String;")};
     jfieldID applicationAuthorField{env->GetFieldID(clazz, "applicationAuthor", "Ljava/lang/String;")};
     jfieldID rawIconField{env->GetFieldID(clazz, "rawIcon", "[B")};
     jfieldID applicationVersionField{env->GetFieldID(clazz, "applicationVersion", "Ljava/lang/String;")};
 
-    if (loader->nacp) {
-        auto language{skyline::language::GetApplicationLanguage(static_cast<skyline::language::SystemLanguage>(systemLanguage))};
-        if (((1 << static_cast<skyline::u32>(language)) & loader->nacp->supportedTitleLanguages) == 0)
-            language = loader->nacp->GetFirstSupportedTitleLanguage();
+    env->SetObjectField(romFile, applicationNameField, env->NewStringUTF(metadata.name.c_str()));
+    env->SetObjectField(romFile, applicationVersionField, env->NewStringUTF(metadata.version.c_str()));
+    env->SetObjectField(romFile, applicationAuthorField, env->NewStringUTF(metadata.author.c_str()));
+
+    jbyteArray iconByteArray{env->NewByteArray(static_cast<jsize>(metadata.icon.size()))};
+    env->SetByteArrayRegion(iconByteArray, 0, static_cast<jsize>(metadata.icon.size()), reinterpret_cast<const jbyte *>(metadata.icon.data()));
+    env->SetObjectField(romFile, rawIconField, iconByteArray);
 
-        env->SetObjectField(thiz, applicationNameField, env->NewStringUTF(loader->nacp->GetApplicationName(language).c_str()));
-        env->SetObjectField(thiz, applicationVersionField, env->NewStringUTF(loader->nacp->GetApplicationVersion().c_str()));
-        env->SetObjectField(thiz, applicationAuthorField, env->NewStringUTF(loader->nacp->GetApplicationPublisher(language).c_str()));
+    env->DeleteLocalRef(clazz);
+}
+
+extern "C" JNIEXPORT jintArray JNICALL Java_emu_skyline_loader_RomFile_populateBatch(JNIEnv *env, jclass, jobjectArray romFiles, jintArray jformats, jintArray jfds, jstring appFilesPathJstring, jint systemLanguage) {
+    skyline::signal::ScopedStackBlocker stackBlocker;
 
-        auto icon{loader->GetIcon(language)};
-        jbyteArray iconByteArray{env->NewByteArray(static_cast<jsize>(icon.size()))};
-        env->SetByteArrayRegion(iconByteArray, 0, static_cast<jsize>(icon.size()), reinterpret_cast<const jbyte *>(icon.data()));
-        env->SetObjectField(thiz, rawIconField, iconByteArray);
+    skyline::Logger::SetContext(&skyline::Logger::LoaderContext);
+
+    auto &metadataCache{GetMetadataCache(skyline::JniString(env, appFilesPathJstring))};
+
+    auto count{static_cast<size_t>(env->GetArrayLength(romFiles))};
+    std::vector<jint> formats(count), fds(count);
+    env->GetIntArrayRegion(jformats, 0, static_cast<jsize>(count), formats.data());
+    env->GetIntArrayRegion(jfds, 0, static_cast<jsize>(count), fds.data());
+
+    // The ROMs are parsed on a pool of workers which never touch the JNI environment, the results are written into the RomFile objects on this thread afterwards
+    std::vector<skyline::loader::RomMetadata> metadata(count);
+    {
+        auto [workerPool, workerPoolMutex]{GetWorkerPool()};
+        std::scoped_lock lock{workerPoolMutex};
+        workerPool.Run(count, [&](size_t index) {
+            if (fds[index] < 0)
+                return; // The file couldn't be opened on the Kotlin side, it's left as a parsing error
+
+            metadata[index] = metadataCache.Get(fds[index], static_cast<skyline::loader::RomFormat>(formats[index]), static_cast<skyline::language::SystemLanguage>(systemLanguage));
+        });
     }
 
-    return static_cast<jint>(skyline::loader::LoaderResult::Success);
+    std::vector<jint> results(count);
+    for (size_t index{}; index < count; index++) {
+        jobject romFile{env->GetObjectArrayElement(romFiles, static_cast<jsize>(index))};
+        SetRomFileFields(env, romFile, metadata[index]);
+        env->DeleteLocalRef(romFile);
+
+        results[index] = static_cast<jint>(metadata[index].result);
+    }
+
+    metadataCache.LogStatistics();
+
+    jintArray jresults{env->NewIntArray(static_cast<jsize>(count))};
+    env->SetIntArrayRegion(jresults, 0, static_cast<jsize>(count), results.data());
+    return jresults;
 }
@@ -1,24 +1,107 @@
 // SPDX-License-Identifier: MPL-2.0
 // Copyright © 2020 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
+#include <common/signal.h>
+#include <loader/loader.h>
+#include <kernel/types/KProcess.h>
+#include <vfs/os_filesystem.h>
+#include <audio/oboe_sink.h>
+#include <audio/wav_sink.h>
+#include <common/settings.h>
+#include <os.h>
 #include "audio.h"
 
 namespace skyline::audio {
-    Audio::Audio(const DeviceState &state) : oboe::AudioStreamCallback() {
-        builder.setChannelCount(constant::StereoChannelCount);
-        builder.setSampleRate(constant::SampleRate);
-        builder.setFormat(constant::PcmFormat);
-        builder.setUsage(oboe::Usage::Game);
-        builder.setCallback(this);
-        builder.setSharingMode(oboe::SharingMode::Exclusive);
-        builder.setPerformanceMode(oboe::PerformanceMode::LowLatency);
-
-        builder.openManagedStream(outputStream);
-        outputStream->requestStart();
+    Audio::Audio(const DeviceState &state) : state{state}, releaseThread{&Audio::ReleaseThread, this} {
+        switch (*state.settings->audioSink) {
+            case AudioSinkType::Null:
+                sink = std::make_unique<NullSink>(GetRenderCallback());
+                break;
+
+            case AudioSinkType::Wav: {
+                // The release thread is already running so an exception can't be allowed to escape the constructor, audio is output to the device instead
+                try {
+                    vfs::OsFileSystem filesystem{state.os->publicAppFilesPath + "audio/"};
+                    auto filename{fmt::format("audio_{}.wav", util::GetTimeNs())};
+                    if (!filesystem.CreateFile(filename, 0))
+                        throw exception("Failed to create WAV file: {}", filename);
+
+                    sink = std::make_unique<WavSink>(GetRenderCallback(), filesystem.OpenFile(filename, {false, true, true}));
+                    Logger::Info("Recording audio to {}audio/{}", state.os->publicAppFilesPath, filename);
+                } catch (const std::exception &e) {
+                    Logger::Warn("Failed to start recording audio, falling back to the device output: {}", e.what());
+                }
+                break;
+            }
+
+            default:
+                break;
+        }
+
+        if (!sink)
+            sink = std::make_unique<OboeSink>(GetRenderCallback());
     }
 
     Audio::~Audio() {
-        outputStream->requestStop();
+        sink.reset();
+
+        releaseThreadExit = true;
+        releaseSequence.fetch_add(1, std::memory_order_release);
+        releaseSequence.notify_one();
+        releaseThread.join();
+    }
+
+    void Audio::SetSink(std::unique_ptr<AudioSink> newSink) {
+        sink.reset(); // Tracks are consumed from a single thread at a time so the previous sink must be stopped first
+        sink = std::move(newSink);
+    }
+
+    void Audio::ReleaseThread() {
+        if (int result{pthread_setname_np(pthread_self(), "Sky-AudioRelease")})
+            Logger::Warn("Failed to set the thread name: {}", strerror(result));
+
+        try {
+            signal::SetSignalHandler({SIGINT, SIGILL, SIGTRAP, SIGBUS, SIGFPE, SIGSEGV}, signal::ExceptionalSignalHandler);
+
+            u32 sequence{releaseSequence.load(std::memory_order_acquire)};
+            while (!releaseThreadExit) {
+                releaseSequence.wait(sequence, std::memory_order_acquire);
+                sequence = releaseSequence.load(std::memory_order_acquire);
+
+                std::scoped_lock trackGuard{trackLock};
+                for (auto &track : audioTracks)
+                    track->CheckReleasedBuffers();
+            }
+        } catch (const signal::SignalException &e) {
+            Logger::Error("{}\nStack Trace:{}", e.what(), state.loader->GetStackTrace(e.frames));
+            if (state.process)
+                state.process->Kill(false);
+            else
+                std::rethrow_exception(std::current_exception());
+        } catch (const std::exception &e) {
+            Logger::Error(e.what());
+            if (state.process)
+                state.process->Kill(false);
+            else
+                std::rethrow_exception(std::current_exception());
+        }
+    }
+
+    void Audio::PublishTracks() {
+        auto tracks{std::make_unique<std::vector<AudioTrack *>>()};
+        tracks->reserve(audioTracks.size());
+        for (auto &track : audioTracks)
+            tracks->push_back(track.get());
+
+        playbackTracks.store(tracks.get());
+
+        // If the callback was running when the new list was published then it may still be using the previous list, we wait for it to return before freeing it
+        u32 sequence{callbackSequence.load()};
+        if (sequence & 1)
+            while (callbackSequence.load() == sequence)
+                std::this_thread::yield();
+
+        publishedTracks = std::move(tracks);
     }
 
     std::shared_ptr<AudioTrack> Audio::OpenTrack(u8 channelCount, u32 sampleRate, const std::function<void()> &releaseCallback) {
@@ -26,6 +109,7 @@ namespace skyline::audio {
 
         auto track{std::make_shared<AudioTrack>(channelCount, sampleRate, releaseCallback)};
         audioTracks.push_back(track);
+        PublishTracks();
 
         return track;
     }
@@ -33,42 +117,30 @@ namespace skyline::audio {
     void Audio::CloseTrack(std::shared_ptr<AudioTrack> &track) {
         std::scoped_lock trackGuard{trackLock};
 
+        Logger::Debug("Closing audio track: {} underruns, {} samples dropped from overruns", track->underrunCount.load(), track->overrunSampleCount.load());
+
         audioTracks.erase(std::remove(audioTracks.begin(), audioTracks.end(), track), audioTracks.end());
+        PublishTracks();
     }
 
-    oboe::DataCallbackResult Audio::onAudioReady(oboe::AudioStream *audioStream, void *audioData, int32_t numFrames) {
-        auto destBuffer{static_cast<i16 *>(audioData)};
-        auto streamSamples{static_cast<size_t>(numFrames) * static_cast<size_t>(audioStream->getChannelCount())};
-        size_t writtenSamples{};
-
-        {
-            std::scoped_lock trackGuard{trackLock};
+    void Audio::Render(span<i16> output) {
+        std::fill(output.begin(), output.end(), 0);
 
-            for (auto &track : audioTracks) {
-                if (track->playbackState == AudioOutState::Stopped)
+        bool anyReleased{};
+        callbackSequence.fetch_add(1);
+        if (auto tracks{playbackTracks.load()}) {
+            for (auto track : *tracks) {
+                if (track->playbackState.load(std::memory_order_relaxed) == AudioOutState::Stopped)
                     continue;
 
-                std::scoped_lock bufferGuard{track->bufferLock};
-
-                auto trackSamples{track->samples.Read(span(destBuffer, streamSamples), [](i16 *source, i16 *destination) {
-                    *destination = Saturate<i16, i32>(static_cast<u32>(*destination) + static_cast<u32>(*source));
-                }, static_cast<ssize_t>(writtenSamples))};
-
-                writtenSamples = std::max(trackSamples, writtenSamples);
-
-                track->sampleCounter += trackSamples;
-                track->CheckReleasedBuffers();
+                anyReleased |= track->Play(output);
             }
         }
+        callbackSequence.fetch_add(1);
 
-        if (streamSamples > writtenSamples)
-            memset(destBuffer + writtenSamples, 0, (streamSamples - writtenSamples) * sizeof(i16));
-
-        return oboe::DataCallbackResult::Continue;
-    }
-
-    void Audio::onErrorAfterClose(oboe::AudioStream *audioStream, oboe::Result error) {
-        builder.openManagedStream(outputStream);
-        outputStream->requestStart();
+        if (anyReleased) {
+            releaseSequence.fetch_add(1, std::memory_order_release);
+            releaseSequence.notify_one();
+        }
     }
 }
@@ -4,17 +4,37 @@
 #pragma once
 
 #include <audio/track.h>
+#include <audio/sink.h>
 
 namespace skyline::audio {
     /**
      * @brief The Audio class is used to mix audio from all tracks
      */
-    class Audio : public oboe::AudioStreamCallback {
+    class Audio {
       private:
-        oboe::AudioStreamBuilder builder;
-        oboe::ManagedStream outputStream;
+        const DeviceState &state;
+        std::unique_ptr<AudioSink> sink; //!< The sink that mixed audio is output to
         std::vector<std::shared_ptr<AudioTrack>> audioTracks;
-        std::mutex trackLock; //!< Synchronizes modifications to the audio tracks
+        std::mutex trackLock; //!< Synchronizes modifications to the audio tracks, this is never taken by the audio callback
+
+        std::unique_ptr<const std::vector<AudioTrack *>> publishedTracks; //!< The track list that's currently visible to the audio callback, this is only accessed with trackLock held
+        std::atomic<const std::vector<AudioTrack *> *> playbackTracks{}; //!< An atomically published pointer to publishedTracks for the audio callback
+        std::atomic<u32> callbackSequence{}; //!< A counter that's incremented on entry and exit of the audio callback, it's odd while the callback could be accessing a track list
+
+        std::atomic<u32> releaseSequence{}; //!< A counter that's incremented by the audio callback whenever any buffers have been played
+        std::atomic<bool> releaseThreadExit{};
+        std::thread releaseThread; //!< A thread that calls the release callbacks of tracks on behalf of the audio callback as they may block
+
+        /**
+         * @brief Publishes the current set of tracks to the audio callback and waits till the callback can no longer be using the previous set
+         * @note trackLock MUST be locked when calling this
+         */
+        void PublishTracks();
+
+        /**
+         * @brief The entry point for the release thread, this waits on releaseSequence and checks all tracks for released buffers
+         */
+        void ReleaseThread();
 
       public:
         Audio(const DeviceState &state);
@@ -22,11 +42,24 @@ namespace skyline::audio {
         ~Audio();
 
         void Pause() {
-            outputStream->requestPause();
+            sink->Pause();
         }
 
         void Resume() {
-            outputStream->requestStart();
+            sink->Resume();
+        }
+
+        /**
+         * @brief Replaces the sink that audio is output to, the previous sink is destroyed before the new one is used
+         * @note The sink must be created with GetRenderCallback() as its render callback
+         */
+        void SetSink(std::unique_ptr<AudioSink> newSink);
+
+        /**
+         * @return A render callback that mixes all tracks, this is used to create sinks
+         */
+        AudioSink::RenderCallback GetRenderCallback() {
+            return [this](span<i16> output) { Render(output); };
         }
 
         /**
@@ -44,18 +77,10 @@ namespace skyline::audio {
         void CloseTrack(std::shared_ptr<AudioTrack> &track);
 
         /**
-         * @brief The callback oboe uses to get audio sample data
-         * @param audioStream The audio stream we are being called by
-         * @param audioData The raw audio sample data
-         * @param numFrames The amount of frames the sample data needs to contain
-         */
-        oboe::DataCallbackResult onAudioReady(oboe::AudioStream *audioStream, void *audioData, int32_t numFrames);
-
-        /**
-         * @brief The callback oboe uses to notify the application about stream closure
-         * @param audioStream The audio stream we are being called by
-         * @param error The error due to which the stream is being closed
+         * @brief Mixes the samples of all playing tracks into the output buffer, this is called by the sink
+         * @param output The buffer to write interleaved stereo samples into
+         * @note This is wait-free, it must only ever be called from one thread at a time
          */
-        void onErrorAfterClose(oboe::AudioStream *audioStream, oboe::Result error);
+        void Render(span<i16> output);
     };
 }
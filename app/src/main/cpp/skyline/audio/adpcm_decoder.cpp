@@ -1,24 +1,117 @@
 // SPDX-License-Identifier: MPL-2.0
 // Copyright © 2020 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
+#include <arm_neon.h>
 #include "common.h"
 #include "adpcm_decoder.h"
 
 namespace skyline::audio {
-    AdpcmDecoder::AdpcmDecoder(std::vector<std::array<i16, 2>> coefficients) : coefficients(std::move(coefficients)) {}
+    AdpcmDecoder::AdpcmDecoder(span<const std::array<i16, 2>> pCoefficients) {
+        for (size_t index{}; index < std::min(pCoefficients.size(), CoefficientCount); index++)
+            coefficients[index] = {pCoefficients[index][0], pCoefficients[index][1]};
+    }
+
+    /**
+     * @return The signed nibble for the sample at the supplied index within a frame, the high nibble of a byte comes first
+     */
+    static inline i32 GetNibble(const u8 *frame, size_t index) {
+        u8 byte{frame[1 + (index / 2)]};
+        return (index & 1) ? (static_cast<i8>(byte << 4) >> 4) : (static_cast<i8>(byte) >> 4);
+    }
+
+    void AdpcmDecoder::DecodeFrame(const u8 *frame, i16 *output) {
+        FrameHeader header{frame[0]};
+        auto [coefficient0, coefficient1]{coefficients[header.coefficientIndex]};
+        i32 scale{0x800 << header.scale};
+        i32 history0{history[0]}, history1{history[1]};
+
+        [&]<size_t... Index>(std::index_sequence<Index...>) {
+            ((output[Index] = [&] {
+                auto sample{audio::Saturate<i16, i32>((GetNibble(frame, Index) * scale + history0 * coefficient0 + history1 * coefficient1 + 0x400) >> 11)};
+                history1 = history0;
+                history0 = sample;
+                return sample;
+            }()), ...);
+        }(std::make_index_sequence<SamplesPerFrame>{});
+
+        history = {history0, history1};
+    }
 
-    std::vector<i16> AdpcmDecoder::Decode(span<u8> adpcmData) {
-        constexpr size_t BytesPerFrame{0x8};
-        constexpr size_t SamplesPerFrame{0xE};
+    void AdpcmDecoder::DecodeFrames(span<const BatchFrame> frames) {
+        constexpr size_t LaneCount{4};
+        size_t index{};
 
-        size_t remainingSamples{(adpcmData.size() / BytesPerFrame) * SamplesPerFrame};
+        for (; index + LaneCount <= frames.size(); index += LaneCount) {
+            auto batch{frames.subspan(index, LaneCount)};
 
-        std::vector<i16> output;
-        output.reserve(remainingSamples);
+            std::array<i32, LaneCount> coefficient0s, coefficient1s, scales, history0s, history1s;
+            for (size_t lane{}; lane < LaneCount; lane++) {
+                auto decoder{batch[lane].decoder};
+                FrameHeader header{batch[lane].frame[0]};
+                coefficient0s[lane] = decoder->coefficients[header.coefficientIndex][0];
+                coefficient1s[lane] = decoder->coefficients[header.coefficientIndex][1];
+                scales[lane] = 0x800 << header.scale;
+                history0s[lane] = decoder->history[0];
+                history1s[lane] = decoder->history[1];
+            }
+
+            int32x4_t coefficient0{vld1q_s32(coefficient0s.data())}, coefficient1{vld1q_s32(coefficient1s.data())}, scale{vld1q_s32(scales.data())};
+            int32x4_t history0{vld1q_s32(history0s.data())}, history1{vld1q_s32(history1s.data())};
+            int32x4_t rounding{vdupq_n_s32(0x400)};
+
+            for (size_t sampleIndex{}; sampleIndex < SamplesPerFrame; sampleIndex++) {
+                std::array<i32, LaneCount> nibbles;
+                for (size_t lane{}; lane < LaneCount; lane++)
+                    nibbles[lane] = GetNibble(batch[lane].frame, sampleIndex);
+
+                int32x4_t value{vmlaq_s32(vmlaq_s32(vmlaq_s32(rounding, history1, coefficient1), history0, coefficient0), vld1q_s32(nibbles.data()), scale)};
+                int32x4_t sample{vmovl_s16(vqmovn_s32(vshrq_n_s32(value, 11)))}; // SQXTN saturates to the range of i16
 
-        size_t inputOffset{};
+                history1 = history0;
+                history0 = sample;
 
-        while (inputOffset < adpcmData.size()) {
+                for (size_t lane{}; lane < LaneCount; lane++)
+                    batch[lane].output[sampleIndex] = static_cast<i16>(sample[lane]);
+            }
+
+            vst1q_s32(history0s.data(), history0);
+            vst1q_s32(history1s.data(), history1);
+            for (size_t lane{}; lane < LaneCount; lane++)
+                batch[lane].decoder->history = {history0s[lane], history1s[lane]};
+        }
+
+        for (; index < frames.size(); index++)
+            frames[index].decoder->DecodeFrame(frames[index].frame, frames[index].output);
+    }
+
+    size_t AdpcmDecoder::Decode(span<const u8> adpcmData, span<i16> output) {
+        size_t frameCount{std::min(adpcmData.size() / BytesPerFrame, util::DivideCeil(output.size(), SamplesPerFrame))};
+        size_t wholeFrames{std::min(frameCount, output.size() / SamplesPerFrame)};
+
+        for (size_t frame{}; frame < wholeFrames; frame++)
+            DecodeFrame(adpcmData.data() + (frame * BytesPerFrame), output.data() + (frame * SamplesPerFrame));
+
+        // Only part of the last frame fits into the output, it's decoded through a temporary frame so the history is still correct
+        if (frameCount > wholeFrames) {
+            std::array<i16, SamplesPerFrame> frame;
+            size_t outputOffset{wholeFrames * SamplesPerFrame};
+            i32 previousSample{history[0]};
+            DecodeFrame(adpcmData.data() + (wholeFrames * BytesPerFrame), frame.data());
+
+            size_t partialSamples{output.size() - outputOffset};
+            std::copy_n(frame.begin(), partialSamples, output.begin() + static_cast<ssize_t>(outputOffset));
+            history = {frame[partialSamples - 1], partialSamples > 1 ? frame[partialSamples - 2] : previousSample};
+            return outputOffset + partialSamples;
+        }
+
+        return wholeFrames * SamplesPerFrame;
+    }
+
+    size_t AdpcmDecoder::DecodeReference(span<const u8> adpcmData, span<i16> output) {
+        size_t remainingSamples{std::min((adpcmData.size() / BytesPerFrame) * SamplesPerFrame, output.size())};
+        size_t inputOffset{}, outputOffset{};
+
+        while (remainingSamples) {
             FrameHeader header{adpcmData[inputOffset++]};
 
             size_t frameSamples{std::min(SamplesPerFrame, remainingSamples)};
@@ -39,14 +132,21 @@ namespace skyline::audio {
                 sample = (sample * (0x800 << header.scale) + prediction + 0x400) >> 11;
 
                 auto saturated{audio::Saturate<i16, i32>(sample)};
-                output.push_back(saturated);
+                output[outputOffset++] = saturated;
                 history[1] = history[0];
                 history[0] = saturated;
             }
 
+            inputOffset += BytesPerFrame - 1 - ((frameSamples + 1) / 2); // Skip any bytes of a partially decoded frame
             remainingSamples -= frameSamples;
         }
 
+        return outputOffset;
+    }
+
+    std::vector<i16> AdpcmDecoder::Decode(span<const u8> adpcmData) {
+        std::vector<i16> output((adpcmData.size() / BytesPerFrame) * SamplesPerFrame);
+        Decode(adpcmData, output);
         return output;
     }
 }
@@ -22,15 +22,71 @@ namespace skyline::audio {
         };
         static_assert(sizeof(FrameHeader) == 0x1);
 
+        static constexpr size_t CoefficientCount{8}; //!< The amount of coefficient pairs that can be addressed by a frame header
+
         std::array<i32, 2> history{}; //!< The previous samples for decoding the ADPCM stream
-        std::vector<std::array<i16, 2>> coefficients; //!< The coefficients for decoding the ADPCM stream
+        std::array<std::array<i32, 2>, CoefficientCount> coefficients{}; //!< The coefficients for decoding the ADPCM stream, widened ahead of time and zero for any pairs the guest didn't supply
 
       public:
-        AdpcmDecoder(std::vector<std::array<i16, 2>> coefficients);
+        static constexpr size_t BytesPerFrame{0x8};
+        static constexpr size_t SamplesPerFrame{0xE};
+
+        /**
+         * @brief A single frame to decode with DecodeFrames()
+         */
+        struct BatchFrame {
+            AdpcmDecoder *decoder;
+            const u8 *frame; //!< BytesPerFrame bytes of ADPCM data
+            i16 *output; //!< A buffer for SamplesPerFrame samples
+        };
+
+        AdpcmDecoder(span<const std::array<i16, 2>> coefficients);
+
+        /**
+         * @brief Decodes a single complete frame, the 14 samples are fully unrolled with the coefficients and scale hoisted out
+         */
+        void DecodeFrame(const u8 *frame, i16 *output);
+
+        /**
+         * @brief Decodes a single frame of several independent streams at once, 4 streams are decoded together in the lanes of a vector
+         * @note A decoder must not occur more than once in a batch as every frame depends on the history of the previous one
+         */
+        static void DecodeFrames(span<const BatchFrame> frames);
+
+        /**
+         * @brief Decodes ADPCM data into a caller-provided buffer, decoding continues from the history of the previous call
+         * @param adpcmData The ADPCM data to decode, this must start at a frame boundary
+         * @param output The buffer to write I16 PCM samples into, decoding stops once it is full
+         * @return The amount of samples that were written into the output buffer
+         */
+        size_t Decode(span<const u8> adpcmData, span<i16> output);
+
+        /**
+         * @brief A sample-at-a-time implementation of Decode which the frame decoders are verified against
+         */
+        size_t DecodeReference(span<const u8> adpcmData, span<i16> output);
+
+        /**
+         * @brief Resets the decoding history for a new stream
+         */
+        void Reset() {
+            history = {};
+        }
+
+        /**
+         * @return The decoding history, all samples decoded after this point depend on it
+         */
+        std::array<i32, 2> GetHistory() const {
+            return history;
+        }
+
+        void SetHistory(std::array<i32, 2> pHistory) {
+            history = pHistory;
+        }
 
         /**
          * @brief Decodes a buffer of ADPCM data into I16 PCM
          */
-        std::vector<i16> Decode(span <u8> adpcmData);
+        std::vector<i16> Decode(span<const u8> adpcmData);
     };
 }
@@ -28,9 +28,10 @@ namespace skyline::audio {
     };
 
     /**
-     * @brief Downmixes a buffer of 5.1 surround audio to stereo
+     * @brief Downmixes a buffer of 5.1 surround audio to stereo into a caller-provided buffer
+     * @param stereoSamples The buffer to write stereo samples into, this must be at least as large as surroundSamples
      */
-    inline std::vector<StereoSample> DownMix(span<Surround51Sample> surroundSamples) {
+    inline void DownMix(span<const Surround51Sample> surroundSamples, span<StereoSample> stereoSamples) {
         constexpr i16 FixedPointMultiplier{1000}; //!< Avoids using floating point maths
         constexpr i16 Attenuation3Db{707}; //! 10^(-3/20)
         constexpr i16 Attenuation6Db{501}; //! 10^(-6/20)
@@ -43,15 +44,21 @@ namespace skyline::audio {
                                      back * Attenuation6Db) / FixedPointMultiplier);
         }};
 
-        std::vector<StereoSample> stereoSamples(surroundSamples.size());
         for (size_t i{}; i < surroundSamples.size(); i++) {
-            auto &surroundSample = surroundSamples[i];
+            auto surroundSample = surroundSamples[i]; // This is copied as the buffers may alias when downmixing in-place
             auto &stereoSample = stereoSamples[i];
 
             stereoSample.left = downmixChannel(surroundSample.frontLeft, surroundSample.centre, surroundSample.lowFrequency, surroundSample.backLeft);
             stereoSample.right = downmixChannel(surroundSample.frontRight, surroundSample.centre, surroundSample.lowFrequency, surroundSample.backRight);
         }
+    }
 
+    /**
+     * @brief Downmixes a buffer of 5.1 surround audio to stereo
+     */
+    inline std::vector<StereoSample> DownMix(span<Surround51Sample> surroundSamples) {
+        std::vector<StereoSample> stereoSamples(surroundSamples.size());
+        DownMix(surroundSamples, stereoSamples);
         return stereoSamples;
     }
 }
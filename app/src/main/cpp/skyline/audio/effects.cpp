@@ -0,0 +1,222 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <arm_neon.h>
+#include "common.h"
+#include "effects.h"
+
+namespace skyline::audio {
+    /**
+     * @brief Loads a single frame of up to 4 planar channels into the lanes of a vector, any lanes without a channel are zero
+     */
+    static inline float32x4_t LoadLanes(span<const float *const> inputs, size_t firstChannel, size_t laneCount, size_t frame) {
+        float32x4_t lanes{vdupq_n_f32(0.0f)};
+        for (size_t lane{}; lane < laneCount; lane++)
+            lanes[lane] = inputs[firstChannel + lane][frame];
+        return lanes;
+    }
+
+    static inline void StoreLanes(span<float *const> outputs, size_t firstChannel, size_t laneCount, size_t frame, float32x4_t lanes) {
+        for (size_t lane{}; lane < laneCount; lane++)
+            outputs[firstChannel + lane][frame] = lanes[lane];
+    }
+
+    static constexpr u32 MsToFrames(float milliseconds) {
+        return static_cast<u32>(milliseconds * (constant::SampleRate / 1000));
+    }
+
+    void BiquadFilter::Reset() {
+        s1.fill(0.0f);
+        s2.fill(0.0f);
+    }
+
+    void BiquadFilter::Process(span<float *const> outputs, span<const float *const> inputs, size_t frameCount, const BiquadCoefficients &coefficients) {
+        float32x4_t b0{vdupq_n_f32(coefficients.b0)}, b1{vdupq_n_f32(coefficients.b1)}, b2{vdupq_n_f32(coefficients.b2)};
+        float32x4_t a1{vdupq_n_f32(coefficients.a1)}, a2{vdupq_n_f32(coefficients.a2)};
+
+        for (size_t firstChannel{}; firstChannel < inputs.size(); firstChannel += EffectLaneCount) {
+            size_t laneCount{std::min(EffectLaneCount, inputs.size() - firstChannel)};
+            float32x4_t state1{vld1q_f32(s1.data() + firstChannel)}, state2{vld1q_f32(s2.data() + firstChannel)};
+
+            for (size_t frame{}; frame < frameCount; frame++) {
+                float32x4_t input{LoadLanes(inputs, firstChannel, laneCount, frame)};
+                float32x4_t output{vfmaq_f32(state1, input, b0)};
+                state1 = vfmaq_f32(vfmaq_f32(state2, input, b1), output, a1);
+                state2 = vfmaq_f32(vmulq_f32(input, b2), output, a2);
+                StoreLanes(outputs, firstChannel, laneCount, frame, output);
+            }
+
+            vst1q_f32(s1.data() + firstChannel, state1);
+            vst1q_f32(s2.data() + firstChannel, state2);
+        }
+    }
+
+    void Delay::Resize(size_t pMaxFrames) {
+        maxFrames = std::max<size_t>(pMaxFrames, 1);
+        buffer.resize(maxFrames * EffectLaneChannels);
+        Reset();
+    }
+
+    void Delay::Reset() {
+        std::fill(buffer.begin(), buffer.end(), 0.0f);
+        lowPassState.fill(0.0f);
+        position = 0;
+    }
+
+    void Delay::Process(span<float *const> outputs, span<const float *const> inputs, size_t frameCount, const Parameters &parameters) {
+        size_t delayFrames{std::clamp<size_t>(parameters.delayFrames, 1, maxFrames)};
+        if (position >= delayFrames)
+            position = 0;
+
+        float spread{inputs.size() > 1 ? parameters.channelSpread : 0.0f}; // A single channel has nothing to spread into
+        float32x4_t inGain{vdupq_n_f32(parameters.inGain)}, wetGain{vdupq_n_f32(parameters.wetGain)}, dryGain{vdupq_n_f32(parameters.dryGain)};
+        float32x4_t directGain{vdupq_n_f32(parameters.feedbackGain * (1.0f - spread))}, spreadGain{vdupq_n_f32(parameters.feedbackGain * spread)};
+        float32x4_t lowPass{vdupq_n_f32(parameters.lowPassAmount)}, lowPassInverse{vdupq_n_f32(1.0f - parameters.lowPassAmount)};
+
+        size_t groupPosition{};
+        for (size_t firstChannel{}; firstChannel < inputs.size(); firstChannel += EffectLaneCount) {
+            size_t laneCount{std::min(EffectLaneCount, inputs.size() - firstChannel)};
+            float32x4_t lowPassed{vld1q_f32(lowPassState.data() + firstChannel)};
+
+            groupPosition = position;
+            for (size_t frame{}; frame < frameCount; frame++) {
+                float *line{buffer.data() + (groupPosition * EffectLaneChannels) + firstChannel};
+                float32x4_t input{LoadLanes(inputs, firstChannel, laneCount, frame)}, delayed{vld1q_f32(line)};
+
+                // VREV64 swaps adjacent lanes which cross-feeds every pair of channels
+                float32x4_t feedback{vfmaq_f32(vmulq_f32(delayed, directGain), vrev64q_f32(delayed), spreadGain)};
+                lowPassed = vfmaq_f32(vmulq_f32(feedback, lowPassInverse), lowPassed, lowPass);
+                vst1q_f32(line, vfmaq_f32(lowPassed, input, inGain));
+
+                StoreLanes(outputs, firstChannel, laneCount, frame, vfmaq_f32(vmulq_f32(input, dryGain), delayed, wetGain));
+
+                if (++groupPosition == delayFrames)
+                    groupPosition = 0;
+            }
+
+            vst1q_f32(lowPassState.data() + firstChannel, lowPassed);
+        }
+
+        position = groupPosition;
+    }
+
+    void Reverb::DelayLine::Resize(size_t maxLength) {
+        buffer.resize(std::max<size_t>(maxLength, 1));
+        length = 1;
+        position = 0;
+    }
+
+    void Reverb::DelayLine::SetLength(u32 pLength) {
+        pLength = std::clamp<u32>(pLength, 1, static_cast<u32>(buffer.size()));
+        if (length != pLength) {
+            length = pLength;
+            position = 0;
+            std::fill(buffer.begin(), buffer.end(), 0.0f);
+        }
+    }
+
+    void Reverb::Initialize() {
+        if (initialized)
+            return;
+
+        preDelay.Resize(MsToFrames(MaxPreDelayTime + MaxLineTime) + 1);
+        for (auto &line : lines)
+            line.Resize(MsToFrames(MaxLineTime));
+        for (auto &allPass : allPasses)
+            allPass.Resize(MsToFrames(MaxLineTime));
+
+        initialized = true;
+    }
+
+    void Reverb::Update(const Parameters &parameters) {
+        // The tap times are in milliseconds relative to the pre-delay, they are scaled by the size of the room
+        constexpr std::array<float, EarlyTapCount> EarlyTapTimes{0.0f, 3.5f, 5.8f, 8.9f, 12.3f, 15.7f, 19.1f, 22.6f, 26.0f, 29.4f};
+        constexpr std::array<float, EarlyTapCount> EarlyTapGains{0.70f, 0.68f, 0.61f, 0.55f, 0.50f, 0.44f, 0.39f, 0.33f, 0.28f, 0.22f};
+        constexpr std::array<float, 5> EarlyModeScale{1.0f, 1.6f, 2.2f, 3.0f, 0.0f};
+
+        // Mutually prime line lengths in milliseconds, these are scaled by the size of the space
+        constexpr std::array<float, LineCount> LineTimes{29.7f, 37.1f, 41.1f, 43.7f};
+        constexpr std::array<float, LineCount> AllPassTimes{5.0f, 6.8f, 8.4f, 10.0f};
+        constexpr std::array<float, 5> LateModeScale{1.0f, 1.6f, 0.8f, 2.5f, 3.0f};
+
+        auto earlyMode{std::min<size_t>(static_cast<size_t>(parameters.earlyMode), EarlyModeScale.size() - 1)};
+        auto lateMode{std::min<size_t>(static_cast<size_t>(parameters.lateMode), LateModeScale.size() - 1)};
+
+        preDelayFrames = MsToFrames(std::clamp(parameters.preDelayTime, 0.0f, MaxPreDelayTime));
+        u32 maxTap{preDelayFrames};
+        for (size_t tap{}; tap < EarlyTapCount; tap++) {
+            earlyTaps[tap] = preDelayFrames + MsToFrames(EarlyTapTimes[tap] * EarlyModeScale[earlyMode]);
+            earlyGains[tap] = EarlyModeScale[earlyMode] != 0.0f ? EarlyTapGains[tap] : 0.0f;
+            maxTap = std::max(maxTap, earlyTaps[tap]);
+        }
+        preDelay.SetLength(maxTap + 1);
+
+        float decayTime{std::max(parameters.decayTime, 0.1f)};
+        for (size_t line{}; line < LineCount; line++) {
+            float lineTime{std::min(LineTimes[line] * LateModeScale[lateMode], MaxLineTime)};
+            lines[line].SetLength(MsToFrames(lineTime));
+            allPasses[line].SetLength(MsToFrames(AllPassTimes[line]));
+            lineGains[line] = std::pow(10.0f, (-3.0f * lineTime / 1000.0f) / decayTime); // -60dB after the decay time
+        }
+
+        damping = std::clamp(1.0f - parameters.highFrequencyDecayRatio, 0.0f, 0.95f);
+    }
+
+    void Reverb::Reset() {
+        std::fill(preDelay.buffer.begin(), preDelay.buffer.end(), 0.0f);
+        for (auto &line : lines)
+            std::fill(line.buffer.begin(), line.buffer.end(), 0.0f);
+        for (auto &allPass : allPasses)
+            std::fill(allPass.buffer.begin(), allPass.buffer.end(), 0.0f);
+        lowPassState.fill(0.0f);
+    }
+
+    void Reverb::Process(span<float *const> outputs, span<const float *const> inputs, size_t frameCount, const Parameters &parameters) {
+        float inputGain{parameters.baseGain / static_cast<float>(std::max<size_t>(inputs.size(), 1))};
+        float32x4_t lineGain{vld1q_f32(lineGains.data())}, colouration{vdupq_n_f32(parameters.colouration)};
+        float32x4_t dampingGain{vdupq_n_f32(damping)}, dampingInverse{vdupq_n_f32(1.0f - damping)};
+        float32x4_t lowPassed{vld1q_f32(lowPassState.data())};
+
+        auto tapPreDelay{[this](u32 writePosition, u32 tap) {
+            return preDelay.buffer[(writePosition + preDelay.length - tap) % preDelay.length];
+        }};
+
+        for (size_t frame{}; frame < frameCount; frame++) {
+            float input{};
+            for (auto channel : inputs)
+                input += channel[frame];
+
+            u32 writePosition{preDelay.position};
+            preDelay.Write(input * inputGain);
+
+            // Early reflections alternate between the left and right channels
+            std::array<float, 2> early{};
+            for (size_t tap{}; tap < EarlyTapCount; tap++)
+                early[tap & 1] += tapPreDelay(writePosition, earlyTaps[tap]) * earlyGains[tap];
+
+            float32x4_t delayed{lines[0].Read(), lines[1].Read(), lines[2].Read(), lines[3].Read()};
+            lowPassed = vfmaq_f32(vmulq_f32(delayed, dampingInverse), lowPassed, dampingGain);
+
+            // A Householder matrix (I - 2/N * 11^T) mixes every line into all others without changing the energy in the network
+            float32x4_t feedback{vmulq_f32(vsubq_f32(lowPassed, vdupq_n_f32(vaddvq_f32(lowPassed) * 0.5f)), lineGain)};
+            feedback = vaddq_f32(feedback, vdupq_n_f32(tapPreDelay(writePosition, preDelayFrames)));
+
+            // The input of every line is diffused by a Schroeder all-pass filter
+            float32x4_t allPassed{allPasses[0].Read(), allPasses[1].Read(), allPasses[2].Read(), allPasses[3].Read()};
+            float32x4_t diffused{vfmaq_f32(feedback, allPassed, colouration)};
+            float32x4_t lineInput{vfmsq_f32(allPassed, diffused, colouration)};
+
+            for (size_t line{}; line < LineCount; line++) {
+                allPasses[line].Write(diffused[line]);
+                lines[line].Write(lineInput[line]);
+            }
+
+            for (size_t channel{}; channel < inputs.size(); channel++) {
+                float wet{(early[channel & 1] * parameters.earlyGain) + (lowPassed[channel % LineCount] * parameters.lateGain)};
+                outputs[channel][frame] = (inputs[channel][frame] * parameters.dryGain) + (wet * parameters.wetGain);
+            }
+        }
+
+        vst1q_f32(lowPassState.data(), lowPassed);
+    }
+}
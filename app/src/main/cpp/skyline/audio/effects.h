@@ -0,0 +1,164 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <common.h>
+
+namespace skyline::audio {
+    constexpr size_t MaxEffectChannels{6}; //!< The maximum amount of channels that a single effect can process
+    constexpr size_t EffectLaneCount{4}; //!< The amount of channels that are processed together in the lanes of a vector
+    constexpr size_t EffectLaneChannels{util::AlignUp(MaxEffectChannels, EffectLaneCount)}; //!< The maximum amount of channels padded to a multiple of the lane count
+
+    /**
+     * @brief The coefficients of a biquad filter, these are normalised such that a0 is 1
+     * @note The feedback coefficients follow the sign convention of HOS, they are added to the output rather than subtracted
+     */
+    struct BiquadCoefficients {
+        float b0, b1, b2;
+        float a1, a2;
+    };
+
+    /**
+     * @brief A biquad filter in transposed direct form II, up to 4 channels are filtered at once in the lanes of a vector
+     */
+    class BiquadFilter {
+      private:
+        std::array<float, EffectLaneChannels> s1{}, s2{}; //!< The state of the filter for every channel
+
+      public:
+        void Reset();
+
+        /**
+         * @param outputs The buffer to write the filtered samples of each channel into, these may alias the corresponding input
+         * @param inputs The buffer of samples for each channel
+         */
+        void Process(span<float *const> outputs, span<const float *const> inputs, size_t frameCount, const BiquadCoefficients &coefficients);
+    };
+
+    /**
+     * @brief A multi-tap delay with a low-pass filtered feedback path, adjacent pairs of channels are cross-fed into each other by the channel spread
+     */
+    class Delay {
+      public:
+        struct Parameters {
+            u32 delayFrames; //!< The length of the delay in frames, this must not exceed the maximum passed to Resize()
+            float inGain;
+            float feedbackGain;
+            float wetGain;
+            float dryGain;
+            float channelSpread; //!< The fraction of the feedback of a channel that is fed into the adjacent channel
+            float lowPassAmount; //!< The coefficient of the one-pole low-pass filter in the feedback path, 0 disables filtering
+        };
+
+      private:
+        std::vector<float> buffer; //!< The delay line of every group of channels, the channels of a group are interleaved so a frame can be loaded as a single vector
+        size_t maxFrames{};
+        size_t position{};
+        std::array<float, EffectLaneChannels> lowPassState{};
+
+      public:
+        /**
+         * @brief Resizes the delay lines to fit a delay of the supplied amount of frames, this clears the state of the delay
+         * @note This allocates and must only be called when parameters are updated, not while mixing
+         */
+        void Resize(size_t maxFrames);
+
+        void Reset();
+
+        void Process(span<float *const> outputs, span<const float *const> inputs, size_t frameCount, const Parameters &parameters);
+    };
+
+    /**
+     * @brief A reverb consisting of early reflections tapped from a pre-delay line followed by a 4-line feedback delay network for the late reverberation
+     * @note The 4 lines of the network are processed together in the lanes of a vector with a Householder feedback matrix
+     */
+    class Reverb {
+      public:
+        enum class EarlyMode : u32 {
+            SmallRoom,
+            LargeRoom,
+            Hall,
+            CathedralRoom,
+            NoEarlyReflection,
+        };
+
+        enum class LateMode : u32 {
+            Room,
+            Hall,
+            Plate,
+            CathedralRoom,
+            MaxDelay,
+        };
+
+        struct Parameters {
+            EarlyMode earlyMode;
+            LateMode lateMode;
+            float earlyGain;
+            float preDelayTime; //!< The delay before any reflections in milliseconds
+            float lateGain;
+            float decayTime; //!< The time it takes for the late reverberation to decay by 60dB in seconds
+            float highFrequencyDecayRatio; //!< The ratio of the decay time of high frequencies to that of low frequencies
+            float colouration; //!< The gain of the diffusing all-pass filters
+            float baseGain; //!< The gain of the input into the reverb
+            float wetGain;
+            float dryGain;
+        };
+
+      private:
+        static constexpr size_t LineCount{4};
+        static constexpr size_t EarlyTapCount{10};
+        static constexpr float MaxPreDelayTime{300.0f}; //!< The maximum pre-delay in milliseconds
+        static constexpr float MaxLineTime{150.0f}; //!< The maximum length of a line of the network or an all-pass filter in milliseconds
+
+        /**
+         * @brief A circular buffer of samples with a variable length
+         */
+        struct DelayLine {
+            std::vector<float> buffer;
+            u32 length{1};
+            u32 position{};
+
+            void Resize(size_t maxLength);
+
+            void SetLength(u32 length);
+
+            float Read() const {
+                return buffer[position];
+            }
+
+            void Write(float sample) {
+                buffer[position] = sample;
+                if (++position == length)
+                    position = 0;
+            }
+        };
+
+        DelayLine preDelay;
+        u32 preDelayFrames{};
+        std::array<u32, EarlyTapCount> earlyTaps{}; //!< The offsets of the early reflection taps behind the write position of the pre-delay line
+        std::array<float, EarlyTapCount> earlyGains{};
+        std::array<DelayLine, LineCount> lines;
+        std::array<DelayLine, LineCount> allPasses;
+        std::array<float, LineCount> lineGains{}; //!< The gain applied to the output of each line for the decay time
+        std::array<float, LineCount> lowPassState{};
+        float damping{}; //!< The coefficient of the high frequency damping low-pass filter
+        bool initialized{};
+
+      public:
+        /**
+         * @brief Allocates the delay lines of the reverb, this must be called prior to any other function
+         */
+        void Initialize();
+
+        /**
+         * @brief Recomputes the delay lengths and gains from the parameters
+         * @note This doesn't allocate and can be called while mixing
+         */
+        void Update(const Parameters &parameters);
+
+        void Reset();
+
+        void Process(span<float *const> outputs, span<const float *const> inputs, size_t frameCount, const Parameters &parameters);
+    };
+}
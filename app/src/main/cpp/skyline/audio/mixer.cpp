@@ -0,0 +1,123 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <arm_neon.h>
+#include "common.h"
+#include "mixer.h"
+
+namespace skyline::audio {
+    static inline void MixStereoSample(span<float> mix, span<const i16> samples, size_t index, float volume, float volumeDelta) {
+        float frameVolume{std::fma(volumeDelta, static_cast<float>(index / constant::StereoChannelCount), volume)};
+        mix[index] = std::fma(static_cast<float>(samples[index]), frameVolume, mix[index]);
+    }
+
+    static inline void SaturateSample(span<i16> output, span<const float> mix, size_t index) {
+        output[index] = static_cast<i16>(std::clamp(mix[index], static_cast<float>(std::numeric_limits<i16>::min()), static_cast<float>(std::numeric_limits<i16>::max())));
+    }
+
+    void MixStereo(span<float> mix, span<const i16> samples, float volume, float volumeDelta) {
+        constexpr size_t SamplesPerIteration{8}; //!< 4 stereo frames are processed in every iteration
+        size_t index{};
+
+        if (samples.size() >= SamplesPerIteration) {
+            float32x4_t baseVolume{vdupq_n_f32(volume)}, delta{vdupq_n_f32(volumeDelta)};
+            float32x4_t lowFrames{0.0f, 0.0f, 1.0f, 1.0f}, highFrames{2.0f, 2.0f, 3.0f, 3.0f}; // The frame index of every sample in the iteration, these are exact integers in float
+            float32x4_t frameIncrement{vdupq_n_f32(SamplesPerIteration / constant::StereoChannelCount)};
+
+            for (; index + SamplesPerIteration <= samples.size(); index += SamplesPerIteration) {
+                int16x8_t input{vld1q_s16(samples.data() + index)};
+                float32x4_t lowSamples{vcvtq_f32_s32(vmovl_s16(vget_low_s16(input)))}, highSamples{vcvtq_f32_s32(vmovl_high_s16(input))};
+
+                float32x4_t lowVolume{vfmaq_f32(baseVolume, delta, lowFrames)}, highVolume{vfmaq_f32(baseVolume, delta, highFrames)};
+
+                float *output{mix.data() + index};
+                vst1q_f32(output, vfmaq_f32(vld1q_f32(output), lowSamples, lowVolume));
+                vst1q_f32(output + 4, vfmaq_f32(vld1q_f32(output + 4), highSamples, highVolume));
+
+                lowFrames = vaddq_f32(lowFrames, frameIncrement);
+                highFrames = vaddq_f32(highFrames, frameIncrement);
+            }
+        }
+
+        for (; index < samples.size(); index++)
+            MixStereoSample(mix, samples, index, volume, volumeDelta);
+    }
+
+    void MixStereoReference(span<float> mix, span<const i16> samples, float volume, float volumeDelta) {
+        for (size_t index{}; index < samples.size(); index++)
+            MixStereoSample(mix, samples, index, volume, volumeDelta);
+    }
+
+    void SaturateMix(span<i16> output, span<const float> mix) {
+        constexpr size_t SamplesPerIteration{8};
+        size_t index{};
+
+        for (; index + SamplesPerIteration <= mix.size(); index += SamplesPerIteration) {
+            // FCVTZS truncates towards zero and saturates to the range of i32, SQXTN then saturates that to i16
+            int32x4_t low{vcvtq_s32_f32(vld1q_f32(mix.data() + index))}, high{vcvtq_s32_f32(vld1q_f32(mix.data() + index + 4))};
+            vst1q_s16(output.data() + index, vqmovn_high_s32(vqmovn_s32(low), high));
+        }
+
+        for (; index < mix.size(); index++)
+            SaturateSample(output, mix, index);
+    }
+
+    void SaturateMixReference(span<i16> output, span<const float> mix) {
+        for (size_t index{}; index < mix.size(); index++)
+            SaturateSample(output, mix, index);
+    }
+
+    void MixSaturated(span<i16> output, span<const i16> samples) {
+        size_t index{};
+        for (; index + 8 <= samples.size(); index += 8)
+            vst1q_s16(output.data() + index, vqaddq_s16(vld1q_s16(output.data() + index), vld1q_s16(samples.data() + index)));
+
+        for (; index < samples.size(); index++)
+            output[index] = Saturate<i16, i32>(static_cast<i32>(output[index]) + samples[index]);
+    }
+
+    void DeinterleaveStereo(span<float> left, span<float> right, span<const float> interleaved) {
+        size_t frame{}, frameCount{interleaved.size() / constant::StereoChannelCount};
+
+        for (; frame + 4 <= frameCount; frame += 4) {
+            float32x4x2_t frames{vld2q_f32(interleaved.data() + (frame * constant::StereoChannelCount))};
+            vst1q_f32(left.data() + frame, frames.val[0]);
+            vst1q_f32(right.data() + frame, frames.val[1]);
+        }
+
+        for (; frame < frameCount; frame++) {
+            left[frame] = interleaved[frame * constant::StereoChannelCount];
+            right[frame] = interleaved[(frame * constant::StereoChannelCount) + 1];
+        }
+    }
+
+    void InterleaveStereo(span<float> interleaved, span<const float> left, span<const float> right) {
+        size_t frame{}, frameCount{interleaved.size() / constant::StereoChannelCount};
+
+        for (; frame + 4 <= frameCount; frame += 4)
+            vst2q_f32(interleaved.data() + (frame * constant::StereoChannelCount), float32x4x2_t{vld1q_f32(left.data() + frame), vld1q_f32(right.data() + frame)});
+
+        for (; frame < frameCount; frame++) {
+            interleaved[frame * constant::StereoChannelCount] = left[frame];
+            interleaved[(frame * constant::StereoChannelCount) + 1] = right[frame];
+        }
+    }
+
+    void MixScaled(span<float> output, span<const float> input, float gain) {
+        size_t index{};
+        for (; index + 4 <= input.size(); index += 4)
+            vst1q_f32(output.data() + index, vfmaq_n_f32(vld1q_f32(output.data() + index), vld1q_f32(input.data() + index), gain));
+
+        for (; index < input.size(); index++)
+            output[index] = std::fma(input[index], gain, output[index]);
+    }
+
+    void Scale(span<float> output, span<const float> input, float gain) {
+        size_t index{};
+        for (; index + 4 <= input.size(); index += 4)
+            vst1q_f32(output.data() + index, vmulq_n_f32(vld1q_f32(input.data() + index), gain));
+
+        for (; index < input.size(); index++)
+            output[index] = input[index] * gain;
+    }
+}
@@ -0,0 +1,57 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <common.h>
+
+namespace skyline::audio {
+    /**
+     * @brief Accumulates interleaved stereo samples into a mix buffer with a volume that is linearly ramped across frames
+     * @param mix The mix buffer to accumulate into, this must be the same size as samples
+     * @param volume The volume of the first frame
+     * @param volumeDelta The amount the volume changes by for every frame
+     * @note Every output sample is computed as fma(sample, fma(volumeDelta, frame, volume), mix) so the vectorised kernel is bit-exact with MixStereoReference
+     */
+    void MixStereo(span<float> mix, span<const i16> samples, float volume, float volumeDelta);
+
+    /**
+     * @brief A scalar implementation of MixStereo which the vectorised kernel is verified against
+     */
+    void MixStereoReference(span<float> mix, span<const i16> samples, float volume, float volumeDelta);
+
+    /**
+     * @brief Converts a mix buffer into PCM16 samples, values are truncated towards zero and saturated to the range of i16
+     */
+    void SaturateMix(span<i16> output, span<const float> mix);
+
+    /**
+     * @brief A scalar implementation of SaturateMix which the vectorised kernel is verified against
+     */
+    void SaturateMixReference(span<i16> output, span<const float> mix);
+
+    /**
+     * @brief Accumulates PCM16 samples into an output buffer with the result saturated to the range of i16
+     */
+    void MixSaturated(span<i16> output, span<const i16> samples);
+
+    /**
+     * @brief Splits interleaved stereo samples into a separate buffer for each channel
+     */
+    void DeinterleaveStereo(span<float> left, span<float> right, span<const float> interleaved);
+
+    /**
+     * @brief Combines a buffer for each channel into interleaved stereo samples
+     */
+    void InterleaveStereo(span<float> interleaved, span<const float> left, span<const float> right);
+
+    /**
+     * @brief Accumulates samples scaled by a constant gain into an output buffer, this is safe to use in-place
+     */
+    void MixScaled(span<float> output, span<const float> input, float gain);
+
+    /**
+     * @brief Scales samples by a constant gain into an output buffer, this is safe to use in-place
+     */
+    void Scale(span<float> output, span<const float> input, float gain);
+}
@@ -0,0 +1,69 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include "null_sink.h"
+
+namespace skyline::audio {
+    NullSink::NullSink(RenderCallback renderCallback, bool realtime, OutputCallback outputCallback)
+        : renderCallback{std::move(renderCallback)},
+          outputCallback{std::move(outputCallback)},
+          realtime{realtime},
+          thread{&NullSink::Run, this} {}
+
+    NullSink::~NullSink() {
+        {
+            std::scoped_lock lock{stateMutex};
+            exit = true;
+        }
+        stateCondition.notify_all();
+        thread.join();
+    }
+
+    void NullSink::Pause() {
+        std::scoped_lock lock{stateMutex};
+        paused = true;
+    }
+
+    void NullSink::Resume() {
+        {
+            std::scoped_lock lock{stateMutex};
+            paused = false;
+        }
+        stateCondition.notify_all();
+    }
+
+    void NullSink::Run() {
+        if (int result{pthread_setname_np(pthread_self(), "Sky-AudioSink")})
+            Logger::Warn("Failed to set the thread name: {}", strerror(result));
+
+        constexpr std::chrono::nanoseconds Period{(constant::NsInSecond * PeriodFrames) / constant::SampleRate};
+        auto next{std::chrono::steady_clock::now()};
+
+        try {
+            while (!exit) {
+                if (paused) {
+                    std::unique_lock lock{stateMutex};
+                    stateCondition.wait(lock, [this] { return !paused || exit; });
+                    next = std::chrono::steady_clock::now();
+                    continue;
+                }
+
+                renderCallback(buffer);
+                if (outputCallback)
+                    outputCallback(buffer);
+                renderedFrames.fetch_add(PeriodFrames, std::memory_order_relaxed);
+
+                if (realtime) {
+                    next += Period;
+                    auto now{std::chrono::steady_clock::now()};
+                    if (now - next > Period)
+                        next = now; // We've fallen behind by more than a period, there's no point in trying to catch up
+                    else
+                        std::this_thread::sleep_until(next);
+                }
+            }
+        } catch (const std::exception &e) {
+            Logger::Error("Audio sink thread has exited: {}", e.what());
+        }
+    }
+}
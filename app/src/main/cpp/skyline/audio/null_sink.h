@@ -0,0 +1,52 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include "common.h"
+#include "sink.h"
+
+namespace skyline::audio {
+    /**
+     * @brief A sink without an audio device which requests samples from a thread at the real-time rate or as fast as possible
+     * @note This is useful for running and profiling the audio path on devices or hosts without any audio output
+     */
+    class NullSink : public AudioSink {
+      public:
+        using OutputCallback = std::function<void(span<const i16> samples)>; //!< A callback which receives every period of rendered samples
+
+        static constexpr size_t PeriodFrames{240}; //!< The amount of frames requested from the render callback at a time (5ms)
+
+      private:
+        RenderCallback renderCallback;
+        OutputCallback outputCallback;
+        bool realtime; //!< If periods are paced at the real-time rate rather than being rendered back-to-back
+        std::array<i16, PeriodFrames * constant::StereoChannelCount> buffer;
+
+        std::mutex stateMutex; //!< Synchronizes changes to paused and exit for stateCondition
+        std::condition_variable stateCondition;
+        std::atomic<bool> paused{};
+        std::atomic<bool> exit{};
+
+      public:
+        std::atomic<u64> renderedFrames{}; //!< The total amount of frames that have been requested from the render callback
+
+      private:
+        std::thread thread; //!< The thread requesting periods, this must be declared after all members it accesses so they're initialized before it starts
+
+        void Run();
+
+      public:
+        /**
+         * @param realtime If periods should be paced at 48 kHz with a high-resolution clock, otherwise they're rendered as fast as the render callback allows
+         * @param outputCallback An optional callback which is called with the samples of every period after they've been rendered
+         */
+        NullSink(RenderCallback renderCallback, bool realtime = true, OutputCallback outputCallback = {});
+
+        ~NullSink();
+
+        void Pause() override;
+
+        void Resume() override;
+    };
+}
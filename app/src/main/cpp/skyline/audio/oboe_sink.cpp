@@ -0,0 +1,41 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include "oboe_sink.h"
+
+namespace skyline::audio {
+    OboeSink::OboeSink(RenderCallback renderCallback) : renderCallback{std::move(renderCallback)} {
+        builder.setChannelCount(constant::StereoChannelCount);
+        builder.setSampleRate(constant::SampleRate);
+        builder.setFormat(constant::PcmFormat);
+        builder.setUsage(oboe::Usage::Game);
+        builder.setCallback(this);
+        builder.setSharingMode(oboe::SharingMode::Exclusive);
+        builder.setPerformanceMode(oboe::PerformanceMode::LowLatency);
+
+        builder.openManagedStream(outputStream);
+        outputStream->requestStart();
+    }
+
+    OboeSink::~OboeSink() {
+        outputStream->requestStop();
+    }
+
+    void OboeSink::Pause() {
+        outputStream->requestPause();
+    }
+
+    void OboeSink::Resume() {
+        outputStream->requestStart();
+    }
+
+    oboe::DataCallbackResult OboeSink::onAudioReady(oboe::AudioStream *audioStream, void *audioData, int32_t numFrames) {
+        renderCallback(span<i16>{static_cast<i16 *>(audioData), static_cast<size_t>(numFrames) * static_cast<size_t>(audioStream->getChannelCount())});
+        return oboe::DataCallbackResult::Continue;
+    }
+
+    void OboeSink::onErrorAfterClose(oboe::AudioStream *audioStream, oboe::Result error) {
+        builder.openManagedStream(outputStream);
+        outputStream->requestStart();
+    }
+}
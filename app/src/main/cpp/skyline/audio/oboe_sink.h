@@ -0,0 +1,43 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include "common.h"
+#include "sink.h"
+
+namespace skyline::audio {
+    /**
+     * @brief A sink that outputs audio to the device using a low latency Oboe stream
+     */
+    class OboeSink : public AudioSink, public oboe::AudioStreamCallback {
+      private:
+        RenderCallback renderCallback;
+        oboe::AudioStreamBuilder builder;
+        oboe::ManagedStream outputStream;
+
+      public:
+        OboeSink(RenderCallback renderCallback);
+
+        ~OboeSink();
+
+        void Pause() override;
+
+        void Resume() override;
+
+        /**
+         * @brief The callback oboe uses to get audio sample data
+         * @param audioStream The audio stream we are being called by
+         * @param audioData The raw audio sample data
+         * @param numFrames The amount of frames the sample data needs to contain
+         */
+        oboe::DataCallbackResult onAudioReady(oboe::AudioStream *audioStream, void *audioData, int32_t numFrames) override;
+
+        /**
+         * @brief The callback oboe uses to notify the application about stream closure
+         * @param audioStream The audio stream we are being called by
+         * @param error The error due to which the stream is being closed
+         */
+        void onErrorAfterClose(oboe::AudioStream *audioStream, oboe::Result error) override;
+    };
+}
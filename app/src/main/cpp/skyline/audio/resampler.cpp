@@ -1,6 +1,8 @@
 // SPDX-License-Identifier: MPL-2.0
 // Copyright © 2020 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
+#include <bit>
+#include <arm_neon.h>
 #include "common.h"
 #include "resampler.h"
 
@@ -119,40 +121,234 @@ namespace skyline::audio {
         {-42, 3751, 26253, 2811},   {-38, 3608, 26270, 2936},   {-34, 3467, 26281, 3064},   {-32, 3329, 26287, 3195}}};
     // @fmt:on
 
-    std::vector<i16> Resampler::ResampleBuffer(span<i16> inputBuffer, double ratio, u8 channelCount) {
-        auto step{static_cast<u32>(ratio * 0x8000)};
-        auto outputSize{static_cast<size_t>(inputBuffer.size() / ratio)};
-        std::vector<i16> outputBuffer(outputSize);
+    /**
+     * @return The interpolation curve that should be used for the supplied step
+     */
+    static const std::array<LutEntry, 128> &GetCurveLut(u32 step) {
+        if (step > 0xAAAA)
+            return CurveLut0;
+        else if (step <= 0x8000)
+            return CurveLut1;
+        else
+            return CurveLut2;
+    }
+
+    /**
+     * @brief The curves narrowed to 16-bit so they can be directly multiplied with samples, all coefficients fit in an i16
+     */
+    template<const std::array<LutEntry, 128> &Lut>
+    static constexpr std::array<std::array<i16, 4>, 128> NarrowCurveLut() {
+        std::array<std::array<i16, 4>, 128> narrowed{};
+        for (size_t index{}; index < Lut.size(); index++)
+            narrowed[index] = {static_cast<i16>(Lut[index].a), static_cast<i16>(Lut[index].b), static_cast<i16>(Lut[index].c), static_cast<i16>(Lut[index].d)};
+        return narrowed;
+    }
 
-        const std::array<LutEntry, 128> &lut = [step] {
-            if (step > 0xAAAA)
-                return CurveLut0;
-            else if (step <= 0x8000)
-                return CurveLut1;
-            else
-                return CurveLut2;
-        }();
+    constexpr std::array<std::array<i16, 4>, 128> NarrowCurveLut0{NarrowCurveLut<CurveLut0>()}, NarrowCurveLut1{NarrowCurveLut<CurveLut1>()}, NarrowCurveLut2{NarrowCurveLut<CurveLut2>()};
 
-        for (size_t outIndex{}, inIndex{}; outIndex < outputSize; outIndex += channelCount) {
-            u32 lutIndex{fraction >> 8};
+    static const std::array<std::array<i16, 4>, 128> &GetNarrowCurveLut(u32 step) {
+        if (step > 0xAAAA)
+            return NarrowCurveLut0;
+        else if (step <= 0x8000)
+            return NarrowCurveLut1;
+        else
+            return NarrowCurveLut2;
+    }
+
+    /**
+     * @brief Resamples with the 4-tap curves using a scalar loop, this supports any channel count
+     */
+    static void ResampleCurveScalar(span<const i16> input, span<i16> output, u32 step, u8 channelCount, u32 &fraction, size_t outIndex, size_t inIndex) {
+        const auto &lut{GetCurveLut(step)};
+
+        for (; outIndex < output.size(); outIndex += channelCount) {
+            const auto &entry{lut[fraction >> 8]};
+            const i16 *frames{input.data() + inIndex * channelCount};
 
             for (u8 channel{}; channel < channelCount; channel++) {
-                if (((inIndex + 3) * channelCount + channel) >= inputBuffer.size())
-                    continue;
+                i32 data{frames[channel] * entry.a +
+                         frames[channelCount + channel] * entry.b +
+                         frames[(2 * channelCount) + channel] * entry.c +
+                         frames[(3 * channelCount) + channel] * entry.d};
+
+                output[outIndex + channel] = Saturate<i16, i32>(data >> 15);
+            }
+
+            u32 newOffset{fraction + step};
+            inIndex += newOffset >> 15;
+            fraction = newOffset & 0x7FFF;
+        }
+    }
+
+    /**
+     * @brief Resamples with the 4-tap curves using NEON for mono and stereo, the result is bit-exact with ResampleCurveScalar
+     */
+    static void ResampleCurve(span<const i16> input, span<i16> output, u32 step, u8 channelCount, u32 &fraction) {
+        const auto &lut{GetNarrowCurveLut(step)};
+        size_t outIndex{}, inIndex{};
 
-                i32 data{inputBuffer[(inIndex + 0) * channelCount + channel] * lut[lutIndex].a +
-                         inputBuffer[(inIndex + 1) * channelCount + channel] * lut[lutIndex].b +
-                         inputBuffer[(inIndex + 2) * channelCount + channel] * lut[lutIndex].c +
-                         inputBuffer[(inIndex + 3) * channelCount + channel] * lut[lutIndex].d};
+        if (channelCount == 1) {
+            for (; outIndex < output.size(); outIndex++) {
+                int32x4_t products{vmull_s16(vld1_s16(input.data() + inIndex), vld1_s16(lut[fraction >> 8].data()))};
+                output[outIndex] = Saturate<i16, i32>(vaddvq_s32(products) >> 15);
 
-                outputBuffer[outIndex + channel] = Saturate<i16, i32>(data >> 15);
+                u32 newOffset{fraction + step};
+                inIndex += newOffset >> 15;
+                fraction = newOffset & 0x7FFF;
+            }
+        } else if (channelCount == constant::StereoChannelCount) {
+            // Two output frames are produced per iteration so the narrowing store writes a full vector of 4 samples
+            auto resampleFrame{[&]() {
+                int16x4_t coefficients{vld1_s16(lut[fraction >> 8].data())};
+                int16x8_t frames{vld1q_s16(input.data() + (inIndex * constant::StereoChannelCount))}; // L0 R0 L1 R1 L2 R2 L3 R3
+
+                // {a, a, b, b} * {L0, R0, L1, R1} + {c, c, d, d} * {L2, R2, L3, R3}
+                int32x4_t products{vmull_s16(vget_low_s16(frames), vzip1_s16(coefficients, coefficients))};
+                products = vmlal_s16(products, vget_high_s16(frames), vzip2_s16(coefficients, coefficients));
+
+                u32 newOffset{fraction + step};
+                inIndex += newOffset >> 15;
+                fraction = newOffset & 0x7FFF;
+
+                return vadd_s32(vget_low_s32(products), vget_high_s32(products));
+            }};
+
+            for (; outIndex + (2 * constant::StereoChannelCount) <= output.size(); outIndex += 2 * constant::StereoChannelCount) {
+                int32x2_t first{resampleFrame()}, second{resampleFrame()};
+                vst1_s16(output.data() + outIndex, vqshrn_n_s32(vcombine_s32(first, second), 15));
+            }
+        }
+
+        ResampleCurveScalar(input, output, step, channelCount, fraction, outIndex, inIndex);
+    }
+
+    /**
+     * @brief Resamples with a polyphase filter, mono and stereo are filtered with NEON
+     */
+    static void ResamplePolyphase(span<const i16> input, span<i16> output, u32 step, u8 channelCount, u32 &fraction, const Resampler::PolyphaseFilter &filter) {
+        constexpr size_t Taps{Resampler::HighQualityTaps};
+        constexpr u32 PhaseShift{15 - std::countr_zero(Resampler::PhaseCount)};
+
+        auto toSample{[](float value) {
+            return Saturate<i16, float>(std::nearbyint(value));
+        }};
+
+        for (size_t outIndex{}, inIndex{}; outIndex < output.size(); outIndex += channelCount) {
+            const auto &phase{filter.phases[fraction >> PhaseShift]};
+            const i16 *frames{input.data() + inIndex * channelCount};
+
+            if (channelCount == 1) {
+                float32x4_t sum{vdupq_n_f32(0.0f)};
+                for (size_t tap{}; tap < Taps; tap += 8) {
+                    int16x8_t samples{vld1q_s16(frames + tap)};
+                    sum = vfmaq_f32(sum, vcvtq_f32_s32(vmovl_s16(vget_low_s16(samples))), vld1q_f32(phase.data() + tap));
+                    sum = vfmaq_f32(sum, vcvtq_f32_s32(vmovl_high_s16(samples)), vld1q_f32(phase.data() + tap + 4));
+                }
+                output[outIndex] = toSample(vaddvq_f32(sum));
+            } else if (channelCount == constant::StereoChannelCount) {
+                float32x4_t left{vdupq_n_f32(0.0f)}, right{vdupq_n_f32(0.0f)};
+                for (size_t tap{}; tap < Taps; tap += 8) {
+                    int16x8x2_t samples{vld2q_s16(frames + (tap * constant::StereoChannelCount))}; // Deinterleaves 8 frames into the left and right channels
+                    float32x4_t lowCoefficients{vld1q_f32(phase.data() + tap)}, highCoefficients{vld1q_f32(phase.data() + tap + 4)};
+                    left = vfmaq_f32(left, vcvtq_f32_s32(vmovl_s16(vget_low_s16(samples.val[0]))), lowCoefficients);
+                    left = vfmaq_f32(left, vcvtq_f32_s32(vmovl_high_s16(samples.val[0])), highCoefficients);
+                    right = vfmaq_f32(right, vcvtq_f32_s32(vmovl_s16(vget_low_s16(samples.val[1]))), lowCoefficients);
+                    right = vfmaq_f32(right, vcvtq_f32_s32(vmovl_high_s16(samples.val[1])), highCoefficients);
+                }
+                output[outIndex] = toSample(vaddvq_f32(left));
+                output[outIndex + 1] = toSample(vaddvq_f32(right));
+            } else {
+                for (u8 channel{}; channel < channelCount; channel++) {
+                    float sum{};
+                    for (size_t tap{}; tap < Taps; tap++)
+                        sum = std::fma(static_cast<float>(frames[(tap * channelCount) + channel]), phase[tap], sum);
+                    output[outIndex + channel] = toSample(sum);
+                }
             }
 
             u32 newOffset{fraction + step};
             inIndex += newOffset >> 15;
             fraction = newOffset & 0x7FFF;
         }
+    }
+
+    std::shared_ptr<const Resampler::PolyphaseFilter> Resampler::GetPolyphaseFilter(u32 step) {
+        static std::mutex mutex;
+        static std::unordered_map<u32, std::shared_ptr<const PolyphaseFilter>> filters;
+
+        std::scoped_lock lock{mutex};
+        auto &filter{filters[step]};
+        if (filter)
+            return filter;
+
+        // The cutoff is at the Nyquist frequency of the lower of the input and output rates with some headroom for the transition band
+        constexpr double TransitionHeadroom{0.9};
+        double cutoff{std::min(1.0, static_cast<double>(1 << 15) / step) * TransitionHeadroom};
+        constexpr double HalfWidth{HighQualityTaps / 2};
+
+        auto newFilter{std::make_shared<PolyphaseFilter>()};
+        for (size_t phase{}; phase < PhaseCount; phase++) {
+            // The output position lies between taps (HighQualityTaps / 2 - 1) and (HighQualityTaps / 2) at the fraction of the phase
+            double position{(HalfWidth - 1) + static_cast<double>(phase) / PhaseCount}, sum{};
+            std::array<double, HighQualityTaps> coefficients{};
+            for (size_t tap{}; tap < HighQualityTaps; tap++) {
+                double x{static_cast<double>(tap) - position};
+                double sinc{x == 0.0 ? 1.0 : std::sin(M_PI * cutoff * x) / (M_PI * cutoff * x)};
+                double window{0.42 + 0.5 * std::cos(M_PI * x / HalfWidth) + 0.08 * std::cos(2.0 * M_PI * x / HalfWidth)}; // Blackman
+                coefficients[tap] = std::abs(x) < HalfWidth ? sinc * window : 0.0;
+                sum += coefficients[tap];
+            }
+
+            // Every phase is normalised to unity gain at DC so there's no modulation of the signal level between phases
+            for (size_t tap{}; tap < HighQualityTaps; tap++)
+                newFilter->phases[phase][tap] = static_cast<float>(coefficients[tap] / sum);
+        }
+
+        filter = std::move(newFilter);
+        return filter;
+    }
+
+    Resampler::Resampler(ResamplerQuality quality) : quality{quality} {}
+
+    void Resampler::Resample(span<const i16> input, span<i16> output, u32 step, u8 channelCount) {
+        if (quality == ResamplerQuality::High) {
+            if (filterStep != step || !filter) {
+                filter = GetPolyphaseFilter(step);
+                filterStep = step;
+            }
+            ResamplePolyphase(input, output, step, channelCount, fraction, *filter);
+        } else {
+            ResampleCurve(input, output, step, channelCount, fraction);
+        }
+    }
+
+    span<i16> Resampler::ResampleChunk(span<const i16> input, u32 step, u8 channelCount) {
+        size_t historyFrames{GetHistoryFrames()};
+        if (chunkPendingFrames < historyFrames) {
+            // The stream is preceded by silence
+            chunkInput.resize(std::max(chunkInput.size(), historyFrames * channelCount));
+            std::fill_n(chunkInput.begin(), historyFrames * channelCount, 0);
+            chunkPendingFrames = historyFrames;
+        }
+
+        size_t pendingSamples{chunkPendingFrames * channelCount}, totalSamples{pendingSamples + input.size()};
+        if (chunkInput.size() < totalSamples)
+            chunkInput.resize(totalSamples);
+        std::copy(input.begin(), input.end(), chunkInput.begin() + static_cast<ssize_t>(pendingSamples));
+
+        size_t totalFrames{totalSamples / channelCount};
+        size_t outputFrames{GetOutputFrameCount(totalFrames - historyFrames, step)};
+        size_t consumedFrames{GetInputFrameCount(outputFrames, step)};
+
+        if (chunkOutput.size() < outputFrames * channelCount)
+            chunkOutput.resize(outputFrames * channelCount);
+        auto output{span(chunkOutput).first(outputFrames * channelCount)};
+        Resample(span(chunkInput).first(totalFrames * channelCount), output, step, channelCount);
+
+        // The history of the next chunk starts at the first frame that wasn't consumed, any frames after it are also retained
+        chunkPendingFrames = totalFrames - consumedFrames;
+        std::memmove(chunkInput.data(), chunkInput.data() + (consumedFrames * channelCount), chunkPendingFrames * channelCount * sizeof(i16));
 
-        return outputBuffer;
+        return output;
     }
 }
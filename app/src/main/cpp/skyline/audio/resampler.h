@@ -6,20 +6,95 @@
 #include <common.h>
 
 namespace skyline::audio {
+    enum class ResamplerQuality : u8 {
+        Standard, //!< The 4-tap interpolation curves used by HOS
+        High, //!< A 16-tap windowed-sinc polyphase filter
+    };
+
     /**
      * @brief The Resampler class handles resampling audio PCM data
      */
     class Resampler {
+      public:
+        static constexpr size_t StandardTaps{4}; //!< The amount of input frames that contribute to an output frame with ResamplerQuality::Standard
+        static constexpr size_t HighQualityTaps{16}; //!< The amount of input frames that contribute to an output frame with ResamplerQuality::High
+        static constexpr size_t PhaseCount{128}; //!< The amount of distinct fractional positions between two input frames
+
+        /**
+         * @brief The coefficients of a windowed-sinc filter for every phase, the cutoff of the filter depends on the resampling step
+         */
+        struct PolyphaseFilter {
+            std::array<std::array<float, HighQualityTaps>, PhaseCount> phases;
+        };
+
       private:
+        ResamplerQuality quality;
         u32 fraction{}; //!< The fractional value used for storing the resamplers last frame
+        std::shared_ptr<const PolyphaseFilter> filter; //!< The filter used for ResamplerQuality::High, this is only valid for filterStep
+        u32 filterStep{};
+
+        std::vector<i16> chunkInput; //!< The history and unconsumed frames from previous chunks followed by the new chunk for ResampleChunk
+        size_t chunkPendingFrames{}; //!< The amount of frames at the start of chunkInput that were carried over from the previous chunk
+        std::vector<i16> chunkOutput;
+
+        /**
+         * @return A filter for the supplied step, filters are cached globally and shared between resamplers
+         */
+        static std::shared_ptr<const PolyphaseFilter> GetPolyphaseFilter(u32 step);
 
       public:
+        Resampler(ResamplerQuality quality = ResamplerQuality::Standard);
+
+        /**
+         * @return The step between output frames in the input in 17.15 fixed point
+         */
+        static constexpr u32 GetStep(u32 inputSampleRate, u32 outputSampleRate) {
+            return static_cast<u32>((static_cast<u64>(inputSampleRate) << 15) / outputSampleRate);
+        }
+
+        /**
+         * @return The amount of frames from the previous input that must precede the new input in Resample
+         */
+        size_t GetHistoryFrames() const {
+            return (quality == ResamplerQuality::High ? HighQualityTaps : StandardTaps) - 1;
+        }
+
+        /**
+         * @return The amount of new input frames that Resample will consume to produce the supplied amount of output frames
+         */
+        size_t GetInputFrameCount(size_t outputFrames, u32 step) const {
+            return static_cast<size_t>((fraction + static_cast<u64>(step) * outputFrames) >> 15);
+        }
+
+        /**
+         * @return The maximum amount of output frames that can be produced from the supplied amount of new input frames without consuming more than that
+         */
+        size_t GetOutputFrameCount(size_t inputFrames, u32 step) const {
+            return static_cast<size_t>(((static_cast<u64>(inputFrames) << 15) - std::min<u64>(fraction, static_cast<u64>(inputFrames) << 15)) / step);
+        }
+
+        /**
+         * @brief Resamples a continuous stream of frames in chunks, the fractional position is retained across calls so chunk boundaries are seamless
+         * @param input Interleaved frames consisting of the last GetHistoryFrames() frames of the previous input followed by GetInputFrameCount(outputFrames) new frames
+         * @param output The buffer to write the resampled frames into, its size determines the amount of output frames
+         * @param step The step returned by GetStep()
+         * @note Mono and stereo are resampled with NEON kernels, the standard quality kernel is bit-exact with the scalar implementation
+         */
+        void Resample(span<const i16> input, span<i16> output, u32 step, u8 channelCount);
+
+        /**
+         * @brief Resamples an arbitrarily sized chunk of a stream, input frames that can't be consumed yet are retained for the next chunk
+         * @return The resampled frames, this is only valid until the next call
+         * @note The internal buffers only grow when a chunk is larger than any previous one
+         */
+        span<i16> ResampleChunk(span<const i16> input, u32 step, u8 channelCount);
+
         /**
-         * @brief Resamples the given sample buffer by the given ratio
-         * @param inputBuffer A buffer containing PCM sample data
-         * @param ratio The conversion ratio needed
-         * @param channelCount The amount of channels the buffer contains
+         * @brief Resets the fractional position and any retained input for a new stream
          */
-        std::vector<i16> ResampleBuffer(span <i16> inputBuffer, double ratio, u8 channelCount);
+        void Reset() {
+            fraction = 0;
+            chunkPendingFrames = 0;
+        }
     };
 }
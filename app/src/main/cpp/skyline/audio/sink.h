@@ -0,0 +1,38 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <common.h>
+
+namespace skyline::audio {
+    /**
+     * @brief The types of sinks that audio can be output to
+     */
+    enum class AudioSinkType : u32 {
+        Device = 0, //!< The device's audio output through Oboe
+        Null = 1, //!< Audio is mixed at the real-time rate but discarded
+        Wav = 2, //!< Audio is mixed at the real-time rate and recorded to a WAV file
+    };
+
+    /**
+     * @brief An abstract destination for the final mixed audio, a sink periodically requests interleaved stereo PCM16 samples at 48 kHz from a callback
+     * @note A sink must never call its render callback from more than one thread at a time
+     */
+    class AudioSink {
+      public:
+        using RenderCallback = std::function<void(span<i16> output)>; //!< A callback which fills the output buffer with samples, this is wait-free
+
+        virtual ~AudioSink() = default;
+
+        /**
+         * @brief Pauses requesting samples from the render callback
+         */
+        virtual void Pause() = 0;
+
+        /**
+         * @brief Resumes requesting samples from the render callback
+         */
+        virtual void Resume() = 0;
+    };
+}
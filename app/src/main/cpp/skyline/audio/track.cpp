@@ -1,7 +1,7 @@
 // SPDX-License-Identifier: MPL-2.0
 // Copyright © 2020 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
-#include "downmixer.h"
+#include "mixer.h"
 #include "track.h"
 
 namespace skyline::audio {
@@ -17,75 +17,91 @@ namespace skyline::audio {
     }
 
     void AudioTrack::Stop() {
-        auto allSamplesReleased{[&]() {
-            std::scoped_lock lock{bufferLock};
-            return identifiers.empty() || identifiers.back().released;
-        }};
-
-        while (!allSamplesReleased());
+        while (sampleCounter.load(std::memory_order_acquire) < appendedSamples.load(std::memory_order_acquire));
         playbackState = AudioOutState::Stopped;
     }
 
     bool AudioTrack::ContainsBuffer(u64 tag) {
-        std::scoped_lock lock(bufferLock);
-
-        // Iterate from front of queue as we don't want released samples
-        for (auto identifier{identifiers.crbegin()}; identifier != identifiers.crend(); identifier++) {
-            if (identifier->released)
-                return false;
-
-            if (identifier->tag == tag)
-                return true;
-        }
+        std::scoped_lock lock{identifierLock};
 
-        return false;
+        u64 playedSamples{sampleCounter.load(std::memory_order_acquire)};
+        return identifiers.Any([&](const BufferIdentifier &identifier) {
+            return identifier.tag == tag && identifier.finalSample > playedSamples;
+        });
     }
 
     std::vector<u64> AudioTrack::GetReleasedBuffers(u32 max) {
         std::vector<u64> bufferIds;
-        std::scoped_lock lock(bufferLock);
+        std::scoped_lock lock{identifierLock};
 
+        u64 playedSamples{sampleCounter.load(std::memory_order_acquire)};
         for (u32 index{}; index < max; index++) {
-            if (identifiers.empty() || !identifiers.back().released)
+            auto identifier{identifiers.Front()};
+            if (!identifier || identifier->finalSample > playedSamples)
                 break;
-            bufferIds.push_back(identifiers.back().tag);
-            identifiers.pop_back();
+            bufferIds.push_back(identifier->tag);
+            identifiers.Pop();
         }
 
         return bufferIds;
     }
 
     void AudioTrack::AppendBuffer(u64 tag, span<i16> buffer) {
-        std::scoped_lock lock(bufferLock);
+        std::scoped_lock lock{appendLock};
 
-        size_t size{(channelCount == constant::SurroundChannelCount) ? (buffer.size() / sizeof(Surround51Sample)) * sizeof(StereoSample) : buffer.size()};
-        BufferIdentifier identifier{
-            .released = false,
-            .tag = tag,
-            .finalSample = identifiers.empty() ? size : (size + identifiers.front().finalSample)
-        };
-
-        identifiers.push_front(identifier);
+        // This is checked prior to writing any samples so a buffer that can't be tracked doesn't leave its samples in the ring, space can only increase concurrently as we're the sole producer
+        if (identifiers.Size() >= MaxBufferCount)
+            throw exception("Too many audio buffers have been appended without being released: {}", MaxBufferCount);
 
+        span<const i16> stereoSamples{buffer};
         if (channelCount == constant::SurroundChannelCount) {
-            auto stereoBuffer{DownMix(buffer.cast<Surround51Sample>())};
-            samples.Append(span(stereoBuffer).cast<i16>());
-        } else {
-            samples.Append(buffer);
+            auto surroundSamples{buffer.cast<Surround51Sample>()};
+            if (downMixBuffer.size() < surroundSamples.size())
+                downMixBuffer.resize(surroundSamples.size());
+
+            span<StereoSample> stereoBuffer(downMixBuffer.data(), surroundSamples.size());
+            DownMix(surroundSamples, stereoBuffer);
+            stereoSamples = span<const i16>(stereoBuffer.cast<i16>());
         }
+
+        size_t written{samples.Write(stereoSamples)};
+        if (written != stereoSamples.size())
+            overrunSampleCount.fetch_add(stereoSamples.size() - written, std::memory_order_relaxed);
+
+        // The final sample is based on what was actually written, otherwise the buffer would never be considered played
+        u64 finalSample{appendedSamples.load(std::memory_order_relaxed) + written};
+        // Every entry in releaseSamples either has an identifier or is about to be popped by the audio callback, so it can't be full while identifiers has space
+        if (!identifiers.Push(BufferIdentifier{.tag = tag, .finalSample = finalSample}) || !releaseSamples.Push(finalSample)) [[unlikely]]
+            throw exception("Failed to track appended audio buffer, the identifier and release sample rings are out of sync");
+        appendedSamples.store(finalSample, std::memory_order_release);
     }
 
-    void AudioTrack::CheckReleasedBuffers() {
-        bool anyReleased{};
+    bool AudioTrack::Play(span<i16> output) {
+        size_t played{samples.Read(output.size(), [&output, offset = size_t{}](span<const i16> segment) mutable {
+            MixSaturated(output.subspan(offset, segment.size()), segment);
+            offset += segment.size();
+        })};
+
+        bool underrun{played < output.size()};
+        if (underrun && !starved)
+            underrunCount.fetch_add(1, std::memory_order_relaxed);
+        starved = underrun;
+
+        u64 playedSamples{sampleCounter.fetch_add(played, std::memory_order_acq_rel) + played};
 
-        for (auto &identifier : identifiers) {
-            if (identifier.finalSample <= sampleCounter && !identifier.released) {
-                anyReleased = true;
-                identifier.released = true;
-            }
+        bool anyReleased{};
+        for (auto finalSample{releaseSamples.Front()}; finalSample && *finalSample <= playedSamples; finalSample = releaseSamples.Front()) {
+            releaseSamples.Pop();
+            anyReleased = true;
         }
 
         if (anyReleased)
+            releasePending.store(true, std::memory_order_release);
+        return anyReleased;
+    }
+
+    void AudioTrack::CheckReleasedBuffers() {
+        if (releasePending.exchange(false, std::memory_order_acq_rel))
             releaseCallback();
     }
 }
@@ -3,29 +3,38 @@
 
 #pragma once
 
-#include <deque>
-#include <kernel/types/KEvent.h>
-#include <common/circular_buffer.h>
-#include "common.h"
+#include <common/spsc_ring.h>
+#include "downmixer.h"
 
 namespace skyline::audio {
     /**
      * @brief The AudioTrack class manages the buffers for an audio stream
+     * @note Buffers may be appended by any emulator thread while they're consumed by the audio callback, the two sides only communicate through lock-free rings and atomics so the callback never blocks
      */
     class AudioTrack {
       private:
+        static constexpr size_t MaxBufferCount{128}; //!< The maximum amount of buffers that can be appended but not yet released by the guest
+
         std::function<void()> releaseCallback; //!< Callback called when a buffer has been played
-        std::deque<BufferIdentifier> identifiers; //!< Queue of all appended buffer identifiers
+        std::mutex appendLock; //!< Serializes appending buffers as the rings only support a single producer, this is never taken by the audio callback
+        SpscRing<BufferIdentifier, MaxBufferCount> identifiers; //!< All appended buffers which haven't been returned by GetReleasedBuffers yet
+        std::mutex identifierLock; //!< Synchronizes consumers of identifiers, this is never taken by the audio callback
+        SpscRing<u64, MaxBufferCount * 2> releaseSamples; //!< The final sample of every appended buffer, this is consumed by the audio callback to detect played buffers and is twice as large as identifiers since entries can briefly outlive their identifier
+        std::atomic<u64> appendedSamples{}; //!< The total amount of samples that have been written into the sample ring
+        std::vector<StereoSample> downMixBuffer; //!< A buffer for downmixing surround samples to stereo prior to appending them, this is protected by appendLock
+        bool starved{}; //!< If the last audio callback couldn't be fully satisfied by this track, this is only accessed by the audio callback
 
         u8 channelCount;
         u32 sampleRate;
 
       public:
-        CircularBuffer<i16, constant::SampleRate * constant::StereoChannelCount * 10> samples; //!< A circular buffer with all appended audio samples
-        std::mutex bufferLock; //!< Synchronizes appending to audio buffers
+        SpscRing<i16, constant::SampleRate * constant::StereoChannelCount * 10> samples; //!< A ring with all appended audio samples which haven't been played yet
+        std::atomic<AudioOutState> playbackState{AudioOutState::Stopped}; //!< The current state of playback
+        std::atomic<u64> sampleCounter{}; //!< The total amount of samples that have been played, this is used to determine when buffers have been played and can be released
+        std::atomic<bool> releasePending{}; //!< If any buffers have been played since the release callback was last called
 
-        AudioOutState playbackState{AudioOutState::Stopped}; //!< The current state of playback
-        u64 sampleCounter{}; //!< A counter used for tracking when buffers have been played and can be released
+        std::atomic<u64> underrunCount{}; //!< The amount of times the track ran out of samples while it was being played
+        std::atomic<u64> overrunSampleCount{}; //!< The amount of samples that were dropped due to the sample ring being full
 
         /**
          * @param channelCount The amount channels that will be present in the track
@@ -64,12 +73,21 @@ namespace skyline::audio {
          * @brief Appends audio samples to the output buffer
          * @param tag The tag of the buffer
          * @param buffer A span containing the source sample buffer
+         * @note Samples that don't fit into the sample ring are dropped and counted in overrunSampleCount
+         * @note This is thread-safe but must not be called by the audio callback
          */
         void AppendBuffer(u64 tag, span<i16> buffer = {});
 
         /**
-         * @brief Checks if any buffers have been released and calls the appropriate callback for them
-         * @note bufferLock MUST be locked when calling this
+         * @brief Mixes played samples from the track into an output buffer and marks any buffers that finished playing
+         * @return If any buffers finished playing, CheckReleasedBuffers should be called from a non-realtime thread in that case
+         * @note This is wait-free and must only be called by the audio callback
+         */
+        bool Play(span<i16> output);
+
+        /**
+         * @brief Calls the release callback if any buffers have been played since it was last called
+         * @note This must not be called from the audio callback as the release callback may block
          */
         void CheckReleasedBuffers();
     };
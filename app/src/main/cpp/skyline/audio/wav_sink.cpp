@@ -0,0 +1,39 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include "wav_sink.h"
+
+namespace skyline::audio {
+    WavSink::WavSink(RenderCallback renderCallback, std::shared_ptr<vfs::Backing> pBacking, bool realtime) : backing{std::move(pBacking)} {
+        WriteHeader();
+        timer.emplace(std::move(renderCallback), realtime, [this](span<const i16> samples) {
+            dataSize += backing->Write(span(const_cast<u8 *>(reinterpret_cast<const u8 *>(samples.data())), samples.size_bytes()), sizeof(WavHeader) + dataSize);
+        });
+    }
+
+    WavSink::~WavSink() {
+        timer.reset();
+
+        try {
+            WriteHeader();
+        } catch (const exception &e) {
+            Logger::Warn("Failed to finalize WAV file: {}", e.what());
+        }
+    }
+
+    void WavSink::WriteHeader() {
+        WavHeader header{
+            .riffSize = static_cast<u32>(sizeof(WavHeader) - (sizeof(u32) * 2) + dataSize),
+            .dataSize = static_cast<u32>(dataSize),
+        };
+        backing->Write(span(reinterpret_cast<u8 *>(&header), sizeof(WavHeader)));
+    }
+
+    void WavSink::Pause() {
+        timer->Pause();
+    }
+
+    void WavSink::Resume() {
+        timer->Resume();
+    }
+}
@@ -0,0 +1,57 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <vfs/backing.h>
+#include "null_sink.h"
+
+namespace skyline::audio {
+    /**
+     * @brief A sink that records audio to a WAV file, it's paced like a NullSink
+     */
+    class WavSink : public AudioSink {
+      private:
+        /**
+         * @brief The header of a canonical PCM WAV file
+         */
+        struct WavHeader {
+            u32 riffMagic{util::MakeMagic<u32>("RIFF")};
+            u32 riffSize; //!< The size of the file excluding riffMagic and riffSize
+            u32 waveMagic{util::MakeMagic<u32>("WAVE")};
+            u32 formatMagic{util::MakeMagic<u32>("fmt ")};
+            u32 formatSize{0x10};
+            u16 audioFormat{1}; //!< PCM
+            u16 channelCount{constant::StereoChannelCount};
+            u32 sampleRate{constant::SampleRate};
+            u32 byteRate{constant::SampleRate * constant::StereoChannelCount * sizeof(i16)};
+            u16 blockAlign{constant::StereoChannelCount * sizeof(i16)};
+            u16 bitsPerSample{sizeof(i16) * 8};
+            u32 dataMagic{util::MakeMagic<u32>("data")};
+            u32 dataSize;
+        };
+        static_assert(sizeof(WavHeader) == 0x2C);
+
+        std::shared_ptr<vfs::Backing> backing;
+        size_t dataSize{}; //!< The amount of sample data that has been written in bytes
+        std::optional<NullSink> timer; //!< The sink that paces rendering, this must be destroyed before the header is finalized
+
+        /**
+         * @brief Writes the header with the current data size to the start of the backing
+         */
+        void WriteHeader();
+
+      public:
+        /**
+         * @param backing A writable and appendable backing to write the WAV file into
+         * @param realtime If rendering should be paced at the real-time rate, see NullSink
+         */
+        WavSink(RenderCallback renderCallback, std::shared_ptr<vfs::Backing> backing, bool realtime = true);
+
+        ~WavSink();
+
+        void Pause() override;
+
+        void Resume() override;
+    };
+}
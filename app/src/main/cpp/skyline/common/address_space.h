@@ -246,6 +246,13 @@ namespace skyline {
 
         void Copy(VaType dst, VaType src, VaType size, std::function<void(span<u8>)> cpuAccessCallback = {});
 
+        /**
+         * @brief Calls the supplied function on every mapped block in the AS in ascending order of VA
+         * @note Sparse blocks are supplied with a null mapping that has the size of the block
+         * @note The block mutex is held during the calls, the function must not access the AS
+         */
+        void ForEachMapping(const std::function<void(VaType virt, span<u8> mapping, bool sparse)> &function);
+
         void Map(VaType virt, u8 *phys, VaType size, MemoryManagerBlockInfo extraInfo = {}) {
             std::scoped_lock lock(this->blockMutex);
             blockSegmentTable.Set(virt, virt + size, {virt, phys, size, extraInfo});
@@ -37,11 +37,21 @@ namespace skyline {
             systemRegion = ktSettings.GetInt<skyline::region::RegionCode>("systemRegion");
             forceTripleBuffering = ktSettings.GetBool("forceTripleBuffering");
             disableFrameThrottling = ktSettings.GetBool("disableFrameThrottling");
+            highQualityResampling = ktSettings.GetBool("highQualityResampling");
+            audioSink = ktSettings.GetInt<audio::AudioSinkType>("audioSink");
             gpuDriver = ktSettings.GetString("gpuDriver");
             gpuDriverLibraryName = ktSettings.GetString("gpuDriverLibraryName");
             executorSlotCount = ktSettings.GetInt<u32>("executorSlotCount");
             enableTextureReadbackHack = ktSettings.GetBool("enableTextureReadbackHack");
+            pipelineCompilation = ktSettings.GetInt<gpu::PipelineCompilationMode>("pipelineCompilation");
+            macroExecution = ktSettings.GetInt<soc::gm20b::MacroExecutionMode>("macroExecution");
             validationLayer = ktSettings.GetBool("validationLayer");
+            guestProfiler = ktSettings.GetBool("guestProfiler");
+            guestProfilerFrequency = ktSettings.GetInt<u32>("guestProfilerFrequency");
+            guestProfilerThreadFilter = ktSettings.GetString("guestProfilerThreadFilter");
+            gpfifoCapture = ktSettings.GetBool("gpfifoCapture");
+            gpfifoReplay = ktSettings.GetBool("gpfifoReplay");
+            gpfifoReplayIterations = ktSettings.GetInt<u32>("gpfifoReplayIterations");
         };
     };
 }
@@ -3,6 +3,9 @@
 
 #pragma once
 
+#include <audio/sink.h>
+#include <gpu/pipeline_compiler.h>
+#include <soc/gm20b/macro/macro_jit.h>
 #include "language.h"
 
 namespace skyline {
@@ -68,14 +71,26 @@ namespace skyline {
         Setting<bool> forceTripleBuffering; //!< If the presentation engine should always triple buffer even if the swapchain supports double buffering
         Setting<bool> disableFrameThrottling; //!< Allow the guest to submit frames without any blocking calls
 
+        // Audio
+        Setting<bool> highQualityResampling; //!< If audio should be resampled with a polyphase filter rather than the 4-tap curves used by HOS
+        Setting<audio::AudioSinkType> audioSink; //!< The sink that mixed audio is output to
+
         // GPU
         Setting<std::string> gpuDriver; //!< The label of the GPU driver to use
         Setting<std::string> gpuDriverLibraryName; //!< The name of the GPU driver library to use
         Setting<u32> executorSlotCount; //!< Number of GPU executor slots that can be used concurrently
         Setting<bool> enableTextureReadbackHack; //!< If the CPU texture readback skipping hack should be used
+        Setting<gpu::PipelineCompilationMode> pipelineCompilation; //!< How pipelines are compiled and how draws are handled while they're compiling
+        Setting<soc::gm20b::MacroExecutionMode> macroExecution; //!< How GPU macros without an HLE implementation are executed
 
         // Debug
         Setting<bool> validationLayer; //!< If the vulkan validation layer is enabled
+        Setting<bool> guestProfiler; //!< If guest threads should be sampled by the guest profiler
+        Setting<u32> guestProfilerFrequency; //!< The frequency at which each guest thread is sampled in Hz
+        Setting<std::string> guestProfilerThreadFilter; //!< A comma separated list of guest thread IDs to sample, all threads are sampled if empty
+        Setting<bool> gpfifoCapture; //!< If all GPFIFO entries alongside the GPU memory they reference should be captured to a file for offline replay
+        Setting<bool> gpfifoReplay; //!< If the GPFIFO capture of a title should be replayed rather than running the title
+        Setting<u32> gpfifoReplayIterations; //!< The amount of times a GPFIFO capture is replayed
 
         Settings() = default;
 
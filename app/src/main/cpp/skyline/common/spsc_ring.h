@@ -0,0 +1,131 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <common.h>
+
+namespace skyline {
+    /**
+     * @brief A fixed-size lock-free ring buffer for a single producer and a single consumer thread, neither side ever blocks on the other
+     * @tparam Type The type of elements stored in the ring, this must be trivially copyable
+     * @tparam Capacity The maximum amount of elements that can be stored in the ring
+     * @note All producer functions must be called from the same thread (or be externally synchronized), the same applies to consumer functions
+     */
+    template<typename Type, size_t Capacity>
+    class SpscRing {
+      private:
+        static_assert(std::is_trivially_copyable_v<Type>);
+
+        std::array<Type, Capacity> array; //!< The internal array holding the ring's data
+        alignas(64) std::atomic<size_t> readPosition{}; //!< The total amount of elements read from the ring, this is only written by the consumer
+        alignas(64) std::atomic<size_t> writePosition{}; //!< The total amount of elements written to the ring, this is only written by the producer
+
+      public:
+        /**
+         * @return The amount of elements that can currently be read, this is exact on the consumer and a lower bound elsewhere
+         */
+        size_t Size() const {
+            return writePosition.load(std::memory_order_acquire) - readPosition.load(std::memory_order_acquire);
+        }
+
+        bool Empty() const {
+            return Size() == 0;
+        }
+
+        /**
+         * @brief Writes as many elements as there's free space for into the ring
+         * @return The amount of elements that were written, any remaining elements were dropped
+         * @note This must only be called by the producer
+         */
+        size_t Write(span<const Type> buffer) {
+            size_t write{writePosition.load(std::memory_order_relaxed)};
+            size_t count{std::min(buffer.size(), Capacity - (write - readPosition.load(std::memory_order_acquire)))};
+
+            size_t offset{write % Capacity}, sizeEnd{std::min(count, Capacity - offset)};
+            std::memcpy(array.data() + offset, buffer.data(), sizeEnd * sizeof(Type));
+            std::memcpy(array.data(), buffer.data() + sizeEnd, (count - sizeEnd) * sizeof(Type));
+
+            writePosition.store(write + count, std::memory_order_release);
+            return count;
+        }
+
+        /**
+         * @brief Writes a single element into the ring
+         * @return If there was space for the element
+         * @note This must only be called by the producer
+         */
+        bool Push(const Type &item) {
+            return Write(span<const Type>(&item, 1)) == 1;
+        }
+
+        /**
+         * @brief Consumes up to the supplied amount of elements from the ring without copying them
+         * @param function A function that's called with a span for every contiguous segment of the consumed elements, there are at most two
+         * @return The amount of elements that were consumed
+         * @note This must only be called by the consumer
+         */
+        template<typename Function>
+        size_t Read(size_t count, Function function) {
+            size_t read{readPosition.load(std::memory_order_relaxed)};
+            count = std::min(count, writePosition.load(std::memory_order_acquire) - read);
+
+            size_t offset{read % Capacity}, sizeEnd{std::min(count, Capacity - offset)};
+            if (sizeEnd)
+                function(span<const Type>(array.data() + offset, sizeEnd));
+            if (count > sizeEnd)
+                function(span<const Type>(array.data(), count - sizeEnd));
+
+            readPosition.store(read + count, std::memory_order_release);
+            return count;
+        }
+
+        /**
+         * @brief Reads elements from the ring into the supplied buffer
+         * @return The amount of elements that were read
+         * @note This must only be called by the consumer
+         */
+        size_t Read(span<Type> buffer) {
+            Type *pointer{buffer.data()};
+            return Read(buffer.size(), [&](span<const Type> segment) {
+                std::memcpy(pointer, segment.data(), segment.size_bytes());
+                pointer += segment.size();
+            });
+        }
+
+        /**
+         * @return A pointer to the oldest element in the ring or nullptr if it's empty, the element stays valid till it's popped
+         * @note This must only be called by the consumer
+         */
+        const Type *Front() const {
+            size_t read{readPosition.load(std::memory_order_relaxed)};
+            if (read == writePosition.load(std::memory_order_acquire))
+                return nullptr;
+            return &array[read % Capacity];
+        }
+
+        /**
+         * @brief Removes the oldest element from the ring, this is a no-op if the ring is empty
+         * @note This must only be called by the consumer
+         */
+        void Pop() {
+            size_t read{readPosition.load(std::memory_order_relaxed)};
+            if (read != writePosition.load(std::memory_order_acquire))
+                readPosition.store(read + 1, std::memory_order_release);
+        }
+
+        /**
+         * @brief Calls the supplied function with every element in the ring from oldest to newest until it returns true
+         * @return If the function returned true for any element
+         * @note This must only be called by the consumer
+         */
+        template<typename Function>
+        bool Any(Function function) const {
+            size_t read{readPosition.load(std::memory_order_relaxed)}, write{writePosition.load(std::memory_order_acquire)};
+            for (; read != write; read++)
+                if (function(array[read % Capacity]))
+                    return true;
+            return false;
+        }
+    };
+}
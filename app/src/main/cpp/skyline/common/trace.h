@@ -16,7 +16,8 @@ PERFETTO_DEFINE_CATEGORIES(
     perfetto::Category("host").SetDescription("Events relating to host code"),
     perfetto::Category("gpu").SetDescription("Events from the emulated GPU"),
     perfetto::Category("service").SetDescription("Events from the HLE sysmodule implementations"),
-    perfetto::Category("containers").SetDescription("Events from custom container implementations")
+    perfetto::Category("containers").SetDescription("Events from custom container implementations"),
+    perfetto::Category("profiler").SetDescription("Samples from the guest profiler")
 );
 
 namespace skyline::trace {
@@ -25,5 +26,6 @@ namespace skyline::trace {
      */
     enum class TrackIds : u64 {
         Presentation = std::numeric_limits<u64>::max(),
+        ChannelBase = Presentation - 1, //!< The track of the channel with ID N is `ChannelBase - N`, this must remain the last ID as channel IDs count down from it
     };
 }
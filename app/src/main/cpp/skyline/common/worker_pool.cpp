@@ -0,0 +1,71 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include "worker_pool.h"
+
+namespace skyline {
+    WorkerPool::WorkerPool(size_t threadCount, std::string threadName, std::function<void()> threadInitializer) : threadName{std::move(threadName)}, threadInitializer{std::move(threadInitializer)} {
+        workers.reserve(threadCount);
+        for (size_t index{}; index < threadCount; index++)
+            workers.emplace_back(&WorkerPool::WorkerThread, this, index);
+    }
+
+    WorkerPool::~WorkerPool() {
+        {
+            std::scoped_lock lock{mutex};
+            exit = true;
+        }
+        jobCondition.notify_all();
+
+        for (auto &worker : workers)
+            worker.join();
+    }
+
+    void WorkerPool::Process() {
+        for (size_t index{nextIndex.fetch_add(1, std::memory_order_relaxed)}; index < jobCount; index = nextIndex.fetch_add(1, std::memory_order_relaxed))
+            (*job)(index);
+    }
+
+    void WorkerPool::WorkerThread(size_t index) {
+        if (int result{pthread_setname_np(pthread_self(), fmt::format("{}{}", threadName, index).c_str())})
+            Logger::Warn("Failed to set the thread name: {}", strerror(result));
+
+        if (threadInitializer)
+            threadInitializer();
+
+        u64 lastGeneration{};
+        while (true) {
+            {
+                std::unique_lock lock{mutex};
+                jobCondition.wait(lock, [&] { return exit || generation != lastGeneration; });
+                if (exit)
+                    return;
+                lastGeneration = generation;
+            }
+
+            Process();
+
+            std::scoped_lock lock{mutex};
+            if (--activeWorkers == 0)
+                doneCondition.notify_one();
+        }
+    }
+
+    void WorkerPool::Run(size_t count, const std::function<void(size_t)> &function) {
+        {
+            std::scoped_lock lock{mutex};
+            job = &function;
+            jobCount = count;
+            nextIndex = 0;
+            activeWorkers = workers.size();
+            generation++;
+        }
+        jobCondition.notify_all();
+
+        Process();
+
+        std::unique_lock lock{mutex};
+        doneCondition.wait(lock, [this] { return activeWorkers == 0; });
+        job = nullptr;
+    }
+}
@@ -0,0 +1,51 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <common.h>
+
+namespace skyline {
+    /**
+     * @brief A set of long-lived worker threads that independent indices of a job are partitioned across
+     */
+    class WorkerPool {
+      private:
+        std::vector<std::thread> workers;
+        std::string threadName; //!< The prefix of the name of every worker thread, the index of the worker is appended to it
+        std::function<void()> threadInitializer; //!< An optional function that's called on every worker thread before it processes any jobs
+        std::mutex mutex; //!< Synchronizes the job state below for the conditions
+        std::condition_variable jobCondition; //!< Signalled when a new job is posted or the pool is exiting
+        std::condition_variable doneCondition; //!< Signalled when the last worker finishes with a job
+        const std::function<void(size_t)> *job{}; //!< The function for the current job, this is only valid while Run is executing
+        size_t jobCount{}; //!< The amount of indices in the current job
+        std::atomic<size_t> nextIndex{}; //!< The next index in the current job which hasn't been claimed by any thread
+        size_t activeWorkers{}; //!< The amount of workers that are still processing the current job
+        u64 generation{}; //!< A counter that's incremented for every job, workers use it to detect new jobs
+        bool exit{};
+
+        void WorkerThread(size_t index);
+
+        /**
+         * @brief Claims and runs indices from the current job until there are none left
+         */
+        void Process();
+
+      public:
+        /**
+         * @param threadCount The amount of worker threads, the thread calling Run also processes indices
+         * @param threadName The prefix of the worker thread names, this must be short enough to fit the index into the 15 character limit
+         * @param threadInitializer A function called on every worker thread when it starts, such as for setting up signal handlers
+         */
+        WorkerPool(size_t threadCount, std::string threadName, std::function<void()> threadInitializer = {});
+
+        ~WorkerPool();
+
+        /**
+         * @brief Calls the function for every index in [0, count) across the workers and the calling thread, this returns once all of them have completed
+         * @note Indices are claimed individually so the load is balanced regardless of how long each index takes
+         * @note This must not be called concurrently from multiple threads
+         */
+        void Run(size_t count, const std::function<void(size_t)> &function);
+    };
+}
@@ -1,11 +1,12 @@
 // SPDX-License-Identifier: MPL-2.0
 // Copyright © 2020 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
+#include <sys/stat.h>
 #include <vfs/os_filesystem.h>
 #include "key_store.h"
 
 namespace skyline::crypto {
-    KeyStore::KeyStore(const std::string &rootPath) {
+    KeyStore::KeyStore(const std::string &rootPath) : fileStamp{GetFileStamp(rootPath)} {
         vfs::OsFileSystem root(rootPath);
         if (root.FileExists("title.keys"))
             ReadPairs(root.OpenFile("title.keys"), &KeyStore::PopulateTitleKeys);
@@ -13,6 +14,33 @@ namespace skyline::crypto {
             ReadPairs(root.OpenFile("prod.keys"), &KeyStore::PopulateKeys);
     }
 
+    std::shared_ptr<KeyStore> KeyStore::GetShared(const std::string &rootPath) {
+        static std::mutex mutex;
+        static std::unordered_map<std::string, std::shared_ptr<KeyStore>> keyStores;
+
+        std::scoped_lock lock{mutex};
+        auto &keyStore{keyStores[rootPath]};
+        if (!keyStore || keyStore->fileStamp != GetFileStamp(rootPath))
+            keyStore = std::make_shared<KeyStore>(rootPath);
+        return keyStore;
+    }
+
+    u64 KeyStore::GetFileStamp(const std::string &rootPath) {
+        std::array<i64, 6> stampData{};
+        auto stampIt{stampData.begin()};
+        for (const auto &filename : {"title.keys", "prod.keys"}) {
+            struct stat fileInfo{};
+            if (!stat((rootPath + filename).c_str(), &fileInfo)) {
+                *stampIt++ = fileInfo.st_size;
+                *stampIt++ = fileInfo.st_mtim.tv_sec;
+                *stampIt++ = fileInfo.st_mtim.tv_nsec;
+            } else {
+                stampIt += 3; // A missing file is represented by zeroes
+            }
+        }
+        return XXH64(stampData.data(), sizeof(stampData), 0);
+    }
+
     void KeyStore::ReadPairs(const std::shared_ptr<vfs::Backing> &backing, ReadPairsCallback callback) {
         std::vector<char> fileContent(backing->size);
         backing->Read(span(fileContent));
@@ -39,6 +67,7 @@ namespace skyline::crypto {
     }
 
     void KeyStore::PopulateTitleKey(Key128 keyName, Key128 value) {
+        std::unique_lock lock{titleKeyMutex};
         if (!titleKeys.contains(keyName))
             titleKeys.emplace(keyName, value);
     }
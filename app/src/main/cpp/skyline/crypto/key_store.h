@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <shared_mutex>
 #include <vfs/backing.h>
 
 namespace skyline::crypto {
@@ -14,6 +15,17 @@ namespace skyline::crypto {
       public:
         KeyStore(const std::string &rootPath);
 
+        /**
+         * @return A KeyStore for the supplied path that is shared across all callers, the key files are only parsed again after they've been modified
+         * @note This is intended for cases where keys are required repeatedly in a short span such as scanning the ROM library
+         */
+        static std::shared_ptr<KeyStore> GetShared(const std::string &rootPath);
+
+        /**
+         * @return A stamp derived from the size and modification time of the key files in rootPath, it changes whenever a key file is added, removed or modified
+         */
+        static u64 GetFileStamp(const std::string &rootPath);
+
         using Key128 = std::array<u8, 16>;
         using Key256 = std::array<u8, 32>;
         using IndexedKeys128 = std::array<std::optional<Key128>, 20>;
@@ -24,7 +36,11 @@ namespace skyline::crypto {
         IndexedKeys128 areaKeyApplication;
         IndexedKeys128 areaKeyOcean;
         IndexedKeys128 areaKeySystem;
+
+        u64 fileStamp; //!< The stamp of the key files at the time they were read, see GetFileStamp()
+
       private:
+        std::shared_mutex titleKeyMutex; //!< Synchronizes access to titleKeys as a shared store may be populated by tickets from multiple threads
         std::map<Key128, Key128> titleKeys;
 
         std::unordered_map<std::string_view, std::optional<Key256> &> key256Names{
@@ -48,6 +64,7 @@ namespace skyline::crypto {
 
       public:
         std::optional<Key128> GetTitleKey(const Key128 &title) {
+            std::shared_lock lock{titleKeyMutex};
             auto it{titleKeys.find(title)};
             if (it == titleKeys.end())
                 return std::nullopt;
@@ -376,8 +376,10 @@ namespace skyline::gpu {
           megaBufferAllocator(*this),
           descriptor(*this),
           shader(state, *this),
+          shaderCache(*this),
           helperShaders(*this, state.os->assetFileSystem),
           graphicsPipelineCache(*this),
+          pipelineCompiler(state),
           renderPassCache(*this),
           framebufferCache(*this) {}
 }
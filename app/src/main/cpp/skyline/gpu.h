@@ -12,10 +12,13 @@
 #include "gpu/megabuffer.h"
 #include "gpu/descriptor_allocator.h"
 #include "gpu/shader_manager.h"
+#include "gpu/pipeline_compiler.h"
 #include "gpu/shaders/helper_shaders.h"
 #include "gpu/cache/graphics_pipeline_cache.h"
 #include "gpu/cache/renderpass_cache.h"
 #include "gpu/cache/framebuffer_cache.h"
+#include "gpu/cache/shader_cache.h"
+#include "gpu/cache/pipeline_warmup_cache.h"
 
 namespace skyline::gpu {
     static constexpr u32 VkApiVersion{VK_API_VERSION_1_1}; //!< The version of core Vulkan that we require
@@ -50,10 +53,13 @@ namespace skyline::gpu {
 
         DescriptorAllocator descriptor;
         ShaderManager shader;
+        cache::ShaderCache shaderCache;
 
         HelperShaders helperShaders;
 
         cache::GraphicsPipelineCache graphicsPipelineCache;
+        cache::PipelineWarmupCache pipelineWarmupCache;
+        PipelineCompiler pipelineCompiler; //!< This must be destroyed prior to the caches as the workers may be using them
         cache::RenderPassCache renderPassCache;
         cache::FramebufferCache framebufferCache;
 
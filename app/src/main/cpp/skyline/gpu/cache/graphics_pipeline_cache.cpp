@@ -2,12 +2,159 @@
 // Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
 #include <boost/functional/hash.hpp>
+#include <vfs/os_filesystem.h>
+#include <common/trace.h>
 #include <gpu.h>
 #include "graphics_pipeline_cache.h"
 
 namespace skyline::gpu::cache {
     GraphicsPipelineCache::GraphicsPipelineCache(GPU &gpu) : gpu(gpu), vkPipelineCache(gpu.vkDevice, vk::PipelineCacheCreateInfo{}) {}
 
+    GraphicsPipelineCache::~GraphicsPipelineCache() {
+        if (saveThread.joinable()) {
+            {
+                std::scoped_lock lock{saveMutex};
+                saveThreadExit = true;
+            }
+            saveCondition.notify_all();
+            saveThread.join();
+        }
+
+        if (unsavedPipelineCount.load(std::memory_order_relaxed))
+            Save();
+    }
+
+    bool GraphicsPipelineCache::IsCacheDataCompatible(span<const u8> data) {
+        if (data.size() < sizeof(VkPipelineCacheHeaderVersionOne))
+            return false;
+
+        VkPipelineCacheHeaderVersionOne header;
+        std::memcpy(&header, data.data(), sizeof(VkPipelineCacheHeaderVersionOne));
+
+        // Drivers are meant to reject incompatible data themselves but not all of them do so reliably, we validate it prior to passing it to them
+        auto properties{gpu.vkPhysicalDevice.getProperties()};
+        return header.headerSize >= sizeof(VkPipelineCacheHeaderVersionOne) &&
+            header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+            header.vendorID == properties.vendorID &&
+            header.deviceID == properties.deviceID &&
+            std::memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID.data(), VK_UUID_SIZE) == 0;
+    }
+
+    void GraphicsPipelineCache::Open(const std::string &path, u64 titleId) {
+        TRACE_EVENT("gpu", "GraphicsPipelineCache::Open");
+
+        std::scoped_lock saveLock{saveMutex};
+        saveDirectory = path;
+        saveFilename = fmt::format("{:016X}.bin", titleId);
+
+        auto startTime{util::GetTimeNs()};
+        std::vector<u8> data;
+        try {
+            vfs::OsFileSystem filesystem{saveDirectory};
+            if (filesystem.FileExists(saveFilename)) {
+                auto backing{filesystem.OpenFile(saveFilename)};
+                if (backing->size >= sizeof(FileHeader)) {
+                    auto header{backing->Read<FileHeader>()};
+                    if (header.magic == FileHeader::Magic && header.version == FileHeader::Version && header.dataSize == backing->size - sizeof(FileHeader)) {
+                        data.resize(header.dataSize);
+                        backing->Read(span{data}, sizeof(FileHeader));
+                        if (XXH64(data.data(), data.size(), 0) != header.dataHash) {
+                            Logger::Warn("Pipeline cache data is corrupted, it'll be rebuilt");
+                            data.clear();
+                        } else if (!IsCacheDataCompatible(data)) {
+                            Logger::Info("Pipeline cache is for a different device or driver, it'll be rebuilt");
+                            data.clear();
+                        }
+                    }
+                }
+            }
+        } catch (const exception &e) {
+            Logger::Warn("Failed to load pipeline cache: {}", e.what());
+            data.clear();
+        }
+
+        {
+            std::scoped_lock lock{mutex};
+            vk::raii::PipelineCache loadedCache{gpu.vkDevice, vk::PipelineCacheCreateInfo{
+                .initialDataSize = data.size(),
+                .pInitialData = data.data(),
+            }};
+            loadedCache.mergeCaches(*vkPipelineCache); // Any pipelines compiled prior to the cache being opened are retained
+            vkPipelineCache = std::move(loadedCache);
+        }
+
+        if (!data.empty())
+            Logger::Info("Loaded {} KiB of pipeline cache data in {}ms", data.size() / 1024, (util::GetTimeNs() - startTime) / constant::NsInMillisecond);
+
+        if (!saveThread.joinable())
+            saveThread = std::thread(&GraphicsPipelineCache::SaveThread, this);
+    }
+
+    void GraphicsPipelineCache::SaveThread() {
+        if (int result{pthread_setname_np(pthread_self(), "Sky-PipeSave")})
+            Logger::Warn("Failed to set the thread name: {}", strerror(result));
+
+        std::unique_lock lock{saveMutex};
+        while (!saveCondition.wait_for(lock, SaveInterval, [this] { return saveThreadExit; }))
+            if (unsavedPipelineCount.load(std::memory_order_relaxed))
+                SaveLocked();
+    }
+
+    void GraphicsPipelineCache::SaveLocked() {
+        if (saveDirectory.empty())
+            return;
+
+        TRACE_EVENT("gpu", "GraphicsPipelineCache::Save");
+
+        auto startTime{util::GetTimeNs()};
+        unsavedPipelineCount.store(0, std::memory_order_relaxed);
+        try {
+            auto data{vkPipelineCache.getData()};
+            FileHeader header{
+                .magic = FileHeader::Magic,
+                .version = FileHeader::Version,
+                .dataSize = data.size(),
+                .dataHash = XXH64(data.data(), data.size(), 0),
+            };
+
+            // The data is written to a temporary file which then atomically replaces the cache file, an interrupted save can't lose the previously saved cache
+            vfs::OsFileSystem filesystem{saveDirectory};
+            auto tempFilename{saveFilename + ".tmp"};
+            if (!filesystem.CreateFile(tempFilename, 0))
+                throw exception("Failed to create file");
+
+            try {
+                auto backing{filesystem.OpenFile(tempFilename, {false, true, false})};
+                backing->Resize(sizeof(FileHeader) + data.size());
+                backing->Write(span<FileHeader>{header}.cast<u8>());
+                backing->Write(span{data}, sizeof(FileHeader));
+            } catch (...) {
+                filesystem.DeleteFile(tempFilename);
+                throw;
+            }
+
+            auto directory{saveDirectory.ends_with('/') ? saveDirectory : saveDirectory + '/'};
+            if (std::rename((directory + tempFilename).c_str(), (directory + saveFilename).c_str())) {
+                auto error{errno};
+                filesystem.DeleteFile(tempFilename);
+                throw exception("Failed to replace the cache file: {}", strerror(error));
+            }
+
+            Logger::Info("Saved {} KiB of pipeline cache data in {}ms", data.size() / 1024, (util::GetTimeNs() - startTime) / constant::NsInMillisecond);
+        } catch (const std::exception &e) {
+            Logger::Warn("Failed to save pipeline cache: {}", e.what());
+        }
+    }
+
+    void GraphicsPipelineCache::Save() {
+        std::scoped_lock lock{saveMutex};
+        SaveLocked();
+    }
+
+    GraphicsPipelineCache::AttachmentMetadata::AttachmentMetadata(TextureView *view)
+        : format(view ? view->format->vkFormat : vk::Format::eUndefined),
+          sampleCount(view ? view->texture->sampleCount : vk::SampleCountFlagBits::e1) {}
+
     #define VEC_CPY(pointer, size) state.pointer, state.pointer + state.size
 
     GraphicsPipelineCache::PipelineCacheKey::PipelineCacheKey(const GraphicsPipelineCache::PipelineState &state)
@@ -25,7 +172,9 @@ namespace skyline::gpu::cache {
           multisampleState(state.multisampleState),
           depthStencilState(state.depthStencilState),
           colorBlendState(state.colorBlendState),
-          colorBlendAttachments(VEC_CPY(colorBlendState.pAttachments, colorBlendState.attachmentCount)) {
+          colorBlendAttachments(VEC_CPY(colorBlendState.pAttachments, colorBlendState.attachmentCount)),
+          colorAttachments(state.colorAttachments.begin(), state.colorAttachments.end()),
+          depthStencilAttachment(state.depthStencilAttachment) {
         auto &vertexInputState{vertexState.get<vk::PipelineVertexInputStateCreateInfo>()};
         vertexInputState.pVertexBindingDescriptions = vertexBindings.data();
         vertexInputState.pVertexAttributeDescriptions = vertexAttributes.data();
@@ -35,16 +184,6 @@ namespace skyline::gpu::cache {
         viewportState.pScissors = scissors.data();
 
         colorBlendState.pAttachments = colorBlendAttachments.data();
-
-        for (auto &colorAttachment : state.colorAttachments) {
-            if (colorAttachment)
-                colorAttachments.emplace_back(AttachmentMetadata{colorAttachment->format->vkFormat, colorAttachment->texture->sampleCount});
-            else
-                colorAttachments.emplace_back(AttachmentMetadata{vk::Format::eUndefined, vk::SampleCountFlagBits::e1});
-        }
-
-        if (state.depthStencilAttachment)
-            depthStencilAttachment.emplace(AttachmentMetadata{state.depthStencilAttachment->format->vkFormat, state.depthStencilAttachment->texture->sampleCount});
     }
 
     #undef VEC_CPY
@@ -168,32 +307,6 @@ namespace skyline::gpu::cache {
             HASH(static_cast<VkBlendFactor>(attachment.srcColorBlendFactor));
         }
 
-        return hash;
-    }
-
-    size_t GraphicsPipelineCache::PipelineStateHash::operator()(const GraphicsPipelineCache::PipelineState &key) const {
-        size_t hash{HashCommonPipelineState(key)};
-
-        HASH(key.colorAttachments.size());
-        for (const auto &attachment : key.colorAttachments) {
-            if (attachment) {
-                HASH(attachment->format->vkFormat);
-                HASH(attachment->texture->sampleCount);
-            }
-        }
-
-        HASH(key.depthStencilAttachment != nullptr);
-        if (key.depthStencilAttachment != nullptr) {
-            HASH(key.depthStencilAttachment->format->vkFormat);
-            HASH(key.depthStencilAttachment->texture->sampleCount);
-        }
-
-        return hash;
-    }
-
-    size_t GraphicsPipelineCache::PipelineStateHash::operator()(const GraphicsPipelineCache::PipelineCacheKey &key) const {
-        size_t hash{HashCommonPipelineState(key)};
-
         HASH(key.colorAttachments.size());
         for (const auto &attachment : key.colorAttachments) {
             HASH(attachment.format);
@@ -209,6 +322,14 @@ namespace skyline::gpu::cache {
         return hash;
     }
 
+    size_t GraphicsPipelineCache::PipelineStateHash::operator()(const GraphicsPipelineCache::PipelineState &key) const {
+        return HashCommonPipelineState(key);
+    }
+
+    size_t GraphicsPipelineCache::PipelineStateHash::operator()(const GraphicsPipelineCache::PipelineCacheKey &key) const {
+        return HashCommonPipelineState(key);
+    }
+
     #undef HASH
 
     bool GraphicsPipelineCache::PipelineCacheEqual::operator()(const GraphicsPipelineCache::PipelineCacheKey &lhs, const GraphicsPipelineCache::PipelineState &rhs) const {
@@ -296,16 +417,9 @@ namespace skyline::gpu::cache {
             KEYNEQ(colorBlendState.blendConstants)
         )
 
-        RETF(CARREQ(colorAttachments.begin(), colorAttachments.size(), {
-            return lhs.format == rhs->format->vkFormat && lhs.sampleCount == rhs->texture->sampleCount;
-        }))
+        RETF(ARREQ(colorAttachments.begin(), colorAttachments.size()))
 
-        RETF(lhs.depthStencilAttachment.has_value() != (rhs.depthStencilAttachment != nullptr) ||
-            (lhs.depthStencilAttachment.has_value() &&
-                lhs.depthStencilAttachment->format != rhs.depthStencilAttachment->format->vkFormat &&
-                lhs.depthStencilAttachment->sampleCount != rhs.depthStencilAttachment->texture->sampleCount
-            )
-        )
+        RETF(KEYNEQ(depthStencilAttachment))
 
         #undef ARREQ
         #undef CARREQ
@@ -320,16 +434,30 @@ namespace skyline::gpu::cache {
         return lhs == rhs;
     }
 
-    GraphicsPipelineCache::PipelineCacheEntry::PipelineCacheEntry(vk::raii::DescriptorSetLayout &&descriptorSetLayout, vk::raii::PipelineLayout &&pipelineLayout, vk::raii::Pipeline &&pipeline) : descriptorSetLayout(std::move(descriptorSetLayout)), pipelineLayout(std::move(pipelineLayout)), pipeline(std::move(pipeline)) {}
+    size_t GraphicsPipelineCache::PipelineLayoutKeyHash::operator()(const std::vector<u8> &key) const {
+        return XXH64(key.data(), key.size(), 0);
+    }
 
-    GraphicsPipelineCache::CompiledPipeline::CompiledPipeline(const PipelineCacheEntry &entry) : descriptorSetLayout(*entry.descriptorSetLayout), pipelineLayout(*entry.pipelineLayout), pipeline(*entry.pipeline) {}
+    GraphicsPipelineCache::PipelineLayoutEntry::PipelineLayoutEntry(vk::raii::DescriptorSetLayout &&descriptorSetLayout, vk::raii::PipelineLayout &&pipelineLayout) : descriptorSetLayout(std::move(descriptorSetLayout)), pipelineLayout(std::move(pipelineLayout)) {}
+
+    GraphicsPipelineCache::PipelineCacheEntry::PipelineCacheEntry(const PipelineLayoutEntry &layout, vk::raii::Pipeline &&pipeline) : descriptorSetLayout(*layout.descriptorSetLayout), pipelineLayout(*layout.pipelineLayout), pipeline(std::move(pipeline)) {}
+
+    GraphicsPipelineCache::CompiledPipeline::CompiledPipeline(const PipelineCacheEntry &entry) : descriptorSetLayout(entry.descriptorSetLayout), pipelineLayout(entry.pipelineLayout), pipeline(*entry.pipeline) {}
+
+    GraphicsPipelineCache::CompiledPipeline::CompiledPipeline(const PipelineLayoutEntry &layout) : descriptorSetLayout(*layout.descriptorSetLayout), pipelineLayout(*layout.pipelineLayout) {}
+
+    const GraphicsPipelineCache::PipelineLayoutEntry &GraphicsPipelineCache::GetPipelineLayoutEntry(span<const vk::DescriptorSetLayoutBinding> layoutBindings, span<const vk::PushConstantRange> pushConstantRanges, bool noPushDescriptors) {
+        // All members of the bindings and ranges are tightly packed so their raw bytes uniquely identify them, immutable samplers are compared by their pointers
+        std::vector<u8> key(layoutBindings.size_bytes() + pushConstantRanges.size_bytes() + 1);
+        std::memcpy(key.data(), layoutBindings.data(), layoutBindings.size_bytes());
+        std::memcpy(key.data() + layoutBindings.size_bytes(), pushConstantRanges.data(), pushConstantRanges.size_bytes());
+        key.back() = static_cast<u8>(noPushDescriptors);
 
-    GraphicsPipelineCache::CompiledPipeline GraphicsPipelineCache::GetCompiledPipeline(const PipelineState &state, span<const vk::DescriptorSetLayoutBinding> layoutBindings, span<const vk::PushConstantRange> pushConstantRanges, bool noPushDescriptors) {
         std::unique_lock lock(mutex);
 
-        auto it{pipelineCache.find(state)};
-        if (it != pipelineCache.end())
-            return CompiledPipeline{it->second};
+        auto it{pipelineLayoutCache.find(key)};
+        if (it != pipelineLayoutCache.end())
+            return it->second;
 
         lock.unlock();
 
@@ -346,25 +474,47 @@ namespace skyline::gpu::cache {
             .pushConstantRangeCount = static_cast<u32>(pushConstantRanges.size()),
         }};
 
+        lock.lock();
+
+        // If another thread created identical layouts in the meantime then those are used and the ones created here are destroyed
+        return pipelineLayoutCache.try_emplace(std::move(key), std::move(descriptorSetLayout), std::move(pipelineLayout)).first->second;
+    }
+
+    GraphicsPipelineCache::CompiledPipeline GraphicsPipelineCache::GetPipelineLayout(span<const vk::DescriptorSetLayoutBinding> layoutBindings, span<const vk::PushConstantRange> pushConstantRanges, bool noPushDescriptors) {
+        return CompiledPipeline{GetPipelineLayoutEntry(layoutBindings, pushConstantRanges, noPushDescriptors)};
+    }
+
+    GraphicsPipelineCache::CompiledPipeline GraphicsPipelineCache::GetCompiledPipeline(const PipelineState &state, span<const vk::DescriptorSetLayoutBinding> layoutBindings, span<const vk::PushConstantRange> pushConstantRanges, bool noPushDescriptors) {
+        std::unique_lock lock(mutex);
+
+        auto it{pipelineCache.find(state)};
+        if (it != pipelineCache.end())
+            return CompiledPipeline{it->second};
+
+        lock.unlock();
+
+        const auto &layout{GetPipelineLayoutEntry(layoutBindings, pushConstantRanges, noPushDescriptors)};
+
         boost::container::small_vector<vk::AttachmentDescription, 8> attachmentDescriptions;
         boost::container::small_vector<vk::AttachmentReference, 8> attachmentReferences;
 
-        auto pushAttachment{[&](TextureView *view) {
-            if (view) {
+        // Image layouts aren't a part of render pass compatibility so the pipeline can be compiled without knowing the layouts of the attachments it'll be used with
+        auto pushAttachment{[&](const AttachmentMetadata &attachment) {
+            if (attachment.format != vk::Format::eUndefined) {
                 attachmentDescriptions.push_back(vk::AttachmentDescription{
-                    .format = view->format->vkFormat,
-                    .samples = view->texture->sampleCount,
+                    .format = attachment.format,
+                    .samples = attachment.sampleCount,
                     .loadOp = vk::AttachmentLoadOp::eLoad,
                     .storeOp = vk::AttachmentStoreOp::eStore,
                     .stencilLoadOp = vk::AttachmentLoadOp::eLoad,
                     .stencilStoreOp = vk::AttachmentStoreOp::eStore,
-                    .initialLayout = view->texture->layout,
-                    .finalLayout = view->texture->layout,
+                    .initialLayout = vk::ImageLayout::eGeneral,
+                    .finalLayout = vk::ImageLayout::eGeneral,
                     .flags = vk::AttachmentDescriptionFlagBits::eMayAlias
                 });
                 attachmentReferences.push_back(vk::AttachmentReference{
                     .attachment = static_cast<u32>(attachmentDescriptions.size() - 1),
-                    .layout = view->texture->layout,
+                    .layout = vk::ImageLayout::eGeneral,
                 });
             } else {
                 attachmentReferences.push_back(vk::AttachmentReference{
@@ -382,7 +532,7 @@ namespace skyline::gpu::cache {
             pushAttachment(colorAttachment);
 
         if (state.depthStencilAttachment) {
-            pushAttachment(state.depthStencilAttachment);
+            pushAttachment(*state.depthStencilAttachment);
 
             subpassDescription.pColorAttachments = attachmentReferences.data();
             subpassDescription.colorAttachmentCount = static_cast<u32>(attachmentReferences.size() - 1);
@@ -410,14 +560,16 @@ namespace skyline::gpu::cache {
             .pDepthStencilState = &state.depthStencilState,
             .pColorBlendState = &state.colorBlendState,
             .pDynamicState = &state.dynamicState,
-            .layout = *pipelineLayout,
+            .layout = *layout.pipelineLayout,
             .renderPass = *renderPass,
             .subpass = 0,
         })};
 
+        unsavedPipelineCount.fetch_add(1, std::memory_order_relaxed);
+
         lock.lock();
 
-        auto pipelineEntryIt{pipelineCache.try_emplace(PipelineCacheKey{state}, std::move(descriptorSetLayout), std::move(pipelineLayout), std::move(pipeline))};
+        auto pipelineEntryIt{pipelineCache.try_emplace(PipelineCacheKey{state}, layout, std::move(pipeline))};
         return CompiledPipeline{pipelineEntryIt.first->second};
     }
 }
@@ -4,6 +4,7 @@
 #pragma once
 
 #include <vulkan/vulkan_raii.hpp>
+#include <common.h>
 
 namespace skyline::gpu {
     class TextureView;
@@ -16,6 +17,27 @@ namespace skyline::gpu::cache {
      */
     class GraphicsPipelineCache {
       public:
+        /**
+         * @brief All unique metadata in a single attachment for a compatible render pass according to Render Pass Compatibility clause in the Vulkan specification
+         * @url https://www.khronos.org/registry/vulkan/specs/1.3-extensions/html/vkspec.html#renderpass-compatibility
+         * @url https://www.khronos.org/registry/vulkan/specs/1.3-extensions/man/html/VkAttachmentDescription.html
+         */
+        struct AttachmentMetadata {
+            vk::Format format; //!< The format of the attachment, this is undefined for unbound color attachments
+            vk::SampleCountFlagBits sampleCount;
+
+            AttachmentMetadata() = default;
+
+            constexpr AttachmentMetadata(vk::Format format, vk::SampleCountFlagBits sampleCount) : format(format), sampleCount(sampleCount) {}
+
+            /**
+             * @param view A nullable pointer to the view bound to the attachment
+             */
+            AttachmentMetadata(TextureView *view);
+
+            bool operator==(const AttachmentMetadata &rhs) const = default;
+        };
+
         /**
          * @brief All unique state required to compile a graphics pipeline as references
          */
@@ -31,8 +53,8 @@ namespace skyline::gpu::cache {
             const vk::PipelineColorBlendStateCreateInfo &colorBlendState;
             const vk::PipelineDynamicStateCreateInfo &dynamicState;
 
-            span<TextureView *> colorAttachments; //!< All color attachments in the subpass of this pipeline
-            TextureView *depthStencilAttachment; //!< A nullable pointer to the depth/stencil attachment in the subpass of this pipeline
+            span<const AttachmentMetadata> colorAttachments; //!< All color attachments in the subpass of this pipeline
+            std::optional<AttachmentMetadata> depthStencilAttachment; //!< The depth/stencil attachment in the subpass of this pipeline, if any
 
             constexpr const vk::PipelineVertexInputStateCreateInfo &VertexInputState() const {
                 return vertexState.get<vk::PipelineVertexInputStateCreateInfo>();
@@ -57,18 +79,41 @@ namespace skyline::gpu::cache {
         vk::raii::PipelineCache vkPipelineCache; //!< A Vulkan Pipeline Cache which stores all unique graphics pipelines
 
         /**
-         * @brief All unique metadata in a single attachment for a compatible render pass according to Render Pass Compatibility clause in the Vulkan specification
-         * @url https://www.khronos.org/registry/vulkan/specs/1.3-extensions/html/vkspec.html#renderpass-compatibility
-         * @url https://www.khronos.org/registry/vulkan/specs/1.3-extensions/man/html/VkAttachmentDescription.html
+         * @brief The header of the file that the Vulkan pipeline cache data is saved in, this is followed by the data itself
          */
-        struct AttachmentMetadata {
-            vk::Format format;
-            vk::SampleCountFlagBits sampleCount;
+        struct FileHeader {
+            static constexpr u32 Magic{util::MakeMagic<u32>("SKVC")};
+            static constexpr u32 Version{1};
+
+            u32 magic;
+            u32 version;
+            u64 dataSize;
+            u64 dataHash; //!< XXH64 of the data, this guards against the file being partially written
+        };
+        static_assert(sizeof(FileHeader) == 0x18);
 
-            constexpr AttachmentMetadata(vk::Format format, vk::SampleCountFlagBits sampleCount) : format(format), sampleCount(sampleCount) {}
+        static constexpr std::chrono::minutes SaveInterval{2}; //!< The interval at which the pipeline cache is saved if any pipelines were compiled since it was last saved
 
-            bool operator==(const AttachmentMetadata &rhs) const = default;
-        };
+        std::mutex saveMutex; //!< Serializes saving the pipeline cache and synchronizes the save thread state
+        std::condition_variable saveCondition; //!< Signalled when the save thread should exit
+        std::thread saveThread; //!< A thread which periodically saves the pipeline cache, this is only running after the cache has been opened
+        bool saveThreadExit{};
+        std::string saveDirectory; //!< The directory of the file the pipeline cache is saved to, this is empty if the cache hasn't been opened
+        std::string saveFilename;
+        std::atomic<u32> unsavedPipelineCount{}; //!< The amount of pipelines compiled since the cache was last saved
+
+        /**
+         * @return If the Vulkan pipeline cache header in the data is for the current device and driver
+         */
+        bool IsCacheDataCompatible(span<const u8> data);
+
+        void SaveThread();
+
+        /**
+         * @brief Writes the pipeline cache data to the cache file
+         * @note The save mutex must be locked when calling this
+         */
+        void SaveLocked();
 
         /**
          * @brief All data in PipelineState in value form to allow cheap heterogenous lookups with reference types while still storing a value-based key in the map
@@ -131,29 +176,69 @@ namespace skyline::gpu::cache {
             bool operator()(const PipelineCacheKey &lhs, const PipelineCacheKey &rhs) const;
         };
 
-        struct PipelineCacheEntry {
+        struct PipelineLayoutKeyHash {
+            size_t operator()(const std::vector<u8> &key) const;
+        };
+
+        struct PipelineLayoutEntry {
             vk::raii::DescriptorSetLayout descriptorSetLayout;
             vk::raii::PipelineLayout pipelineLayout;
+
+            PipelineLayoutEntry(vk::raii::DescriptorSetLayout &&descriptorSetLayout, vk::raii::PipelineLayout &&pipelineLayout);
+        };
+
+        std::unordered_map<std::vector<u8>, PipelineLayoutEntry, PipelineLayoutKeyHash> pipelineLayoutCache; //!< A map from the raw bytes of the layout bindings, push constant ranges and push descriptor usage to the layouts created from them
+
+        struct PipelineCacheEntry {
+            vk::DescriptorSetLayout descriptorSetLayout; //!< A non-owning handle to a layout in the pipeline layout cache
+            vk::PipelineLayout pipelineLayout; //!< A non-owning handle to a layout in the pipeline layout cache
             vk::raii::Pipeline pipeline;
 
-            PipelineCacheEntry(vk::raii::DescriptorSetLayout&& descriptorSetLayout, vk::raii::PipelineLayout &&layout, vk::raii::Pipeline &&pipeline);
+            PipelineCacheEntry(const PipelineLayoutEntry &layout, vk::raii::Pipeline &&pipeline);
         };
 
         std::unordered_map<PipelineCacheKey, PipelineCacheEntry, PipelineStateHash, PipelineCacheEqual> pipelineCache;
 
+        const PipelineLayoutEntry &GetPipelineLayoutEntry(span<const vk::DescriptorSetLayoutBinding> layoutBindings, span<const vk::PushConstantRange> pushConstantRanges, bool noPushDescriptors);
+
       public:
         GraphicsPipelineCache(GPU &gpu);
 
+        ~GraphicsPipelineCache();
+
+        /**
+         * @brief Loads the Vulkan pipeline cache data for a title and starts saving it periodically
+         * @param path The directory that pipeline cache files are stored in
+         * @note This must be called prior to any pipelines being compiled concurrently as the Vulkan pipeline cache is replaced
+         */
+        void Open(const std::string &path, u64 titleId);
+
+        /**
+         * @brief Saves the Vulkan pipeline cache data to the file it was loaded from, this is a no-op if the cache hasn't been opened
+         */
+        void Save();
+
         struct CompiledPipeline {
             vk::DescriptorSetLayout descriptorSetLayout;
             vk::PipelineLayout pipelineLayout;
             vk::Pipeline pipeline;
 
             CompiledPipeline(const PipelineCacheEntry &entry);
+
+            /**
+             * @brief Creates a compiled pipeline with only the layouts filled in, the pipeline handle is null until it's compiled
+             */
+            CompiledPipeline(const PipelineLayoutEntry &layout);
         };
 
         /**
-         * @note All attachments in the PipelineState **must** be locked prior to calling this function
+         * @return The layouts that a pipeline with the supplied bindings will be compiled with, this doesn't compile the pipeline itself so descriptors can be prepared prior to compilation completing
+         * @note This is thread-safe and layouts with identical bindings are shared across all pipelines
+         */
+        CompiledPipeline GetPipelineLayout(span<const vk::DescriptorSetLayoutBinding> layoutBindings, span<const vk::PushConstantRange> pushConstantRanges = {}, bool noPushDescriptors = false);
+
+        /**
+         * @note This is thread-safe and may be called concurrently, pipelines are compiled without holding the lock
          * @note Shader specializiation constants are **not** supported and will result in UB
          * @note Input/Resolve attachments are **not** supported and using them with the supplied pipeline will result in UB
          */
@@ -0,0 +1,161 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <vfs/os_filesystem.h>
+#include <common/trace.h>
+#include "pipeline_warmup_cache.h"
+
+namespace skyline::gpu::cache {
+    void PipelineWarmupCache::Open(const std::string &path, u64 titleId, u64 recordLayout) {
+        TRACE_EVENT("gpu", "PipelineWarmupCache::Open");
+        std::scoped_lock lock{mutex};
+
+        FileHeader expectedHeader{
+            .magic = FileHeader::Magic,
+            .version = FileHeader::Version,
+            .titleId = titleId,
+            .recordLayout = recordLayout,
+        };
+
+        auto filename{fmt::format("{:016X}.bin", titleId)};
+        try {
+            vfs::OsFileSystem filesystem{path};
+            if (!filesystem.FileExists(filename) && !filesystem.CreateFile(filename, 0))
+                throw exception("Failed to create file");
+            backing = filesystem.OpenFile(filename, {true, true, true});
+
+            bool valid{backing->size >= sizeof(FileHeader)};
+            if (valid) {
+                auto header{backing->Read<FileHeader>()};
+                valid = std::memcmp(&header, &expectedHeader, sizeof(FileHeader)) == 0;
+                if (!valid)
+                    Logger::Info("Pipeline warm-up cache is outdated, it'll be rebuilt");
+            }
+
+            if (!valid) {
+                backing->Resize(0);
+                backing->Write(span<FileHeader>{expectedHeader}.cast<u8>());
+                return;
+            }
+
+            std::vector<u8> contents(backing->size - sizeof(FileHeader));
+            backing->Read(span{contents}, sizeof(FileHeader));
+
+            size_t offset{};
+            while (contents.size() - offset >= sizeof(RecordHeader)) {
+                RecordHeader header;
+                std::memcpy(&header, contents.data() + offset, sizeof(RecordHeader));
+                if (contents.size() - offset - sizeof(RecordHeader) < header.size)
+                    break;
+
+                auto record{contents.data() + offset + sizeof(RecordHeader)};
+                if (XXH64(record, header.size, 0) != header.hash)
+                    break;
+
+                if (recordHashes.insert(header.hash).second)
+                    records.emplace_back(record, record + header.size);
+                offset += sizeof(RecordHeader) + header.size;
+            }
+
+            // Anything past the last valid record is from an interrupted write, it's removed so future records are appended directly after the valid ones
+            if (offset != contents.size()) {
+                Logger::Warn("Discarding 0x{:X} bytes of invalid data at the end of the pipeline warm-up cache", contents.size() - offset);
+                backing->Resize(sizeof(FileHeader) + offset);
+            }
+
+            Logger::Info("Loaded {} pipelines from the pipeline warm-up cache", records.size());
+        } catch (const exception &e) {
+            Logger::Warn("Failed to open pipeline warm-up cache {}, recording will be disabled: {}", filename, e.what());
+            backing = nullptr;
+            records.clear();
+            recordHashes.clear();
+        }
+    }
+
+    void PipelineWarmupCache::Insert(span<const u8> record) {
+        RecordHeader header{
+            .size = static_cast<u32>(record.size()),
+            .hash = XXH64(record.data(), record.size(), 0),
+        };
+
+        std::scoped_lock lock{mutex};
+        if (!backing || !recordHashes.insert(header.hash).second)
+            return;
+
+        TRACE_EVENT("gpu", "PipelineWarmupCache::Insert");
+
+        // The header and record are written together so an interrupted write can only leave a truncated record at the end of the file
+        std::vector<u8> data(sizeof(RecordHeader) + record.size());
+        std::memcpy(data.data(), &header, sizeof(RecordHeader));
+        std::memcpy(data.data() + sizeof(RecordHeader), record.data(), record.size());
+
+        try {
+            backing->Write(span{data}, backing->size);
+        } catch (const exception &e) {
+            Logger::Warn("Failed to write to the pipeline warm-up cache, recording will be disabled: {}", e.what());
+            backing = nullptr;
+        }
+    }
+
+    void PipelineWarmupCache::Precompile(const std::function<bool(span<const u8>)> &compile, const std::function<void(size_t, size_t)> &progress) {
+        TRACE_EVENT("gpu", "PipelineWarmupCache::Precompile");
+
+        std::vector<std::vector<u8>> pendingRecords;
+        {
+            std::scoped_lock lock{mutex};
+            pendingRecords = std::move(records);
+            records.clear();
+        }
+
+        if (pendingRecords.empty())
+            return;
+
+        auto startTime{util::GetTimeNs()};
+        std::atomic<size_t> nextIndex{}, processedCount{}, compiledCount{};
+        std::mutex progressMutex;
+        std::condition_variable progressCondition;
+
+        auto worker{[&] {
+            if (int result{pthread_setname_np(pthread_self(), "Sky-PipeWarmup")})
+                Logger::Warn("Failed to set the thread name: {}", strerror(result));
+
+            for (size_t index{nextIndex++}; index < pendingRecords.size(); index = nextIndex++) {
+                try {
+                    if (compile(pendingRecords[index]))
+                        compiledCount++;
+                } catch (const std::exception &e) {
+                    Logger::Warn("Failed to precompile pipeline: {}", e.what());
+                }
+
+                {
+                    std::scoped_lock lock{progressMutex};
+                    processedCount++;
+                }
+                progressCondition.notify_one();
+            }
+        }};
+
+        // A single thread is left for the rest of the system so the loading screen stays responsive
+        size_t threadCount{std::clamp<size_t>(std::thread::hardware_concurrency(), 2, 8) - 1};
+        std::vector<std::thread> threads;
+        threads.reserve(threadCount);
+        for (size_t i{}; i < threadCount; i++)
+            threads.emplace_back(worker);
+
+        size_t reportedCount{};
+        progress(reportedCount, pendingRecords.size());
+        while (reportedCount != pendingRecords.size()) {
+            {
+                std::unique_lock lock{progressMutex};
+                progressCondition.wait(lock, [&] { return processedCount != reportedCount; });
+                reportedCount = processedCount;
+            }
+            progress(reportedCount, pendingRecords.size());
+        }
+
+        for (auto &thread : threads)
+            thread.join();
+
+        Logger::Info("Precompiled {}/{} pipelines in {}ms", compiledCount.load(), pendingRecords.size(), (util::GetTimeNs() - startTime) / constant::NsInMillisecond);
+    }
+}
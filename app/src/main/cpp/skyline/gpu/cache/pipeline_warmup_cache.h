@@ -0,0 +1,60 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <unordered_set>
+#include <vfs/backing.h>
+
+namespace skyline::gpu::cache {
+    /**
+     * @brief A persistent per-title record of all pipelines a title has created, these are compiled ahead of time when the title is next booted so they don't need to be compiled during gameplay
+     * @note Records are opaque to the cache, they're created and compiled by the engine interconnect that uses the pipelines
+     * @note The cache file is append-only and every record is checksummed, an interrupted write only loses the record being written and the file is truncated to the last valid record when it's opened
+     */
+    class PipelineWarmupCache {
+      private:
+        struct FileHeader {
+            static constexpr u32 Magic{util::MakeMagic<u32>("SKPW")};
+            static constexpr u32 Version{2}; //!< The version of the cache file format, this must be incremented for any changes to the format, changes to the layout of records are covered by recordLayout
+
+            u32 magic;
+            u32 version;
+            u64 titleId;
+            u64 recordLayout; //!< A hash of the layout of records supplied by the user of the cache
+        };
+        static_assert(sizeof(FileHeader) == 0x18);
+
+        struct RecordHeader {
+            u32 size;
+            u32 _pad_;
+            u64 hash; //!< XXH64 of the record following the header, this is also used to deduplicate records
+        };
+        static_assert(sizeof(RecordHeader) == 0x10);
+
+        std::mutex mutex; //!< Synchronizes accesses to the backing and the record hashes
+        std::shared_ptr<vfs::Backing> backing; //!< The backing of the cache file, this'll be null if the cache hasn't been opened or failed to
+        std::vector<std::vector<u8>> records; //!< The records loaded from the cache file, these are released after they're compiled
+        std::unordered_set<u64> recordHashes; //!< The hashes of all records in the cache file
+
+      public:
+        /**
+         * @brief Opens the cache file for a title and loads all valid records from it
+         * @param path The directory that cache files are stored in
+         * @param recordLayout A hash of the layout of records, the cache file is rebuilt if it was written with records of a different layout
+         */
+        void Open(const std::string &path, u64 titleId, u64 recordLayout);
+
+        /**
+         * @brief Appends a record to the cache file if an identical record isn't already in it
+         */
+        void Insert(span<const u8> record);
+
+        /**
+         * @brief Compiles all records loaded from the cache file across a set of worker threads, this blocks until all of them are compiled
+         * @param compile A thread-safe function which compiles a record and returns if it was compiled successfully
+         * @param progress A function called on the calling thread with the amount of compiled records and the total amount of records whenever progress is made
+         */
+        void Precompile(const std::function<bool(span<const u8>)> &compile, const std::function<void(size_t, size_t)> &progress);
+    };
+}
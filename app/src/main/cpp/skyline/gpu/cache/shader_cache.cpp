@@ -0,0 +1,306 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <vfs/os_filesystem.h>
+#include <common/trace.h>
+#include <gpu.h>
+#include "shader_cache.h"
+
+namespace skyline::gpu::cache {
+    /**
+     * @brief Calls the supplied function with every descriptor container in Shader::Info, all other members of it are trivially copyable
+     * @note Any new containers added to Shader::Info must be added here and the cache version must be incremented
+     */
+    template<typename InfoType, typename Function>
+    static void ForEachDescriptorContainer(InfoType &info, Function function) {
+        function(info.constant_buffer_descriptors);
+        function(info.storage_buffers_descriptors);
+        function(info.texture_buffer_descriptors);
+        function(info.image_buffer_descriptors);
+        function(info.texture_descriptors);
+        function(info.image_descriptors);
+    }
+
+    /**
+     * @return The byte ranges of the descriptor containers within Shader::Info sorted by their offset
+     */
+    static std::vector<std::pair<size_t, size_t>> GetDescriptorContainerRanges(const Shader::Info &info) {
+        std::vector<std::pair<size_t, size_t>> ranges;
+        ForEachDescriptorContainer(info, [&](const auto &container) {
+            auto offset{static_cast<size_t>(reinterpret_cast<const u8 *>(&container) - reinterpret_cast<const u8 *>(&info))};
+            ranges.emplace_back(offset, offset + sizeof(container));
+        });
+        std::sort(ranges.begin(), ranges.end());
+        return ranges;
+    }
+
+    /**
+     * @brief A helper for appending trivially copyable objects and arrays of them to a buffer
+     */
+    struct PayloadWriter {
+        std::vector<u8> &payload;
+
+        template<typename T> requires std::is_trivially_copyable_v<T>
+        void Write(const T &object) {
+            auto bytes{reinterpret_cast<const u8 *>(&object)};
+            payload.insert(payload.end(), bytes, bytes + sizeof(T));
+        }
+
+        template<typename Container>
+        void WriteArray(const Container &container) {
+            using ValueType = typename Container::value_type;
+            static_assert(std::is_trivially_copyable_v<ValueType>);
+
+            Write(static_cast<u32>(container.size()));
+            auto bytes{reinterpret_cast<const u8 *>(container.data())};
+            payload.insert(payload.end(), bytes, bytes + (container.size() * sizeof(ValueType)));
+        }
+    };
+
+    /**
+     * @brief A helper for reading objects written by PayloadWriter with bounds checking
+     */
+    struct PayloadReader {
+        span<const u8> payload;
+        size_t offset{};
+
+        span<const u8> Consume(size_t size) {
+            if (payload.size() - offset < size)
+                throw exception("Payload is truncated: 0x{:X} + 0x{:X} > 0x{:X}", offset, size, payload.size());
+            auto bytes{payload.subspan(offset, size)};
+            offset += size;
+            return bytes;
+        }
+
+        template<typename T> requires std::is_trivially_copyable_v<T>
+        T Read() {
+            T object;
+            std::memcpy(&object, Consume(sizeof(T)).data(), sizeof(T));
+            return object;
+        }
+
+        template<typename Container>
+        void ReadArray(Container &container) {
+            using ValueType = typename Container::value_type;
+            static_assert(std::is_trivially_copyable_v<ValueType>);
+
+            auto count{Read<u32>()};
+            auto bytes{Consume(count * sizeof(ValueType))};
+            if (count > container.max_size())
+                throw exception("Array is larger than its container: {}", count);
+
+            container.resize(count);
+            std::memcpy(container.data(), bytes.data(), bytes.size());
+        }
+    };
+
+    u64 ShaderCache::GetEntryLayoutHash() {
+        // Shader::Info isn't standard-layout so offsets are calculated from an instance rather than with offsetof
+        Shader::Info info{};
+        auto offsetOf{[&](const auto &member) {
+            return static_cast<u64>(reinterpret_cast<const u8 *>(&member) - reinterpret_cast<const u8 *>(&info));
+        }};
+
+        std::vector<u64> layout{
+            FileHeader::Version,
+            sizeof(Shader::Info),
+            offsetOf(info.constant_buffer_used_sizes),
+            offsetOf(info.loads),
+            offsetOf(info.stores),
+            sizeof(Shader::Backend::Bindings),
+            sizeof(ShaderManager::ConstantBufferWord),
+            sizeof(ShaderManager::CachedTextureType),
+        };
+
+        ForEachDescriptorContainer(info, [&](const auto &container) {
+            layout.push_back(offsetOf(container));
+            layout.push_back(sizeof(typename std::remove_cvref_t<decltype(container)>::value_type));
+        });
+
+        return XXH64(layout.data(), layout.size() * sizeof(u64), 0);
+    }
+
+    std::vector<u8> ShaderCache::SerializeEntry(const Entry &entry) {
+        std::vector<u8> payload;
+        payload.reserve((entry.spirv.size() * sizeof(u32)) + sizeof(Shader::Info) + 0x400);
+        PayloadWriter writer{payload};
+
+        writer.Write(entry.stage);
+        writer.Write(entry.outputTopology);
+        writer.Write(static_cast<u8>(entry.isGeometryPassthrough));
+        writer.Write(entry.bindings);
+        writer.WriteArray(entry.constantBufferWords);
+        writer.WriteArray(entry.textureTypes);
+        writer.WriteArray(entry.spirv);
+
+        // The descriptor containers aren't trivially copyable so they're cleared in the raw copy of the info and written separately
+        std::array<u8, sizeof(Shader::Info)> infoBytes;
+        std::memcpy(infoBytes.data(), &entry.info, sizeof(Shader::Info));
+        for (auto [start, end] : GetDescriptorContainerRanges(entry.info))
+            std::fill(infoBytes.begin() + static_cast<ssize_t>(start), infoBytes.begin() + static_cast<ssize_t>(end), 0);
+        payload.insert(payload.end(), infoBytes.begin(), infoBytes.end());
+
+        ForEachDescriptorContainer(entry.info, [&](const auto &container) {
+            writer.WriteArray(container);
+        });
+
+        return payload;
+    }
+
+    std::shared_ptr<ShaderCache::Entry> ShaderCache::DeserializeEntry(span<const u8> payload) {
+        try {
+            auto entry{std::make_shared<Entry>()};
+            PayloadReader reader{payload};
+
+            entry->stage = reader.Read<Shader::Stage>();
+            entry->outputTopology = reader.Read<Shader::OutputTopology>();
+            entry->isGeometryPassthrough = reader.Read<u8>() != 0;
+            entry->bindings = reader.Read<Shader::Backend::Bindings>();
+            reader.ReadArray(entry->constantBufferWords);
+            reader.ReadArray(entry->textureTypes);
+            reader.ReadArray(entry->spirv);
+
+            // Only the bytes outside of the descriptor containers are copied as the containers in the stored bytes are invalid
+            auto infoBytes{reader.Consume(sizeof(Shader::Info))};
+            auto infoPointer{reinterpret_cast<u8 *>(&entry->info)};
+            size_t copyStart{};
+            for (auto [start, end] : GetDescriptorContainerRanges(entry->info)) {
+                std::memcpy(infoPointer + copyStart, infoBytes.data() + copyStart, start - copyStart);
+                copyStart = end;
+            }
+            std::memcpy(infoPointer + copyStart, infoBytes.data() + copyStart, sizeof(Shader::Info) - copyStart);
+
+            ForEachDescriptorContainer(entry->info, [&](auto &container) {
+                reader.ReadArray(container);
+            });
+
+            if (reader.offset != payload.size())
+                throw exception("Trailing data in payload: 0x{:X}", payload.size() - reader.offset);
+
+            return entry;
+        } catch (const exception &e) {
+            Logger::Warn("Malformed shader cache entry: {}", e.what());
+            return nullptr;
+        }
+    }
+
+    ShaderCache::ShaderCache(GPU &gpu) : gpu{gpu} {}
+
+    void ShaderCache::Open(const std::string &path, u64 titleId) {
+        TRACE_EVENT("gpu", "ShaderCache::Open");
+        std::scoped_lock lock{mutex};
+
+        auto properties{gpu.vkPhysicalDevice.getProperties()};
+        std::array<u32, 3> deviceIds{properties.vendorID, properties.deviceID, properties.driverVersion};
+        u64 deviceHash{XXH64(properties.pipelineCacheUUID.data(), properties.pipelineCacheUUID.size(), XXH64(deviceIds.data(), sizeof(deviceIds), 0))};
+
+        FileHeader expectedHeader{
+            .magic = FileHeader::Magic,
+            .version = FileHeader::Version,
+            .layoutHash = GetEntryLayoutHash(),
+            .deviceHash = deviceHash,
+            .titleId = titleId,
+        };
+
+        auto filename{fmt::format("{:016X}.bin", titleId)};
+        try {
+            vfs::OsFileSystem filesystem{path};
+            if (!filesystem.FileExists(filename) && !filesystem.CreateFile(filename, 0))
+                throw exception("Failed to create file");
+            backing = filesystem.OpenFile(filename, {true, true, true});
+
+            bool valid{backing->size >= sizeof(FileHeader)};
+            if (valid) {
+                auto header{backing->Read<FileHeader>()};
+                valid = std::memcmp(&header, &expectedHeader, sizeof(FileHeader)) == 0;
+                if (!valid)
+                    Logger::Info("Shader cache is outdated or for a different device, it'll be rebuilt");
+            }
+
+            if (!valid) {
+                backing->Resize(0);
+                backing->Write(span<FileHeader>{expectedHeader}.cast<u8>());
+                return;
+            }
+
+            std::vector<u8> contents(backing->size - sizeof(FileHeader));
+            backing->Read(span{contents}, sizeof(FileHeader));
+
+            size_t offset{};
+            while (contents.size() - offset >= sizeof(EntryHeader)) {
+                EntryHeader header;
+                std::memcpy(&header, contents.data() + offset, sizeof(EntryHeader));
+                if (contents.size() - offset - sizeof(EntryHeader) < header.payloadSize)
+                    break;
+
+                span<const u8> payload{contents.data() + offset + sizeof(EntryHeader), header.payloadSize};
+                if (XXH64(payload.data(), payload.size(), 0) != header.payloadHash)
+                    break;
+
+                auto entry{DeserializeEntry(payload)};
+                if (!entry)
+                    break;
+
+                entries[header.key] = std::move(entry);
+                offset += sizeof(EntryHeader) + header.payloadSize;
+            }
+
+            // Anything past the last valid entry is from an interrupted write, it's removed so future entries are appended directly after the valid ones
+            if (offset != contents.size()) {
+                Logger::Warn("Discarding 0x{:X} bytes of invalid data at the end of the shader cache", contents.size() - offset);
+                backing->Resize(sizeof(FileHeader) + offset);
+            }
+
+            Logger::Info("Loaded {} shaders from the shader cache", entries.size());
+        } catch (const exception &e) {
+            Logger::Warn("Failed to open shader cache {}, caching will be disabled: {}", filename, e.what());
+            backing = nullptr;
+            entries.clear();
+        }
+    }
+
+    std::shared_ptr<const ShaderCache::Entry> ShaderCache::Lookup(u64 key) {
+        std::scoped_lock lock{mutex};
+        auto it{entries.find(key)};
+        return it != entries.end() ? it->second : nullptr;
+    }
+
+    void ShaderCache::Store(u64 key, std::shared_ptr<const Entry> entry) {
+        TRACE_EVENT("gpu", "ShaderCache::Store");
+
+        auto payload{SerializeEntry(*entry)};
+        EntryHeader header{
+            .key = key,
+            .payloadSize = static_cast<u32>(payload.size()),
+            .payloadHash = XXH64(payload.data(), payload.size(), 0),
+        };
+
+        // The header and payload are written together so an interrupted write can only leave a truncated entry at the end of the file
+        std::vector<u8> record(sizeof(EntryHeader) + payload.size());
+        std::memcpy(record.data(), &header, sizeof(EntryHeader));
+        std::memcpy(record.data() + sizeof(EntryHeader), payload.data(), payload.size());
+
+        std::scoped_lock lock{mutex};
+        entries[key] = std::move(entry);
+
+        if (backing) {
+            try {
+                backing->Write(span{record}, backing->size);
+            } catch (const exception &e) {
+                Logger::Warn("Failed to write to the shader cache, caching will be disabled: {}", e.what());
+                backing = nullptr;
+            }
+        }
+    }
+
+    vk::ShaderModule ShaderCache::GetShaderModule(const Entry &entry) {
+        std::call_once(entry.moduleFlag, [&] {
+            entry.module = gpu.shader.CreateShaderModule(entry.spirv);
+        });
+        return entry.module;
+    }
+
+    void ShaderCache::LogStatistics() {
+        Logger::Info("Shader cache: {}/{} hits", hitCount.load(), hitCount.load() + missCount.load());
+    }
+}
@@ -0,0 +1,103 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <vfs/backing.h>
+#include <gpu/shader_manager.h>
+
+namespace skyline::gpu::cache {
+    /**
+     * @brief A persistent per-title cache of translated guest shaders, shaders found in it skip the Maxwell frontend and SPIR-V emission entirely
+     * @note The cache file is append-only and every entry is checksummed, an interrupted write only loses the entry being written and the file is truncated to the last valid entry when it's opened
+     */
+    class ShaderCache {
+      public:
+        /**
+         * @brief A single translated shader stage alongside all the state required to use it in place of translating the guest binary
+         */
+        struct Entry {
+            std::vector<ShaderManager::ConstantBufferWord> constantBufferWords; //!< The constant buffer words the shader was specialized on, these must match the current constant buffer contents for the entry to be used
+            std::vector<ShaderManager::CachedTextureType> textureTypes; //!< The texture types the shader was specialized on, these must match the current TICs for the entry to be used
+            std::vector<u32> spirv;
+            Shader::Info info; //!< The shader info after the SPIR-V was emitted
+            Shader::Stage stage;
+            Shader::OutputTopology outputTopology;
+            bool isGeometryPassthrough;
+            Shader::Backend::Bindings bindings; //!< The bindings after the SPIR-V was emitted, these are used as the starting bindings of the following stage
+
+            mutable std::once_flag moduleFlag; //!< Guards the lazy creation of the module
+            mutable vk::ShaderModule module; //!< The module created from the SPIR-V, this is shared by all pipelines using the entry so they can share the same Vulkan pipelines
+        };
+
+      private:
+        struct FileHeader {
+            static constexpr u32 Magic{util::MakeMagic<u32>("SKSC")};
+            static constexpr u32 Version{2}; //!< The version of the cache file format, this must be incremented for any changes to the format or to the shader compiler that affect its output
+
+            u32 magic;
+            u32 version;
+            u64 layoutHash; //!< A hash of the layout of all raw structures in entries, this guards against the layout of Shader::Info changing without the version being incremented
+            u64 deviceHash; //!< A hash of the host GPU and driver that the SPIR-V was generated for
+            u64 titleId;
+        };
+        static_assert(sizeof(FileHeader) == 0x20);
+
+        struct EntryHeader {
+            u64 key;
+            u32 payloadSize;
+            u32 _pad_;
+            u64 payloadHash; //!< XXH64 of the payload following the header
+        };
+        static_assert(sizeof(EntryHeader) == 0x18);
+
+        GPU &gpu;
+        std::mutex mutex; //!< Synchronizes accesses to the entries and the backing
+        std::shared_ptr<vfs::Backing> backing; //!< The backing of the cache file, this'll be null if the cache hasn't been opened or failed to
+        std::unordered_map<u64, std::shared_ptr<const Entry>> entries;
+
+        /**
+         * @return A hash of the sizes and offsets of all structures that are stored as raw bytes in entries
+         */
+        static u64 GetEntryLayoutHash();
+
+        static std::vector<u8> SerializeEntry(const Entry &entry);
+
+        /**
+         * @return The entry deserialized from the payload or nullptr if the payload is malformed
+         */
+        static std::shared_ptr<Entry> DeserializeEntry(span<const u8> payload);
+
+      public:
+        std::atomic<u64> hitCount{};
+        std::atomic<u64> missCount{};
+
+        ShaderCache(GPU &gpu);
+
+        /**
+         * @brief Opens the cache file for a title and loads all valid entries from it, this must be called prior to any lookups for them to hit
+         * @param path The directory that cache files are stored in
+         */
+        void Open(const std::string &path, u64 titleId);
+
+        /**
+         * @return The entry for the supplied key or nullptr if there's none, the caller is responsible for validating the constant buffer words and texture types
+         */
+        std::shared_ptr<const Entry> Lookup(u64 key);
+
+        /**
+         * @brief Inserts an entry and appends it to the cache file
+         */
+        void Store(u64 key, std::shared_ptr<const Entry> entry);
+
+        /**
+         * @return The shader module for an entry, this is created on the first call and the same module is returned for all subsequent calls
+         */
+        vk::ShaderModule GetShaderModule(const Entry &entry);
+
+        /**
+         * @brief Logs the hit rate of the cache
+         */
+        void LogStatistics();
+    };
+}
@@ -44,6 +44,8 @@ namespace skyline::gpu::interconnect {
     }
 
     void Inline2Memory::Upload(IOVA dst, span<u32> src) {
+        channelCtx.Lock();
+
         auto dstMappings{channelCtx.asCtx->gmmu.TranslateRange(dst, src.size_bytes())};
 
         size_t offset{};
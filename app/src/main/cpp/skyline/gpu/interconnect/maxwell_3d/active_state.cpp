@@ -394,6 +394,21 @@ namespace skyline::gpu::interconnect::maxwell3d {
         dirtyFunc(stencilValues);
     }
 
+    void ActiveState::MarkBuilderStateDirty() {
+        auto dirtyFunc{[&](auto &stateElem) { stateElem.MarkDirty(false); }};
+
+        ranges::for_each(vertexBuffers, dirtyFunc);
+        dirtyFunc(indexBuffer);
+        ranges::for_each(transformFeedbackBuffers, dirtyFunc);
+        ranges::for_each(viewports, dirtyFunc);
+        ranges::for_each(scissors, dirtyFunc);
+        dirtyFunc(lineWidth);
+        dirtyFunc(depthBias);
+        dirtyFunc(blendConstants);
+        dirtyFunc(depthBounds);
+        dirtyFunc(stencilValues);
+    }
+
     void ActiveState::Update(InterconnectContext &ctx, Textures &textures, ConstantBufferSet &constantBuffers, StateUpdateBuilder &builder, bool indexed, engine::DrawTopology topology, u32 drawFirstIndex, u32 drawElementCount) {
         if (topology != directState.inputAssembly.GetPrimitiveTopology()) {
             directState.inputAssembly.SetPrimitiveTopology(topology);
@@ -254,6 +254,11 @@ namespace skyline::gpu::interconnect::maxwell3d {
 
         void MarkAllDirty();
 
+        /**
+         * @brief Marks all state that's recorded into the state update builder as dirty without purging any caches, this is required when the state updates from a draw are discarded
+         */
+        void MarkBuilderStateDirty();
+
         /**
          * @brief Updates the active state for a given draw operation, removing the dirtiness of all member states
          */
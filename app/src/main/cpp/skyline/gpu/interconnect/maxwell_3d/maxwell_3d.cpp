@@ -112,10 +112,12 @@ namespace skyline::gpu::interconnect::maxwell3d {
     }
 
     void Maxwell3D::LoadConstantBuffer(span<u32> data, u32 offset) {
+        ctx.channelCtx.Lock();
         constantBuffers.Load(ctx, data, offset);
     }
 
     void Maxwell3D::BindConstantBuffer(engine::ShaderStage stage, u32 index, bool enable) {
+        ctx.channelCtx.Lock();
         if (enable)
             constantBuffers.Bind(ctx, stage, index);
         else
@@ -127,6 +129,8 @@ namespace skyline::gpu::interconnect::maxwell3d {
     }
 
     void Maxwell3D::Clear(engine::ClearSurface &clearSurface) {
+        ctx.channelCtx.Lock();
+
         auto scissor{GetClearScissor()};
         if (scissor.extent.width == 0 || scissor.extent.height == 0)
             return;
@@ -209,11 +213,44 @@ namespace skyline::gpu::interconnect::maxwell3d {
         }, renderArea, {}, {}, colorView ? colorAttachments : span<TextureView *>{}, depthStencilView ? &*depthStencilView : nullptr);
     }
 
-    void Maxwell3D::Draw(engine::DrawTopology topology, bool transformFeedbackEnable, bool indexed, u32 count, u32 first, u32 instanceCount, u32 vertexOffset, u32 firstInstance) {
+    BufferBinding Maxwell3D::PushIndirectDrawCommands(bool indexed, span<const MultiDrawParams> draws) {
+        vk::DeviceSize size{draws.size() * (indexed ? sizeof(vk::DrawIndexedIndirectCommand) : sizeof(vk::DrawIndirectCommand))};
+
+        // Megabuffer allocations are unaligned while indirect commands need to be 4-byte aligned, the allocation is padded to allow for aligning it
+        auto allocation{ctx.gpu.megaBufferAllocator.Allocate(ctx.executor.cycle, size + sizeof(u32) - 1)};
+        vk::DeviceSize alignedOffset{util::AlignUp(allocation.offset, sizeof(u32))};
+        auto commands{allocation.region.subspan(alignedOffset - allocation.offset, size)};
+
+        if (indexed) {
+            auto indexedCommands{commands.cast<vk::DrawIndexedIndirectCommand>()};
+            for (size_t i{}; i < draws.size(); i++)
+                indexedCommands[i] = vk::DrawIndexedIndirectCommand{draws[i].count, draws[i].instanceCount, draws[i].first, static_cast<i32>(draws[i].vertexOffset), draws[i].firstInstance};
+        } else {
+            auto nonIndexedCommands{commands.cast<vk::DrawIndirectCommand>()};
+            for (size_t i{}; i < draws.size(); i++)
+                nonIndexedCommands[i] = vk::DrawIndirectCommand{draws[i].count, draws[i].instanceCount, draws[i].first, draws[i].firstInstance};
+        }
+
+        return {allocation.buffer, alignedOffset, size};
+    }
+
+    void Maxwell3D::Draw(engine::DrawTopology topology, bool transformFeedbackEnable, bool indexed, u32 count, u32 first, u32 instanceCount, u32 vertexOffset, u32 firstInstance, span<const MultiDrawParams> indirectDraws) {
+        ctx.channelCtx.Lock();
+
         StateUpdateBuilder builder{*ctx.executor.allocator};
 
-        Pipeline *oldPipeline{activeState.GetPipeline()};
+        Pipeline *oldPipeline{pipelineBindSkipped ? nullptr : activeState.GetPipeline()};
         activeState.Update(ctx, textures, constantBuffers.boundConstantBuffers, builder, indexed, topology, first, count);
+
+        Pipeline *pipeline{activeState.GetPipeline()};
+        if (ctx.gpu.pipelineCompiler.mode == PipelineCompilationMode::AsyncSkip && !pipeline->IsCompiled()) {
+            // The state updates from this draw are discarded so they need to be reapplied on the next draw alongside a full pipeline and descriptor rebind
+            activeState.MarkBuilderStateDirty();
+            pipelineBindSkipped = true;
+            return;
+        }
+        pipelineBindSkipped = false;
+
         if (directState.inputAssembly.NeedsQuadConversion()) {
             count = conversion::quads::GetIndexCount(count);
             first = 0;
@@ -226,7 +263,6 @@ namespace skyline::gpu::interconnect::maxwell3d {
             }
         }
 
-        Pipeline *pipeline{activeState.GetPipeline()};
         activeDescriptorSetSampledImages.resize(pipeline->GetTotalSampledImageCount());
 
         auto *descUpdateInfo{[&]() -> DescriptorUpdateInfo * {
@@ -243,9 +279,14 @@ namespace skyline::gpu::interconnect::maxwell3d {
             }
         }()};
 
-        if (oldPipeline != pipeline)
+        if (oldPipeline != pipeline) {
             // If the pipeline has changed, we need to update the pipeline state
-            builder.SetPipeline(pipeline->compiledPipeline.pipeline);
+            if (pipeline->IsCompiled())
+                builder.SetPipeline(pipeline->compiledPipeline.pipeline);
+            else
+                // The pipeline is bound when the draw is recorded, this'll only block if compilation hasn't completed by then
+                builder.SetPendingPipeline(pipeline);
+        }
 
         if (descUpdateInfo) {
             if (ctx.gpu.traits.supportsPushDescriptors) {
@@ -269,6 +310,10 @@ namespace skyline::gpu::interconnect::maxwell3d {
 
         auto stateUpdater{builder.Build()};
 
+        BufferBinding indirectCommands{};
+        if (!indirectDraws.empty())
+            indirectCommands = PushIndirectDrawCommands(indexed, indirectDraws);
+
         /**
          * @brief Struct that can be linearly allocated, holding all state for the draw to avoid a dynamic allocation with lambda captures
          */
@@ -281,10 +326,13 @@ namespace skyline::gpu::interconnect::maxwell3d {
             u32 firstInstance;
             bool indexed;
             bool transformFeedbackEnable;
+            BufferBinding indirectCommands;
+            u32 indirectDrawCount;
         };
         auto *drawParams{ctx.executor.allocator->EmplaceUntracked<DrawParams>(DrawParams{stateUpdater,
                                                                                          count, first, instanceCount, vertexOffset, firstInstance, indexed,
-                                                                                         ctx.gpu.traits.supportsTransformFeedback ? transformFeedbackEnable : false})};
+                                                                                         ctx.gpu.traits.supportsTransformFeedback ? transformFeedbackEnable : false,
+                                                                                         indirectCommands, static_cast<u32>(indirectDraws.size())})};
 
         const auto &surfaceClip{clearEngineRegisters.surfaceClip};
         vk::Rect2D scissor{
@@ -298,10 +346,16 @@ namespace skyline::gpu::interconnect::maxwell3d {
             if (drawParams->transformFeedbackEnable)
                 commandBuffer.beginTransformFeedbackEXT(0, {}, {});
 
-            if (drawParams->indexed)
+            if (drawParams->indirectCommands) {
+                if (drawParams->indexed)
+                    commandBuffer.drawIndexedIndirect(drawParams->indirectCommands.buffer, drawParams->indirectCommands.offset, drawParams->indirectDrawCount, sizeof(vk::DrawIndexedIndirectCommand));
+                else
+                    commandBuffer.drawIndirect(drawParams->indirectCommands.buffer, drawParams->indirectCommands.offset, drawParams->indirectDrawCount, sizeof(vk::DrawIndirectCommand));
+            } else if (drawParams->indexed) {
                 commandBuffer.drawIndexed(drawParams->count, drawParams->instanceCount, drawParams->first, static_cast<i32>(drawParams->vertexOffset), drawParams->firstInstance);
-            else
+            } else {
                 commandBuffer.draw(drawParams->count, drawParams->instanceCount, drawParams->first, drawParams->firstInstance);
+            }
 
             if (drawParams->transformFeedbackEnable)
                 commandBuffer.endTransformFeedbackEXT(0, {}, {});
@@ -309,4 +363,25 @@ namespace skyline::gpu::interconnect::maxwell3d {
 
         constantBuffers.ResetQuickBind();
     }
+
+    void Maxwell3D::MultiDraw(engine::DrawTopology topology, bool transformFeedbackEnable, bool indexed, span<const MultiDrawParams> draws) {
+        ctx.channelCtx.Lock();
+
+        bool usesFirstInstance{ranges::any_of(draws, [](const MultiDrawParams &draw) { return draw.firstInstance != 0; })};
+        if (draws.size() == 1 || topology == engine::DrawTopology::Quads || !ctx.gpu.traits.supportsMultiDrawIndirect || (usesFirstInstance && !ctx.gpu.traits.supportsDrawIndirectFirstInstance)) {
+            // Quad conversion modifies the draw parameters on the host so it can't be used alongside indirect draws
+            for (const auto &draw : draws)
+                Draw(topology, transformFeedbackEnable, indexed, draw.count, draw.first, draw.instanceCount, draw.vertexOffset, draw.firstInstance);
+            return;
+        }
+
+        // The index buffer is sized to cover the indices used by all draws
+        u32 first{std::numeric_limits<u32>::max()}, end{};
+        for (const auto &draw : draws) {
+            first = std::min(first, draw.first);
+            end = std::max(end, draw.first + draw.count);
+        }
+
+        Draw(topology, transformFeedbackEnable, indexed, end - first, first, 0, 0, 0, draws);
+    }
 }
\ No newline at end of file
@@ -38,6 +38,17 @@ namespace skyline::gpu::interconnect::maxwell3d {
             TexturePoolState::EngineRegisters texturePoolRegisters;
         };
 
+        /**
+         * @brief The parameters of a single draw within a multi-draw
+         */
+        struct MultiDrawParams {
+            u32 count; //!< indexed ? indexCount : vertexCount
+            u32 first; //!< indexed ? firstIndex : firstVertex
+            u32 instanceCount;
+            u32 vertexOffset; //!< Only applicable to indexed draws
+            u32 firstInstance;
+        };
+
       private:
         InterconnectContext ctx;
         ActiveState activeState;
@@ -52,11 +63,18 @@ namespace skyline::gpu::interconnect::maxwell3d {
         std::shared_ptr<boost::container::static_vector<DescriptorAllocator::ActiveDescriptorSet, DescriptorBatchSize>> attachedDescriptorSets;
         DescriptorAllocator::ActiveDescriptorSet *activeDescriptorSet{};
         std::vector<TextureView *> activeDescriptorSetSampledImages{};
+        bool pipelineBindSkipped{}; //!< If the last draw was skipped as its pipeline wasn't compiled yet, the pipeline and descriptors that are bound on the host don't match the active state in this case
 
         size_t UpdateQuadConversionBuffer(u32 count, u32 firstVertex);
 
         vk::Rect2D GetClearScissor();
 
+        /**
+         * @brief Pushes the indirect draw commands for a multi-draw into the megabuffer
+         * @return A binding to the commands, they're tightly packed VkDrawIndexedIndirectCommand or VkDrawIndirectCommand structures depending on if the draws are indexed
+         */
+        BufferBinding PushIndirectDrawCommands(bool indexed, span<const MultiDrawParams> draws);
+
       public:
         DirectPipelineState &directState;
 
@@ -84,6 +102,15 @@ namespace skyline::gpu::interconnect::maxwell3d {
 
         void Clear(engine::ClearSurface &clearSurface);
 
-        void Draw(engine::DrawTopology topology, bool transformFeedbackEnable, bool indexed, u32 count, u32 first, u32 instanceCount, u32 vertexOffset, u32 firstInstance);
+        /**
+         * @param indirectDraws If supplied, these draws are performed with a single indirect draw and count/first only describe the range of vertices or indices used by all of them
+         */
+        void Draw(engine::DrawTopology topology, bool transformFeedbackEnable, bool indexed, u32 count, u32 first, u32 instanceCount, u32 vertexOffset, u32 firstInstance, span<const MultiDrawParams> indirectDraws = {});
+
+        /**
+         * @brief Performs a set of draws which share all state besides their draw parameters using a single indirect draw with the commands built in the megabuffer
+         * @note If indirect multi-draws aren't supported by the host or quad conversion is required, this falls back to performing each draw individually
+         */
+        void MultiDraw(engine::DrawTopology topology, bool transformFeedbackEnable, bool indexed, span<const MultiDrawParams> draws);
     };
 }
@@ -181,37 +181,144 @@ namespace skyline::gpu::interconnect::maxwell3d {
         return info;
     }
 
-    static std::array<Pipeline::ShaderStage, engine::ShaderStageCount> MakePipelineShaders(InterconnectContext &ctx, Textures &textures, ConstantBufferSet &constantBuffers, const PackedPipelineState &packedState, const std::array<ShaderBinary, engine::PipelineCount> &shaderBinaries) {
+    /**
+     * @return A hash of all pipeline state that the shader frontend or MakeRuntimeInfo depend on, shaders are only reused from the shader cache if this matches
+     */
+    static u64 HashShaderRuntimeState(const PackedPipelineState &packedState) {
+        struct {
+            std::array<u32, 8> postVtgShaderAttributeSkipMask;
+            std::array<u8, engine::VertexAttributeCount> attributeTypes;
+            float pointSize;
+            float alphaRef;
+            u8 topology;
+            u8 domainType;
+            u8 spacing;
+            u8 outputPrimitives;
+            u8 alphaFunc;
+            u8 bindlessTextureConstantBufferSlotSelect;
+            bool openGlNdc;
+            bool transformFeedbackEnable;
+            bool alphaTestEnable;
+            bool apiMandatedEarlyZ;
+            bool flipYEnable;
+        } runtimeState{}; // Value-initialization zeroes any padding so it can be hashed directly
+
+        runtimeState.postVtgShaderAttributeSkipMask = packedState.postVtgShaderAttributeSkipMask;
+        for (size_t i{}; i < engine::VertexAttributeCount; i++) {
+            const auto &attribute{packedState.vertexAttributes[i]};
+            runtimeState.attributeTypes[i] = attribute.source == engine::VertexAttribute::Source::Inactive ? 0xFF : static_cast<u8>(attribute.numericalType);
+        }
+        runtimeState.pointSize = packedState.pointSize;
+        runtimeState.alphaRef = packedState.alphaRef;
+        runtimeState.topology = static_cast<u8>(packedState.topology);
+        runtimeState.domainType = static_cast<u8>(packedState.domainType);
+        runtimeState.spacing = static_cast<u8>(packedState.spacing);
+        runtimeState.outputPrimitives = static_cast<u8>(packedState.outputPrimitives);
+        runtimeState.alphaFunc = packedState.alphaFunc;
+        runtimeState.bindlessTextureConstantBufferSlotSelect = packedState.bindlessTextureConstantBufferSlotSelect;
+        runtimeState.openGlNdc = packedState.openGlNdc;
+        runtimeState.transformFeedbackEnable = packedState.transformFeedbackEnable;
+        runtimeState.alphaTestEnable = packedState.alphaTestEnable;
+        runtimeState.apiMandatedEarlyZ = packedState.apiMandatedEarlyZ;
+        runtimeState.flipYEnable = packedState.flipYEnable;
+
+        u64 hash{XXH64(&runtimeState, sizeof(runtimeState), 0)};
+        if (packedState.transformFeedbackEnable)
+            hash = XXH64(packedState.transformFeedbackVaryings.data(), sizeof(packedState.transformFeedbackVaryings), hash);
+        return hash;
+    }
+
+    /**
+     * @param cacheKeys The shader cache keys of all stages will be written into this
+     */
+    static std::array<Pipeline::ShaderStage, engine::ShaderStageCount> MakePipelineShaders(InterconnectContext &ctx, Textures &textures, ConstantBufferSet &constantBuffers, const PackedPipelineState &packedState, const std::array<ShaderBinary, engine::PipelineCount> &shaderBinaries, std::array<u64, engine::PipelineCount> &cacheKeys) {
         ctx.gpu.shader.ResetPools();
 
         using PipelineStage = engine::Pipeline::Shader::Type;
+        using ShaderCacheEntry = cache::ShaderCache::Entry;
         auto pipelineStage{[](size_t i) { return static_cast<PipelineStage>(i); }};
         auto stageIdx{[](PipelineStage stage) { return static_cast<u8>(stage); }};
 
         std::array<Shader::IR::Program, engine::PipelineCount> programs;
-        bool ignoreVertexCullBeforeFetch{};
+        bool ignoreVertexCullBeforeFetch{packedState.shaderHashes[stageIdx(PipelineStage::Vertex)] && packedState.shaderHashes[stageIdx(PipelineStage::VertexCullBeforeFetch)]};
+        size_t firstStage{stageIdx(ignoreVertexCullBeforeFetch ? PipelineStage::Vertex : PipelineStage::VertexCullBeforeFetch)};
+
+        std::array<std::shared_ptr<const ShaderCacheEntry>, engine::PipelineCount> cachedStages{}; //!< Entries from the shader cache for stages which don't need to be translated
+        std::array<std::shared_ptr<ShaderCacheEntry>, engine::PipelineCount> translatedStages{}; //!< New entries for stages which are translated, these are stored once they're compiled
+        u64 runtimeStateHash{HashShaderRuntimeState(packedState)};
+        u64 previousStageHash{}; //!< A hash of the key and specialization state of the previous stage, this is chained into the key of every stage as they depend on the previous stage
 
-        for (size_t i{}; i < engine::PipelineCount; i++) {
+        for (size_t i{firstStage}; i < engine::PipelineCount; i++) {
             if (!packedState.shaderHashes[i])
                 continue;
 
-            auto program{ctx.gpu.shader.ParseGraphicsShader(
-                packedState.postVtgShaderAttributeSkipMask,
-                ConvertCompilerShaderStage(static_cast<PipelineStage>(i)),
-                shaderBinaries[i].binary, shaderBinaries[i].baseOffset,
-                packedState.bindlessTextureConstantBufferSlotSelect,
-                [&](u32 index, u32 offset) {
-                    size_t shaderStage{i > 0 ? (i - 1) : 0};
-                    return constantBuffers[shaderStage][index].Read<int>(ctx.executor, offset);
-                }, [&](u32 index) {
-                    return textures.GetTextureType(ctx, BindlessHandle{ .raw = index }.textureIndex);
-                })};
-            if (i == stageIdx(PipelineStage::Vertex) && packedState.shaderHashes[stageIdx(PipelineStage::VertexCullBeforeFetch)]) {
-                ignoreVertexCullBeforeFetch = true;
-                programs[i] = ctx.gpu.shader.CombineVertexShaders(programs[stageIdx(PipelineStage::VertexCullBeforeFetch)], program, shaderBinaries[i].binary);
+            size_t shaderStage{i > 0 ? (i - 1) : 0};
+            auto readConstantBuffer{[&](u32 index, u32 offset) -> u32 {
+                return static_cast<u32>(constantBuffers[shaderStage][index].Read<int>(ctx.executor, offset));
+            }};
+            auto getTextureType{[&](u32 handle) {
+                return textures.GetTextureType(ctx, BindlessHandle{ .raw = handle }.textureIndex);
+            }};
+
+            bool combineVertexShaders{i == stageIdx(PipelineStage::Vertex) && ignoreVertexCullBeforeFetch};
+            std::array<u64, 6> keyData{
+                i,
+                packedState.shaderHashes[i],
+                combineVertexShaders ? packedState.shaderHashes[stageIdx(PipelineStage::VertexCullBeforeFetch)] : 0,
+                packedState.shaderHashes[stageIdx(PipelineStage::Geometry)], // Vertex shaders depend on whether the geometry shader is a passthrough shader
+                runtimeStateHash,
+                previousStageHash,
+            };
+            cacheKeys[i] = XXH64(keyData.data(), sizeof(keyData), 0);
+
+            // The shader is only reused if all the constant buffer words and texture types it was specialized on still match
+            auto entry{ctx.gpu.shaderCache.Lookup(cacheKeys[i])};
+            if (entry && ranges::all_of(entry->constantBufferWords, [&](const ShaderManager::ConstantBufferWord &word) { return readConstantBuffer(word.index, word.offset) == word.value; })
+                && ranges::all_of(entry->textureTypes, [&](const ShaderManager::CachedTextureType &type) { return getTextureType(type.handle) == type.type; })) {
+                ctx.gpu.shaderCache.hitCount++;
+
+                // Only the state that's required by MakeRuntimeInfo for the following stages is reconstructed
+                auto &program{programs[i]};
+                program.info = entry->info;
+                program.stage = entry->stage;
+                program.output_topology = entry->outputTopology;
+                program.is_geometry_passthrough = entry->isGeometryPassthrough;
+                cachedStages[i] = entry;
             } else {
-                programs[i] = program;
+                ctx.gpu.shaderCache.missCount++;
+
+                auto translated{std::make_shared<ShaderCacheEntry>()};
+                auto parseShader{[&](size_t stage) {
+                    return ctx.gpu.shader.ParseGraphicsShader(
+                        packedState.postVtgShaderAttributeSkipMask,
+                        ConvertCompilerShaderStage(pipelineStage(stage)),
+                        shaderBinaries[stage].binary, shaderBinaries[stage].baseOffset,
+                        packedState.bindlessTextureConstantBufferSlotSelect,
+                        [&](u32 index, u32 offset) {
+                            auto value{readConstantBuffer(index, offset)};
+                            translated->constantBufferWords.emplace_back(index, offset, value);
+                            return value;
+                        }, [&](u32 handle) {
+                            auto type{getTextureType(handle)};
+                            translated->textureTypes.emplace_back(handle, type);
+                            return type;
+                        });
+                }};
+
+                if (combineVertexShaders) {
+                    auto vertexA{parseShader(stageIdx(PipelineStage::VertexCullBeforeFetch))};
+                    auto vertexB{parseShader(i)};
+                    programs[i] = ctx.gpu.shader.CombineVertexShaders(vertexA, vertexB, shaderBinaries[i].binary);
+                } else {
+                    programs[i] = parseShader(i);
+                }
+
+                entry = translated;
+                translatedStages[i] = std::move(translated);
             }
+
+            previousStageHash = XXH64(entry->constantBufferWords.data(), entry->constantBufferWords.size() * sizeof(ShaderManager::ConstantBufferWord), cacheKeys[i]);
+            previousStageHash = XXH64(entry->textureTypes.data(), entry->textureTypes.size() * sizeof(ShaderManager::CachedTextureType), previousStageHash);
         }
 
         bool hasGeometry{packedState.shaderHashes[stageIdx(PipelineStage::Geometry)] && programs[stageIdx(PipelineStage::Geometry)].is_geometry_passthrough};
@@ -220,12 +327,29 @@ namespace skyline::gpu::interconnect::maxwell3d {
 
         std::array<Pipeline::ShaderStage, engine::ShaderStageCount> shaderStages{};
 
-        for (size_t i{stageIdx(ignoreVertexCullBeforeFetch ? PipelineStage::Vertex : PipelineStage::VertexCullBeforeFetch)}; i < engine::PipelineCount; i++) {
+        for (size_t i{firstStage}; i < engine::PipelineCount; i++) {
             if (!packedState.shaderHashes[i])
                 continue;
 
-            auto runtimeInfo{MakeRuntimeInfo(packedState, programs[i], lastProgram, hasGeometry)};
-            shaderStages[i - (i >= 1 ? 1 : 0)] = {ConvertVkShaderStage(pipelineStage(i)), ctx.gpu.shader.CompileShader(runtimeInfo, programs[i], bindings), programs[i].info};
+            vk::ShaderModule module;
+            if (const auto &cached{cachedStages[i]}) {
+                module = ctx.gpu.shaderCache.GetShaderModule(*cached);
+                bindings = cached->bindings;
+            } else {
+                auto runtimeInfo{MakeRuntimeInfo(packedState, programs[i], lastProgram, hasGeometry)};
+                auto &translated{*translatedStages[i]};
+                translated.spirv = ctx.gpu.shader.GenerateSpirv(runtimeInfo, programs[i], bindings);
+                module = ctx.gpu.shaderCache.GetShaderModule(translated);
+
+                translated.info = programs[i].info;
+                translated.stage = programs[i].stage;
+                translated.outputTopology = programs[i].output_topology;
+                translated.isGeometryPassthrough = programs[i].is_geometry_passthrough;
+                translated.bindings = bindings;
+                ctx.gpu.shaderCache.Store(cacheKeys[i], std::move(translatedStages[i]));
+            }
+
+            shaderStages[i - (i >= 1 ? 1 : 0)] = {ConvertVkShaderStage(pipelineStage(i)), module, programs[i].info};
 
             lastProgram = &programs[i];
         }
@@ -428,11 +552,12 @@ namespace skyline::gpu::interconnect::maxwell3d {
         }
     }
 
-    static cache::GraphicsPipelineCache::CompiledPipeline MakeCompiledPipeline(InterconnectContext &ctx,
+    static cache::GraphicsPipelineCache::CompiledPipeline MakeCompiledPipeline(GPU &gpu,
                                                                                const PackedPipelineState &packedState,
                                                                                const std::array<Pipeline::ShaderStage, engine::ShaderStageCount> &shaderStages,
                                                                                span<vk::DescriptorSetLayoutBinding> layoutBindings,
-                                                                               span<TextureView *> colorAttachments, TextureView *depthAttachment) {
+                                                                               span<const cache::GraphicsPipelineCache::AttachmentMetadata> colorAttachments,
+                                                                               std::optional<cache::GraphicsPipelineCache::AttachmentMetadata> depthAttachment) {
         boost::container::static_vector<vk::PipelineShaderStageCreateInfo, engine::ShaderStageCount> shaderStageInfos;
         for (const auto &stage : shaderStages)
             if (stage.module)
@@ -455,10 +580,10 @@ namespace skyline::gpu::interconnect::maxwell3d {
                                    });
 
             if (binding.GetInputRate() == vk::VertexInputRate::eInstance) {
-                if (!ctx.gpu.traits.supportsVertexAttributeDivisor)
+                if (!gpu.traits.supportsVertexAttributeDivisor)
                     [[unlikely]]
                         Logger::Warn("Vertex attribute divisor used on guest without host support");
-                else if (!ctx.gpu.traits.supportsVertexAttributeZeroDivisor && binding.divisor == 0)
+                else if (!gpu.traits.supportsVertexAttributeZeroDivisor && binding.divisor == 0)
                     [[unlikely]]
                         Logger::Warn("Vertex attribute zero divisor used on guest without host support");
                 else
@@ -514,7 +639,7 @@ namespace skyline::gpu::interconnect::maxwell3d {
         rasterizationCreateInfo.frontFace = packedState.frontFaceClockwise ? vk::FrontFace::eClockwise : vk::FrontFace::eCounterClockwise;
         rasterizationCreateInfo.depthBiasEnable = packedState.depthBiasEnable;
         rasterizationCreateInfo.depthClampEnable = packedState.depthClampEnable;
-        if (!ctx.gpu.traits.supportsDepthClamp)
+        if (!gpu.traits.supportsDepthClamp)
             Logger::Warn("Depth clamp used on guest without host support");
         rasterizationState.get<vk::PipelineRasterizationProvokingVertexStateCreateInfoEXT>().provokingVertexMode = ConvertProvokingVertex(packedState.provokingVertex);
 
@@ -565,13 +690,13 @@ namespace skyline::gpu::interconnect::maxwell3d {
         std::array<vk::Viewport, engine::ViewportCount> emptyViewports{};
 
         vk::PipelineViewportStateCreateInfo viewportState{
-            .viewportCount = static_cast<u32>(ctx.gpu.traits.supportsMultipleViewports ? engine::ViewportCount : 1),
+            .viewportCount = static_cast<u32>(gpu.traits.supportsMultipleViewports ? engine::ViewportCount : 1),
             .pViewports = emptyViewports.data(),
-            .scissorCount = static_cast<u32>(ctx.gpu.traits.supportsMultipleViewports ? engine::ViewportCount : 1),
+            .scissorCount = static_cast<u32>(gpu.traits.supportsMultipleViewports ? engine::ViewportCount : 1),
             .pScissors = emptyScissors.data(),
         };
 
-        return ctx.gpu.graphicsPipelineCache.GetCompiledPipeline(cache::GraphicsPipelineCache::PipelineState{
+        return gpu.graphicsPipelineCache.GetCompiledPipeline(cache::GraphicsPipelineCache::PipelineState{
             .shaderStages = shaderStageInfos,
             .vertexState = vertexInputState,
             .inputAssemblyState = inputAssemblyState,
@@ -587,12 +712,131 @@ namespace skyline::gpu::interconnect::maxwell3d {
         }, layoutBindings);
     }
 
+    /**
+     * @brief All state required to compile a pipeline without any guest state, these are recorded in the pipeline warm-up cache when a pipeline is first created
+     */
+    struct PipelineWarmupRecord {
+        PackedPipelineState packedState;
+        std::array<u64, engine::PipelineCount> shaderCacheKeys; //!< The shader cache keys of all stages, the pipeline can only be precompiled if all of them are in the shader cache
+        std::array<cache::GraphicsPipelineCache::AttachmentMetadata, engine::ColorTargetCount> colorAttachments;
+        u32 colorAttachmentCount;
+        bool hasDepthStencilAttachment;
+        cache::GraphicsPipelineCache::AttachmentMetadata depthStencilAttachment;
+    };
+    static_assert(std::is_trivially_copyable_v<PipelineWarmupRecord>);
+
+    constexpr u32 PipelineWarmupRecordVersion{1}; //!< The version of PipelineWarmupRecord, this must be incremented for any changes to the layout or meaning of it or any state in it
+    static_assert(sizeof(PackedPipelineState) == 0x5B8, "PipelineWarmupRecordVersion must be incremented for any changes to PackedPipelineState");
+    static_assert(sizeof(PipelineWarmupRecord) == 0x638, "PipelineWarmupRecordVersion must be incremented for any changes to PipelineWarmupRecord");
+
+    u64 PipelineManager::GetWarmupRecordLayout() {
+        // The sizes are hashed alongside the version so records are still discarded if a layout change didn't increment the version
+        constexpr std::array<u64, 5> Layout{
+            PipelineWarmupRecordVersion,
+            sizeof(PackedPipelineState),
+            sizeof(PipelineWarmupRecord),
+            offsetof(PipelineWarmupRecord, colorAttachments),
+            offsetof(PipelineWarmupRecord, depthStencilAttachment),
+        };
+        return XXH64(Layout.data(), sizeof(Layout), 0);
+    }
+
+    /**
+     * @brief Compiles the Vulkan pipeline for a warm-up record, this results in the same shader modules and Vulkan pipeline as creating a Pipeline with the same state so it'll hit in all caches
+     * @return If the pipeline could be compiled, this'll fail if any of the shaders aren't in the shader cache
+     */
+    static bool PrecompilePipeline(GPU &gpu, const PipelineWarmupRecord &record) {
+        using PipelineStage = engine::Pipeline::Shader::Type;
+        auto pipelineStage{[](size_t i) { return static_cast<PipelineStage>(i); }};
+        auto stageIdx{[](PipelineStage stage) { return static_cast<u8>(stage); }};
+
+        const auto &packedState{record.packedState};
+        if (record.colorAttachmentCount > engine::ColorTargetCount)
+            return false;
+
+        bool ignoreVertexCullBeforeFetch{packedState.shaderHashes[stageIdx(PipelineStage::Vertex)] && packedState.shaderHashes[stageIdx(PipelineStage::VertexCullBeforeFetch)]};
+        std::array<Pipeline::ShaderStage, engine::ShaderStageCount> shaderStages{};
+        for (size_t i{stageIdx(ignoreVertexCullBeforeFetch ? PipelineStage::Vertex : PipelineStage::VertexCullBeforeFetch)}; i < engine::PipelineCount; i++) {
+            if (!packedState.shaderHashes[i])
+                continue;
+
+            auto entry{gpu.shaderCache.Lookup(record.shaderCacheKeys[i])};
+            if (!entry)
+                return false;
+
+            shaderStages[i - (i >= 1 ? 1 : 0)] = {ConvertVkShaderStage(pipelineStage(i)), gpu.shaderCache.GetShaderModule(*entry), entry->info};
+        }
+
+        auto descriptorInfo{MakePipelineDescriptorInfo(shaderStages, gpu.traits.quirks.needsIndividualTextureBindingWrites)};
+        MakeCompiledPipeline(gpu, packedState, shaderStages, descriptorInfo.descriptorSetLayoutBindings,
+                             span{record.colorAttachments}.first(record.colorAttachmentCount),
+                             record.hasDepthStencilAttachment ? std::optional{record.depthStencilAttachment} : std::nullopt);
+        return true;
+    }
+
     Pipeline::Pipeline(InterconnectContext &ctx, Textures &textures, ConstantBufferSet &constantBuffers, const PackedPipelineState &packedState, const std::array<ShaderBinary, engine::PipelineCount> &shaderBinaries, span<TextureView *> colorAttachments, TextureView *depthAttachment)
-        : shaderStages{MakePipelineShaders(ctx, textures, constantBuffers, packedState, shaderBinaries)},
+        : shaderStages{MakePipelineShaders(ctx, textures, constantBuffers, packedState, shaderBinaries, shaderCacheKeys)},
           descriptorInfo{MakePipelineDescriptorInfo(shaderStages, ctx.gpu.traits.quirks.needsIndividualTextureBindingWrites)},
-          compiledPipeline{MakeCompiledPipeline(ctx, packedState, shaderStages, descriptorInfo.descriptorSetLayoutBindings, colorAttachments, depthAttachment)},
+          compiledPipeline{ctx.gpu.graphicsPipelineCache.GetPipelineLayout(descriptorInfo.descriptorSetLayoutBindings)},
           sourcePackedState{packedState} {
         storageBufferViews.resize(descriptorInfo.totalStorageBufferCount);
+
+        // The attachments are copied as the views may be destroyed prior to an asynchronous compilation running, only their metadata is required for it
+        boost::container::static_vector<cache::GraphicsPipelineCache::AttachmentMetadata, engine::ColorTargetCount> colorAttachmentMetadata(colorAttachments.begin(), colorAttachments.end());
+        std::optional<cache::GraphicsPipelineCache::AttachmentMetadata> depthAttachmentMetadata;
+        if (depthAttachment)
+            depthAttachmentMetadata.emplace(depthAttachment);
+
+        auto compile{[this, &gpu = ctx.gpu, colorAttachmentMetadata, depthAttachmentMetadata] {
+            compiledPipeline.pipeline = MakeCompiledPipeline(gpu, sourcePackedState, shaderStages, descriptorInfo.descriptorSetLayoutBindings, colorAttachmentMetadata, depthAttachmentMetadata).pipeline;
+        }};
+
+        if (ctx.gpu.pipelineCompiler.mode == PipelineCompilationMode::Synchronous)
+            compile();
+        else
+            compileJob = ctx.gpu.pipelineCompiler.Submit(std::move(compile));
+
+        PipelineWarmupRecord record{}; // Value-initialization zeroes any padding so identical records are deduplicated
+        record.packedState = packedState;
+        record.shaderCacheKeys = shaderCacheKeys;
+        record.colorAttachmentCount = static_cast<u32>(colorAttachments.size());
+        std::copy(colorAttachments.begin(), colorAttachments.end(), record.colorAttachments.begin());
+        record.hasDepthStencilAttachment = depthAttachment != nullptr;
+        if (depthAttachment)
+            record.depthStencilAttachment = depthAttachment;
+        ctx.gpu.pipelineWarmupCache.Insert(span<PipelineWarmupRecord>{record}.cast<u8>());
+    }
+
+    Pipeline::~Pipeline() {
+        if (compileJob)
+            compileJob->Cancel();
+    }
+
+    bool Pipeline::IsCompiled() const {
+        if (!compileJob)
+            return true;
+
+        if (!compileJob->IsDone())
+            return false;
+
+        compileJob->Wait(); // This won't block as the job is done but it'll rethrow any exception thrown during compilation
+        return true;
+    }
+
+    void Pipeline::WaitForCompilation() const {
+        if (compileJob)
+            compileJob->Wait();
+    }
+
+    void PipelineManager::PrecompilePipelines(GPU &gpu, const std::function<void(size_t, size_t)> &progress) {
+        gpu.pipelineWarmupCache.Precompile([&gpu](span<const u8> data) {
+            if (data.size() != sizeof(PipelineWarmupRecord))
+                return false;
+
+            PipelineWarmupRecord record;
+            std::memcpy(&record, data.data(), sizeof(PipelineWarmupRecord));
+            return PrecompilePipeline(gpu, record);
+        }, progress);
     }
 
     void Pipeline::SyncCachedStorageBufferViews(u32 executionNumber) {
@@ -6,6 +6,7 @@
 #include <tsl/robin_map.h>
 #include <shader_compiler/frontend/ir/program.h>
 #include <gpu/cache/graphics_pipeline_cache.h>
+#include <gpu/pipeline_compiler.h>
 #include "common.h"
 #include "packed_pipeline_state.h"
 #include "constant_buffers.h"
@@ -89,8 +90,10 @@ namespace skyline::gpu::interconnect::maxwell3d {
       private:
         std::vector<CachedMappedBufferView> storageBufferViews;
         u32 lastExecutionNumber{}; //!< The last execution number this pipeline was used at
+        std::array<u64, engine::PipelineCount> shaderCacheKeys{}; //!< The shader cache keys of all stages, these are recorded for pipeline warm-up
         std::array<ShaderStage, engine::ShaderStageCount> shaderStages;
         DescriptorInfo descriptorInfo;
+        std::shared_ptr<PipelineCompiler::Job> compileJob; //!< The job compiling the Vulkan pipeline when compiling asynchronously, this is retained after completion as pending pipeline binds may still reference the pipeline
 
         std::array<Pipeline *, 4> transitionCache{};
         size_t transitionCacheNextIdx{};
@@ -100,13 +103,28 @@ namespace skyline::gpu::interconnect::maxwell3d {
         void SyncCachedStorageBufferViews(u32 executionNumber);
 
       public:
-        cache::GraphicsPipelineCache::CompiledPipeline compiledPipeline;
+        cache::GraphicsPipelineCache::CompiledPipeline compiledPipeline; //!< The layouts are always valid but the pipeline handle is only valid after compilation has completed
         size_t sampledImageCount{};
 
         PackedPipelineState sourcePackedState;
 
         Pipeline(InterconnectContext &ctx, Textures &textures, ConstantBufferSet &constantBuffers, const PackedPipelineState &packedState, const std::array<ShaderBinary, engine::PipelineCount> &shaderBinaries, span<TextureView *> colorAttachments, TextureView *depthAttachment);
 
+        /**
+         * @note Any pending compilation is cancelled and any running compilation is waited on as it writes into the pipeline
+         */
+        ~Pipeline();
+
+        /**
+         * @return If the Vulkan pipeline has been compiled, this is always true when compiling synchronously
+         */
+        bool IsCompiled() const;
+
+        /**
+         * @brief Blocks until the Vulkan pipeline has been compiled, if no worker has started on it yet then it's compiled on the calling thread
+         */
+        void WaitForCompilation() const;
+
         Pipeline *LookupNext(const PackedPipelineState &packedState);
 
         void AddTransition(Pipeline *next);
@@ -140,5 +158,17 @@ namespace skyline::gpu::interconnect::maxwell3d {
 
             return map.emplace(packedState, std::make_unique<Pipeline>(ctx, textures, constantBuffers, packedState, shaderBinaries, colorAttachments, depthAttachment)).first->second.get();
         }
+
+        /**
+         * @brief Compiles all pipelines recorded in the pipeline warm-up cache on a set of worker threads, this blocks until all of them are compiled
+         * @param progress A function called on the calling thread with the amount of compiled pipelines and the total amount of pipelines whenever progress is made
+         * @note The shader and pipeline warm-up caches must be opened prior to calling this
+         */
+        static void PrecompilePipelines(GPU &gpu, const std::function<void(size_t, size_t)> &progress);
+
+        /**
+         * @return A hash of the layout of the records in the pipeline warm-up cache, the cache must be opened with it so records with a different layout are discarded
+         */
+        static u64 GetWarmupRecordLayout();
     };
 }
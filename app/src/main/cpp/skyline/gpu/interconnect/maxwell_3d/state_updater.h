@@ -5,6 +5,7 @@
 
 #include <gpu/interconnect/command_executor.h>
 #include "common.h"
+#include "pipeline_manager.h"
 
 namespace skyline::gpu::interconnect::maxwell3d {
     /**
@@ -246,6 +247,19 @@ namespace skyline::gpu::interconnect::maxwell3d {
     };
     using SetPipelineCmd = CmdHolder<SetPipelineCmdImpl>;
 
+    /**
+     * @brief Binds a pipeline that's being compiled asynchronously, recording blocks until compilation has completed
+     */
+    struct SetPendingPipelineCmdImpl {
+        void Record(GPU &gpu, vk::raii::CommandBuffer &commandBuffer) {
+            pipeline->WaitForCompilation();
+            commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline->compiledPipeline.pipeline);
+        }
+
+        const Pipeline *pipeline;
+    };
+    using SetPendingPipelineCmd = CmdHolder<SetPendingPipelineCmdImpl>;
+
     /**
      * @brief Single-use helper for recording a batch of state updates into a command buffer
      */
@@ -450,6 +464,13 @@ namespace skyline::gpu::interconnect::maxwell3d {
                 });
         }
 
+        void SetPendingPipeline(const Pipeline *pipeline) {
+            AppendCmd<SetPendingPipelineCmd>(
+                {
+                    .pipeline = pipeline,
+                });
+        }
+
         void SetDescriptorSetWithPush(DescriptorUpdateInfo *updateInfo) {
             AppendCmd<SetDescriptorSetWithPushCmd>(
                 {
@@ -16,6 +16,8 @@ namespace skyline::gpu::interconnect {
           executor{channelCtx.executor} {}
 
     void MaxwellDma::Copy(IOVA dst, IOVA src, size_t size) {
+        channelCtx.Lock();
+
         auto srcMappings{channelCtx.asCtx->gmmu.TranslateRange(src, size)};
         auto dstMappings{channelCtx.asCtx->gmmu.TranslateRange(dst, size)};
 
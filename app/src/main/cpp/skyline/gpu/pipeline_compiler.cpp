@@ -0,0 +1,111 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <common/settings.h>
+#include <common/trace.h>
+#include "pipeline_compiler.h"
+
+namespace skyline::gpu {
+    PipelineCompiler::Job::Job(std::function<void()> &&function) : function{std::move(function)}, submitTime{util::GetTimeNs()} {}
+
+    void PipelineCompiler::Job::Execute() {
+        TRACE_EVENT("gpu", "PipelineCompiler::Job::Execute");
+
+        try {
+            function();
+        } catch (...) {
+            exception = std::current_exception();
+        }
+        function = nullptr;
+
+        TRACE_COUNTER("gpu", "PipelineCompileLatencyMs", static_cast<double>(util::GetTimeNs() - submitTime) / constant::NsInMillisecond);
+
+        state.store(State::Done, std::memory_order_release);
+        state.notify_all();
+    }
+
+    void PipelineCompiler::Job::Wait() {
+        State expected{State::Pending};
+        if (state.compare_exchange_strong(expected, State::Running, std::memory_order_acquire)) {
+            // The job is compiled on this thread rather than waiting for a worker to get to it, the worker will skip it when it's dequeued
+            Execute();
+        } else {
+            while (expected != State::Done) {
+                state.wait(expected, std::memory_order_acquire);
+                expected = state.load(std::memory_order_acquire);
+            }
+        }
+
+        if (exception)
+            std::rethrow_exception(exception);
+    }
+
+    void PipelineCompiler::Job::Cancel() {
+        State expected{State::Pending};
+        if (state.compare_exchange_strong(expected, State::Running, std::memory_order_acquire)) {
+            // The function is released without running it, a worker dequeuing the job will skip it as it's no longer pending
+            function = nullptr;
+            state.store(State::Done, std::memory_order_release);
+            state.notify_all();
+        } else {
+            while (expected != State::Done) {
+                state.wait(expected, std::memory_order_acquire);
+                expected = state.load(std::memory_order_acquire);
+            }
+        }
+    }
+
+    PipelineCompiler::PipelineCompiler(const DeviceState &state) : mode{*state.settings->pipelineCompilation} {}
+
+    PipelineCompiler::~PipelineCompiler() {
+        {
+            std::scoped_lock lock{mutex};
+            exit = true;
+        }
+        condition.notify_all();
+
+        for (auto &thread : threads)
+            thread.join();
+    }
+
+    void PipelineCompiler::Run() {
+        if (int result{pthread_setname_np(pthread_self(), "Sky-PipeCompile")})
+            Logger::Warn("Failed to set the thread name: {}", strerror(result));
+
+        while (true) {
+            std::shared_ptr<Job> job;
+            {
+                std::unique_lock lock{mutex};
+                condition.wait(lock, [this] { return exit || !queue.empty(); });
+                if (exit)
+                    return;
+
+                job = std::move(queue.front());
+                queue.pop_front();
+                TRACE_COUNTER("gpu", "PipelineCompileQueueDepth", queue.size());
+            }
+
+            auto expected{Job::State::Pending};
+            if (job->state.compare_exchange_strong(expected, Job::State::Running, std::memory_order_acquire))
+                job->Execute();
+        }
+    }
+
+    std::shared_ptr<PipelineCompiler::Job> PipelineCompiler::Submit(std::function<void()> &&function) {
+        auto job{std::make_shared<Job>(std::move(function))};
+        {
+            std::scoped_lock lock{mutex};
+            if (threads.empty()) {
+                // Half of the cores are left for the guest and the other emulator threads, the pool is also bounded to a few threads so compilation bursts don't starve the GPFIFO thread
+                size_t threadCount{std::clamp<size_t>(std::thread::hardware_concurrency() / 2, 1, 4)};
+                for (size_t i{}; i < threadCount; i++)
+                    threads.emplace_back(&PipelineCompiler::Run, this);
+            }
+
+            queue.push_back(job);
+            TRACE_COUNTER("gpu", "PipelineCompileQueueDepth", queue.size());
+        }
+        condition.notify_one();
+        return job;
+    }
+}
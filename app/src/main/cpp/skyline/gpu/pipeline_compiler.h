@@ -0,0 +1,94 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <deque>
+#include <thread>
+#include <common.h>
+
+namespace skyline::gpu {
+    /**
+     * @brief The policies for how draws using a pipeline that hasn't been compiled yet are handled
+     */
+    enum class PipelineCompilationMode : u32 {
+        Synchronous = 0, //!< Pipelines are compiled on the GPFIFO thread when they're first used
+        AsyncDefer = 1, //!< Pipelines are compiled on worker threads, draws are recorded immediately and command buffer recording only waits on compilation if it hasn't completed by then
+        AsyncSkip = 2, //!< Pipelines are compiled on worker threads and all draws using them are skipped until compilation completes, this trades rendering artifacts for avoiding stutter
+    };
+
+    /**
+     * @brief A bounded pool of worker threads that compile host pipelines in the order they were first used
+     * @note Only the host pipeline compilation is done on the workers, shader translation still occurs on the submitting thread as the shader frontend isn't thread-safe
+     */
+    class PipelineCompiler {
+      public:
+        /**
+         * @brief A single compilation job, this can be waited on by any thread and is compiled on the waiting thread if no worker has started on it yet
+         */
+        class Job {
+          private:
+            friend PipelineCompiler;
+
+            enum class State : u32 {
+                Pending,
+                Running,
+                Done,
+            };
+
+            std::function<void()> function; //!< The function that compiles the pipeline, this is released after it has run
+            std::atomic<State> state{State::Pending};
+            i64 submitTime; //!< The time at which the job was submitted in nanoseconds, this is used to determine the compile latency
+            std::exception_ptr exception; //!< Any exception thrown by the function, this is rethrown to anyone waiting on the job
+
+            /**
+             * @brief Runs the function and marks the job as done, the state must have been transitioned to running by the caller
+             */
+            void Execute();
+
+          public:
+            Job(std::function<void()> &&function);
+
+            /**
+             * @return If the job has been completed, successfully or not
+             */
+            bool IsDone() const {
+                return state.load(std::memory_order_acquire) == State::Done;
+            }
+
+            /**
+             * @brief Blocks till the job has completed, the job is run on the calling thread if it hasn't been started yet
+             * @note Any exception thrown during compilation will be rethrown by this
+             */
+            void Wait();
+
+            /**
+             * @brief Cancels the job if no thread has started on it yet, otherwise blocks till it has completed
+             * @note This must be used prior to destroying anything the function references, any exception thrown during compilation is discarded
+             */
+            void Cancel();
+        };
+
+        const PipelineCompilationMode mode; //!< The compilation mode selected by the user, this is fixed for the lifetime of the compiler
+
+      private:
+        std::mutex mutex; //!< Synchronizes accesses to the queue and the thread state
+        std::condition_variable condition; //!< Signalled when a job is submitted or the workers should exit
+        std::deque<std::shared_ptr<Job>> queue; //!< A FIFO of submitted jobs, these are ordered by first use as that's when pipelines are submitted
+        std::vector<std::thread> threads; //!< The worker threads, these are only started on the first submission so synchronous compilation doesn't spawn any
+        bool exit{}; //!< If the workers should exit
+
+        void Run();
+
+      public:
+        PipelineCompiler(const DeviceState &state);
+
+        ~PipelineCompiler();
+
+        /**
+         * @brief Queues a function that compiles a pipeline to be run on a worker thread
+         * @note The function must be thread-safe with respect to anything it references, it may be run on the thread that waits on the job
+         */
+        std::shared_ptr<Job> Submit(std::function<void()> &&function);
+    };
+}
@@ -202,17 +202,19 @@ namespace skyline::gpu {
         return Shader::Maxwell::MergeDualVertexPrograms(vertexA, vertexB, env);
     }
 
-    vk::ShaderModule ShaderManager::CompileShader(Shader::RuntimeInfo &runtimeInfo, Shader::IR::Program &program, Shader::Backend::Bindings &bindings) {
+    std::vector<u32> ShaderManager::GenerateSpirv(Shader::RuntimeInfo &runtimeInfo, Shader::IR::Program &program, Shader::Backend::Bindings &bindings) {
         std::scoped_lock lock{poolMutex};
 
         if (program.info.loads.Legacy() || program.info.stores.Legacy())
             Shader::Maxwell::ConvertLegacyToGeneric(program, runtimeInfo);
 
-        auto spirv{Shader::Backend::SPIRV::EmitSPIRV(profile, runtimeInfo, program, bindings)};
+        return Shader::Backend::SPIRV::EmitSPIRV(profile, runtimeInfo, program, bindings);
+    }
 
+    vk::ShaderModule ShaderManager::CreateShaderModule(span<const u32> spirv) {
         vk::ShaderModuleCreateInfo createInfo{
             .pCode = spirv.data(),
-            .codeSize = spirv.size() * sizeof(u32),
+            .codeSize = spirv.size_bytes(),
         };
 
         return (*gpu.vkDevice).createShaderModule(createInfo, nullptr, *gpu.vkDevice.getDispatcher());
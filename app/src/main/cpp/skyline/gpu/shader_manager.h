@@ -40,6 +40,8 @@ namespace skyline::gpu {
             u32 offset; //!< The offset of the constant buffer word
             u32 value; //!< The contents of the word
 
+            ConstantBufferWord() = default;
+
             constexpr ConstantBufferWord(u32 index, u32 offset, u32 value);
 
             constexpr bool operator==(const ConstantBufferWord &other) const = default;
@@ -51,6 +53,8 @@ namespace skyline::gpu {
             u32 handle;
             Shader::TextureType type;
 
+            CachedTextureType() = default;
+
             constexpr CachedTextureType(u32 handle, Shader::TextureType type);
 
             constexpr bool operator==(const CachedTextureType &other) const = default;
@@ -69,7 +73,12 @@ namespace skyline::gpu {
          */
         Shader::IR::Program CombineVertexShaders(Shader::IR::Program &vertexA, Shader::IR::Program &vertexB, span<u8> vertexBBinary);
 
-        vk::ShaderModule CompileShader(Shader::RuntimeInfo &runtimeInfo, Shader::IR::Program &program, Shader::Backend::Bindings &bindings);
+        /**
+         * @return The SPIR-V for the supplied program, the bindings are advanced past all the bindings used by the program
+         */
+        std::vector<u32> GenerateSpirv(Shader::RuntimeInfo &runtimeInfo, Shader::IR::Program &program, Shader::Backend::Bindings &bindings);
+
+        vk::ShaderModule CreateShaderModule(span<const u32> spirv);
 
         void ResetPools();
     };
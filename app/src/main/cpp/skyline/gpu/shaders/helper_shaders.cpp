@@ -136,6 +136,8 @@ namespace skyline::gpu {
             .scissorCount = 1
         };
 
+        std::array<cache::GraphicsPipelineCache::AttachmentMetadata, 1> colorAttachmentMetadata{colorAttachment};
+
         return gpu.graphicsPipelineCache.GetCompiledPipeline(cache::GraphicsPipelineCache::PipelineState{
             .shaderStages = shaderStages,
             .vertexState = vertexState,
@@ -147,8 +149,8 @@ namespace skyline::gpu {
             .depthStencilState = depthStencilState,
             .colorBlendState = blendState,
             .dynamicState = {},
-            .colorAttachments = span<TextureView *>{colorAttachment},
-            .depthStencilAttachment = depthStencilAttachment,
+            .colorAttachments = span<const cache::GraphicsPipelineCache::AttachmentMetadata>{colorAttachmentMetadata},
+            .depthStencilAttachment = depthStencilAttachment ? std::optional<cache::GraphicsPipelineCache::AttachmentMetadata>{depthStencilAttachment} : std::nullopt,
         }, layoutBindings, pushConstantRanges, true);
     }
 
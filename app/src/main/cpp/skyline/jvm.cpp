@@ -63,6 +63,7 @@ namespace skyline {
           waitForSubmitOrCancelId{environ->GetMethodID(instanceClass, "waitForSubmitOrCancel", "(Lemu/skyline/applet/swkbd/SoftwareKeyboardDialog;)[Ljava/lang/Object;")},
           closeKeyboardId{environ->GetMethodID(instanceClass, "closeKeyboard", "(Lemu/skyline/applet/swkbd/SoftwareKeyboardDialog;)V")},
           showValidationResultId{environ->GetMethodID(instanceClass, "showValidationResult", "(Lemu/skyline/applet/swkbd/SoftwareKeyboardDialog;ILjava/lang/String;)I")},
+          updatePipelineWarmupProgressId{environ->GetMethodID(instanceClass, "updatePipelineWarmupProgress", "(II)V")},
           getVersionCodeId{environ->GetMethodID(instanceClass, "getVersionCode", "()I")},
           getIntegerValueId{environ->GetMethodID(environ->FindClass("java/lang/Integer"), "intValue", "()I")} {
         env.Initialize(environ);
@@ -137,6 +138,10 @@ namespace skyline {
         env->DeleteGlobalRef(dialog);
     }
 
+    void JvmManager::UpdatePipelineWarmupProgress(jint compiled, jint total) {
+        env->CallVoidMethod(instance, updatePipelineWarmupProgressId, compiled, total);
+    }
+
     i32 JvmManager::GetVersionCode() {
         return env->CallIntMethod(instance, getVersionCodeId);
     }
@@ -176,6 +176,11 @@ namespace skyline {
          */
         KeyboardCloseResult ShowValidationResult(KeyboardHandle dialog, KeyboardTextCheckResult checkResult, std::u16string message);
 
+        /**
+         * @brief A call to EmulationActivity.updatePipelineWarmupProgress in Kotlin
+         */
+        void UpdatePipelineWarmupProgress(jint compiled, jint total);
+
         /**
          * @brief A call to EmulationActivity.getVersionCode in Kotlin
          * @return A version code in Vulkan's format with 14-bit patch + 10-bit major and minor components
@@ -190,6 +195,7 @@ namespace skyline {
         jmethodID waitForSubmitOrCancelId;
         jmethodID closeKeyboardId;
         jmethodID showValidationResultId;
+        jmethodID updatePipelineWarmupProgressId;
         jmethodID getVersionCodeId;
 
         jmethodID getIntegerValueId;
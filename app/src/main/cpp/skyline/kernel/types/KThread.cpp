@@ -32,6 +32,8 @@ namespace skyline::kernel::type {
             thread.join();
         if (preemptionTimer)
             timer_delete(preemptionTimer);
+        if (profilerTimer)
+            timer_delete(profilerTimer);
     }
 
     void KThread::StartThread() {
@@ -83,6 +85,9 @@ namespace skyline::kernel::type {
         signal::SetSignalHandler({SIGINT, SIGILL, SIGTRAP, SIGBUS, SIGFPE, SIGSEGV}, nce::NCE::SignalHandler);
         signal::SetSignalHandler({Scheduler::YieldSignal, Scheduler::PreemptionSignal}, Scheduler::SignalHandler, false); // We want futexes to fail and their predicates rechecked
 
+        if (state.nce->profiler)
+            profilerTimer = state.nce->profiler->CreateThreadTimer(id);
+
         {
             std::scoped_lock lock{statusMutex};
             ready = true;
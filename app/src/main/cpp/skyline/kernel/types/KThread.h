@@ -22,6 +22,7 @@ namespace skyline {
             std::thread thread; //!< If this KThread is backed by a host thread then this'll hold it
             pthread_t pthread{}; //!< The pthread_t for the host thread running this guest thread
             timer_t preemptionTimer{}; //!< A kernel timer used for preemption interrupts
+            timer_t profilerTimer{}; //!< A kernel timer used for sampling the thread by the guest profiler, this is only created when profiling
 
             /**
              * @brief Entry function any guest threads, sets up necessary context and jumps into guest code from the calling thread
@@ -27,8 +27,6 @@ namespace skyline::loader {
         if (!util::IsPageAligned(executable.text.offset) || !util::IsPageAligned(executable.ro.offset) || !util::IsPageAligned(executable.data.offset))
             throw exception("Section offsets are not aligned with page size: 0x{:X}, 0x{:X}, 0x{:X}", executable.text.offset, executable.ro.offset, executable.data.offset);
 
-        auto patch{state.nce->GetPatchData(executable.text.contents)};
-
         span dynsym{reinterpret_cast<Elf64_Sym *>(executable.ro.contents.data() + executable.dynsym.offset), executable.dynsym.size / sizeof(Elf64_Sym)};
         span dynstr{reinterpret_cast<char *>(executable.ro.contents.data() + executable.dynstr.offset), executable.dynstr.size};
         std::vector<nce::NCE::HookedSymbolEntry> executableSymbols;
@@ -70,6 +68,13 @@ namespace skyline::loader {
             hookSize = util::AlignUp(state.nce->GetHookSectionSize(executableSymbols), PAGE_SIZE);
         }
 
+        // The patches only depend on the contents of .text and the placement of it relative to .patch, a cached copy of them allows skipping scanning and emission entirely
+        auto patchStartTime{util::GetTimeNs()};
+        auto patchKey{nce::PatchCache::GetKey(executable.text.contents, hookSize)};
+        auto cachedPatch{state.nce->patchCache.Lookup(patchKey, hookSize)};
+        nce::NCE::PatchData patch{cachedPatch ? nce::NCE::PatchData{cachedPatch->patchSize} : state.nce->GetPatchData(executable.text.contents)};
+        auto patchTime{util::GetTimeNs() - patchStartTime}; // We exclude the time spent mapping sections from any measurements
+
         process->NewHandle<kernel::type::KPrivateMemory>(span<u8>{base, patch.size + hookSize}, memory::Permission{false, false, false}, memory::states::Reserved); // ---
         Logger::Error("Successfully mapped section .patch @ 0x{:X}, Size = 0x{:X}", base, patch.size);
         if (hookSize > 0)
@@ -88,7 +93,7 @@ namespace skyline::loader {
         size_t size{patch.size + hookSize + textSize + roSize + dataSize};
         {
             // Note: We need to copy out the symbols here as it'll be overwritten by any hooks
-            ExecutableSymbolicInfo symbolicInfo{
+            auto symbolicInfo{std::make_unique<ExecutableSymbolicInfo>(ExecutableSymbolicInfo{
                 .patchStart = base,
                 .hookStart = base + patch.size,
                 .programStart = executableBase,
@@ -98,11 +103,44 @@ namespace skyline::loader {
                 .hookName = name + ".hook",
                 .symbols = {dynsym.begin(), dynsym.end()},
                 .symbolStrings = {dynstr.begin(), dynstr.end()},
+            })};
+            symbolicInfo->BuildSymbolIndex();
+
+            std::unique_lock lock{executablesMutex};
+            executables.insert(std::upper_bound(executables.begin(), executables.end(), base, [](void *ptr, const std::unique_ptr<ExecutableSymbolicInfo> &it) { return ptr < it->patchStart; }), std::move(symbolicInfo));
+        }
+
+        patchStartTime = util::GetTimeNs();
+        if (cachedPatch) {
+            auto text{span(executable.text.contents).cast<u32>()};
+            for (size_t index{}; index < cachedPatch->offsets.size(); index++)
+                text[cachedPatch->offsets[index]] = cachedPatch->instructions[index];
+
+            std::memcpy(base, cachedPatch->patch.data(), cachedPatch->patchSize);
+            state.nce->WritePatchPrologue(reinterpret_cast<u32 *>(base));
+
+            auto loadTime{patchTime + (util::GetTimeNs() - patchStartTime)};
+            state.nce->patchCache.RecordHit(*cachedPatch, loadTime);
+            Logger::Info("Loaded cached patches for {}: {} instructions in {}us (generation took {}us)", name, cachedPatch->offsets.size(), loadTime / constant::NsInMicrosecond, cachedPatch->generationTime / constant::NsInMicrosecond);
+        } else {
+            state.nce->PatchCode(executable.text.contents, reinterpret_cast<u32 *>(base), patch.size, patch.offsets, hookSize);
+
+            auto text{span(executable.text.contents).cast<u32>()};
+            nce::PatchCache::Entry entry{
+                .patchSize = patch.size,
+                .offsets = {patch.offsets.begin(), patch.offsets.end()},
+                .patch = {reinterpret_cast<u32 *>(base), reinterpret_cast<u32 *>(base + patch.size)},
             };
-            executables.insert(std::upper_bound(executables.begin(), executables.end(), base, [](void *ptr, const ExecutableSymbolicInfo &it) { return ptr < it.patchStart; }), std::move(symbolicInfo));
+            entry.instructions.reserve(entry.offsets.size());
+            for (auto offset : entry.offsets)
+                entry.instructions.push_back(text[offset]);
+            entry.generationTime = patchTime + (util::GetTimeNs() - patchStartTime);
+
+            state.nce->patchCache.Store(patchKey, hookSize, entry);
+            Logger::Info("Generated patches for {}: {} instructions in {}us", name, entry.offsets.size(), entry.generationTime / constant::NsInMicrosecond);
         }
+        state.nce->patchCache.LogStatistics();
 
-        state.nce->PatchCode(executable.text.contents, reinterpret_cast<u32 *>(base), patch.size, patch.offsets, hookSize);
         if (hookSize)
             state.nce->WriteHookSection(executableSymbols, span<u8>{base + patch.size, hookSize}.cast<u32>());
 
@@ -114,21 +152,75 @@ namespace skyline::loader {
         return {base, size, executableBase + executable.text.offset};
     }
 
-    Loader::SymbolInfo Loader::ResolveSymbol(void *ptr) {
-        auto executable{std::lower_bound(executables.begin(), executables.end(), ptr, [](const ExecutableSymbolicInfo &it, void *ptr) { return it.programEnd < ptr; })};
-        if (executable != executables.end() && ptr >= executable->patchStart && ptr <= executable->programEnd) {
+    void Loader::ExecutableSymbolicInfo::BuildSymbolIndex() {
+        symbolRanges.clear();
+        symbolRanges.reserve(symbols.size());
+        for (const auto &symbol : symbols)
+            if (symbol.st_name && symbol.st_name < symbolStrings.size() && symbol.st_size)
+                symbolRanges.push_back({symbol.st_value, symbol.st_value + symbol.st_size, symbol.st_name, SymbolRange::NoParent});
+
+        // Symbols at the same address are sorted by descending size so the outermost one is retained
+        std::sort(symbolRanges.begin(), symbolRanges.end(), [](const SymbolRange &a, const SymbolRange &b) {
+            return a.start < b.start || (a.start == b.start && a.end > b.end);
+        });
+        symbolRanges.erase(std::unique(symbolRanges.begin(), symbolRanges.end(), [](const SymbolRange &a, const SymbolRange &b) {
+            return a.start == b.start;
+        }), symbolRanges.end());
+
+        // Each range is linked to the range enclosing its start so lookups can walk outwards from the closest preceding range when it ends prior to the address
+        std::vector<u32> enclosing;
+        for (u32 index{}; index < symbolRanges.size(); index++) {
+            auto &range{symbolRanges[index]};
+            while (!enclosing.empty() && symbolRanges[enclosing.back()].end <= range.start)
+                enclosing.pop_back();
+            if (!enclosing.empty())
+                range.parent = enclosing.back();
+            enclosing.push_back(index);
+        }
+
+        symbolRanges.shrink_to_fit();
+        demangledNames.resize(symbolRanges.size());
+    }
+
+    Loader::SymbolInfo Loader::ResolveSymbol(void *ptr, bool demangle) {
+        ExecutableSymbolicInfo *executable{};
+        {
+            std::shared_lock lock{executablesMutex};
+            auto entry{std::lower_bound(executables.begin(), executables.end(), ptr, [](const std::unique_ptr<ExecutableSymbolicInfo> &it, void *ptr) { return it->programEnd < ptr; })};
+            if (entry != executables.end())
+                executable = entry->get();
+        }
+
+        if (executable && ptr >= executable->patchStart && ptr <= executable->programEnd) {
             if (ptr >= executable->programStart) {
-                auto offset{reinterpret_cast<u8 *>(ptr) - reinterpret_cast<u8 *>(executable->programStart)};
-                auto symbol{std::find_if(executable->symbols.begin(), executable->symbols.end(), [&offset](const Elf64_Sym &sym) { return sym.st_value <= offset && sym.st_value + sym.st_size > offset; })};
-                if (symbol != executable->symbols.end() && symbol->st_name && symbol->st_name < executable->symbolStrings.size()) {
-                    return {executable->symbolStrings.data() + symbol->st_name, executable->name};
+                u64 offset{static_cast<u64>(reinterpret_cast<u8 *>(ptr) - reinterpret_cast<u8 *>(executable->programStart))};
+                auto range{std::upper_bound(executable->symbolRanges.begin(), executable->symbolRanges.end(), offset, [](u64 offset, const ExecutableSymbolicInfo::SymbolRange &range) { return offset < range.start; })};
+                if (range != executable->symbolRanges.begin()) {
+                    range = std::prev(range);
+                    while (offset >= range->end && range->parent != ExecutableSymbolicInfo::SymbolRange::NoParent)
+                        range = executable->symbolRanges.begin() + range->parent;
+                }
+                if (range != executable->symbolRanges.end() && range->start <= offset && offset < range->end) {
+                    char *name{executable->symbolStrings.data() + range->nameOffset};
+                    SymbolInfo info{name, executable->name, {}, offset - range->start, offset};
+                    if (demangle) {
+                        auto &demangledName{executable->demangledNames[static_cast<size_t>(std::distance(executable->symbolRanges.begin(), range))]};
+                        std::scoped_lock lock{demangleMutex};
+                        if (demangledName.empty()) {
+                            int status{};
+                            std::unique_ptr<char, decltype(&std::free)> demangled{abi::__cxa_demangle(name, nullptr, nullptr, &status), std::free};
+                            demangledName = (status == 0) ? demangled.get() : name;
+                        }
+                        info.demangledName = demangledName;
+                    }
+                    return info;
                 } else {
-                    return {.executableName = executable->name};
+                    return {.executableName = executable->name, .executableOffset = offset};
                 }
             } else if (ptr >= executable->hookStart) {
-                return {.executableName = executable->hookName};
+                return {.executableName = executable->hookName, .executableOffset = static_cast<u64>(reinterpret_cast<u8 *>(ptr) - reinterpret_cast<u8 *>(executable->hookStart))};
             } else {
-                return {.executableName = executable->patchName};
+                return {.executableName = executable->patchName, .executableOffset = static_cast<u64>(reinterpret_cast<u8 *>(ptr) - reinterpret_cast<u8 *>(executable->patchStart))};
             }
         }
         return {};
@@ -136,13 +228,9 @@ namespace skyline::loader {
 
     inline std::string GetFunctionStackTrace(Loader *loader, void *pointer) {
         Dl_info info;
-        auto symbol{loader->ResolveSymbol(pointer)};
+        auto symbol{loader->ResolveSymbol(pointer, true)};
         if (symbol.name) {
-            int status{};
-            size_t length{};
-            std::unique_ptr<char, decltype(&std::free)> demangled{abi::__cxa_demangle(symbol.name, nullptr, &length, &status), std::free};
-
-            return fmt::format("\n* 0x{:X} ({} from {})", reinterpret_cast<uintptr_t>(pointer), (status == 0) ? std::string_view(demangled.get()) : symbol.name, symbol.executableName);
+            return fmt::format("\n* 0x{:X} ({} from {})", reinterpret_cast<uintptr_t>(pointer), symbol.demangledName, symbol.executableName);
         } else if (!symbol.executableName.empty()) {
             return fmt::format("\n* 0x{:X} (from {})", reinterpret_cast<uintptr_t>(pointer), symbol.executableName);
         } else if (dladdr(pointer, &info)) {
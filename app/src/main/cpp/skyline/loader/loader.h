@@ -62,9 +62,31 @@ namespace skyline::loader {
             std::string hookName; //!< The name of the hook section
             std::vector<Elf64_Sym> symbols; //!< A span over the .dynsym section
             std::vector<char> symbolStrings; //!< A span over the .dynstr section
+
+            /**
+             * @brief A range of addresses relative to the start of the executable that corresponds to a single symbol, ranges may be nested inside other ranges
+             */
+            struct SymbolRange {
+                static constexpr u32 NoParent{std::numeric_limits<u32>::max()};
+
+                u64 start;
+                u64 end;
+                u32 nameOffset; //!< The offset of the symbol's name in symbolStrings
+                u32 parent; //!< The index of the closest preceding range that contains the start of this range or NoParent, this is used to find enclosing symbols for addresses past the end of a nested one
+            };
+
+            std::vector<SymbolRange> symbolRanges; //!< All named symbols with a non-zero size sorted by their start address
+            std::vector<std::string> demangledNames; //!< The lazily demangled names of all symbols in symbolRanges, an empty string denotes that the name hasn't been demangled yet
+
+            /**
+             * @brief Builds symbolRanges from the symbols, this should be called once after symbols/symbolStrings have been filled in
+             */
+            void BuildSymbolIndex();
         };
 
-        std::vector<ExecutableSymbolicInfo> executables;
+        std::vector<std::unique_ptr<ExecutableSymbolicInfo>> executables; //!< The symbolic information of all loaded executables sorted by their base, these are heap allocated so SymbolInfo can point into them while executables are inserted
+        std::shared_mutex executablesMutex; //!< Synchronizes insertions into executables with lookups which may occur concurrently from other threads, such as the profiler
+        std::mutex demangleMutex; //!< Synchronizes writes to ExecutableSymbolicInfo::demangledNames
 
       public:
         /**
@@ -104,13 +126,18 @@ namespace skyline::loader {
         struct SymbolInfo {
             char *name; //!< The name of the symbol that was found
             std::string_view executableName; //!< The executable that contained the symbol
+            std::string_view demangledName; //!< The demangled name of the symbol or the raw name if it couldn't be demangled, this is only filled in when requested
+            u64 offset; //!< The offset of the address from the start of the symbol
+            u64 executableOffset; //!< The offset of the address from the start of the executable section it's in
         };
 
         /**
+         * @param demangle If the demangled name of the symbol should be looked up, demangling is only done once per symbol and cached after
          * @return All symbolic information about the symbol for the specified address
          * @note If a symbol isn't found then SymbolInfo::name will be nullptr
+         * @note This is O(log n) in the amount of symbols in the executable and is intended to be cheap enough to be called at a high frequency
          */
-        SymbolInfo ResolveSymbol(void *ptr);
+        SymbolInfo ResolveSymbol(void *ptr, bool demangle = false);
 
         /**
          * @param frame The initial stack frame or the calling function's stack frame by default
@@ -0,0 +1,212 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vfs/os_backing.h>
+#include "nro.h"
+#include "nso.h"
+#include "nca.h"
+#include "xci.h"
+#include "nsp.h"
+#include "metadata_cache.h"
+
+namespace skyline::loader {
+    MetadataCache::MetadataCache(const std::string &path, std::string keysPath) : keysPath{std::move(keysPath)} {
+        try {
+            filesystem = std::make_shared<vfs::OsFileSystem>(path);
+        } catch (const exception &e) {
+            Logger::Warn("Failed to create ROM metadata cache directory, caching will be disabled: {}", e.what());
+        }
+    }
+
+    std::string MetadataCache::GetFilename(u64 identity) {
+        return fmt::format("{:016X}.bin", identity);
+    }
+
+    u64 MetadataCache::GetIdentity(int fd, RomFormat format, language::SystemLanguage systemLanguage) {
+        constexpr size_t HeaderHashSize{0x4000}; //!< The amount of bytes at the start of the file that are hashed, this covers the headers of all supported formats
+
+        struct stat fileInfo{};
+        if (fstat(fd, &fileInfo))
+            throw exception("Failed to stat fd: {}", strerror(errno));
+
+        std::array<u8, HeaderHashSize> header{};
+        auto headerSize{pread64(fd, header.data(), header.size(), 0)};
+        if (headerSize < 0)
+            throw exception("Failed to read from fd: {}", strerror(errno));
+
+        std::array<u64, 6> identityData{
+            static_cast<u64>(fileInfo.st_size),
+            static_cast<u64>(fileInfo.st_mtim.tv_sec),
+            static_cast<u64>(fileInfo.st_mtim.tv_nsec),
+            XXH64(header.data(), static_cast<size_t>(headerSize), 0),
+            static_cast<u64>(format),
+            static_cast<u64>(systemLanguage),
+        };
+        return XXH64(identityData.data(), sizeof(identityData), 0);
+    }
+
+    RomMetadata MetadataCache::Parse(int fd, RomFormat format, language::SystemLanguage systemLanguage, const std::shared_ptr<crypto::KeyStore> &keyStore) {
+        std::unique_ptr<Loader> loader;
+        try {
+            auto backing{std::make_shared<vfs::OsBacking>(fd)};
+
+            switch (format) {
+                case RomFormat::NRO:
+                    loader = std::make_unique<NroLoader>(backing);
+                    break;
+                case RomFormat::NSO:
+                    loader = std::make_unique<NsoLoader>(backing);
+                    break;
+                case RomFormat::NCA:
+                    loader = std::make_unique<NcaLoader>(backing, keyStore);
+                    break;
+                case RomFormat::XCI:
+                    loader = std::make_unique<XciLoader>(backing, keyStore);
+                    break;
+                case RomFormat::NSP:
+                    loader = std::make_unique<NspLoader>(backing, keyStore);
+                    break;
+                default:
+                    return {.result = LoaderResult::ParsingError};
+            }
+        } catch (const loader_exception &e) {
+            return {.result = e.error};
+        } catch (const std::exception &e) {
+            return {.result = LoaderResult::ParsingError};
+        }
+
+        RomMetadata metadata{.result = LoaderResult::Success};
+        if (loader->nacp) {
+            auto language{language::GetApplicationLanguage(systemLanguage)};
+            if (((1 << static_cast<u32>(language)) & loader->nacp->supportedTitleLanguages) == 0)
+                language = loader->nacp->GetFirstSupportedTitleLanguage();
+
+            metadata.hasControlData = true;
+            metadata.name = loader->nacp->GetApplicationName(language);
+            metadata.version = loader->nacp->GetApplicationVersion();
+            metadata.author = loader->nacp->GetApplicationPublisher(language);
+            metadata.icon = loader->GetIcon(language);
+        }
+        return metadata;
+    }
+
+    std::optional<RomMetadata> MetadataCache::Lookup(u64 identity, u64 keyStamp) {
+        if (!filesystem)
+            return std::nullopt;
+
+        auto filename{GetFilename(identity)};
+        try {
+            if (!filesystem->FileExists(filename))
+                return std::nullopt;
+
+            auto backing{filesystem->OpenFile(filename)};
+            if (backing->size < sizeof(FileHeader))
+                throw exception("File is too small: 0x{:X}", backing->size);
+
+            auto header{backing->Read<FileHeader>()};
+            if (header.magic != FileHeader::Magic || header.version != FileHeader::Version)
+                throw exception("Invalid magic or version: 0x{:X}, {}", header.magic, header.version);
+
+            if (header.identity != identity)
+                throw exception("Mismatching identity: 0x{:X}", header.identity);
+
+            // Keys being added or changed can only affect ROMs which failed to parse, we don't want to reparse the entire library whenever keys are imported
+            if (static_cast<LoaderResult>(header.result) != LoaderResult::Success && header.keyStamp != keyStamp)
+                return std::nullopt;
+
+            size_t payloadSize{static_cast<size_t>(header.nameSize) + header.versionSize + header.authorSize + header.iconSize};
+            if (backing->size != sizeof(FileHeader) + payloadSize)
+                throw exception("Invalid size: 0x{:X} (Payload Size: 0x{:X})", backing->size, payloadSize);
+
+            std::vector<u8> payload(payloadSize);
+            backing->Read(span{payload}, sizeof(FileHeader));
+            if (XXH64(payload.data(), payload.size(), 0) != header.payloadHash)
+                throw exception("Payload hash mismatch");
+
+            RomMetadata metadata{
+                .result = static_cast<LoaderResult>(header.result),
+                .hasControlData = header.hasControlData,
+            };
+
+            auto payloadIt{payload.begin()};
+            auto copyOut{[&payloadIt](auto &container, size_t size) {
+                container.assign(payloadIt, payloadIt + static_cast<ssize_t>(size));
+                payloadIt += static_cast<ssize_t>(size);
+            }};
+            copyOut(metadata.name, header.nameSize);
+            copyOut(metadata.version, header.versionSize);
+            copyOut(metadata.author, header.authorSize);
+            copyOut(metadata.icon, header.iconSize);
+
+            return metadata;
+        } catch (const exception &e) {
+            Logger::Warn("Discarding invalid ROM metadata cache entry {}: {}", filename, e.what());
+            filesystem->DeleteFile(filename);
+            return std::nullopt;
+        }
+    }
+
+    void MetadataCache::Store(u64 identity, u64 keyStamp, const RomMetadata &metadata) {
+        if (!filesystem)
+            return;
+
+        std::vector<u8> payload;
+        payload.reserve(metadata.name.size() + metadata.version.size() + metadata.author.size() + metadata.icon.size());
+        payload.insert(payload.end(), metadata.name.begin(), metadata.name.end());
+        payload.insert(payload.end(), metadata.version.begin(), metadata.version.end());
+        payload.insert(payload.end(), metadata.author.begin(), metadata.author.end());
+        payload.insert(payload.end(), metadata.icon.begin(), metadata.icon.end());
+
+        FileHeader header{
+            .magic = FileHeader::Magic,
+            .version = FileHeader::Version,
+            .identity = identity,
+            .keyStamp = keyStamp,
+            .nameSize = static_cast<u32>(metadata.name.size()),
+            .versionSize = static_cast<u32>(metadata.version.size()),
+            .authorSize = static_cast<u32>(metadata.author.size()),
+            .iconSize = static_cast<u32>(metadata.icon.size()),
+            .result = static_cast<i8>(metadata.result),
+            .hasControlData = metadata.hasControlData,
+            .payloadHash = XXH64(payload.data(), payload.size(), 0),
+        };
+
+        auto filename{GetFilename(identity)};
+        try {
+            if (!filesystem->CreateFile(filename, sizeof(FileHeader) + payload.size()))
+                throw exception("Failed to create file");
+
+            // The header is written last so an interrupted write leaves behind a file with an invalid magic rather than a truncated payload with a valid header
+            auto backing{filesystem->OpenFile(filename, {false, true, false})};
+            backing->Write(span{payload}, sizeof(FileHeader));
+            backing->Write(span{header}.cast<u8>());
+        } catch (const exception &e) {
+            Logger::Warn("Failed to write ROM metadata cache entry {}: {}", filename, e.what());
+        }
+    }
+
+    RomMetadata MetadataCache::Get(int fd, RomFormat format, language::SystemLanguage systemLanguage) {
+        u64 identity, keyStamp{crypto::KeyStore::GetFileStamp(keysPath)};
+        try {
+            identity = GetIdentity(fd, format, systemLanguage);
+        } catch (const exception &e) {
+            return {.result = LoaderResult::ParsingError};
+        }
+
+        if (auto metadata{Lookup(identity, keyStamp)}) {
+            hits++;
+            return std::move(*metadata);
+        }
+        misses++;
+
+        auto metadata{Parse(fd, format, systemLanguage, crypto::KeyStore::GetShared(keysPath))};
+        Store(identity, keyStamp, metadata);
+        return metadata;
+    }
+
+    void MetadataCache::LogStatistics() {
+        Logger::Info("ROM metadata cache: {}/{} hits", hits.load(), hits.load() + misses.load());
+    }
+}
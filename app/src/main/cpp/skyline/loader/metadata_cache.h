@@ -0,0 +1,89 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <vfs/os_filesystem.h>
+#include <crypto/key_store.h>
+#include "loader.h"
+
+namespace skyline::loader {
+    /**
+     * @brief The metadata of a ROM that is displayed in the library
+     */
+    struct RomMetadata {
+        LoaderResult result{LoaderResult::ParsingError};
+        bool hasControlData{}; //!< If the ROM contains a NACP, all fields below are empty otherwise
+        std::string name;
+        std::string version;
+        std::string author;
+        std::vector<u8> icon; //!< The raw JPEG data of the icon
+    };
+
+    /**
+     * @brief A persistent on-disk cache of ROM metadata which avoids parsing (and potentially decrypting) a ROM to read its NACP and icon
+     * @note Entries are keyed by the identity of the ROM file which is derived from its size, modification time and a hash of its header as SAF doesn't expose stable paths
+     */
+    class MetadataCache {
+      private:
+        /**
+         * @brief The header of a cache file, this is followed by the name, version, author and icon
+         */
+        struct FileHeader {
+            static constexpr u32 Magic{util::MakeMagic<u32>("SRMC")};
+            static constexpr u32 Version{1}; //!< The version of the cache file format, this must be incremented for any changes to the format or the parsed metadata
+
+            u32 magic;
+            u32 version;
+            u64 identity;
+            u64 keyStamp; //!< The stamp of the key files when the entry was created, entries that failed to parse are invalidated when it changes
+            u32 nameSize;
+            u32 versionSize;
+            u32 authorSize;
+            u32 iconSize;
+            i8 result;
+            bool hasControlData;
+            u8 _pad_[6];
+            u64 payloadHash; //!< XXH64 of everything following the header
+        };
+        static_assert(sizeof(FileHeader) == 0x38);
+
+        std::shared_ptr<vfs::OsFileSystem> filesystem; //!< The directory that cache files are stored in, this'll be null if it couldn't be created
+        std::string keysPath;
+        std::atomic<size_t> hits{}, misses{};
+
+        static std::string GetFilename(u64 identity);
+
+        std::optional<RomMetadata> Lookup(u64 identity, u64 keyStamp);
+
+        void Store(u64 identity, u64 keyStamp, const RomMetadata &metadata);
+
+      public:
+        /**
+         * @param path The directory to store cache files in
+         * @param keysPath The directory containing the key files, as accepted by crypto::KeyStore
+         */
+        MetadataCache(const std::string &path, std::string keysPath);
+
+        /**
+         * @return A key which identifies the contents of the file for the supplied format and language without reading all of it
+         */
+        static u64 GetIdentity(int fd, RomFormat format, language::SystemLanguage systemLanguage);
+
+        /**
+         * @brief Parses the metadata of a ROM without going through the cache
+         */
+        static RomMetadata Parse(int fd, RomFormat format, language::SystemLanguage systemLanguage, const std::shared_ptr<crypto::KeyStore> &keyStore);
+
+        /**
+         * @return The metadata of the ROM from the cache if there's a valid entry for it, otherwise it's parsed and stored in the cache
+         * @note This is thread-safe and is intended to be called concurrently for multiple ROMs
+         */
+        RomMetadata Get(int fd, RomFormat format, language::SystemLanguage systemLanguage);
+
+        /**
+         * @brief Logs the hit rate of the cache
+         */
+        void LogStatistics();
+    };
+}
@@ -3,6 +3,7 @@
 
 #include <cxxabi.h>
 #include <unistd.h>
+#include "common/settings.h"
 #include "common/signal.h"
 #include "common/trace.h"
 #include "os.h"
@@ -247,12 +248,18 @@ namespace skyline::nce {
         return threadCtx;
     }
 
-    NCE::NCE(const DeviceState &state) : state(state) {
+    NCE::NCE(const DeviceState &state) : state(state), patchCache(state.os->privateAppFilesPath + "nce_cache/") {
         signal::SetTlsRestorer(&NceTlsRestorer);
         staticNce = this;
+
+        if (*state.settings->guestProfiler)
+            profiler = std::make_unique<GuestProfiler>(state, *state.settings->guestProfilerFrequency, *state.settings->guestProfilerThreadFilter);
     }
 
     NCE::~NCE() {
+        if (profiler)
+            profiler->Stop(); // The profiler must not be destroyed while a sampling signal handler might still be accessing it
+        profiler.reset();
         staticNce = nullptr;
     }
 
@@ -347,17 +354,21 @@ namespace skyline::nce {
         return {util::AlignUp(size * sizeof(u32), constant::PageSize), offsets};
     }
 
-    void NCE::PatchCode(std::vector<u8> &text, u32 *patch, size_t patchSize, const std::vector<size_t> &offsets, size_t textOffset) {
-        u32 *start{patch};
-        u32 *end{patch + (patchSize / sizeof(u32))};
-
+    u32 *NCE::WritePatchPrologue(u32 *patch) {
         std::memcpy(patch, reinterpret_cast<void *>(&guest::SaveCtx), guest::SaveCtxSize * sizeof(u32));
         patch += guest::SaveCtxSize;
 
         patch = WriteTrampoline(patch, reinterpret_cast<u64>(&NCE::SvcHandler));
 
         std::memcpy(patch, reinterpret_cast<void *>(&guest::LoadCtx), guest::LoadCtxSize * sizeof(u32));
-        patch += guest::LoadCtxSize;
+        return patch + guest::LoadCtxSize;
+    }
+
+    void NCE::PatchCode(std::vector<u8> &text, u32 *patch, size_t patchSize, const std::vector<size_t> &offsets, size_t textOffset) {
+        u32 *start{patch};
+        u32 *end{patch + (patchSize / sizeof(u32))};
+
+        patch = WritePatchPrologue(patch);
 
         u64 frequency;
         asm("MRS %0, CNTFRQ_EL0" : "=r"(frequency));
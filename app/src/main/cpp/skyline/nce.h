@@ -8,6 +8,8 @@
 #include "common.h"
 #include "hle/symbol_hooks.h"
 #include "common/interval_map.h"
+#include "nce/patch_cache.h"
+#include "nce/profiler.h"
 
 namespace skyline::nce {
     /**
@@ -100,6 +102,9 @@ namespace skyline::nce {
 
         ~NCE();
 
+        PatchCache patchCache; //!< A persistent cache of the patches applied to executables
+        std::unique_ptr<GuestProfiler> profiler; //!< The guest profiler, this is only created when profiling is enabled in the settings
+
         struct PatchData {
             size_t size; //!< Size of the .patch section
             std::vector<size_t> offsets; //!< Offsets in .text of instructions that need to be patched
@@ -107,6 +112,13 @@ namespace skyline::nce {
 
         static PatchData GetPatchData(const std::vector<u8> &text);
 
+        /**
+         * @brief Writes the context save/restore functions and the SVC trampoline to the start of the .patch section
+         * @note This is the only part of the .patch section that depends on the layout of the host process, it must be rewritten when a .patch section is reused across runs
+         * @return A pointer to the end of the prologue
+         */
+        static u32 *WritePatchPrologue(u32 *patch);
+
         /**
          * @brief Writes the .patch section and mutates the code accordingly
          * @param patch A pointer to the .patch section which should be exactly patchSize in size and located before the .text section
@@ -0,0 +1,153 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include "guest.h"
+#include "patch_cache.h"
+
+namespace skyline::nce {
+    PatchCache::PatchCache(const std::string &path) {
+        try {
+            filesystem = std::make_shared<vfs::OsFileSystem>(path);
+        } catch (const exception &e) {
+            Logger::Warn("Failed to create NCE patch cache directory, caching will be disabled: {}", e.what());
+        }
+    }
+
+    std::string PatchCache::GetFilename(u64 key) {
+        return fmt::format("{:016X}.bin", key);
+    }
+
+    u64 PatchCache::GetKey(span<u8> text, size_t textOffset) {
+        // Any code that is copied from the host into the .patch section is hashed as a change to it would invalidate all entries
+        static const u64 hostCodeHash{[] {
+            XXH64_state_t *hashState{XXH64_createState()};
+            XXH64_reset(hashState, 0);
+            XXH64_update(hashState, reinterpret_cast<void *>(&guest::SaveCtx), guest::SaveCtxSize * sizeof(u32));
+            XXH64_update(hashState, reinterpret_cast<void *>(&guest::LoadCtx), guest::LoadCtxSize * sizeof(u32));
+            XXH64_update(hashState, reinterpret_cast<void *>(&guest::RescaleClock), guest::RescaleClockSize * sizeof(u32));
+            u64 hash{XXH64_digest(hashState)};
+            XXH64_freeState(hashState);
+            return hash;
+        }()};
+
+        u64 frequency;
+        asm("MRS %0, CNTFRQ_EL0" : "=r"(frequency));
+
+        std::array<u64, 4> keyData{XXH64(text.data(), text.size_bytes(), 0), frequency, textOffset, hostCodeHash};
+        return XXH64(keyData.data(), sizeof(keyData), 0);
+    }
+
+    std::optional<PatchCache::Entry> PatchCache::Lookup(u64 key, size_t textOffset) {
+        std::scoped_lock lock{mutex};
+        if (!filesystem)
+            return std::nullopt;
+
+        auto filename{GetFilename(key)};
+        try {
+            if (!filesystem->FileExists(filename)) {
+                misses++;
+                return std::nullopt;
+            }
+
+            auto backing{filesystem->OpenFile(filename)};
+            if (backing->size < sizeof(FileHeader))
+                throw exception("File is too small: 0x{:X}", backing->size);
+
+            auto header{backing->Read<FileHeader>()};
+            if (header.magic != FileHeader::Magic || header.version != FileHeader::Version)
+                throw exception("Invalid magic or version: 0x{:X}, {}", header.magic, header.version);
+
+            u64 frequency;
+            asm("MRS %0, CNTFRQ_EL0" : "=r"(frequency));
+            if (header.key != key || header.frequency != frequency || header.textOffset != textOffset)
+                throw exception("Mismatching key: 0x{:X} (Frequency: {}, Text Offset: 0x{:X})", header.key, header.frequency, header.textOffset);
+
+            if (!util::IsPageAligned(header.patchSize) || backing->size != sizeof(FileHeader) + (header.offsetCount * 2 * sizeof(u32)) + header.patchSize)
+                throw exception("Invalid size: 0x{:X} (Patch Size: 0x{:X}, Offsets: {})", backing->size, header.patchSize, header.offsetCount);
+
+            std::vector<u8> payload(backing->size - sizeof(FileHeader));
+            backing->Read(span{payload}, sizeof(FileHeader));
+            if (XXH64(payload.data(), payload.size(), 0) != header.payloadHash)
+                throw exception("Payload hash mismatch");
+
+            Entry entry{
+                .patchSize = header.patchSize,
+                .offsets = std::vector<u32>(header.offsetCount),
+                .instructions = std::vector<u32>(header.offsetCount),
+                .patch = std::vector<u32>(header.patchSize / sizeof(u32)),
+                .generationTime = header.generationTime,
+            };
+
+            auto payloadIt{payload.data()};
+            auto copyOut{[&payloadIt](auto &vector) {
+                std::memcpy(vector.data(), payloadIt, vector.size() * sizeof(u32));
+                payloadIt += vector.size() * sizeof(u32);
+            }};
+            copyOut(entry.offsets);
+            copyOut(entry.instructions);
+            copyOut(entry.patch);
+
+            return entry;
+        } catch (const exception &e) {
+            Logger::Warn("Discarding invalid NCE patch cache entry {}: {}", filename, e.what());
+            filesystem->DeleteFile(filename);
+            misses++;
+            return std::nullopt;
+        }
+    }
+
+    void PatchCache::Store(u64 key, size_t textOffset, const Entry &entry) {
+        std::scoped_lock lock{mutex};
+        if (!filesystem)
+            return;
+
+        u64 frequency;
+        asm("MRS %0, CNTFRQ_EL0" : "=r"(frequency));
+
+        std::vector<u8> payload((entry.offsets.size() + entry.instructions.size() + entry.patch.size()) * sizeof(u32));
+        auto payloadIt{payload.data()};
+        auto copyIn{[&payloadIt](const auto &vector) {
+            std::memcpy(payloadIt, vector.data(), vector.size() * sizeof(u32));
+            payloadIt += vector.size() * sizeof(u32);
+        }};
+        copyIn(entry.offsets);
+        copyIn(entry.instructions);
+        copyIn(entry.patch);
+
+        FileHeader header{
+            .magic = FileHeader::Magic,
+            .version = FileHeader::Version,
+            .key = key,
+            .frequency = frequency,
+            .textOffset = textOffset,
+            .patchSize = entry.patchSize,
+            .offsetCount = entry.offsets.size(),
+            .generationTime = entry.generationTime,
+            .payloadHash = XXH64(payload.data(), payload.size(), 0),
+        };
+
+        auto filename{GetFilename(key)};
+        try {
+            if (!filesystem->CreateFile(filename, sizeof(FileHeader) + payload.size()))
+                throw exception("Failed to create file");
+
+            // The header is written last so an interrupted write leaves behind a file with an invalid magic rather than a truncated payload with a valid header
+            auto backing{filesystem->OpenFile(filename, {false, true, false})};
+            backing->Write(span{payload}, sizeof(FileHeader));
+            backing->Write(span{header}.cast<u8>());
+        } catch (const exception &e) {
+            Logger::Warn("Failed to write NCE patch cache entry {}: {}", filename, e.what());
+        }
+    }
+
+    void PatchCache::RecordHit(const Entry &entry, i64 loadTime) {
+        std::scoped_lock lock{mutex};
+        hits++;
+        timeSaved += std::max(entry.generationTime - loadTime, i64{});
+    }
+
+    void PatchCache::LogStatistics() {
+        std::scoped_lock lock{mutex};
+        Logger::Info("NCE patch cache: {}/{} hits, saved {}ms", hits, hits + misses, timeSaved / constant::NsInMillisecond);
+    }
+}
@@ -0,0 +1,82 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <vfs/os_filesystem.h>
+
+namespace skyline::nce {
+    /**
+     * @brief A persistent on-disk cache of the .patch section and .text rewrites that NCE produces for an executable
+     * @note Entries are keyed by the hash of the unpatched .text alongside the host counter frequency and the offset of .text from the .patch section, as the patched code depends on nothing else
+     */
+    class PatchCache {
+      public:
+        /**
+         * @brief Everything required to reproduce the result of NCE::PatchCode without scanning .text
+         */
+        struct Entry {
+            size_t patchSize; //!< The size of the .patch section in bytes
+            std::vector<u32> offsets; //!< Offsets in .text (in instructions) that were rewritten
+            std::vector<u32> instructions; //!< The rewritten instruction at each corresponding offset
+            std::vector<u32> patch; //!< The contents of the .patch section, the host-dependent prologue must be rewritten on load
+            i64 generationTime; //!< The time it took to scan and emit this entry originally in nanoseconds
+        };
+
+      private:
+        /**
+         * @brief The header of a cache file, this is followed by the offsets, instructions and .patch section contents
+         */
+        struct FileHeader {
+            static constexpr u32 Magic{util::MakeMagic<u32>("SNPC")};
+            static constexpr u32 Version{1}; //!< The version of the cache file format, this must be incremented for any changes to the format or the emitted code
+
+            u32 magic;
+            u32 version;
+            u64 key;
+            u64 frequency; //!< The host counter frequency the entry was generated for
+            u64 textOffset;
+            u64 patchSize;
+            u64 offsetCount;
+            i64 generationTime;
+            u64 payloadHash; //!< XXH64 of everything following the header
+        };
+        static_assert(sizeof(FileHeader) == 0x40);
+
+        std::shared_ptr<vfs::OsFileSystem> filesystem; //!< The directory that cache files are stored in, this'll be null if it couldn't be created
+        std::mutex mutex;
+        size_t hits{}, misses{};
+        i64 timeSaved{}; //!< The total time saved by cache hits in nanoseconds
+
+        static std::string GetFilename(u64 key);
+
+      public:
+        PatchCache(const std::string &path);
+
+        /**
+         * @param textOffset The offset of .text from the end of the .patch section
+         * @return A key which uniquely identifies the patches of the supplied .text for the current host
+         */
+        static u64 GetKey(span<u8> text, size_t textOffset);
+
+        /**
+         * @return The cache entry corresponding to the key if it exists and was successfully validated
+         */
+        std::optional<Entry> Lookup(u64 key, size_t textOffset);
+
+        /**
+         * @brief Writes an entry for the supplied key to disk, any existing entry is overwritten
+         */
+        void Store(u64 key, size_t textOffset, const Entry &entry);
+
+        /**
+         * @brief Records the time taken to load a cached entry for statistics
+         */
+        void RecordHit(const Entry &entry, i64 loadTime);
+
+        /**
+         * @brief Logs the hit rate and time saved by the cache
+         */
+        void LogStatistics();
+    };
+}
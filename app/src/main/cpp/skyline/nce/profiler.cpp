@@ -0,0 +1,241 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <charconv>
+#include <unistd.h>
+#include <common/signal.h>
+#include <common/trace.h>
+#include <kernel/types/KProcess.h>
+#include <vfs/os_filesystem.h>
+#include <nce.h>
+#include <os.h>
+#include "profiler.h"
+
+namespace skyline::nce {
+    GuestProfiler::SampleQueue::SampleQueue() : slots{std::make_unique<Slot[]>(Size)} {
+        for (size_t index{}; index < Size; index++)
+            slots[index].sequence.store(index, std::memory_order_relaxed);
+    }
+
+    GuestProfiler::SampleQueue::Slot *GuestProfiler::SampleQueue::Claim() {
+        size_t position{enqueuePosition.load(std::memory_order_relaxed)};
+        while (true) {
+            auto &slot{slots[position & (Size - 1)]};
+            auto difference{static_cast<ssize_t>(slot.sequence.load(std::memory_order_acquire)) - static_cast<ssize_t>(position)};
+            if (difference == 0) {
+                if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    return &slot;
+            } else if (difference < 0) {
+                return nullptr; // The queue is full
+            } else {
+                position = enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void GuestProfiler::SampleQueue::Publish(Slot *slot) {
+        slot->sequence.store(slot->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    GuestProfiler::Sample *GuestProfiler::SampleQueue::Peek() {
+        auto &slot{slots[dequeuePosition & (Size - 1)]};
+        if (slot.sequence.load(std::memory_order_acquire) != dequeuePosition + 1)
+            return nullptr;
+        return &slot.sample;
+    }
+
+    void GuestProfiler::SampleQueue::Release() {
+        slots[dequeuePosition & (Size - 1)].sequence.store(dequeuePosition + Size, std::memory_order_release);
+        dequeuePosition++;
+    }
+
+    GuestProfiler::GuestProfiler(const DeviceState &state, u32 frequency, std::string_view threadFilterString) : state{state}, interval{constant::NsInSecond / std::max(frequency, 1U)} {
+        for (size_t start{}; start < threadFilterString.size();) {
+            auto end{std::min(threadFilterString.find(',', start), threadFilterString.size())};
+            auto id{threadFilterString.substr(start, end - start)};
+            if (!id.empty()) {
+                size_t value{};
+                auto result{std::from_chars(id.data(), id.data() + id.size(), value)};
+                if (result.ec == std::errc{})
+                    threadFilter.push_back(value);
+                else
+                    Logger::Warn("Invalid thread ID in guest profiler filter: '{}'", id);
+            }
+            start = end + 1;
+        }
+
+        signal::SetSignalHandler({SampleSignal}, SignalHandler);
+        instance.store(this);
+        thread = std::thread(&GuestProfiler::Run, this);
+        Logger::Info("Guest profiler started at {}Hz ({})", frequency, threadFilter.empty() ? "All Threads" : threadFilterString);
+    }
+
+    GuestProfiler::~GuestProfiler() {
+        Stop();
+
+        running = false;
+        if (thread.joinable())
+            thread.join();
+
+        ProcessSamples();
+        WriteFoldedStacks(state.os->publicAppFilesPath + "profiles/");
+    }
+
+    void GuestProfiler::Stop() {
+        GuestProfiler *expected{this};
+        if (!instance.compare_exchange_strong(expected, nullptr))
+            return;
+
+        // Any handler that loaded the instance prior to it being cleared has already incremented the count, so it's drained here
+        while (activeHandlers.load())
+            std::this_thread::yield();
+    }
+
+    timer_t GuestProfiler::CreateThreadTimer(size_t threadId) {
+        if (!threadFilter.empty() && std::find(threadFilter.begin(), threadFilter.end(), threadId) == threadFilter.end())
+            return nullptr;
+
+        // We use the CPU time of the thread as the clock so blocked threads don't generate any samples
+        struct sigevent event{
+            .sigev_signo = SampleSignal,
+            .sigev_notify = SIGEV_THREAD_ID,
+            .sigev_notify_thread_id = gettid(),
+        };
+        timer_t timer{};
+        if (timer_create(CLOCK_THREAD_CPUTIME_ID, &event, &timer))
+            throw exception("timer_create has failed with '{}'", strerror(errno));
+
+        struct timespec intervalSpec{
+            .tv_sec = interval / constant::NsInSecond,
+            .tv_nsec = interval % constant::NsInSecond,
+        };
+        struct itimerspec spec{.it_interval = intervalSpec, .it_value = intervalSpec};
+        timer_settime(timer, 0, &spec, nullptr);
+
+        return timer;
+    }
+
+    void GuestProfiler::SignalHandler(int signal, siginfo *info, ucontext *ctx, void **tls) {
+        // Note: This function must be async-signal-safe, it can interrupt guest code or host code on a guest thread at any point
+        auto &thread{DeviceState::thread};
+        if (!thread) [[unlikely]]
+            return;
+
+        // The profiler is accessed through the instance rather than the NCE as the handler may be run while the profiler is being destroyed, Stop() waits on all handlers that have loaded it
+        activeHandlers.fetch_add(1);
+        auto profiler{instance.load()};
+        if (profiler)
+            profiler->TakeSample(*thread, ctx, tls);
+        activeHandlers.fetch_sub(1);
+    }
+
+    void GuestProfiler::TakeSample(kernel::type::KThread &thread, ucontext *ctx, void **tls) {
+        auto slot{queue.Claim()};
+        if (!slot) {
+            droppedSamples.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        auto &sample{slot->sample};
+        struct timespec time{};
+        clock_gettime(CLOCK_BOOTTIME, &time);
+        sample.timestamp = static_cast<u64>(time.tv_sec) * constant::NsInSecond + static_cast<u64>(time.tv_nsec);
+        sample.tid = gettid();
+        sample.threadId = static_cast<u32>(thread.id);
+        sample.depth = 0;
+
+        if (*tls) {
+            // TLS was restored so we were in guest code, the frame chain is only followed while it stays inside the guest stack to avoid faulting on a corrupt frame pointer
+            auto &mctx{ctx->uc_mcontext};
+            sample.frames[sample.depth++] = mctx.pc;
+
+            u64 stackBottom{mctx.sp}, stackTop{reinterpret_cast<u64>(thread.stackTop)};
+            auto frame{reinterpret_cast<signal::StackFrame *>(mctx.regs[29])};
+            while (sample.depth < MaxStackDepth) {
+                auto frameAddress{reinterpret_cast<u64>(frame)};
+                if (frameAddress < stackBottom || frameAddress + sizeof(signal::StackFrame) > stackTop || !util::IsAligned(frameAddress, sizeof(u64)))
+                    break;
+
+                if (!frame->lr)
+                    break;
+                sample.frames[sample.depth++] = reinterpret_cast<u64>(frame->lr);
+
+                stackBottom = frameAddress + sizeof(signal::StackFrame); // Frames must strictly grow upwards, this also guarantees termination on cyclic chains
+                frame = frame->next;
+            }
+        }
+
+        queue.Publish(slot);
+    }
+
+    void GuestProfiler::Run() {
+        if (int result{pthread_setname_np(pthread_self(), "Sky-Profiler")})
+            Logger::Warn("Failed to set the thread name: {}", strerror(result));
+
+        while (running) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            ProcessSamples();
+        }
+    }
+
+    std::string GuestProfiler::SymboliseFrame(u64 address) {
+        auto symbol{state.loader->ResolveSymbol(reinterpret_cast<void *>(address), true)};
+        if (symbol.name)
+            return std::string{symbol.demangledName};
+        else if (!symbol.executableName.empty())
+            return fmt::format("{}+0x{:X}", symbol.executableName, symbol.executableOffset);
+        else
+            return fmt::format("0x{:X}", address);
+    }
+
+    void GuestProfiler::ProcessSamples() {
+        if (!state.loader)
+            return;
+
+        std::scoped_lock lock{aggregateMutex};
+        std::string folded;
+        while (auto sample{queue.Peek()}) {
+            auto topFrame{sample->depth ? SymboliseFrame(sample->frames[0]) : std::string{"[HLE]"}};
+
+            // Frames are stored from innermost to outermost while folded stacks go from outermost to innermost
+            folded = fmt::format("HOS-{}", sample->threadId);
+            for (auto frame{sample->depth}; frame > 1; frame--) {
+                folded += ';';
+                folded += SymboliseFrame(sample->frames[frame - 1]);
+            }
+            folded += ';';
+            folded += topFrame;
+
+            TRACE_EVENT_INSTANT("profiler", nullptr, perfetto::ThreadTrack::ForThread(sample->tid), sample->timestamp, [&](perfetto::EventContext ctx) {
+                ctx.event()->set_name(topFrame);
+                ctx.AddDebugAnnotation("stack", folded);
+            });
+
+            foldedStacks[folded]++;
+            totalSamples++;
+            queue.Release();
+        }
+    }
+
+    void GuestProfiler::WriteFoldedStacks(const std::string &path) {
+        std::scoped_lock lock{aggregateMutex};
+        if (foldedStacks.empty())
+            return;
+
+        std::string output;
+        for (const auto &[stack, count] : foldedStacks)
+            output += fmt::format("{} {}\n", stack, count);
+
+        try {
+            vfs::OsFileSystem filesystem{path};
+            auto filename{fmt::format("guest_{}.folded", util::GetTimeNs())};
+            if (!filesystem.CreateFile(filename, output.size()))
+                throw exception("Failed to create file");
+            filesystem.OpenFile(filename, {false, true, false})->Write(span{output}.cast<u8>());
+
+            Logger::Info("Wrote {} guest profiler samples ({} unique stacks, {} dropped) to {}{}", totalSamples, foldedStacks.size(), droppedSamples.load(), path, filename);
+        } catch (const exception &e) {
+            Logger::Warn("Failed to write guest profiler samples: {}", e.what());
+        }
+    }
+}
@@ -0,0 +1,129 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <csignal>
+#include <common.h>
+
+namespace skyline::nce {
+    /**
+     * @brief A sampling profiler for guest code, running guest threads are periodically interrupted by a CPU-time timer signal which captures the guest PC and frame pointer chain
+     * @note Samples are symbolised through the loader and aggregated on a separate thread into folded stacks (as consumed by flamegraph.pl/speedscope) alongside being emitted as perfetto instant events
+     */
+    class GuestProfiler {
+      public:
+        inline static int SampleSignal{SIGRTMIN + 2}; //!< The signal used to sample guest threads, this must not conflict with the scheduler signals
+        static constexpr size_t MaxStackDepth{48}; //!< The maximum amount of frames captured in a single sample
+
+      private:
+        /**
+         * @brief A single sample of a guest thread's call stack
+         */
+        struct Sample {
+            u64 timestamp; //!< The time at which the sample was taken in nanoseconds on the boot clock, this is the default clock of perfetto
+            pid_t tid; //!< The host TID of the sampled thread
+            u32 threadId; //!< The ID of the guest thread
+            u32 depth; //!< The amount of valid entries in frames, this is 0 if the thread was not running guest code
+            std::array<u64, MaxStackDepth> frames; //!< The PC of the thread followed by the return addresses from the frame chain
+        };
+
+        /**
+         * @brief A bounded MPSC queue of samples which is safe to produce into from a signal handler as it's lock-free and doesn't allocate
+         * @url https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+         */
+        class SampleQueue {
+          private:
+            static constexpr size_t Size{4096}; //!< The amount of samples in the queue, this must be a power of 2
+
+            struct Slot {
+                std::atomic<size_t> sequence;
+                Sample sample;
+            };
+
+            std::unique_ptr<Slot[]> slots;
+            std::atomic<size_t> enqueuePosition{};
+            size_t dequeuePosition{}; //!< The position of the consumer, there must only be a single consumer
+
+          public:
+            SampleQueue();
+
+            /**
+             * @brief Claims a slot for a sample, this is async-signal-safe
+             * @return A slot to write a sample into or nullptr if the queue is full, the slot must be published with Publish() after it has been written
+             */
+            Slot *Claim();
+
+            void Publish(Slot *slot);
+
+            /**
+             * @return The oldest sample in the queue or nullptr if it's empty, the sample must be released with Release() prior to the next call
+             */
+            Sample *Peek();
+
+            void Release();
+        };
+
+        static inline std::atomic<GuestProfiler *> instance{}; //!< The profiler that samples are taken for, this is cleared when sampling is stopped
+        static inline std::atomic<size_t> activeHandlers{}; //!< The amount of signal handlers that are currently accessing the profiler
+
+        const DeviceState &state;
+        SampleQueue queue;
+        std::atomic<size_t> droppedSamples{}; //!< The amount of samples that were dropped due to the queue being full
+        i64 interval; //!< The interval between samples of a thread in nanoseconds
+        std::vector<size_t> threadFilter; //!< The IDs of guest threads that should be sampled, all threads are sampled if this is empty
+
+        std::mutex aggregateMutex;
+        std::unordered_map<std::string, u64> foldedStacks; //!< A map from folded stacks to the amount of samples with that stack
+        size_t totalSamples{};
+
+        std::atomic<bool> running{true};
+        std::thread thread; //!< The thread that symbolises and aggregates samples
+
+        /**
+         * @brief Captures a sample of the supplied thread into the queue, this is async-signal-safe
+         */
+        void TakeSample(kernel::type::KThread &thread, ucontext *ctx, void **tls);
+
+        void Run();
+
+        /**
+         * @brief Symbolises all samples in the queue and aggregates them into foldedStacks
+         */
+        void ProcessSamples();
+
+        /**
+         * @return A human-readable name for the supplied address
+         */
+        std::string SymboliseFrame(u64 address);
+
+      public:
+        /**
+         * @param frequency The frequency at which every thread should be sampled in Hz
+         * @param threadFilter A comma separated list of guest thread IDs to sample, all threads are sampled if this is empty
+         */
+        GuestProfiler(const DeviceState &state, u32 frequency, std::string_view threadFilter);
+
+        ~GuestProfiler();
+
+        /**
+         * @brief Stops taking samples and blocks till all signal handlers that might be accessing the profiler have returned
+         * @note Thread timers are owned by their threads and may still fire after this, their signals are ignored
+         */
+        void Stop();
+
+        /**
+         * @brief Creates a timer that samples the calling guest thread at the profiling frequency
+         * @return The handle of the timer or nullptr if the thread shouldn't be sampled
+         * @note The timer is armed by this function and needs to be deleted by the caller
+         */
+        timer_t CreateThreadTimer(size_t threadId);
+
+        static void SignalHandler(int signal, siginfo *info, ucontext *ctx, void **tls);
+
+        /**
+         * @brief Writes all aggregated samples to a file in the folded stack format
+         */
+        void WriteFoldedStacks(const std::string &path);
+    };
+}
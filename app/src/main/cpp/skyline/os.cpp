@@ -10,6 +10,12 @@
 #include "loader/nca.h"
 #include "loader/nsp.h"
 #include "loader/xci.h"
+#include "jvm.h"
+#include "gpu.h"
+#include "gpu/interconnect/maxwell_3d/pipeline_manager.h"
+#include "soc.h"
+#include "soc/gm20b/macro/macro_state.h"
+#include "soc/gm20b/gpfifo_replay.h"
 #include "os.h"
 
 namespace skyline::kernel {
@@ -64,13 +70,34 @@ namespace skyline::kernel {
             Logger::InfoNoPrefix(R"(Starting "{}" v{} by "{}")", name, nacp->GetApplicationVersion(), publisher);
         }
 
-        process->InitializeHeapTls();
-        auto thread{process->CreateThread(entry)};
-        if (thread) {
-            Logger::Info("Starting main HOS thread");
-            Logger::EmulationContext.Flush();
-            thread->Start(true);
-            process->Kill(true, true, true);
+        state.gpu->shaderCache.Open(privateAppFilesPath + "shader_cache/", process->npdm.aci0.programId);
+        state.gpu->graphicsPipelineCache.Open(privateAppFilesPath + "vk_pipeline_cache/", process->npdm.aci0.programId);
+        state.gpu->pipelineWarmupCache.Open(privateAppFilesPath + "pipeline_cache/", process->npdm.aci0.programId, gpu::interconnect::maxwell3d::PipelineManager::GetWarmupRecordLayout());
+
+        // All pipelines the title used in prior runs are compiled before it starts so they don't need to be compiled during gameplay
+        gpu::interconnect::maxwell3d::PipelineManager::PrecompilePipelines(*state.gpu, [&](size_t compiled, size_t total) {
+            state.jvm->UpdatePipelineWarmupProgress(static_cast<jint>(compiled), static_cast<jint>(total));
+        });
+
+        if (*state.settings->gpfifoReplay) {
+            // The title isn't run when replaying as the replay must be the only source of GPU work for its timings to be meaningful
+            soc::gm20b::GpfifoReplayer{state, publicAppFilesPath + "gpfifo_captures/", process->npdm.aci0.programId}.Run(*state.settings->gpfifoReplayIterations);
+        } else {
+            if (*state.settings->gpfifoCapture)
+                state.soc->gpfifoCapture = std::make_unique<soc::gm20b::GpfifoCapture>(publicAppFilesPath + "gpfifo_captures/", process->npdm.aci0.programId);
+
+            process->InitializeHeapTls();
+            auto thread{process->CreateThread(entry)};
+            if (thread) {
+                Logger::Info("Starting main HOS thread");
+                Logger::EmulationContext.Flush();
+                thread->Start(true);
+                process->Kill(true, true, true);
+            }
         }
+
+        state.gpu->shaderCache.LogStatistics();
+        soc::gm20b::MacroState::LogStatistics();
+        state.gpu->graphicsPipelineCache.Save();
     }
 }
@@ -2,12 +2,14 @@
 // Copyright © 2020 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
 #include <kernel/types/KProcess.h>
+#include <common/settings.h>
 #include "IAudioOut.h"
 
 namespace skyline::service::audio {
     IAudioOut::IAudioOut(const DeviceState &state, ServiceManager &manager, u8 channelCount, u32 sampleRate)
         : sampleRate(sampleRate),
           channelCount(channelCount),
+          resampler(*state.settings->highQualityResampling ? skyline::audio::ResamplerQuality::High : skyline::audio::ResamplerQuality::Standard),
           releaseEvent(std::make_shared<type::KEvent>(state, false)),
           BaseService(state, manager) {
         track = state.audio->OpenTrack(channelCount, constant::SampleRate, [this]() { releaseEvent->Signal(); });
@@ -18,7 +20,7 @@ namespace skyline::service::audio {
     }
 
     Result IAudioOut::GetAudioOutState(type::KSession &session, ipc::IpcRequest &request, ipc::IpcResponse &response) {
-        response.Push(static_cast<u32>(track->playbackState));
+        response.Push(static_cast<u32>(track->playbackState.load()));
         return {};
     }
 
@@ -48,8 +50,7 @@ namespace skyline::service::audio {
 
         span samples(data.sampleBuffer, data.sampleSize / sizeof(i16));
         if (sampleRate != constant::SampleRate) {
-            auto resampledBuffer{resampler.ResampleBuffer(samples, static_cast<double>(sampleRate) / constant::SampleRate, channelCount)};
-            track->AppendBuffer(tag, resampledBuffer);
+            track->AppendBuffer(tag, resampler.ResampleChunk(samples, skyline::audio::Resampler::GetStep(sampleRate, constant::SampleRate), channelCount));
         } else {
             track->AppendBuffer(tag, samples);
         }
@@ -2,26 +2,127 @@
 // Copyright © 2020 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
 #include <kernel/types/KProcess.h>
+#include <loader/loader.h>
+#include <common/signal.h>
+#include <nce.h>
+#include <common/trace.h>
+#include <audio/mixer.h>
 #include "IAudioRenderer.h"
 
 namespace skyline::service::audio::IAudioRenderer {
     IAudioRenderer::IAudioRenderer(const DeviceState &state, ServiceManager &manager, AudioRendererParameters &parameters)
-        : systemEvent(std::make_shared<type::KEvent>(state, true)), parameters(parameters), BaseService(state, manager) {
+        : systemEvent(std::make_shared<type::KEvent>(state, true)), parameters(parameters), waveBufferCache(state), BaseService(state, manager) {
         track = state.audio->OpenTrack(constant::StereoChannelCount, constant::SampleRate, [&]() { systemEvent->Signal(); });
         track->Start();
 
         memoryPools.resize(parameters.effectCount + parameters.voiceCount * 4);
         effects.resize(parameters.effectCount);
-        voices.resize(parameters.voiceCount, Voice(state));
+        effectOrder.reserve(parameters.effectCount);
+        voices.resize(parameters.voiceCount, Voice(state, waveBufferCache));
+
+        // Submixes aren't emulated so only the mix buffers that an effect on the final mix could address are allocated
+        mixBuffers.resize(std::clamp<size_t>(parameters.mixBufferCount, constant::StereoChannelCount, constant::MaxMixBuffers) * constant::MixBufferSize);
+
+        renderedVoices.reserve(parameters.voiceCount);
+        voiceOutputs.resize(parameters.voiceCount);
+        effectOutputs.resize(parameters.effectCount);
+
+        if (parameters.performanceManagerCount)
+            performanceManager.emplace(parameters.voiceCount + 1, parameters.effectCount);
+
+        constexpr size_t MaxWorkerCount{3};
+        size_t workerCount{std::min<size_t>(std::thread::hardware_concurrency() / 2, MaxWorkerCount)};
+        if (parameters.voiceCount >= ParallelVoiceThreshold && workerCount)
+            workerPool.emplace(workerCount, "Sky-AudioWork", [] {
+                signal::SetSignalHandler({SIGSEGV}, nce::NCE::HostSignalHandler); // Voices may write to NCE trapped memory in the audio memory pools
+            });
 
         // Fill track with empty samples that we will triple buffer
         track->AppendBuffer(0);
         track->AppendBuffer(1);
         track->AppendBuffer(2);
+
+        // The renderer thread is the only thread which appends buffers after this point
+        rendererThread = std::thread(&IAudioRenderer::RendererThread, this);
     }
 
     IAudioRenderer::~IAudioRenderer() {
+        {
+            std::scoped_lock lock{commandMutex};
+            rendererExit = true;
+        }
+        commandCondition.notify_all();
+        rendererThread.join();
+
         state.audio->CloseTrack(track);
+
+        Logger::Debug("Wave buffer cache: {} hits, {} misses ({:.1f}% hit rate), {} invalidations", waveBufferCache.hitCount.load(), waveBufferCache.missCount.load(), waveBufferCache.GetHitRate() * 100.0, waveBufferCache.invalidationCount.load());
+    }
+
+    void IAudioRenderer::RendererThread() {
+        if (int result{pthread_setname_np(pthread_self(), "Sky-AudioRender")})
+            Logger::Warn("Failed to set the thread name: {}", strerror(result));
+
+        try {
+            signal::SetSignalHandler({SIGINT, SIGILL, SIGTRAP, SIGBUS, SIGFPE}, signal::ExceptionalSignalHandler);
+            signal::SetSignalHandler({SIGSEGV}, nce::NCE::HostSignalHandler); // We may access NCE trapped memory in the audio memory pools
+
+            while (true) {
+                RenderCommandList commands;
+                {
+                    std::unique_lock lock{commandMutex};
+                    commandCondition.wait(lock, [this] { return rendererExit || !pendingCommands.empty(); });
+                    if (rendererExit)
+                        return;
+
+                    commands = std::move(pendingCommands.front());
+                    pendingCommands.pop_front();
+                }
+
+                ExecuteCommandList(commands);
+
+                std::scoped_lock lock{commandMutex};
+                freeCommands.push_back(std::move(commands));
+            }
+        } catch (const signal::SignalException &e) {
+            Logger::Error("{}\nStack Trace:{}", e.what(), state.loader->GetStackTrace(e.frames));
+            if (state.process)
+                state.process->Kill(false);
+            else
+                std::rethrow_exception(std::current_exception());
+        } catch (const std::exception &e) {
+            Logger::Error(e.what());
+            if (state.process)
+                state.process->Kill(false);
+            else
+                std::rethrow_exception(std::current_exception());
+        }
+    }
+
+    void IAudioRenderer::ExecuteCommandList(const RenderCommandList &commands) {
+        TRACE_EVENT("service", "IAudioRenderer::ExecuteCommandList");
+
+        for (size_t i{}; i < commands.voices.size(); i++)
+            voices[i].ProcessInput(commands.voices[i]);
+
+        size_t mixBufferCount{mixBuffers.size() / constant::MixBufferSize};
+        effectOrder.clear();
+        for (size_t i{}; i < commands.effects.size(); i++) {
+            effects[i].ProcessInput(commands.effects[i], mixBufferCount);
+            if (effects[i].Active())
+                effectOrder.push_back(i);
+        }
+        std::stable_sort(effectOrder.begin(), effectOrder.end(), [this](size_t a, size_t b) {
+            return effects[a].ProcessingOrder() < effects[b].ProcessingOrder();
+        });
+
+        UpdateAudio();
+
+        std::scoped_lock lock{outputMutex};
+        for (size_t i{}; i < voices.size(); i++)
+            voiceOutputs[i] = voices[i].output;
+        for (size_t i{}; i < effects.size(); i++)
+            effectOutputs[i] = effects[i].output;
     }
 
     Result IAudioRenderer::GetSampleRate(type::KSession &session, ipc::IpcRequest &request, ipc::IpcResponse &response) {
@@ -54,21 +155,35 @@ namespace skyline::service::audio::IAudioRenderer {
 
         span memoryPoolsIn(reinterpret_cast<MemoryPoolIn *>(input), memoryPools.size());
         input += inputHeader.memoryPoolSize;
-        for (size_t i{}; i < memoryPools.size(); i++)
-            memoryPools[i].ProcessInput(memoryPoolsIn[i]);
+        for (size_t i{}; i < memoryPools.size(); i++) {
+            const auto &memoryPoolIn{memoryPoolsIn[i]};
+            memoryPools[i].ProcessInput(memoryPoolIn);
+
+            // Wave buffers in a detached pool may be freed or reused by the guest at any point, so any decoded copies of them are dropped along with their traps
+            if (memoryPoolIn.state == MemoryPoolState::RequestDetach && memoryPoolIn.size)
+                waveBufferCache.Invalidate(span<u8>{reinterpret_cast<u8 *>(memoryPoolIn.address), memoryPoolIn.size});
+        }
 
         input += inputHeader.voiceResourceSize;
 
         span voicesIn(reinterpret_cast<VoiceIn *>(input), parameters.voiceCount);
         input += inputHeader.voiceSize;
-        for (u32 i{}; i < voicesIn.size(); i++)
-            voices[i].ProcessInput(voicesIn[i]);
 
         span effectsIn(reinterpret_cast<EffectIn *>(input), parameters.effectCount);
-        for (u32 i{}; i < effectsIn.size(); i++)
-            effects[i].ProcessInput(effectsIn[i]);
 
-        UpdateAudio();
+        {
+            std::scoped_lock lock{commandMutex};
+            RenderCommandList commands;
+            if (!freeCommands.empty()) {
+                commands = std::move(freeCommands.back());
+                freeCommands.pop_back();
+            }
+
+            commands.voices.assign(voicesIn.begin(), voicesIn.end());
+            commands.effects.assign(effectsIn.begin(), effectsIn.end());
+            pendingCommands.push_back(std::move(commands));
+        }
+        commandCondition.notify_one();
 
         UpdateDataHeader outputHeader{
             .revision = constant::RevMagic,
@@ -77,7 +192,7 @@ namespace skyline::service::audio::IAudioRenderer {
             .voiceSize = parameters.voiceCount * static_cast<u32>(sizeof(VoiceOut)),
             .effectSize = parameters.effectCount * static_cast<u32>(sizeof(EffectOut)),
             .sinkSize = parameters.sinkCount * 0x20,
-            .performanceManagerSize = 0x10,
+            .performanceManagerSize = sizeof(PerformanceManagerOut),
             .elapsedFrameCountInfoSize = 0x0
         };
 
@@ -104,15 +219,21 @@ namespace skyline::service::audio::IAudioRenderer {
             output += sizeof(MemoryPoolOut);
         }
 
-        for (const auto &voice : voices) {
-            *reinterpret_cast<VoiceOut *>(output) = voice.output;
-            output += sizeof(VoiceOut);
-        }
+        // Voice and effect outputs are from the last update that the renderer thread executed, the same as the DSP on HOS
+        std::scoped_lock lock{outputMutex};
+        std::memcpy(output, voiceOutputs.data(), voiceOutputs.size() * sizeof(VoiceOut));
+        output += outputHeader.voiceSize;
 
-        for (const auto &effect : effects) {
-            *reinterpret_cast<EffectOut *>(output) = effect.output;
-            output += sizeof(EffectOut);
-        }
+        std::memcpy(output, effectOutputs.data(), effectOutputs.size() * sizeof(EffectOut));
+        output += outputHeader.effectSize;
+
+        output += outputHeader.sinkSize;
+
+        // The performance history is written into a separate buffer which is optional
+        PerformanceManagerOut performanceOut{};
+        if (performanceManager)
+            performanceOut.historySize = performanceManager->CopyHistory(request.outputBuf.size() > 1 ? request.outputBuf[1] : span<u8>{});
+        *reinterpret_cast<PerformanceManagerOut *>(output) = performanceOut;
 
         return {};
     }
@@ -126,38 +247,79 @@ namespace skyline::service::audio::IAudioRenderer {
         }
     }
 
-    void IAudioRenderer::MixFinalBuffer() {
-        u32 writtenSamples{};
-
-        for (auto &voice : voices) {
-            if (!voice.Playable())
-                continue;
+    void IAudioRenderer::ApplyEffects() {
+        span<float> left{span(mixBuffers).first(constant::MixBufferSize)}, right{span(mixBuffers).subspan(constant::MixBufferSize, constant::MixBufferSize)};
+        skyline::audio::DeinterleaveStereo(left, right, mixBuffer);
+        std::fill(mixBuffers.begin() + (constant::StereoChannelCount * constant::MixBufferSize), mixBuffers.end(), 0.0f);
 
-            u32 bufferOffset{};
-            u32 pendingSamples{constant::MixBufferSize};
+        for (auto index : effectOrder) {
+            auto &effect{effects[index]};
+            TRACE_EVENT("service", "IAudioRenderer::ApplyEffect", "type", static_cast<u8>(effect.Type()));
 
-            while (pendingSamples > 0) {
-                u32 voiceBufferOffset{};
-                u32 voiceBufferSize{};
-                auto &voiceSamples{voice.GetBufferData(pendingSamples, voiceBufferOffset, voiceBufferSize)};
+            i64 start{util::GetTimeNs()};
+            effect.Apply(mixBuffers, constant::MixBufferSize);
+            i64 end{util::GetTimeNs()};
 
-                if (voiceBufferSize == 0)
-                    break;
+            effect.processingTime = end - start;
+            if (performanceManager)
+                performanceManager->AddDetail(static_cast<u32>(index), static_cast<u8>(effect.Type()), PerformanceEntryType::FinalMix, start, end);
+        }
 
-                pendingSamples -= voiceBufferSize / constant::StereoChannelCount;
+        skyline::audio::InterleaveStereo(mixBuffer, left, right);
+    }
 
-                for (auto index{voiceBufferOffset}; index < voiceBufferOffset + voiceBufferSize; index++) {
-                    if (writtenSamples == bufferOffset) {
-                        sampleBuffer[bufferOffset] = skyline::audio::Saturate<i16, i32>(voiceSamples[index] * voice.volume);
+    void IAudioRenderer::MixFinalBuffer() {
+        TRACE_EVENT("service", "IAudioRenderer::MixFinalBuffer");
+
+        if (performanceManager)
+            performanceManager->BeginFrame();
+
+        mixBuffer.fill(0);
+
+        renderedVoices.clear();
+        for (auto &voice : voices)
+            if (voice.Playable())
+                renderedVoices.push_back(RenderedVoice{.voice = &voice});
+
+        // Voices are independent of each other until they're mixed so they can be rendered in parallel, they're still mixed in order so the output is deterministic
+        std::function<void(size_t)> renderVoice{[this](size_t index) {
+            auto &rendered{renderedVoices[index]};
+            rendered.start = performanceManager ? util::GetTimeNs() : 0;
+            rendered.samples = rendered.voice->Render();
+            rendered.end = performanceManager ? util::GetTimeNs() : 0;
+        }};
+
+        if (workerPool && renderedVoices.size() >= ParallelVoiceThreshold) {
+            workerPool->Run(renderedVoices.size(), renderVoice);
+        } else {
+            for (size_t index{}; index < renderedVoices.size(); index++)
+                renderVoice(index);
+        }
 
-                        writtenSamples++;
-                    } else {
-                        sampleBuffer[bufferOffset] = skyline::audio::Saturate<i16, i32>(sampleBuffer[bufferOffset] + (voiceSamples[index] * voice.volume));
-                    }
+        for (auto &[voice, samples, start, end] : renderedVoices) {
+            if (!samples.empty()) {
+                // The volume is ramped from the volume at the end of the last mix to the current one across the entire mix to avoid discontinuities
+                float volumeDelta{(voice->volume - voice->mixedVolume) / constant::MixBufferSize};
+                skyline::audio::MixStereo(span{mixBuffer}.first(samples.size()), samples, voice->mixedVolume, volumeDelta);
 
-                    bufferOffset++;
-                }
+                voice->mixedVolume = voice->volume;
             }
+
+            if (performanceManager)
+                performanceManager->AddEntry(voice->nodeId, PerformanceEntryType::Voice, start, end);
+        }
+
+        i64 finalMixStart{performanceManager ? util::GetTimeNs() : 0};
+        if (!effectOrder.empty())
+            ApplyEffects();
+
+        skyline::audio::SaturateMix(sampleBuffer, mixBuffer);
+
+        if (performanceManager) {
+            performanceManager->AddEntry(0, PerformanceEntryType::FinalMix, finalMixStart, util::GetTimeNs());
+
+            std::scoped_lock lock{outputMutex};
+            performanceManager->EndFrame(0);
         }
     }
 
@@ -3,11 +3,15 @@
 
 #pragma once
 
+#include <deque>
+#include <common/worker_pool.h>
 #include <services/serviceman.h>
 #include <audio.h>
 #include "memory_pool.h"
 #include "effect.h"
+#include "performance_manager.h"
 #include "voice.h"
+#include "wave_buffer_cache.h"
 #include "revision_info.h"
 
 namespace skyline {
@@ -56,22 +60,75 @@ namespace skyline {
         };
         static_assert(sizeof(UpdateDataHeader) == 0x40);
 
+        /**
+         * @brief The commands generated by an update for the renderer thread, the guest's parameters are copied so its buffers can be reused as soon as RequestUpdate returns
+         */
+        struct RenderCommandList {
+            std::vector<VoiceIn> voices; //!< The parameters for every voice in order of their index
+            std::vector<EffectIn> effects; //!< The parameters for every effect in order of their index
+        };
+
+        /**
+         * @brief The result of rendering a single voice for a mix
+         */
+        struct RenderedVoice {
+            Voice *voice;
+            span<i16> samples;
+            i64 start; //!< The time at which rendering the voice started, this is only set with a performance manager
+            i64 end;
+        };
+
         /**
         * @brief IAudioRenderer is used to control an audio renderer output
         * @url https://switchbrew.org/wiki/Audio_services#IAudioRenderer
         */
         class IAudioRenderer : public BaseService {
           private:
+            static constexpr size_t ParallelVoiceThreshold{16}; //!< The minimum amount of playable voices for them to be rendered in parallel, below this waking the workers costs more than it saves
+
             AudioRendererParameters parameters;
             RevisionInfo revisionInfo{}; //!< Stores info about supported features for the audren revision used
             std::shared_ptr<skyline::audio::AudioTrack> track; //!< The audio track associated with the audio renderer
             std::shared_ptr<type::KEvent> systemEvent; //!< The KEvent that is signalled when the DSP has processed all the commands
             std::vector<MemoryPool> memoryPools;
             std::vector<Effect> effects;
+            std::vector<size_t> effectOrder; //!< The indices of all active effects in the order they should be applied
+            WaveBufferCache waveBufferCache; //!< The cache of decoded wave buffers shared by all voices, this must outlive them
             std::vector<Voice> voices;
+            std::vector<RenderedVoice> renderedVoices; //!< The voices which are being rendered for the current mix
+            std::optional<PerformanceManager> performanceManager; //!< The performance manager, this is only present if the guest requested one
+            std::array<float, constant::MixBufferSize * constant::StereoChannelCount> mixBuffer{}; //!< The buffer that voices are accumulated into prior to being saturated into the sample buffer
+            std::vector<float> mixBuffers; //!< Planar mix buffers of constant::MixBufferSize samples that effects are applied to, the first two are the left and right channels of the final mix
             std::array<i16, constant::MixBufferSize * constant::StereoChannelCount> sampleBuffer{}; //!< The final output data that is appended to the stream
             skyline::audio::AudioOutState playbackState{skyline::audio::AudioOutState::Stopped};
 
+            std::mutex outputMutex; //!< Synchronizes the outputs that the renderer thread publishes after executing a command list and the performance history
+            std::vector<VoiceOut> voiceOutputs; //!< The outputs of voices as of the last executed command list
+            std::vector<EffectOut> effectOutputs; //!< The outputs of effects as of the last executed command list
+
+            std::mutex commandMutex; //!< Synchronizes the command queues for commandCondition
+            std::condition_variable commandCondition; //!< Signalled when a command list is queued or the renderer thread should exit
+            std::deque<RenderCommandList> pendingCommands; //!< Command lists which have been generated but not executed yet
+            std::vector<RenderCommandList> freeCommands; //!< Executed command lists which are recycled to avoid reallocating them for every update
+            bool rendererExit{};
+            std::optional<WorkerPool> workerPool; //!< The workers that voices are partitioned across, this is only present if the guest requested enough voices
+            std::thread rendererThread; //!< The thread that executes command lists and mixes audio, like the DSP on HOS
+
+            /**
+             * @brief The entry point for the renderer thread, this executes command lists as they're queued
+             */
+            void RendererThread();
+
+            /**
+             * @brief Applies the parameters from a command list and mixes audio into any released buffers
+             */
+            void ExecuteCommandList(const RenderCommandList &commands);
+
+            /**
+             * @brief Applies all active effects to the final mix in their processing order
+             */
+            void ApplyEffects();
+
             /**
              * @brief Obtains new sample data from voices and mixes it together into the sample buffer
              * @return The amount of samples present in the buffer
@@ -90,7 +147,7 @@ namespace skyline {
             IAudioRenderer(const DeviceState &state, ServiceManager &manager, AudioRendererParameters &parameters);
 
             /**
-             * @brief Closes the audio track
+             * @brief Stops the renderer thread, closes the audio track and reports the wave buffer cache hit rate
              */
             ~IAudioRenderer();
 
@@ -119,7 +176,8 @@ namespace skyline {
             Result GetState(type::KSession &session, ipc::IpcRequest &request, ipc::IpcResponse &response);
 
             /**
-             * @brief Updates the audio renderer state and appends new data to playback buffers
+             * @brief Queues the guest's parameters for the renderer thread and returns the outputs from the last executed update
+             * @note This doesn't wait on rendering, it only copies parameters and outputs
              */
             Result RequestUpdate(type::KSession &session, ipc::IpcRequest &request, ipc::IpcResponse &response);
 
@@ -0,0 +1,201 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <audio/common.h>
+#include <audio/mixer.h>
+#include "effect.h"
+
+namespace skyline::service::audio::IAudioRenderer {
+    static constexpr float FromQ14(i64 value) {
+        return static_cast<float>(value) / (1 << 14);
+    }
+
+    void Effect::SetChannels(span<const i8> pInputs, span<const i8> pOutputs, size_t pChannelCount, size_t mixBufferCount, span<const float> pVolumes) {
+        channelCount = 0;
+        for (size_t channel{}; channel < std::min({pChannelCount, pInputs.size(), pOutputs.size()}); channel++) {
+            if (pInputs[channel] < 0 || pOutputs[channel] < 0 || static_cast<size_t>(pInputs[channel]) >= mixBufferCount || static_cast<size_t>(pOutputs[channel]) >= mixBufferCount)
+                continue;
+
+            inputs[channelCount] = static_cast<u8>(pInputs[channel]);
+            outputs[channelCount] = static_cast<u8>(pOutputs[channel]);
+            volumes[channelCount] = channel < pVolumes.size() ? pVolumes[channel] : 1.0f;
+            channelCount++;
+        }
+    }
+
+    void Effect::ProcessInput(const EffectIn &pInput, size_t mixBufferCount) {
+        bool isNew{pInput.isNew || pInput.type != input.type};
+        input = pInput;
+
+        if (isNew)
+            output.state = EffectState::New;
+        else
+            output.state = input.enabled ? EffectState::Enabled : EffectState::Disabled;
+
+        switch (input.type) {
+            case EffectType::BufferMixer: {
+                auto &parameter{*reinterpret_cast<const BufferMixerParameter *>(input.parameter.data())};
+                SetChannels(parameter.inputs, parameter.outputs, parameter.mixCount, mixBufferCount, parameter.volumes);
+                break;
+            }
+
+            case EffectType::Aux: {
+                auto &parameter{*reinterpret_cast<const AuxParameter *>(input.parameter.data())};
+                SetChannels(parameter.inputs, parameter.outputs, parameter.mixBufferCount, mixBufferCount);
+                break;
+            }
+
+            case EffectType::Delay: {
+                auto &parameter{*reinterpret_cast<const DelayParameter *>(input.parameter.data())};
+                SetChannels(parameter.inputs, parameter.outputs, parameter.channelCount, mixBufferCount);
+
+                constexpr u32 FramesPerMs{constant::SampleRate / 1000};
+                if (isNew || parameter.state == EffectParameterState::Initialized)
+                    delay.Resize(parameter.delayTimeMax * FramesPerMs);
+
+                delayParameters = {
+                    .delayFrames = std::min(parameter.delayTime, parameter.delayTimeMax) * FramesPerMs,
+                    .inGain = FromQ14(parameter.inGain),
+                    .feedbackGain = FromQ14(parameter.feedbackGain),
+                    .wetGain = FromQ14(parameter.wetGain),
+                    .dryGain = FromQ14(parameter.dryGain),
+                    .channelSpread = FromQ14(parameter.channelSpread),
+                    .lowPassAmount = FromQ14(parameter.lowPassAmount),
+                };
+                break;
+            }
+
+            case EffectType::Reverb: {
+                auto &parameter{*reinterpret_cast<const ReverbParameter *>(input.parameter.data())};
+                SetChannels(parameter.inputs, parameter.outputs, parameter.channelCount, mixBufferCount);
+
+                reverbParameters = {
+                    .earlyMode = parameter.earlyMode,
+                    .lateMode = parameter.lateMode,
+                    .earlyGain = FromQ14(parameter.earlyGain),
+                    .preDelayTime = FromQ14(parameter.preDelayTime),
+                    .lateGain = FromQ14(parameter.lateGain),
+                    .decayTime = FromQ14(parameter.decayTime),
+                    .highFrequencyDecayRatio = FromQ14(parameter.highFrequencyDecayRatio),
+                    .colouration = FromQ14(parameter.colouration),
+                    .baseGain = FromQ14(parameter.baseGain),
+                    .wetGain = FromQ14(parameter.wetGain),
+                    .dryGain = FromQ14(parameter.dryGain),
+                };
+
+                reverb.Initialize();
+                reverb.Update(reverbParameters);
+                if (isNew || parameter.state == EffectParameterState::Initialized)
+                    reverb.Reset();
+                break;
+            }
+
+            case EffectType::BiquadFilter: {
+                auto &parameter{*reinterpret_cast<const BiquadFilterParameter *>(input.parameter.data())};
+                SetChannels(parameter.inputs, parameter.outputs, static_cast<size_t>(std::max<i8>(parameter.channelCount, 0)), mixBufferCount);
+
+                biquadCoefficients = {
+                    .b0 = FromQ14(parameter.b[0]),
+                    .b1 = FromQ14(parameter.b[1]),
+                    .b2 = FromQ14(parameter.b[2]),
+                    .a1 = FromQ14(parameter.a[0]),
+                    .a2 = FromQ14(parameter.a[1]),
+                };
+
+                if (isNew || parameter.state == EffectParameterState::Initialized)
+                    biquadFilter.Reset();
+                break;
+            }
+
+            default:
+                if (isNew && input.type != EffectType::Invalid)
+                    Logger::Warn("Unsupported effect type: {}", static_cast<u8>(input.type));
+                channelCount = 0;
+                break;
+        }
+    }
+
+    void Effect::ApplyAux(span<const float *const> inputChannels, span<float *const> outputChannels, size_t frameCount) {
+        auto &parameter{*reinterpret_cast<const AuxParameter *>(input.parameter.data())};
+        auto sendInfo{reinterpret_cast<AuxBufferInfo *>(parameter.sendBufferInfo)}, returnInfo{reinterpret_cast<AuxBufferInfo *>(parameter.returnBufferInfo)};
+        auto sendBuffer{reinterpret_cast<i32 *>(parameter.sendBuffer)}, returnBuffer{reinterpret_cast<i32 *>(parameter.returnBuffer)};
+        u32 countMax{parameter.countMax};
+
+        if (!sendInfo || !returnInfo || !sendBuffer || !returnBuffer || countMax == 0) {
+            for (size_t channel{}; channel < inputChannels.size(); channel++)
+                if (inputChannels[channel] != outputChannels[channel])
+                    std::memcpy(outputChannels[channel], inputChannels[channel], frameCount * sizeof(float));
+            return;
+        }
+
+        // Every channel has a ring buffer of countMax samples in the send and return buffers, the offsets are shared between all channels
+        // Samples are only written into the free space of the send ring so samples the guest hasn't consumed yet aren't overwritten, a slot is left unused to distinguish a full ring from an empty one
+        u32 writeOffset{sendInfo->writeOffset % countMax}, sendFree{((sendInfo->readOffset % countMax) + countMax - writeOffset - 1) % countMax};
+        u32 sendCount{std::min<u32>(static_cast<u32>(frameCount), sendFree)};
+        for (size_t channel{}; channel < inputChannels.size(); channel++) {
+            auto ring{sendBuffer + (channel * countMax)};
+            for (u32 frame{}; frame < sendCount; frame++)
+                ring[(writeOffset + frame) % countMax] = static_cast<i32>(inputChannels[channel][frame]);
+        }
+        sendInfo->writeOffset = (writeOffset + sendCount) % countMax;
+        sendInfo->totalSampleCount += sendCount;
+        sendInfo->lostSampleCount += static_cast<u32>(frameCount) - sendCount;
+
+        u32 readOffset{returnInfo->readOffset % countMax};
+        u32 returnCount{std::min<u32>(static_cast<u32>(frameCount), ((returnInfo->writeOffset % countMax) + countMax - readOffset) % countMax)};
+        for (size_t channel{}; channel < outputChannels.size(); channel++) {
+            auto ring{returnBuffer + (channel * countMax)};
+            auto channelOutput{outputChannels[channel]};
+            for (u32 frame{}; frame < returnCount; frame++)
+                channelOutput[frame] = static_cast<float>(ring[(readOffset + frame) % countMax]);
+            std::fill(channelOutput + returnCount, channelOutput + frameCount, 0.0f); // The guest didn't return enough samples in time
+        }
+        returnInfo->readOffset = (readOffset + returnCount) % countMax;
+    }
+
+    void Effect::Apply(span<float> mixBuffers, size_t frameCount) {
+        std::array<const float *, constant::MaxMixBuffers> inputChannelArray;
+        std::array<float *, constant::MaxMixBuffers> outputChannelArray;
+        for (size_t channel{}; channel < channelCount; channel++) {
+            inputChannelArray[channel] = mixBuffers.data() + (inputs[channel] * constant::MixBufferSize);
+            outputChannelArray[channel] = mixBuffers.data() + (outputs[channel] * constant::MixBufferSize);
+        }
+        span<const float *const> inputChannels(inputChannelArray.data(), channelCount);
+        span<float *const> outputChannels(outputChannelArray.data(), channelCount);
+
+        if (!input.enabled) {
+            // Disabled effects pass their input through unmodified, a buffer mixer has no input of its own to pass through
+            if (input.type != EffectType::BufferMixer)
+                for (size_t channel{}; channel < channelCount; channel++)
+                    if (inputs[channel] != outputs[channel])
+                        std::memcpy(outputChannels[channel], inputChannels[channel], frameCount * sizeof(float));
+            return;
+        }
+
+        switch (input.type) {
+            case EffectType::BufferMixer:
+                for (size_t channel{}; channel < channelCount; channel++)
+                    skyline::audio::MixScaled(span(outputChannels[channel], frameCount), span<const float>(inputChannels[channel], frameCount), volumes[channel]);
+                break;
+
+            case EffectType::Aux:
+                ApplyAux(inputChannels, outputChannels, frameCount);
+                break;
+
+            case EffectType::Delay:
+                delay.Process(outputChannels, inputChannels, frameCount, delayParameters);
+                break;
+
+            case EffectType::Reverb:
+                reverb.Process(outputChannels, inputChannels, frameCount, reverbParameters);
+                break;
+
+            case EffectType::BiquadFilter:
+                biquadFilter.Process(outputChannels, inputChannels, frameCount, biquadCoefficients);
+                break;
+
+            default:
+                break;
+        }
+    }
+}
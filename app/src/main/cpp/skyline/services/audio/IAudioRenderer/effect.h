@@ -3,43 +3,213 @@
 
 #pragma once
 
+#include <audio/effects.h>
 #include <common.h>
 
-namespace skyline::service::audio::IAudioRenderer {
-    enum class EffectState : u8 {
-        None = 0, //!< The effect isn't being used
-        New = 1,
-    };
-
-    /**
-     * @brief Input containing information on what effects to use on an audio stream
-     */
-    struct EffectIn {
-        u8 _unk0_;
-        u8 isNew; //!< Whether the effect was used in the previous samples
-        u8 _unk1_[0xBE];
-    };
-    static_assert(sizeof(EffectIn) == 0xC0);
-
-    /**
-     * @brief Returned to inform the guest of the state of an effect
-     */
-    struct EffectOut {
-        EffectState state;
-        u8 _pad0_[15];
-    };
-    static_assert(sizeof(EffectOut) == 0x10);
-
-    /**
-     * @brief The Effect class stores the state of audio post processing effects
-     */
-    class Effect {
-      public:
-        EffectOut output{};
-
-        void ProcessInput(const EffectIn &input) {
-            if (input.isNew)
-                output.state = EffectState::New;
-        }
-    };
+namespace skyline {
+    namespace constant {
+        constexpr u8 MaxMixBuffers{24}; //!< The maximum amount of mix buffers that can be addressed by an effect
+    }
+
+    namespace service::audio::IAudioRenderer {
+        enum class EffectType : u8 {
+            Invalid = 0,
+            BufferMixer = 1,
+            Aux = 2,
+            Delay = 3,
+            Reverb = 4,
+            I3dl2Reverb = 5,
+            BiquadFilter = 6,
+        };
+
+        enum class EffectState : u8 {
+            None = 0, //!< The effect isn't being used
+            New = 1,
+            Enabled = 2,
+            Disabled = 3,
+        };
+
+        /**
+         * @brief The state of the type-specific parameters of an effect
+         */
+        enum class EffectParameterState : u8 {
+            Initialized = 0,
+            Updating = 1,
+            Updated = 2,
+        };
+
+        /**
+         * @brief Input containing information on what effects to use on an audio stream
+         */
+        struct EffectIn {
+            EffectType type;
+            u8 isNew; //!< Whether the effect was used in the previous samples
+            u8 enabled;
+            u8 _pad0_;
+            u32 mixId;
+            u64 workBuffer;
+            u64 workBufferSize;
+            u32 processingOrder; //!< The order in which effects are applied, effects with a lower value are applied first
+            u32 _pad1_;
+            std::array<u8, 0xA0> parameter; //!< The type-specific parameters of the effect, these are one of the *Parameter structures
+        };
+        static_assert(sizeof(EffectIn) == 0xC0);
+
+        /**
+         * @brief Returned to inform the guest of the state of an effect
+         */
+        struct EffectOut {
+            EffectState state;
+            u8 _pad0_[15];
+        };
+        static_assert(sizeof(EffectOut) == 0x10);
+
+        struct BufferMixerParameter {
+            std::array<i8, constant::MaxMixBuffers> inputs;
+            std::array<i8, constant::MaxMixBuffers> outputs;
+            std::array<float, constant::MaxMixBuffers> volumes;
+            u32 mixCount;
+        };
+        static_assert(sizeof(BufferMixerParameter) == 0x94);
+
+        struct AuxParameter {
+            std::array<i8, constant::MaxMixBuffers> inputs;
+            std::array<i8, constant::MaxMixBuffers> outputs;
+            u32 mixBufferCount;
+            u32 sampleRate;
+            u32 countMax; //!< The capacity of the send and return buffers in samples per channel
+            u32 mixBufferCountMax;
+            u64 sendBufferInfo;
+            u64 sendBuffer;
+            u64 returnBufferInfo;
+            u64 returnBuffer;
+            u32 mixBufferSampleSize;
+            u32 sampleCount;
+            u32 mixBufferSampleCount;
+        };
+        static_assert(sizeof(AuxParameter) == 0x70);
+
+        /**
+         * @brief The state of an aux ring buffer which is shared with the guest
+         */
+        struct AuxBufferInfo {
+            u32 readOffset;
+            u32 writeOffset;
+            u32 lostSampleCount;
+            u32 totalSampleCount;
+            u8 _pad0_[0x30];
+        };
+        static_assert(sizeof(AuxBufferInfo) == 0x40);
+
+        struct DelayParameter {
+            std::array<i8, skyline::audio::MaxEffectChannels> inputs;
+            std::array<i8, skyline::audio::MaxEffectChannels> outputs;
+            u16 channelCountMax;
+            u16 channelCount;
+            u32 delayTimeMax; //!< The maximum delay time in milliseconds
+            u32 delayTime;
+            u32 sampleRate; //!< Q14
+            u32 inGain; //!< Q14
+            u32 feedbackGain; //!< Q14
+            u32 wetGain; //!< Q14
+            u32 dryGain; //!< Q14
+            u32 channelSpread; //!< Q14
+            u32 lowPassAmount; //!< Q14
+            EffectParameterState state;
+        };
+        static_assert(sizeof(DelayParameter) == 0x38);
+
+        struct ReverbParameter {
+            std::array<i8, skyline::audio::MaxEffectChannels> inputs;
+            std::array<i8, skyline::audio::MaxEffectChannels> outputs;
+            u16 channelCountMax;
+            u16 channelCount;
+            u32 _unk0_;
+            u32 sampleRate;
+            skyline::audio::Reverb::EarlyMode earlyMode;
+            i32 earlyGain; //!< Q14
+            i32 preDelayTime; //!< Q14
+            skyline::audio::Reverb::LateMode lateMode;
+            i32 lateGain; //!< Q14
+            i32 decayTime; //!< Q14
+            i32 highFrequencyDecayRatio; //!< Q14
+            i32 colouration; //!< Q14
+            i32 baseGain; //!< Q14
+            i32 wetGain; //!< Q14
+            i32 dryGain; //!< Q14
+            EffectParameterState state;
+        };
+        static_assert(sizeof(ReverbParameter) == 0x48);
+
+        struct BiquadFilterParameter {
+            std::array<i8, skyline::audio::MaxEffectChannels> inputs;
+            std::array<i8, skyline::audio::MaxEffectChannels> outputs;
+            std::array<i16, 3> b; //!< Q14
+            std::array<i16, 2> a; //!< Q14
+            i8 channelCount;
+            EffectParameterState state;
+        };
+        static_assert(sizeof(BiquadFilterParameter) == 0x18);
+
+        /**
+         * @brief The Effect class stores the state of audio post processing effects and applies them to the mix buffers
+         * @note Submixes aren't emulated, the mix buffer indices of all effects are treated as being relative to the final mix
+         */
+        class Effect {
+          private:
+            EffectIn input{};
+            u8 channelCount{}; //!< The amount of valid entries in inputs and outputs
+            std::array<u8, constant::MaxMixBuffers> inputs{}; //!< The mix buffers that are read by the effect
+            std::array<u8, constant::MaxMixBuffers> outputs{}; //!< The mix buffers that are written by the effect
+            std::array<float, constant::MaxMixBuffers> volumes{}; //!< The volume of each channel, this is only used by buffer mixers
+
+            skyline::audio::BiquadFilter biquadFilter;
+            skyline::audio::BiquadCoefficients biquadCoefficients{};
+            skyline::audio::Delay delay;
+            skyline::audio::Delay::Parameters delayParameters{};
+            skyline::audio::Reverb reverb;
+            skyline::audio::Reverb::Parameters reverbParameters{};
+
+            /**
+             * @brief Copies the mix buffer indices and volumes of the effect from the guest parameters, channels with an out of range index are dropped
+             * @param volumes The per-channel volumes of the effect, channels without a volume are set to unity gain
+             */
+            void SetChannels(span<const i8> inputs, span<const i8> outputs, size_t channelCount, size_t mixBufferCount, span<const float> volumes = {});
+
+            /**
+             * @brief Writes the input channels into the send buffer and reads the output channels from the return buffer
+             */
+            void ApplyAux(span<const float *const> inputChannels, span<float *const> outputChannels, size_t frameCount);
+
+          public:
+            EffectOut output{};
+            i64 processingTime{}; //!< The time it took to apply the effect during the last mix in nanoseconds
+
+            /**
+             * @param mixBufferCount The amount of mix buffers in the renderer
+             */
+            void ProcessInput(const EffectIn &input, size_t mixBufferCount);
+
+            EffectType Type() const {
+                return input.type;
+            }
+
+            u32 ProcessingOrder() const {
+                return input.processingOrder;
+            }
+
+            /**
+             * @return If the effect will process any samples when Apply() is called
+             */
+            bool Active() const {
+                return input.type != EffectType::Invalid && channelCount != 0;
+            }
+
+            /**
+             * @brief Applies the effect to the mix buffers
+             * @param mixBuffers Planar mix buffers with constant::MixBufferSize samples each
+             */
+            void Apply(span<float> mixBuffers, size_t frameCount);
+        };
+    }
 }
@@ -0,0 +1,91 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <audio/common.h>
+#include "performance_manager.h"
+
+namespace skyline::service::audio::IAudioRenderer {
+    PerformanceManager::PerformanceManager(size_t maxEntries, size_t maxDetails)
+        : history(MaxFrames * (sizeof(PerformanceFrameHeader) + (maxEntries * sizeof(PerformanceEntry)) + (maxDetails * sizeof(PerformanceDetail)))) {
+        entries.reserve(maxEntries);
+        details.reserve(maxDetails);
+    }
+
+    u32 PerformanceManager::ToFrameTime(i64 time) const {
+        return static_cast<u32>(std::max<i64>(time - frameStart, 0) / constant::NsInMicrosecond);
+    }
+
+    void PerformanceManager::BeginFrame() {
+        entries.clear();
+        details.clear();
+        frameStart = util::GetTimeNs();
+    }
+
+    void PerformanceManager::AddEntry(u32 nodeId, PerformanceEntryType entryType, i64 start, i64 end) {
+        if (entries.size() == entries.capacity())
+            return;
+
+        entries.push_back(PerformanceEntry{
+            .nodeId = nodeId,
+            .startTime = ToFrameTime(start),
+            .processingTime = static_cast<u32>((end - start) / constant::NsInMicrosecond),
+            .entryType = entryType,
+        });
+    }
+
+    void PerformanceManager::AddDetail(u32 nodeId, u8 detailType, PerformanceEntryType entryType, i64 start, i64 end) {
+        if (details.size() == details.capacity())
+            return;
+
+        details.push_back(PerformanceDetail{
+            .nodeId = nodeId,
+            .startTime = ToFrameTime(start),
+            .processingTime = static_cast<u32>((end - start) / constant::NsInMicrosecond),
+            .detailType = detailType,
+            .entryType = entryType,
+        });
+    }
+
+    void PerformanceManager::EndFrame(u32 voicesDropped) {
+        size_t frameSize{sizeof(PerformanceFrameHeader) + (entries.size() * sizeof(PerformanceEntry)) + (details.size() * sizeof(PerformanceDetail))};
+        if (historySize + frameSize > history.size())
+            return; // The guest hasn't requested the history in a while, it's fine to drop frames as they're only informational
+
+        i64 frameEnd{util::GetTimeNs()};
+        PerformanceFrameHeader header{
+            .magic = PerformanceFrameHeader::Magic,
+            .entryCount = static_cast<u32>(entries.size()),
+            .detailCount = static_cast<u32>(details.size()),
+            .nextOffset = static_cast<u32>(frameSize),
+            .totalProcessingTime = ToFrameTime(frameEnd),
+            .voicesDropped = voicesDropped,
+            .startTime = static_cast<u64>(frameStart / constant::NsInMicrosecond),
+            .frameIndex = frameIndex++,
+            .renderTimeExceeded = (frameEnd - frameStart) > (constant::NsInSecond / (constant::SampleRate / constant::MixBufferSize)),
+        };
+
+        auto frame{history.data() + historySize};
+        std::memcpy(frame, &header, sizeof(PerformanceFrameHeader));
+        frame += sizeof(PerformanceFrameHeader);
+        std::memcpy(frame, entries.data(), entries.size() * sizeof(PerformanceEntry));
+        frame += entries.size() * sizeof(PerformanceEntry);
+        std::memcpy(frame, details.data(), details.size() * sizeof(PerformanceDetail));
+
+        historySize += frameSize;
+    }
+
+    u32 PerformanceManager::CopyHistory(span<u8> output) {
+        // Only whole frames are copied, frames are walked through their next offset to find the last one that fits
+        size_t copySize{};
+        while (copySize < historySize) {
+            auto frameSize{reinterpret_cast<PerformanceFrameHeader *>(history.data() + copySize)->nextOffset};
+            if (copySize + frameSize > output.size())
+                break;
+            copySize += frameSize;
+        }
+
+        std::memcpy(output.data(), history.data(), copySize);
+        historySize = 0;
+        return static_cast<u32>(copySize);
+    }
+}
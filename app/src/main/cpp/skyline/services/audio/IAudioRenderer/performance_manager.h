@@ -0,0 +1,110 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <common.h>
+
+namespace skyline::service::audio::IAudioRenderer {
+    enum class PerformanceEntryType : u8 {
+        Invalid = 0,
+        Voice = 1,
+        SubMix = 2,
+        FinalMix = 3,
+        Sink = 4,
+    };
+
+    /**
+     * @brief The header of a single frame of performance history, this is followed by all entries and then all details of the frame
+     * @note All times are in microseconds, the start times of entries are relative to the start of the frame
+     */
+    struct PerformanceFrameHeader {
+        static constexpr u32 Magic{util::MakeMagic<u32>("PERF")};
+
+        u32 magic;
+        u32 entryCount;
+        u32 detailCount;
+        u32 nextOffset; //!< The offset of the next frame from the start of this one
+        u32 totalProcessingTime;
+        u32 voicesDropped;
+        u64 startTime;
+        u32 frameIndex;
+        bool renderTimeExceeded;
+        u8 _pad0_[0xB];
+    };
+    static_assert(sizeof(PerformanceFrameHeader) == 0x30);
+
+    struct PerformanceEntry {
+        u32 nodeId;
+        u32 startTime;
+        u32 processingTime;
+        PerformanceEntryType entryType;
+        u8 _pad0_[0xB];
+    };
+    static_assert(sizeof(PerformanceEntry) == 0x18);
+
+    /**
+     * @brief The timing of a single command within an entry such as an effect
+     */
+    struct PerformanceDetail {
+        u32 nodeId;
+        u32 startTime;
+        u32 processingTime;
+        u8 detailType; //!< The EffectType of the effect that was applied
+        PerformanceEntryType entryType;
+        u8 _pad0_[0xA];
+    };
+    static_assert(sizeof(PerformanceDetail) == 0x18);
+
+    /**
+     * @brief Returned to inform the guest of the amount of performance history written into the performance buffer
+     */
+    struct PerformanceManagerOut {
+        u32 historySize;
+        u8 _pad0_[0xC];
+    };
+    static_assert(sizeof(PerformanceManagerOut) == 0x10);
+
+    /**
+     * @brief The PerformanceManager class records the time taken by every stage of a mix and provides it to the guest as performance history
+     * @note All storage is allocated upfront, recording a frame doesn't allocate
+     */
+    class PerformanceManager {
+      private:
+        static constexpr size_t MaxFrames{4}; //!< The maximum amount of frames that are retained between updates, any further frames are dropped
+
+        std::vector<PerformanceEntry> entries;
+        std::vector<PerformanceDetail> details;
+        std::vector<u8> history; //!< Completed frames that haven't been copied to the guest yet
+        size_t historySize{}; //!< The amount of valid bytes in history
+        i64 frameStart{};
+        u32 frameIndex{};
+
+        u32 ToFrameTime(i64 time) const;
+
+      public:
+        /**
+         * @param maxEntries The maximum amount of entries in a single frame
+         * @param maxDetails The maximum amount of details in a single frame
+         */
+        PerformanceManager(size_t maxEntries, size_t maxDetails);
+
+        void BeginFrame();
+
+        /**
+         * @param start The time at which the entry started in nanoseconds, as returned by util::GetTimeNs()
+         * @param end The time at which the entry ended in nanoseconds
+         */
+        void AddEntry(u32 nodeId, PerformanceEntryType entryType, i64 start, i64 end);
+
+        void AddDetail(u32 nodeId, u8 detailType, PerformanceEntryType entryType, i64 start, i64 end);
+
+        void EndFrame(u32 voicesDropped);
+
+        /**
+         * @brief Copies as many complete frames of history as fit into the supplied buffer and discards all history
+         * @return The amount of bytes that were copied
+         */
+        u32 CopyHistory(span<u8> output);
+    };
+}
@@ -2,23 +2,32 @@
 // Copyright © 2020 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
 #include <kernel/types/KProcess.h>
+#include <common/settings.h>
 #include <audio/downmixer.h>
 #include "voice.h"
 
 namespace skyline::service::audio::IAudioRenderer {
     void Voice::SetWaveBufferIndex(u8 index) {
         bufferIndex = index & 3;
-        bufferReload = true;
+        sampleOffset = 0;
+        adpcmFrameIndex = InvalidAdpcmFrame;
+        decodedBuffer = nullptr;
     }
 
-    Voice::Voice(const DeviceState &state) : state(state) {}
+    void Voice::ResetStream() {
+        resampler.Reset();
+        if (adpcmDecoder)
+            adpcmDecoder->Reset();
+        std::fill(inputBuffer.begin(), inputBuffer.end(), 0);
+    }
+
+    Voice::Voice(const DeviceState &state, WaveBufferCache &waveBufferCache) : state(state), waveBufferCache(waveBufferCache) {}
 
     void Voice::ProcessInput(const VoiceIn &input) {
         // Voice no longer in use, reset it
         if (acquired && !input.acquired) {
-            bufferReload = true;
-            bufferIndex = 0;
-            sampleOffset = 0;
+            SetWaveBufferIndex(0);
+            ResetStream();
 
             output.playedSamplesCount = 0;
             output.playedWaveBuffersCount = 0;
@@ -35,99 +44,197 @@ namespace skyline::service::audio::IAudioRenderer {
                 throw exception("Unsupported voice PCM format: {}", input.format);
 
             format = input.format;
+
+            if (input.sampleRate == 0)
+                throw exception("Invalid voice sample rate: {}", input.sampleRate);
+
             sampleRate = input.sampleRate;
+            resampleStep = skyline::audio::Resampler::GetStep(sampleRate, constant::SampleRate);
 
-            if (input.channelCount > (input.format == skyline::audio::AudioFormat::ADPCM ? 1 : 6))
+            if (input.channelCount == 0 || input.channelCount > (input.format == skyline::audio::AudioFormat::ADPCM ? 1 : 6))
                 throw exception("Unsupported voice channel count: {}", input.channelCount);
 
             channelCount = static_cast<u8>(input.channelCount);
 
             if (input.format == skyline::audio::AudioFormat::ADPCM) {
-                std::vector<std::array<i16, 2>> adpcmCoefficients(input.adpcmCoeffsSize / (sizeof(u16) * 2));
-                span(adpcmCoefficients).copy_from(span(input.adpcmCoeffs, input.adpcmCoeffsSize / sizeof(u32)));
+                span<const std::array<i16, 2>> adpcmCoefficients(reinterpret_cast<const std::array<i16, 2> *>(input.adpcmCoeffs), input.adpcmCoeffsSize / sizeof(std::array<i16, 2>));
+                adpcmDecoder = skyline::audio::AdpcmDecoder(adpcmCoefficients);
+                this->adpcmCoefficients = input.adpcmCoeffs;
+            }
+
+            resampler = skyline::audio::Resampler{*state.settings->highQualityResampling ? skyline::audio::ResamplerQuality::High : skyline::audio::ResamplerQuality::Standard};
 
-                adpcmDecoder = skyline::audio::AdpcmDecoder(std::move(adpcmCoefficients));
+            // The pipeline buffers are sized for the largest amount of source frames a single mix could require, they aren't reallocated after this
+            if (sampleRate == constant::SampleRate) {
+                inputBuffer.resize(constant::MixBufferSize * channelCount);
+            } else {
+                size_t maxInputFrames{((constant::MixBufferSize * static_cast<u64>(resampleStep)) >> 15) + 1};
+                inputBuffer.resize((resampler.GetHistoryFrames() + maxInputFrames) * channelCount);
+                resampleBuffer.resize(constant::MixBufferSize * channelCount);
             }
 
             SetWaveBufferIndex(static_cast<u8>(input.baseWaveBufferIndex));
+            ResetStream();
+            mixedVolume = input.volume; // A newly added voice shouldn't be faded in
         }
 
         waveBuffers = input.waveBuffers;
+        nodeId = input.nodeId;
         volume = input.volume;
         playbackState = input.playbackState;
     }
 
-    void Voice::UpdateBuffers() {
-        const auto &currentBuffer{waveBuffers.at(bufferIndex)};
-        span buffer(currentBuffer.pointer, currentBuffer.size);
+    size_t Voice::ReadFrames(span<i16> frames) {
+        size_t framesRead{}, frameCount{frames.size() / channelCount};
 
-        if (currentBuffer.size == 0)
-            return;
-
-        switch (format) {
-            case skyline::audio::AudioFormat::Int16:
-                samples.resize(currentBuffer.size / sizeof(i16));
-                span(samples).copy_from(buffer);
+        while (framesRead < frameCount && playbackState == skyline::audio::AudioOutState::Started) {
+            const auto &currentBuffer{waveBuffers[bufferIndex]};
+            if (currentBuffer.size == 0)
                 break;
-            case skyline::audio::AudioFormat::ADPCM: {
-                samples = adpcmDecoder->Decode(buffer);
+
+            using AdpcmDecoder = skyline::audio::AdpcmDecoder;
+            size_t bufferFrames{format == skyline::audio::AudioFormat::ADPCM ? (currentBuffer.size / AdpcmDecoder::BytesPerFrame) * AdpcmDecoder::SamplesPerFrame : currentBuffer.size / (sizeof(i16) * channelCount)};
+            if (bufferFrames == 0)
                 break;
+
+            span buffer(currentBuffer.pointer, currentBuffer.size);
+            auto destination{frames.subspan(framesRead * channelCount, (frameCount - framesRead) * channelCount)};
+            size_t target{std::min<size_t>(bufferFrames - std::min<size_t>(sampleOffset, bufferFrames), frameCount - framesRead)}, read{}; // The offset may be past the end if the guest shrunk the buffer
+
+            switch (format) {
+                case skyline::audio::AudioFormat::Int16:
+                    std::memcpy(destination.data(), buffer.data() + (sampleOffset * channelCount * sizeof(i16)), target * channelCount * sizeof(i16));
+                    read = target;
+                    break;
+
+                case skyline::audio::AudioFormat::ADPCM:
+                    // Buffers are decoded in their entirety through the cache when they start playing, this avoids decoding looped buffers repeatedly
+                    if (!decodedBuffer && sampleOffset == 0 && bufferFrames <= WaveBufferCache::MaxEntrySamples) {
+                        WaveBufferCache::Key key{
+                            .pointer = currentBuffer.pointer,
+                            .size = currentBuffer.size,
+                            .coefficients = adpcmCoefficients,
+                            .history = adpcmDecoder->GetHistory(),
+                            .channelCount = channelCount,
+                            .format = format,
+                        };
+
+                        decodedBuffer = waveBufferCache.Lookup(key);
+                        if (!decodedBuffer)
+                            decodedBuffer = waveBufferCache.Insert(key, bufferFrames, [&](span<i16> samples) {
+                                adpcmDecoder->Decode(buffer, samples);
+                                return adpcmDecoder->GetHistory();
+                            });
+                    }
+
+                    if (decodedBuffer && decodedBuffer->key.pointer == currentBuffer.pointer && decodedBuffer->key.size == currentBuffer.size) {
+                        std::memcpy(destination.data(), decodedBuffer->samples.data() + sampleOffset, target * sizeof(i16));
+                        read = target;
+                        break;
+                    }
+
+                    decodedBuffer = nullptr; // The guest changed the current wave buffer after it was decoded, the remainder of it is streamed
+                    while (read < target) {
+                        size_t offset{sampleOffset + read};
+                        u32 frameIndex{static_cast<u32>(offset / AdpcmDecoder::SamplesPerFrame)};
+                        size_t frameOffset{offset % AdpcmDecoder::SamplesPerFrame};
+                        auto frameData{buffer.subspan(frameIndex * AdpcmDecoder::BytesPerFrame)};
+
+                        if (frameOffset == 0 && target - read >= AdpcmDecoder::SamplesPerFrame) {
+                            // Whole frames are decoded directly into the output, the last one is kept for any partial reads that follow
+                            size_t wholeSamples{((target - read) / AdpcmDecoder::SamplesPerFrame) * AdpcmDecoder::SamplesPerFrame};
+                            read += adpcmDecoder->Decode(frameData, destination.subspan(read, wholeSamples));
+                            std::memcpy(adpcmFrame.data(), destination.data() + read - AdpcmDecoder::SamplesPerFrame, sizeof(adpcmFrame));
+                            adpcmFrameIndex = frameIndex + static_cast<u32>(wholeSamples / AdpcmDecoder::SamplesPerFrame) - 1;
+                        } else {
+                            if (adpcmFrameIndex != frameIndex) {
+                                adpcmDecoder->Decode(frameData.first(AdpcmDecoder::BytesPerFrame), adpcmFrame);
+                                adpcmFrameIndex = frameIndex;
+                            }
+
+                            size_t frameRead{std::min(AdpcmDecoder::SamplesPerFrame - frameOffset, target - read)};
+                            std::memcpy(destination.data() + read, adpcmFrame.data() + frameOffset, frameRead * sizeof(i16));
+                            read += frameRead;
+                        }
+                    }
+                    break;
+
+                default:
+                    throw exception("Unsupported PCM format used by Voice: {}", format);
             }
-            default:
-                throw exception("Unsupported PCM format used by Voice: {}", format);
-        }
 
-        if (sampleRate != constant::SampleRate)
-            samples = resampler.ResampleBuffer(samples, static_cast<double>(sampleRate) / constant::SampleRate, channelCount);
+            framesRead += read;
+            sampleOffset += read;
+            output.playedSamplesCount += read;
 
-        if (channelCount == 1 && constant::StereoChannelCount != channelCount) {
-            auto originalSize{samples.size()};
-            samples.resize((originalSize / channelCount) * constant::StereoChannelCount);
+            if (sampleOffset >= bufferFrames) {
+                output.playedWaveBuffersCount++;
 
-            for (auto monoIndex{originalSize - 1}, targetIndex{samples.size()}; monoIndex > 0; monoIndex--) {
-                auto sample{samples[monoIndex]};
-                for (u8 i{}; i < constant::StereoChannelCount; i++)
-                    samples[--targetIndex] = sample;
+                if (decodedBuffer)
+                    adpcmDecoder->SetHistory(decodedBuffer->finalHistory); // The history wasn't advanced when the buffer was read from the cache
+
+                if (currentBuffer.lastBuffer)
+                    playbackState = skyline::audio::AudioOutState::Paused;
+
+                if (currentBuffer.looping)
+                    SetWaveBufferIndex(bufferIndex);
+                else
+                    SetWaveBufferIndex(static_cast<u8>(bufferIndex + 1));
             }
         }
 
-        if (channelCount == constant::SurroundChannelCount) {
-            span(samples).copy_from(span(skyline::audio::DownMix(span(samples).cast<skyline::audio::Surround51Sample>())));
-            samples.resize((samples.size() / constant::SurroundChannelCount) * constant::StereoChannelCount);
-        }
+        return framesRead;
     }
 
-    std::vector<i16> &Voice::GetBufferData(u32 maxSamples, u32 &outOffset, u32 &outSize) {
-        auto &currentBuffer{waveBuffers.at(bufferIndex)};
+    span<i16> Voice::Render() {
+        constexpr size_t OutputFrames{constant::MixBufferSize};
 
-        if (!acquired || playbackState != skyline::audio::AudioOutState::Started) {
-            outSize = 0;
-            return samples;
-        }
+        if (!acquired || playbackState != skyline::audio::AudioOutState::Started)
+            return {};
 
-        if (bufferReload) {
-            bufferReload = false;
-            UpdateBuffers();
-        }
+        span<i16> source;
+        size_t frameCount;
+        if (sampleRate == constant::SampleRate) {
+            frameCount = ReadFrames(span(inputBuffer).first(OutputFrames * channelCount));
+            source = span(inputBuffer).first(frameCount * channelCount);
+        } else {
+            // The last frames of the previous mix's input are retained at the start of the input buffer for the resampler
+            size_t historySamples{resampler.GetHistoryFrames() * channelCount};
+            size_t inputSamples{resampler.GetInputFrameCount(OutputFrames, resampleStep) * channelCount};
+            auto input{span(inputBuffer).subspan(historySamples, inputSamples)};
 
-        outOffset = sampleOffset;
-        outSize = std::min(maxSamples * constant::StereoChannelCount, static_cast<u32>(samples.size() - sampleOffset));
+            size_t readSamples{ReadFrames(input) * channelCount};
+            std::fill(input.begin() + static_cast<ssize_t>(readSamples), input.end(), 0); // The stream is padded with silence if it ended so the tail is still played out
 
-        output.playedSamplesCount += outSize / constant::StereoChannelCount;
-        sampleOffset += outSize;
+            resampler.Resample(span(inputBuffer).first(historySamples + inputSamples), resampleBuffer, resampleStep, channelCount);
+            std::memmove(inputBuffer.data(), inputBuffer.data() + inputSamples, historySamples * sizeof(i16));
 
-        if (sampleOffset == samples.size()) {
-            sampleOffset = 0;
+            frameCount = OutputFrames;
+            source = span(resampleBuffer);
+        }
 
-            if (currentBuffer.lastBuffer)
-                playbackState = skyline::audio::AudioOutState::Paused;
+        switch (channelCount) {
+            case 1:
+                for (size_t frame{}; frame < frameCount; frame++)
+                    outputBuffer[frame * 2] = outputBuffer[(frame * 2) + 1] = source[frame];
+                break;
+
+            case constant::StereoChannelCount:
+                return source;
 
-            if (!currentBuffer.looping)
-                SetWaveBufferIndex(static_cast<u8>(bufferIndex + 1));
+            case constant::SurroundChannelCount:
+                skyline::audio::DownMix(source.cast<skyline::audio::Surround51Sample>(), span(outputBuffer).cast<skyline::audio::StereoSample>());
+                break;
 
-            output.playedWaveBuffersCount++;
+            default:
+                // Layouts without a downmix only have their front channels played
+                for (size_t frame{}; frame < frameCount; frame++) {
+                    outputBuffer[frame * 2] = source[frame * channelCount];
+                    outputBuffer[(frame * 2) + 1] = source[(frame * channelCount) + 1];
+                }
+                break;
         }
 
-        return samples;
+        return span(outputBuffer).first(frameCount * constant::StereoChannelCount);
     }
 }
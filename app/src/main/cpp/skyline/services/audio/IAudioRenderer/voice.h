@@ -6,6 +6,7 @@
 #include <audio/resampler.h>
 #include <audio/adpcm_decoder.h>
 #include <audio.h>
+#include "wave_buffer_cache.h"
 
 namespace skyline::service::audio::IAudioRenderer {
     struct BiquadFilter {
@@ -71,28 +72,41 @@ namespace skyline::service::audio::IAudioRenderer {
 
     /**
      * @brief The Voice class manages an audio voice
+     * @note Voices are rendered as a stream, only the source data that's required for a mix is decoded and resampled into buffers which are allocated when the voice is first updated
      */
     class Voice {
       private:
+        static constexpr u32 InvalidAdpcmFrame{std::numeric_limits<u32>::max()}; //!< The value of adpcmFrameIndex when there's no cached frame
+
         const DeviceState &state;
+        WaveBufferCache &waveBufferCache;
         std::array<WaveBuffer, 4> waveBuffers;
-        std::vector<i16> samples; //!< A vector containing processed sample data
         skyline::audio::Resampler resampler; //!< The resampler object used for changing the sample rate of a wave buffer's stream
         std::optional<skyline::audio::AdpcmDecoder> adpcmDecoder;
 
+        std::vector<i16> inputBuffer; //!< Source frames for the current mix, these are preceded by the resampler history if the voice is resampled
+        std::vector<i16> resampleBuffer; //!< Resampled frames in the channel layout of the source
+        std::array<i16, constant::MixBufferSize * constant::StereoChannelCount> outputBuffer{}; //!< Stereo frames for the current mix
+        std::array<i16, skyline::audio::AdpcmDecoder::SamplesPerFrame> adpcmFrame{}; //!< A cache of the last decoded ADPCM frame for when only part of it is consumed
+        u32 adpcmFrameIndex{InvalidAdpcmFrame}; //!< The index of the frame in adpcmFrame within the current wave buffer
+        const u32 *adpcmCoefficients{}; //!< The guest address of the ADPCM coefficients, this identifies the coefficients in cache keys
+        std::shared_ptr<const WaveBufferCache::Entry> decodedBuffer; //!< The decoded samples of the current wave buffer, this is only used for ADPCM buffers which are small enough to be cached
+
         bool acquired{false}; //!< If the voice is in use
-        bool bufferReload{true};
         u8 bufferIndex{}; //!< The index of the wave buffer currently in use
-        u32 sampleOffset{}; //!< The offset in the sample data of the current wave buffer
+        u32 sampleOffset{}; //!< The offset in frames into the current wave buffer
         u32 sampleRate{};
+        u32 resampleStep{}; //!< The step of the resampler between output frames, see Resampler::GetStep()
         u8 channelCount{};
         skyline::audio::AudioOutState playbackState{skyline::audio::AudioOutState::Stopped};
         skyline::audio::AudioFormat format{skyline::audio::AudioFormat::Invalid};
 
         /**
-         * @brief Updates the sample buffer with data from the current wave buffer and processes it
+         * @brief Reads source frames from the wave buffers and advances through them
+         * @param output The buffer to read interleaved frames into, its size determines the amount of frames that are read
+         * @return The amount of frames that were read, this is less than requested if the voice ran out of wave buffers
          */
-        void UpdateBuffers();
+        size_t ReadFrames(span<i16> output);
 
         /**
          * @brief Sets the current wave buffer index to use
@@ -100,11 +114,18 @@ namespace skyline::service::audio::IAudioRenderer {
          */
         void SetWaveBufferIndex(u8 index);
 
+        /**
+         * @brief Resets the state of the streaming pipeline
+         */
+        void ResetStream();
+
       public:
         VoiceOut output{};
+        u32 nodeId{}; //!< The ID of the voice in the guest's audio graph, this is used to identify it in performance history
         float volume{};
+        float mixedVolume{}; //!< The volume the voice was mixed at by the end of the last mix, this is ramped towards volume during the next mix
 
-        Voice(const DeviceState &state);
+        Voice(const DeviceState &state, WaveBufferCache &waveBufferCache);
 
         /**
          * @brief Reads the input voice data from the guest and sets internal data based off it
@@ -113,11 +134,10 @@ namespace skyline::service::audio::IAudioRenderer {
         void ProcessInput(const VoiceIn &input);
 
         /**
-         * @brief Obtains the voices audio sample data, updating it if required
-         * @param maxSamples The maximum amount of samples the output buffer should contain
-         * @return A vector of I16 PCM sample data
+         * @brief Renders the voice for a single mix
+         * @return Interleaved stereo samples for the mix, this may contain less than a full mix of frames if the voice stopped playing
          */
-        std::vector<i16> &GetBufferData(u32 maxSamples, u32 &outOffset, u32 &outSize);
+        span<i16> Render();
 
         /**
          * @return If the voice is currently playable
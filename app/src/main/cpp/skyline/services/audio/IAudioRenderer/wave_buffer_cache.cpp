@@ -0,0 +1,95 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <common/trace.h>
+#include "wave_buffer_cache.h"
+
+namespace skyline::service::audio::IAudioRenderer {
+    WaveBufferCache::Entry::Entry(const Key &key) : key{key} {}
+
+    WaveBufferCache::WaveBufferCache(const DeviceState &state) : state{state} {}
+
+    WaveBufferCache::~WaveBufferCache() {
+        std::scoped_lock lock{mutex};
+        while (!entries.empty())
+            Erase(entries.begin());
+    }
+
+    void WaveBufferCache::Erase(std::list<std::shared_ptr<Entry>>::iterator it) {
+        auto &entry{*it};
+        if (entry->trapHandle)
+            state.nce->DeleteTrap(*entry->trapHandle); // Once this returns the trap callback can't be running, so the entry can safely outlive the cache
+
+        cachedSamples -= entry->samples.size();
+        entryMap.erase(entry->key);
+        entries.erase(it);
+    }
+
+    std::shared_ptr<const WaveBufferCache::Entry> WaveBufferCache::Lookup(const Key &key) {
+        std::scoped_lock lock{mutex};
+
+        auto it{entryMap.find(key)};
+        if (it == entryMap.end()) {
+            missCount.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        auto entryIt{it->second};
+        if ((*entryIt)->dirty.load(std::memory_order_acquire)) {
+            Erase(entryIt);
+            invalidationCount.fetch_add(1, std::memory_order_relaxed);
+            missCount.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        entries.splice(entries.begin(), entries, entryIt);
+        hitCount.fetch_add(1, std::memory_order_relaxed);
+        return *entryIt;
+    }
+
+    std::shared_ptr<const WaveBufferCache::Entry> WaveBufferCache::Insert(const Key &key, size_t sampleCount, const DecodeFunction &decode) {
+        TRACE_EVENT("service", "WaveBufferCache::Insert", "size", key.size);
+
+        auto entry{std::make_shared<Entry>(key)};
+        entry->samples.resize(sampleCount);
+
+        // The buffer is trapped prior to decoding it so any guest writes that occur while it's being decoded will mark the entry as dirty
+        std::array<span<u8>, 1> regions{span<u8>{key.pointer, key.size}};
+        entry->trapHandle = state.nce->CreateTrap(regions, [] {}, [] { return true; }, [weakEntry = std::weak_ptr<Entry>{entry}] {
+            if (auto entry{weakEntry.lock()})
+                entry->dirty.store(true, std::memory_order_release);
+            return true;
+        });
+        state.nce->TrapRegions(*entry->trapHandle, true);
+
+        entry->finalHistory = decode(entry->samples); // Decoding is done without holding the lock so other voices can look up entries in the meantime
+
+        std::scoped_lock lock{mutex};
+
+        // Another voice may have decoded the same buffer concurrently, the newer entry replaces it
+        if (auto it{entryMap.find(key)}; it != entryMap.end())
+            Erase(it->second);
+
+        while (!entries.empty() && cachedSamples + sampleCount > MaxCacheSamples)
+            Erase(std::prev(entries.end()));
+
+        entries.push_front(entry);
+        entryMap.emplace(key, entries.begin());
+        cachedSamples += sampleCount;
+        return entry;
+    }
+
+    void WaveBufferCache::Invalidate(span<u8> region) {
+        std::scoped_lock lock{mutex};
+
+        for (auto it{entries.begin()}; it != entries.end();) {
+            auto &key{(*it)->key};
+            if (key.pointer < region.data() + region.size() && region.data() < key.pointer + key.size) {
+                Erase(it++);
+                invalidationCount.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                it++;
+            }
+        }
+    }
+}
@@ -0,0 +1,97 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <list>
+#include <nce.h>
+#include <audio/common.h>
+
+namespace skyline::service::audio::IAudioRenderer {
+    /**
+     * @brief A cache of wave buffers that have been decoded into PCM, this allows sound effects and loops which are played repeatedly to skip decoding them again
+     * @note Entries are invalidated by trapping guest writes to the wave buffer's memory, any write to a page that a buffer resides in invalidates it
+     */
+    class WaveBufferCache {
+      public:
+        static constexpr size_t MaxEntrySamples{1 << 20}; //!< The maximum amount of samples in a single entry, larger wave buffers are streamed as decoding them at once would stall the renderer
+        static constexpr size_t MaxCacheSamples{1 << 24}; //!< The maximum amount of samples across all entries, the least recently used entries are evicted past this
+
+        /**
+         * @brief The state which determines the decoded contents of a wave buffer
+         */
+        struct Key {
+            u8 *pointer;
+            u64 size;
+            const void *coefficients; //!< The ADPCM coefficients the buffer is decoded with
+            std::array<i32, 2> history; //!< The ADPCM decoder history at the start of the buffer
+            u32 channelCount;
+            skyline::audio::AudioFormat format;
+            u8 _pad0_[3];
+
+            bool operator==(const Key &) const = default;
+        };
+        static_assert(std::is_trivial_v<Key> && std::has_unique_object_representations_v<Key>);
+
+        struct Entry {
+            Key key;
+            std::vector<i16> samples; //!< The decoded samples of the entire wave buffer
+            std::array<i32, 2> finalHistory; //!< The ADPCM decoder history at the end of the buffer
+            std::atomic<bool> dirty{}; //!< If the guest has written to the wave buffer since it was decoded
+            std::optional<nce::NCE::TrapHandle> trapHandle;
+
+            Entry(const Key &key);
+        };
+
+        /**
+         * @brief A function which decodes the wave buffer into the supplied span and returns the ADPCM decoder history at the end of it
+         */
+        using DecodeFunction = std::function<std::array<i32, 2>(span<i16>)>;
+
+      private:
+        const DeviceState &state;
+        std::mutex mutex; //!< Synchronizes all accesses to the entries, voices are rendered from multiple threads
+        std::list<std::shared_ptr<Entry>> entries; //!< All valid entries ordered from most to least recently used
+        std::unordered_map<Key, std::list<std::shared_ptr<Entry>>::iterator, util::ObjectHash<Key>> entryMap;
+        size_t cachedSamples{}; //!< The total amount of samples across all entries
+
+        /**
+         * @brief Removes an entry from the cache and deletes its trap, any voices referencing it can continue to use it
+         */
+        void Erase(std::list<std::shared_ptr<Entry>>::iterator it);
+
+      public:
+        std::atomic<u64> hitCount{};
+        std::atomic<u64> missCount{};
+        std::atomic<u64> invalidationCount{}; //!< The amount of entries that were invalidated by guest writes or memory pools being detached
+
+        WaveBufferCache(const DeviceState &state);
+
+        ~WaveBufferCache();
+
+        /**
+         * @return The entry for the supplied key or nullptr if it isn't cached or has been written to
+         */
+        std::shared_ptr<const Entry> Lookup(const Key &key);
+
+        /**
+         * @brief Decodes a wave buffer into a new entry and inserts it into the cache, writes to the source wave buffer are trapped to invalidate it
+         * @param sampleCount The amount of samples the wave buffer decodes to, this must not exceed MaxEntrySamples
+         * @return The new entry, this remains valid after it's evicted from the cache
+         */
+        std::shared_ptr<const Entry> Insert(const Key &key, size_t sampleCount, const DecodeFunction &decode);
+
+        /**
+         * @brief Removes all entries for wave buffers that overlap the supplied region
+         */
+        void Invalidate(span<u8> region);
+
+        /**
+         * @return The ratio of lookups that were hits
+         */
+        double GetHitRate() const {
+            u64 hits{hitCount.load(std::memory_order_relaxed)}, lookups{hits + missCount.load(std::memory_order_relaxed)};
+            return lookups ? static_cast<double>(hits) / static_cast<double>(lookups) : 0.0;
+        }
+    };
+}
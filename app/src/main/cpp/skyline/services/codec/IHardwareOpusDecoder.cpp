@@ -1,8 +1,8 @@
 // SPDX-License-Identifier: MPL-2.0
 // Copyright © 2021 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
-#include <services/timesrv/common.h>
 #include <kernel/types/KProcess.h>
+#include <common/trace.h>
 
 #include "IHardwareOpusDecoder.h"
 
@@ -16,17 +16,43 @@ namespace skyline::service::codec {
           sampleRate(sampleRate),
           channelCount(channelCount),
           workBuffer(state.process->GetHandle<kernel::type::KTransferMemory>(workBufferHandle)),
-          decoderOutputBufferSize(CalculateOutBufferSize(sampleRate, channelCount, isIsLargerSize ? MaxFrameSizeEx : MaxFrameSizeNormal)) {
+          decoderOutputBufferSize(CalculateOutBufferSize(sampleRate, channelCount, isIsLargerSize ? MaxFrameSizeEx : MaxFrameSizeNormal)),
+          maxFrameSize((isIsLargerSize ? MaxFrameSizeEx : MaxFrameSizeNormal) / (OpusFullbandSampleRate / sampleRate)) {
         if (workBufferSize < decoderOutputBufferSize)
             throw exception("Work Buffer doesn't have adequate space for Opus Decoder: 0x{:X} (Required: 0x{:X})", workBufferSize, decoderOutputBufferSize);
 
         // We utilize the guest-supplied work buffer for allocating the OpusDecoder object into
         decoderState = reinterpret_cast<OpusDecoder *>(workBuffer->host.data());
 
-        if (int result = opus_decoder_init(decoderState, sampleRate, channelCount) != OPUS_OK)
+        if (int result{opus_decoder_init(decoderState, sampleRate, channelCount)}; result != OPUS_OK)
             throw OpusException(result);
     }
 
+    IHardwareOpusDecoder::IHardwareOpusDecoder(const DeviceState &state, ServiceManager &manager, i32 sampleRate, i32 channelCount, i32 streamCount, i32 stereoStreamCount, span<const u8> mappings, u32 workBufferSize, KHandle workBufferHandle, bool isIsLargerSize)
+        : BaseService(state, manager),
+          sampleRate(sampleRate),
+          channelCount(channelCount),
+          workBuffer(state.process->GetHandle<kernel::type::KTransferMemory>(workBufferHandle)),
+          decoderOutputBufferSize(CalculateOutBufferSize(sampleRate, channelCount, isIsLargerSize ? MaxFrameSizeEx : MaxFrameSizeNormal)),
+          maxFrameSize((isIsLargerSize ? MaxFrameSizeEx : MaxFrameSizeNormal) / (OpusFullbandSampleRate / sampleRate)) {
+        auto stateSize{static_cast<u32>(opus_multistream_decoder_get_size(streamCount, stereoStreamCount))};
+        if (workBufferSize < stateSize || workBuffer->host.size() < stateSize)
+            throw exception("Work Buffer doesn't have adequate space for Opus Multi-Stream Decoder: 0x{:X} (Required: 0x{:X})", workBufferSize, stateSize);
+
+        if (mappings.size() < static_cast<size_t>(channelCount))
+            throw exception("Opus Multi-Stream Decoder has less channel mappings than channels: {} (Channels: {})", mappings.size(), channelCount);
+
+        multiStreamDecoderState = reinterpret_cast<OpusMSDecoder *>(workBuffer->host.data());
+
+        if (int result{opus_multistream_decoder_init(multiStreamDecoderState, sampleRate, channelCount, streamCount, stereoStreamCount, mappings.data())}; result != OPUS_OK)
+            throw OpusException(result);
+    }
+
+    IHardwareOpusDecoder::~IHardwareOpusDecoder() {
+        if (decodedSampleCount && decodeTime.Nanoseconds())
+            Logger::Debug("Opus decoder statistics: {} samples decoded in {}ms ({} samples/s)", decodedSampleCount, decodeTime.Nanoseconds() / constant::NsInMillisecond, (decodedSampleCount * constant::NsInSecond) / static_cast<u64>(decodeTime.Nanoseconds()));
+    }
+
     Result IHardwareOpusDecoder::DecodeInterleavedOld(type::KSession &session, ipc::IpcRequest &request, ipc::IpcResponse &response) {
         return DecodeInterleavedImpl(request, response);
     }
@@ -43,8 +69,27 @@ namespace skyline::service::codec {
         return DecodeInterleavedImpl(request, response, true);
     }
 
+    Result IHardwareOpusDecoder::DecodeInterleavedForMultiStreamOld(type::KSession &session, ipc::IpcRequest &request, ipc::IpcResponse &response) {
+        return DecodeInterleavedImpl(request, response);
+    }
+
+    Result IHardwareOpusDecoder::DecodeInterleavedForMultiStreamWithPerfOld(type::KSession &session, ipc::IpcRequest &request, ipc::IpcResponse &response) {
+        return DecodeInterleavedImpl(request, response, true);
+    }
+
+    Result IHardwareOpusDecoder::DecodeInterleavedForMultiStream(type::KSession &session, ipc::IpcRequest &request, ipc::IpcResponse &response) {
+        bool reset{static_cast<bool>(request.Pop<u8>())};
+        if (reset)
+            ResetContext();
+
+        return DecodeInterleavedImpl(request, response, true);
+    }
+
     void IHardwareOpusDecoder::ResetContext() {
-        opus_decoder_ctl(decoderState, OPUS_RESET_STATE);
+        if (multiStreamDecoderState)
+            opus_multistream_decoder_ctl(multiStreamDecoderState, OPUS_RESET_STATE);
+        else
+            opus_decoder_ctl(decoderState, OPUS_RESET_STATE);
     }
 
     Result IHardwareOpusDecoder::DecodeInterleavedImpl(ipc::IpcRequest &request, ipc::IpcResponse &response, bool writeDecodeTime) {
@@ -62,13 +107,22 @@ namespace skyline::service::codec {
         // Skip past the header in the input buffer to get the Opus packet
         auto sampleDataIn = dataIn.subspan(sizeof(OpusDataHeader));
 
+        // The frame size is limited by the output buffer as libopus would otherwise write past its end for long packets
+        auto frameSize{static_cast<int>(std::min<size_t>(dataOut.size() / static_cast<size_t>(channelCount), static_cast<size_t>(maxFrameSize)))};
+
+        TRACE_EVENT("service", "IHardwareOpusDecoder::Decode", "size", opusPacketSize);
         auto perfTimer{timesrv::TimeSpanType::FromNanoseconds(util::GetTimeNs())};
-        i32 decodedCount{opus_decode(decoderState, sampleDataIn.data(), opusPacketSize, dataOut.data(), static_cast<int>(decoderOutputBufferSize), false)};
+        i32 decodedCount{multiStreamDecoderState ?
+                         opus_multistream_decode(multiStreamDecoderState, sampleDataIn.data(), opusPacketSize, dataOut.data(), frameSize, false) :
+                         opus_decode(decoderState, sampleDataIn.data(), opusPacketSize, dataOut.data(), frameSize, false)};
         perfTimer = timesrv::TimeSpanType::FromNanoseconds(util::GetTimeNs()) - perfTimer;
 
         if (decodedCount < 0)
             throw OpusException(decodedCount);
 
+        decodedSampleCount += static_cast<u64>(decodedCount) * static_cast<u64>(channelCount);
+        decodeTime = decodeTime + perfTimer;
+
         response.Push(requiredInSize); // Decoded data size is equal to opus packet size + header
         response.Push(decodedCount);
         if (writeDecodeTime)
@@ -4,10 +4,12 @@
 #pragma once
 
 #include <opus.h>
+#include <opus_multistream.h>
 
 #include <common.h>
 #include <services/base_service.h>
 #include <kernel/types/KTransferMemory.h>
+#include <services/timesrv/common.h>
 
 namespace skyline::service::codec {
     /**
@@ -28,9 +30,14 @@ namespace skyline::service::codec {
       private:
         std::shared_ptr<kernel::type::KTransferMemory> workBuffer;
         OpusDecoder *decoderState{};
+        OpusMSDecoder *multiStreamDecoderState{}; //!< The decoder state for multi-stream decoders, only one of this or decoderState is valid
         i32 sampleRate;
         i32 channelCount;
         u32 decoderOutputBufferSize;
+        i32 maxFrameSize; //!< The maximum amount of frames a single packet can decode to at the sample rate of the decoder
+
+        u64 decodedSampleCount{}; //!< The total amount of samples decoded by this decoder, this is used alongside decodeTime for reporting throughput
+        timesrv::TimeSpanType decodeTime{}; //!< The total time spent decoding by this decoder, this is the sum of every perfTimer
 
         /**
          * @brief Holds information about the Opus packet to be decoded
@@ -60,6 +67,16 @@ namespace skyline::service::codec {
       public:
         IHardwareOpusDecoder(const DeviceState &state, ServiceManager &manager, i32 sampleRate, i32 channelCount, u32 workBufferSize, KHandle workBufferHandle, bool isIsLargerSize = false);
 
+        /**
+         * @brief Creates a multi-stream decoder, the parameters are the same as opus_multistream_decoder_init()
+         */
+        IHardwareOpusDecoder(const DeviceState &state, ServiceManager &manager, i32 sampleRate, i32 channelCount, i32 streamCount, i32 stereoStreamCount, span<const u8> mappings, u32 workBufferSize, KHandle workBufferHandle, bool isIsLargerSize = false);
+
+        /**
+         * @brief Reports the decoding throughput of the decoder over its lifetime
+         */
+        ~IHardwareOpusDecoder();
+
         /**
          * @brief Decodes the Opus source data, returns decoded data size and decoded sample count
          * @url https://switchbrew.org/wiki/Audio_services#DecodeInterleavedOld
@@ -79,11 +96,34 @@ namespace skyline::service::codec {
          */
         Result DecodeInterleaved(type::KSession &session, ipc::IpcRequest &request, ipc::IpcResponse &response);
 
+        /**
+         * @brief Decodes the Opus source data from a multi-stream packet, returns decoded data size and decoded sample count
+         * @url https://switchbrew.org/wiki/Audio_services#DecodeInterleavedForMultiStreamOld
+         */
+        Result DecodeInterleavedForMultiStreamOld(type::KSession &session, ipc::IpcRequest &request, ipc::IpcResponse &response);
+
+        /**
+         * @brief Decodes the Opus source data from a multi-stream packet, returns decoded data size, decoded sample count and decode time in microseconds
+         * @url https://switchbrew.org/wiki/Audio_services#DecodeInterleavedForMultiStreamWithPerfOld
+         */
+        Result DecodeInterleavedForMultiStreamWithPerfOld(type::KSession &session, ipc::IpcRequest &request, ipc::IpcResponse &response);
+
+        /**
+         * @brief Decodes the Opus source data from a multi-stream packet, returns decoded data size, decoded sample count and decode time in microseconds
+         * @note The bool flag indicates whether or not to reset the decoder context
+         * @url https://switchbrew.org/wiki/Audio_services#DecodeInterleavedForMultiStream
+         */
+        Result DecodeInterleavedForMultiStream(type::KSession &session, ipc::IpcRequest &request, ipc::IpcResponse &response);
+
         SERVICE_DECL(
             SFUNC(0x0, IHardwareOpusDecoder, DecodeInterleavedOld),
+            SFUNC(0x2, IHardwareOpusDecoder, DecodeInterleavedForMultiStreamOld),
             SFUNC(0x4, IHardwareOpusDecoder, DecodeInterleavedWithPerfOld),
+            SFUNC(0x5, IHardwareOpusDecoder, DecodeInterleavedForMultiStreamWithPerfOld),
             SFUNC(0x6, IHardwareOpusDecoder, DecodeInterleaved), // DecodeInterleavedWithPerfAndResetOld is effectively the same as DecodeInterleaved
+            SFUNC(0x7, IHardwareOpusDecoder, DecodeInterleavedForMultiStream), // DecodeInterleavedForMultiStreamWithPerfAndResetOld is effectively the same as DecodeInterleavedForMultiStream
             SFUNC(0x8, IHardwareOpusDecoder, DecodeInterleaved),
+            SFUNC(0x9, IHardwareOpusDecoder, DecodeInterleavedForMultiStream),
         )
     };
 
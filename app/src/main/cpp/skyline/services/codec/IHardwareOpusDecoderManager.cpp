@@ -7,12 +7,59 @@
 #include "IHardwareOpusDecoder.h"
 
 namespace skyline::service::codec {
+    /**
+     * @return If Opus can decode at the supplied sample rate, any other rates would lead to invalid buffer size calculations
+     */
+    static bool IsValidSampleRate(i32 sampleRate) {
+        switch (sampleRate) {
+            case 8000:
+            case 12000:
+            case 16000:
+            case 24000:
+            case OpusFullbandSampleRate:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    /**
+     * @brief Validates the parameters of a decoder, this must be done prior to using them in any calculations
+     */
+    static Result ValidateParameters(i32 sampleRate, i32 channelCount) {
+        if (!IsValidSampleRate(sampleRate))
+            return result::InvalidSampleRate;
+        if (channelCount != 1 && channelCount != 2)
+            return result::InvalidChannelCount;
+        return {};
+    }
+
+    /**
+     * @brief Validates the parameters of a multi-stream decoder, this must be done prior to using them in any calculations
+     */
+    static Result ValidateMultiStreamParameters(i32 sampleRate, i32 channelCount, i32 streamCount, i32 stereoStreamCount) {
+        if (!IsValidSampleRate(sampleRate))
+            return result::InvalidSampleRate;
+        if (streamCount <= 0 || stereoStreamCount < 0 || stereoStreamCount > streamCount || channelCount <= 0 || channelCount > 0xFF)
+            return result::InvalidChannelCount;
+        return {};
+    }
+
     static u32 CalculateBufferSize(i32 sampleRate, i32 channelCount, i32 useLargerFrameSize = 0) {
         u32 requiredSize{static_cast<u32>(opus_decoder_get_size(channelCount))};
         requiredSize += MaxInputBufferSize + CalculateOutBufferSize(sampleRate, channelCount, useLargerFrameSize ? MaxFrameSizeEx : MaxFrameSizeNormal);
         return requiredSize;
     }
 
+    static u32 CalculateMultiStreamBufferSize(i32 sampleRate, i32 channelCount, i32 streamCount, i32 stereoStreamCount, i32 useLargerFrameSize = 0) {
+        if (ValidateMultiStreamParameters(sampleRate, channelCount, streamCount, stereoStreamCount))
+            throw exception("Invalid Opus multi-stream parameters: {}Hz, {} channels, {} streams ({} stereo)", sampleRate, channelCount, streamCount, stereoStreamCount);
+
+        u32 requiredSize{static_cast<u32>(opus_multistream_decoder_get_size(streamCount, stereoStreamCount))};
+        requiredSize += MaxInputBufferSize + CalculateOutBufferSize(sampleRate, channelCount, useLargerFrameSize ? MaxFrameSizeEx : MaxFrameSizeNormal);
+        return requiredSize;
+    }
+
     Result IHardwareOpusDecoderManager::OpenHardwareOpusDecoder(type::KSession &session, ipc::IpcRequest &request, ipc::IpcResponse &response) {
         i32 sampleRate{request.Pop<i32>()};
         i32 channelCount{request.Pop<i32>()};
@@ -21,6 +68,9 @@ namespace skyline::service::codec {
 
         Logger::Debug("Creating Opus decoder: Sample rate: {}, Channel count: {}, Work buffer handle: 0x{:X} (Size: 0x{:X})", sampleRate, channelCount, workBuffer, workBufferSize);
 
+        if (auto result{ValidateParameters(sampleRate, channelCount)})
+            return result;
+
         manager.RegisterService(std::make_shared<IHardwareOpusDecoder>(state, manager, sampleRate, channelCount, workBufferSize, workBuffer), session, response);
         return {};
     }
@@ -29,6 +79,9 @@ namespace skyline::service::codec {
         i32 sampleRate{request.Pop<i32>()};
         i32 channelCount{request.Pop<i32>()};
 
+        if (auto result{ValidateParameters(sampleRate, channelCount)})
+            return result;
+
         response.Push<u32>(CalculateBufferSize(sampleRate, channelCount));
         return {};
     }
@@ -43,6 +96,9 @@ namespace skyline::service::codec {
 
         Logger::Debug("Creating Opus decoder: Sample rate: {}, Channel count: {}, Work buffer handle: 0x{:X} (Size: 0x{:X})", sampleRate, channelCount, workBuffer, workBufferSize);
 
+        if (auto result{ValidateParameters(sampleRate, channelCount)})
+            return result;
+
         manager.RegisterService(std::make_shared<IHardwareOpusDecoder>(state, manager, sampleRate, channelCount, workBufferSize, workBuffer, useLargerFrameSize), session, response);
         return {};
     }
@@ -53,7 +109,58 @@ namespace skyline::service::codec {
         i32 useLargerFrameSize{request.Pop<i32>()};
         request.Pop<i32>(); // Just padding
 
+        if (auto result{ValidateParameters(sampleRate, channelCount)})
+            return result;
+
         response.Push<u32>(CalculateBufferSize(sampleRate, channelCount, useLargerFrameSize));
         return {};
     }
+
+    Result IHardwareOpusDecoderManager::OpenHardwareOpusDecoderForMultiStream(type::KSession &session, ipc::IpcRequest &request, ipc::IpcResponse &response) {
+        u32 workBufferSize{request.Pop<u32>()};
+        KHandle workBuffer{request.copyHandles.at(0)};
+        auto &params{request.inputBuf.at(0).as<MultiStreamParameters>()};
+
+        Logger::Debug("Creating Opus multi-stream decoder: Sample rate: {}, Channel count: {}, Stream count: {} ({} stereo), Work buffer handle: 0x{:X} (Size: 0x{:X})", params.sampleRate, params.channelCount, params.streamCount, params.stereoStreamCount, workBuffer, workBufferSize);
+
+        if (auto result{ValidateMultiStreamParameters(params.sampleRate, params.channelCount, params.streamCount, params.stereoStreamCount)})
+            return result;
+
+        manager.RegisterService(std::make_shared<IHardwareOpusDecoder>(state, manager, params.sampleRate, params.channelCount, params.streamCount, params.stereoStreamCount, params.mappings, workBufferSize, workBuffer), session, response);
+        return {};
+    }
+
+    Result IHardwareOpusDecoderManager::GetWorkBufferSizeForMultiStream(type::KSession &session, ipc::IpcRequest &request, ipc::IpcResponse &response) {
+        auto &params{request.inputBuf.at(0).as<MultiStreamParameters>()};
+
+        if (auto result{ValidateMultiStreamParameters(params.sampleRate, params.channelCount, params.streamCount, params.stereoStreamCount)})
+            return result;
+
+        response.Push<u32>(CalculateMultiStreamBufferSize(params.sampleRate, params.channelCount, params.streamCount, params.stereoStreamCount));
+        return {};
+    }
+
+    Result IHardwareOpusDecoderManager::OpenHardwareOpusDecoderForMultiStreamEx(type::KSession &session, ipc::IpcRequest &request, ipc::IpcResponse &response) {
+        u32 workBufferSize{request.Pop<u32>()};
+        KHandle workBuffer{request.copyHandles.at(0)};
+        auto &params{request.inputBuf.at(0).as<MultiStreamParametersEx>()};
+
+        Logger::Debug("Creating Opus multi-stream decoder: Sample rate: {}, Channel count: {}, Stream count: {} ({} stereo), Work buffer handle: 0x{:X} (Size: 0x{:X})", params.sampleRate, params.channelCount, params.streamCount, params.stereoStreamCount, workBuffer, workBufferSize);
+
+        if (auto result{ValidateMultiStreamParameters(params.sampleRate, params.channelCount, params.streamCount, params.stereoStreamCount)})
+            return result;
+
+        manager.RegisterService(std::make_shared<IHardwareOpusDecoder>(state, manager, params.sampleRate, params.channelCount, params.streamCount, params.stereoStreamCount, params.mappings, workBufferSize, workBuffer, params.useLargeFrameSize), session, response);
+        return {};
+    }
+
+    Result IHardwareOpusDecoderManager::GetWorkBufferSizeForMultiStreamEx(type::KSession &session, ipc::IpcRequest &request, ipc::IpcResponse &response) {
+        auto &params{request.inputBuf.at(0).as<MultiStreamParametersEx>()};
+
+        if (auto result{ValidateMultiStreamParameters(params.sampleRate, params.channelCount, params.streamCount, params.stereoStreamCount)})
+            return result;
+
+        response.Push<u32>(CalculateMultiStreamBufferSize(params.sampleRate, params.channelCount, params.streamCount, params.stereoStreamCount, params.useLargeFrameSize));
+        return {};
+    }
 }
@@ -6,6 +6,7 @@
 #include "soc/smmu.h"
 #include "soc/host1x.h"
 #include "soc/gm20b/gpfifo.h"
+#include "soc/gm20b/gpfifo_capture.h"
 
 namespace skyline::soc {
     /**
@@ -16,6 +17,7 @@ namespace skyline::soc {
       public:
         SMMU smmu;
         host1x::Host1x host1x;
+        std::unique_ptr<gm20b::GpfifoCapture> gpfifoCapture; //!< The capture that all processed GPFIFO entries are recorded into, this is only created if GPFIFO capturing is enabled
 
         SOC(const DeviceState &state) : host1x(state) {}
     };
@@ -4,18 +4,27 @@
 #include "channel.h"
 
 namespace skyline::soc::gm20b {
+    static std::atomic<u32> nextId{}; //!< The ID of the next channel to be created
+
     ChannelContext::ChannelContext(const DeviceState &state, std::shared_ptr<AddressSpaceContext> pAsCtx, size_t numEntries)
         : asCtx{std::move(pAsCtx)},
           executor{state},
+          macroState{state},
           maxwell3D{state, *this, macroState},
           fermi2D{state, *this, macroState},
           maxwellDma{state, *this},
           keplerCompute{state, *this},
           inline2Memory{state, *this},
           gpfifo{state, *this, numEntries},
-          globalChannelLock{state.gpu->channelLock} {
+          globalChannelLock{state.gpu->channelLock},
+          id{nextId++},
+          track{static_cast<u64>(trace::TrackIds::ChannelBase) - id, perfetto::ProcessTrack::Current()} {
         executor.AddFlushCallback([this] {
             channelSequenceNumber++;
         });
+
+        auto desc{track.Serialize()};
+        desc.set_name(fmt::format("GPFIFO Channel {}", id));
+        perfetto::TrackEvent::SetTrackDescriptor(track, desc);
     }
 }
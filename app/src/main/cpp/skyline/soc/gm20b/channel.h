@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <common/trace.h>
 #include <gpu/interconnect/command_executor.h>
 #include "macro/macro_state.h"
 #include "engines/engine.h"
@@ -19,6 +20,7 @@ namespace skyline::soc::gm20b {
     /**
      * @brief The GPU block in the X1, it contains all GPU engines required for accelerating graphics operations
      * @note We omit parts of components related to external access such as the grhost, all accesses to the external components are done directly
+     * @note Channels only hold the global channel lock while they have GPU work recorded, decoding pushbuffers, executing macros and waiting on syncpoints or semaphores happens in parallel across channels
      */
     struct ChannelContext {
         std::shared_ptr<AddressSpaceContext> asCtx;
@@ -30,19 +32,58 @@ namespace skyline::soc::gm20b {
         engine::KeplerCompute keplerCompute;
         engine::Inline2Memory inline2Memory;
         ChannelGpfifo gpfifo;
-        std::mutex &globalChannelLock;
+        std::mutex &globalChannelLock; //!< Serializes channels while they have GPU resources locked, this prevents lock-order deadlocks between the resources attached to the executors of different channels
+        bool locked{}; //!< If this channel currently holds the global channel lock
         size_t channelSequenceNumber{};
+        u32 id; //!< A unique ID for the channel, this is used to identify it in traces
+        perfetto::Track track; //!< A track showing when the channel is busy processing GpEntries and when it's waiting on the global channel lock, syncpoints or semaphores
 
         ChannelContext(const DeviceState &state, std::shared_ptr<AddressSpaceContext> asCtx, size_t numEntries);
 
+        /**
+         * @brief Acquires the global channel lock if this channel doesn't hold it already
+         * @note This must be called prior to any interconnect operation that may access GPU resources, the lock is held until the recorded work is submitted
+         */
         void Lock() {
-            globalChannelLock.lock();
+            if (locked) [[likely]]
+                return;
+
+            if (!globalChannelLock.try_lock()) {
+                TRACE_EVENT("gpu", "WaitChannelLock", track);
+                globalChannelLock.lock();
+            }
             executor.LockPreserve();
+            locked = true;
         }
 
+        /**
+         * @brief Releases the global channel lock if this channel holds it
+         * @note The executor **must** not have any resources attached when this is called, Submit should be used if there might be recorded work
+         */
         void Unlock() {
+            if (!locked)
+                return;
+
             executor.UnlockPreserve();
             globalChannelLock.unlock();
+            locked = false;
+        }
+
+        /**
+         * @brief Submits all recorded GPU work and releases the global channel lock as the executor has no resources attached after a submission
+         * @note Work can only be recorded while the channel is locked, if it isn't then only deferred engine state is flushed as that locks the channel if it records any work
+         */
+        void Submit() {
+            if (!locked) {
+                maxwell3D.FlushEngineState();
+                if (!locked) {
+                    channelSequenceNumber++; // Cached guest memory reads are still invalidated as they would be by a submission
+                    return;
+                }
+            }
+
+            executor.Submit();
+            Unlock();
         }
     };
 }
@@ -18,14 +18,24 @@ namespace skyline::soc::gm20b::engine {
 
     MacroEngineBase::MacroEngineBase(MacroState &macroState) : macroState(macroState) {}
 
+    void MacroEngineBase::ExecutePendingMacro() {
+        BeginMacroExecution();
+        try {
+            macroState.Execute(macroInvocation.index, macroInvocation.arguments, this);
+        } catch (...) {
+            EndMacroExecution();
+            throw;
+        }
+        EndMacroExecution();
+        macroInvocation.Reset();
+    }
+
     void MacroEngineBase::HandleMacroCall(u32 macroMethodOffset, u32 argument, bool lastCall) {
         // Starting a new macro at index 'macroMethodOffset / 2'
         if (!(macroMethodOffset & 1)) {
             // Flush the current macro as we are switching to another one
-            if (macroInvocation.Valid()) {
-                macroState.Execute(macroInvocation.index, macroInvocation.arguments, this);
-                macroInvocation.Reset();
-            }
+            if (macroInvocation.Valid())
+                ExecutePendingMacro();
 
             // Setup for the new macro index
             macroInvocation.index = (macroMethodOffset / 2) % macroState.macroPositions.size();
@@ -34,9 +44,7 @@ namespace skyline::soc::gm20b::engine {
         macroInvocation.arguments.emplace_back(argument);
 
         // Flush macro after all of the data in the method call has been sent
-        if (lastCall && macroInvocation.Valid()) {
-            macroState.Execute(macroInvocation.index, macroInvocation.arguments, this);
-            macroInvocation.Reset();
-        }
+        if (lastCall && macroInvocation.Valid())
+            ExecutePendingMacro();
     };
 }
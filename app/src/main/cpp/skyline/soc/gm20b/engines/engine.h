@@ -96,6 +96,18 @@ namespace skyline::soc::gm20b::engine {
             throw exception("DrawIndexedInstanced is not implemented for this engine");
         }
 
+        /**
+         * @brief Called prior to and after a macro is executed, this allows engines to batch the work done by a macro
+         */
+        virtual void BeginMacroExecution() {}
+
+        virtual void EndMacroExecution() {}
+
+        /**
+         * @brief Executes the pending macro invocation and resets it
+         */
+        void ExecutePendingMacro();
+
         /**
          * @brief Handles a call to a method in the MME space
          * @param macroMethodOffset The target offset from EngineMethodsEnd
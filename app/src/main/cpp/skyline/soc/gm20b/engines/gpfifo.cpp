@@ -19,17 +19,19 @@ namespace skyline::soc::gm20b::engine {
             ENGINE_STRUCT_CASE(syncpoint, action, {
                 if (action.operation == Registers::Syncpoint::Operation::Incr) {
                     Logger::Debug("Increment syncpoint: {}", +action.index);
-                    channelCtx.executor.Submit();
+                    channelCtx.Submit();
                     syncpoints.at(action.index).Increment();
                 } else if (action.operation == Registers::Syncpoint::Operation::Wait) {
                     Logger::Debug("Wait syncpoint: {}, thresh: {}", +action.index, registers.syncpoint->payload);
+                    if (skipWaits)
+                        return;
 
-                    // Wait forever for another channel to increment
+                    // Wait forever for another channel to increment, all prior work is submitted beforehand as the incrementing channel might depend on it
+                    // As there's a single in-order queue, work submitted by the incrementing channel prior to the increment is guaranteed to execute before any work this channel submits after the wait
+                    channelCtx.Submit();
 
-                    channelCtx.executor.Submit();
-                    channelCtx.Unlock();
+                    TRACE_EVENT("gpu", "WaitSyncpoint", channelCtx.track, "index", +action.index, "threshold", registers.syncpoint->payload);
                     syncpoints.at(action.index).Wait(registers.syncpoint->payload, std::chrono::steady_clock::duration::max());
-                    channelCtx.Lock();
                 }
             })
 
@@ -43,30 +45,34 @@ namespace skyline::soc::gm20b::engine {
                 }
 
                 switch (action.operation) {
-                    case Registers::Semaphore::Operation::Acquire:
+                    case Registers::Semaphore::Operation::Acquire: {
                         Logger::Debug("Acquire semaphore: 0x{:X} payload: {}", address, registers.semaphore->payload);
-                        channelCtx.executor.Submit();
-                        channelCtx.Unlock();
+                        if (skipWaits)
+                            break;
 
+                        channelCtx.Submit();
+
+                        TRACE_EVENT("gpu", "WaitSemaphore", channelCtx.track, "address", address, "payload", registers.semaphore->payload);
                         while (channelCtx.asCtx->gmmu.Read<u32>(address) != registers.semaphore->payload)
                             std::this_thread::yield();
-
-                        channelCtx.Lock();
                         break;
+                    }
                     case Registers::Semaphore::Operation::Release:
                         channelCtx.asCtx->gmmu.Write(address, registers.semaphore->payload);
                         Logger::Debug("SemaphoreRelease: address: 0x{:X} payload: {}", address, registers.semaphore->payload);
                         break;
-                    case Registers::Semaphore::Operation::AcqGeq    :
+                    case Registers::Semaphore::Operation::AcqGeq    : {
                         Logger::Debug("Acquire semaphore: 0x{:X} payload: {}", address, registers.semaphore->payload);
-                        channelCtx.executor.Submit();
-                        channelCtx.Unlock();
+                        if (skipWaits)
+                            break;
 
+                        channelCtx.Submit();
+
+                        TRACE_EVENT("gpu", "WaitSemaphore", channelCtx.track, "address", address, "payload", registers.semaphore->payload);
                         while (channelCtx.asCtx->gmmu.Read<u32>(address) < registers.semaphore->payload)
                             std::this_thread::yield();
-
-                        channelCtx.Lock();
                         break;
+                    }
                     case Registers::Semaphore::Operation::Reduction: {
                         u32 origVal{channelCtx.asCtx->gmmu.Read<u32>(address)};
                         bool isSigned{action.format == Registers::Semaphore::Format::Signed};
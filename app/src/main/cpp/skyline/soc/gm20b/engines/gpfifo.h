@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <soc/host1x/syncpoint.h>
 #include "engine.h"
 
 namespace skyline::soc::gm20b {
@@ -172,6 +173,8 @@ namespace skyline::soc::gm20b::engine {
         ChannelContext &channelCtx;
 
       public:
+        bool skipWaits{}; //!< If syncpoint waits and semaphore acquires are skipped, this is used when replaying GPFIFO captures as the work they'd wait on was already ordered prior to capture
+
         GPFIFO(host1x::SyncpointSet &syncpoints, ChannelContext &channelCtx);
 
         void CallMethod(u32 method, u32 argument);
@@ -24,7 +24,7 @@ namespace skyline::soc::gm20b::engine {
             channelCtx.channelSequenceNumber++;
             interconnect.Upload(u64{state.offsetOut}, span{buffer});
         } else {
-            channelCtx.executor.Submit();
+            channelCtx.Submit();
             Logger::Warn("Non-linear I2M uploads are not supported!");
         }
     }
@@ -75,11 +75,107 @@ namespace skyline::soc::gm20b::engine::maxwell3d {
     __attribute__((always_inline)) void Maxwell3D::FlushDeferredDraw() {
         if (batchEnableState.drawActive) {
             batchEnableState.drawActive = false;
-            interconnect.Draw(deferredDraw.drawTopology, *registers.streamOutputEnable, deferredDraw.indexed, deferredDraw.drawCount, deferredDraw.drawFirst, deferredDraw.instanceCount, deferredDraw.drawBaseVertex, deferredDraw.drawBaseInstance);
+            Draw(deferredDraw.drawTopology, deferredDraw.indexed, deferredDraw.drawCount, deferredDraw.drawFirst, deferredDraw.instanceCount, deferredDraw.drawBaseVertex, deferredDraw.drawBaseInstance);
             deferredDraw.instanceCount = 1;
         }
     }
 
+    void Maxwell3D::Draw(type::DrawTopology topology, bool indexed, u32 count, u32 first, u32 instanceCount, u32 baseVertex, u32 baseInstance) {
+        if (!multiDraw.active) {
+            interconnect.Draw(topology, *registers.streamOutputEnable, indexed, count, first, instanceCount, baseVertex, baseInstance);
+            return;
+        }
+
+        if (!multiDraw.draws.empty() && (multiDraw.drawTopology != topology || multiDraw.indexed != indexed))
+            FlushMultiDraw();
+
+        multiDraw.drawTopology = topology;
+        multiDraw.indexed = indexed;
+        multiDraw.draws.push_back({count, first, instanceCount, baseVertex, baseInstance});
+    }
+
+    void Maxwell3D::FlushMultiDraw() {
+        if (multiDraw.draws.empty())
+            return;
+
+        if (multiDraw.draws.size() == 1) {
+            const auto &draw{multiDraw.draws.front()};
+            interconnect.Draw(multiDraw.drawTopology, *registers.streamOutputEnable, multiDraw.indexed, draw.count, draw.first, draw.instanceCount, draw.vertexOffset, draw.firstInstance);
+        } else {
+            interconnect.MultiDraw(multiDraw.drawTopology, *registers.streamOutputEnable, multiDraw.indexed, multiDraw.draws);
+            macroState.statistics.multiDraws.fetch_add(1, std::memory_order_relaxed);
+            macroState.statistics.multiDrawDraws.fetch_add(multiDraw.draws.size(), std::memory_order_relaxed);
+        }
+
+        multiDraw.draws.clear();
+    }
+
+    bool Maxwell3D::IsDrawParameterMethod(u32 method) {
+        switch (method) {
+            case ENGINE_OFFSET(begin):
+            case ENGINE_OFFSET(end):
+            case ENGINE_OFFSET(vertexArrayStart):
+            case ENGINE_OFFSET(drawVertexArray):
+            case ENGINE_STRUCT_OFFSET(indexBuffer, first):
+            case ENGINE_OFFSET(drawIndexBuffer):
+            case ENGINE_OFFSET(globalBaseVertexIndex):
+            case ENGINE_OFFSET(globalBaseInstanceIndex):
+            case ENGINE_OFFSET(drawVertexArrayBeginEndInstanceFirst):
+            case ENGINE_OFFSET(drawVertexArrayBeginEndInstanceSubsequent):
+            case ENGINE_OFFSET(drawIndexBuffer32BeginEndInstanceFirst):
+            case ENGINE_OFFSET(drawIndexBuffer16BeginEndInstanceFirst):
+            case ENGINE_OFFSET(drawIndexBuffer8BeginEndInstanceFirst):
+            case ENGINE_OFFSET(drawIndexBuffer32BeginEndInstanceSubsequent):
+            case ENGINE_OFFSET(drawIndexBuffer16BeginEndInstanceSubsequent):
+            case ENGINE_OFFSET(drawIndexBuffer8BeginEndInstanceSubsequent):
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    bool Maxwell3D::HasSideEffects(u32 method) {
+        switch (method) {
+            case ENGINE_STRUCT_OFFSET(mme, instructionRamLoad):
+            case ENGINE_STRUCT_OFFSET(mme, startAddressRamLoad):
+            case ENGINE_STRUCT_OFFSET(mme, shadowRamControl):
+            case ENGINE_STRUCT_OFFSET(i2m, launchDma):
+            case ENGINE_STRUCT_OFFSET(i2m, loadInlineData):
+            case ENGINE_OFFSET(syncpointAction):
+            case ENGINE_OFFSET(clearSurface):
+            case ENGINE_OFFSET(begin):
+            case ENGINE_STRUCT_OFFSET(drawVertexArray, count):
+            case ENGINE_OFFSET(drawVertexArrayBeginEndInstanceFirst):
+            case ENGINE_OFFSET(drawVertexArrayBeginEndInstanceSubsequent):
+            case ENGINE_STRUCT_OFFSET(drawInlineIndex4X8, index0):
+            case ENGINE_STRUCT_OFFSET(drawInlineIndex2X16, even):
+            case ENGINE_STRUCT_OFFSET(drawIndexBuffer, count):
+            case ENGINE_OFFSET(drawIndexBuffer32BeginEndInstanceFirst):
+            case ENGINE_OFFSET(drawIndexBuffer16BeginEndInstanceFirst):
+            case ENGINE_OFFSET(drawIndexBuffer8BeginEndInstanceFirst):
+            case ENGINE_OFFSET(drawIndexBuffer32BeginEndInstanceSubsequent):
+            case ENGINE_OFFSET(drawIndexBuffer16BeginEndInstanceSubsequent):
+            case ENGINE_OFFSET(drawIndexBuffer8BeginEndInstanceSubsequent):
+            case ENGINE_STRUCT_OFFSET(semaphore, info):
+            case ENGINE_ARRAY_OFFSET(firmwareCall, 4):
+                return true;
+            default:
+                break;
+        }
+
+        // Constant buffer data loads and constant buffer binds are arrays of methods which are checked by range
+        constexpr u32 LoadConstantBufferDataStart{ENGINE_STRUCT_ARRAY_OFFSET(loadConstantBuffer, data, 0)};
+        constexpr u32 LoadConstantBufferDataEnd{ENGINE_STRUCT_ARRAY_OFFSET(loadConstantBuffer, data, 16)};
+        if (method >= LoadConstantBufferDataStart && method < LoadConstantBufferDataEnd)
+            return true;
+
+        for (u32 stage{}; stage < type::ShaderStageCount; stage++)
+            if (method == ENGINE_ARRAY_STRUCT_OFFSET(bindGroups, stage, constantBuffer))
+                return true;
+
+        return false;
+    }
+
     __attribute__((always_inline)) void Maxwell3D::HandleMethod(u32 method, u32 argument) {
         if (method == ENGINE_STRUCT_OFFSET(mme, shadowRamControl)) [[unlikely]] {
             shadowRegisters.raw[method] = registers.raw[method] = argument;
@@ -182,9 +278,17 @@ namespace skyline::soc::gm20b::engine::maxwell3d {
             }
         }
 
+        // Any state changes need to be applied after all collected draws have been performed as they rely on the prior state
+        if (!multiDraw.draws.empty() && !IsDrawParameterMethod(method)) {
+            registers.raw[method] = origRegisterValue;
+            FlushMultiDraw();
+            registers.raw[method] = argument;
+        }
+
         if (!redundant)
             dirtyManager.MarkDirty(method);
 
+        // Any methods with side effects that are handled here must also be listed in HasSideEffects
         switch (method) {
             ENGINE_STRUCT_CASE(mme, instructionRamLoad, {
                 if (registers.mme->instructionRamPointer >= macroState.macroCode.size())
@@ -217,7 +321,7 @@ namespace skyline::soc::gm20b::engine::maxwell3d {
 
             ENGINE_CASE(syncpointAction, {
                 Logger::Debug("Increment syncpoint: {}", static_cast<u16>(syncpointAction.id));
-                channelCtx.executor.Submit();
+                channelCtx.Submit();
                 syncpoints.at(syncpointAction.id).Increment();
             })
 
@@ -337,7 +441,7 @@ namespace skyline::soc::gm20b::engine::maxwell3d {
 
                 switch (info.op) {
                     case type::SemaphoreInfo::Op::Release:
-                        channelCtx.executor.Submit();
+                        channelCtx.Submit();
                         WriteSemaphoreResult(registers.semaphore->payload);
                         break;
 
@@ -412,6 +516,7 @@ namespace skyline::soc::gm20b::engine::maxwell3d {
 
     void Maxwell3D::FlushEngineState() {
         FlushDeferredDraw();
+        FlushMultiDraw();
 
         if (batchEnableState.constantBufferActive) {
             interconnect.LoadConstantBuffer(batchLoadConstantBuffer.buffer, batchLoadConstantBuffer.startOffset);
@@ -441,6 +546,52 @@ namespace skyline::soc::gm20b::engine::maxwell3d {
             HandleMethod(method, argument);
     }
 
+    void Maxwell3D::CallMethodBatchInc(u32 method, span<u32> arguments) {
+        constexpr u32 LoadConstantBufferDataStart{ENGINE_STRUCT_ARRAY_OFFSET(loadConstantBuffer, data, 0)};
+        constexpr u32 LoadConstantBufferDataEnd{ENGINE_STRUCT_ARRAY_OFFSET(loadConstantBuffer, data, 16)};
+
+        while (!arguments.empty()) {
+            // Methods can only be applied in bulk when they wouldn't be affected by shadow RAM or need to flush any batched draws
+            bool bulkCompatible{shadowRegisters.mme->shadowRamControl == type::MmeShadowRamControl::MethodPassthrough && !batchEnableState.drawActive && multiDraw.draws.empty()};
+
+            size_t count{1};
+            if (bulkCompatible && method >= LoadConstantBufferDataStart && method < LoadConstantBufferDataEnd) {
+                count = std::min<size_t>(LoadConstantBufferDataEnd - method, arguments.size());
+                auto data{arguments.first(count)};
+
+                // This matches calling each method individually, the first one starts a batch if there isn't one active already and the rest are appended to it
+                if (!batchEnableState.constantBufferActive) {
+                    if (registers.raw[method] != data.front())
+                        dirtyManager.MarkDirty(method);
+
+                    batchLoadConstantBuffer.startOffset = registers.loadConstantBuffer->offset;
+                    batchEnableState.constantBufferActive = true;
+                }
+
+                std::copy(data.begin(), data.end(), registers.raw.begin() + method);
+                batchLoadConstantBuffer.buffer.insert(batchLoadConstantBuffer.buffer.end(), data.begin(), data.end());
+                registers.loadConstantBuffer->offset += static_cast<u32>(count * sizeof(u32));
+            } else if (bulkCompatible && !batchEnableState.constantBufferActive && !HasSideEffects(method)) {
+                while (count < arguments.size() && !HasSideEffects(method + static_cast<u32>(count)))
+                    count++;
+
+                // Only registers that have changed need to be marked as dirty, this is done alongside the writes in a single pass
+                for (size_t i{}; i < count; i++) {
+                    u32 &value{registers.raw[method + i]};
+                    if (value != arguments[i]) {
+                        value = arguments[i];
+                        dirtyManager.MarkDirty(method + i);
+                    }
+                }
+            } else {
+                HandleMethod(method, arguments.front());
+            }
+
+            method += static_cast<u32>(count);
+            arguments = arguments.subspan(count);
+        }
+    }
+
     void Maxwell3D::CallMethodFromMacro(u32 method, u32 argument) {
         HandleMethod(method, argument);
     }
@@ -450,6 +601,9 @@ namespace skyline::soc::gm20b::engine::maxwell3d {
     }
 
     void Maxwell3D::DrawInstanced(bool setRegs, u32 drawTopology, u32 vertexArrayCount, u32 instanceCount, u32 vertexArrayStart, u32 globalBaseInstanceIndex) {
+        // Any pending deferred draw was issued prior to this one so it must be performed first to retain ordering
+        FlushDeferredDraw();
+
         auto topology{static_cast<type::DrawTopology>(drawTopology)};
         if (setRegs) {
             registers.begin->op = topology;
@@ -458,10 +612,13 @@ namespace skyline::soc::gm20b::engine::maxwell3d {
             registers.globalBaseInstanceIndex = globalBaseInstanceIndex;
         }
 
-        interconnect.Draw(topology, *registers.streamOutputEnable, false, vertexArrayCount, vertexArrayStart, instanceCount, 0, globalBaseInstanceIndex);
+        Draw(topology, false, vertexArrayCount, vertexArrayStart, instanceCount, 0, globalBaseInstanceIndex);
     }
 
     void Maxwell3D::DrawIndexedInstanced(bool setRegs, u32 drawTopology, u32 indexBufferCount, u32 instanceCount, u32 globalBaseVertexIndex, u32 indexBufferFirst, u32 globalBaseInstanceIndex) {
+        // Any pending deferred draw was issued prior to this one so it must be performed first to retain ordering
+        FlushDeferredDraw();
+
         auto topology{static_cast<type::DrawTopology>(drawTopology)};
         if (setRegs) {
             registers.begin->op = topology;
@@ -471,6 +628,19 @@ namespace skyline::soc::gm20b::engine::maxwell3d {
             registers.globalBaseInstanceIndex = globalBaseInstanceIndex;
         }
 
-        interconnect.Draw(topology, *registers.streamOutputEnable, true, indexBufferCount, indexBufferFirst, instanceCount, globalBaseVertexIndex, globalBaseInstanceIndex);
+        Draw(topology, true, indexBufferCount, indexBufferFirst, instanceCount, globalBaseVertexIndex, globalBaseInstanceIndex);
+    }
+
+    void Maxwell3D::BeginMacroExecution() {
+        multiDraw.active = true;
+    }
+
+    void Maxwell3D::EndMacroExecution() {
+        // A trailing deferred draw is only merged when there are other draws to merge it with so instanced draws spanning beyond the macro are still detected otherwise
+        if (!multiDraw.draws.empty()) {
+            FlushDeferredDraw();
+            FlushMultiDraw();
+        }
+        multiDraw.active = false;
     }
 }
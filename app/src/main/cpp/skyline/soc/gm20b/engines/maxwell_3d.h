@@ -70,10 +70,40 @@ namespace skyline::soc::gm20b::engine::maxwell3d {
             }
         } deferredDraw{};
 
+        /**
+         * @brief Macros commonly perform several draws in a loop where only the draw parameters change between them (multi-draw), while a macro is executing such draws are collected rather than performed immediately so that they can be performed with a single indirect draw on the host once any other state changes or the macro finishes
+         */
+        struct MultiDrawState {
+            bool active; //!< If draws are being collected, this is only the case during macro execution
+            bool indexed; //!< If the collected draws are indexed
+            type::DrawTopology drawTopology; //!< Topology of all collected draws
+            std::vector<gpu::interconnect::maxwell3d::Maxwell3D::MultiDrawParams> draws;
+        } multiDraw{};
+
         type::DrawTopology ApplyTopologyOverride(type::DrawTopology beginMethodTopology);
 
         void FlushDeferredDraw();
 
+        /**
+         * @brief Performs a draw or adds it to the pending multi-draw while draws are being collected
+         */
+        void Draw(type::DrawTopology topology, bool indexed, u32 count, u32 first, u32 instanceCount, u32 baseVertex, u32 baseInstance);
+
+        /**
+         * @brief Performs all draws that were collected for the pending multi-draw
+         */
+        void FlushMultiDraw();
+
+        /**
+         * @return If the method only supplies the parameters of a draw or triggers one, such methods can't affect any state other than the draw parameters
+         */
+        static bool IsDrawParameterMethod(u32 method);
+
+        /**
+         * @return If calling the method has any effect other than writing to its register, this must be kept in sync with the methods handled in HandleMethod
+         */
+        static bool HasSideEffects(u32 method);
+
         /**
          * @brief Calls the appropriate function corresponding to a certain method with the supplied argument
          */
@@ -435,7 +465,7 @@ namespace skyline::soc::gm20b::engine::maxwell3d {
         void InitializeRegisters();
 
         /**
-         * @brief Flushes any batched constant buffer update or instanced draw state
+         * @brief Flushes any batched constant buffer update, instanced draw or multi-draw state
          */
         void FlushEngineState();
 
@@ -443,6 +473,11 @@ namespace skyline::soc::gm20b::engine::maxwell3d {
 
         void CallMethodBatchNonInc(u32 method, span<u32> arguments);
 
+        /**
+         * @brief Calls a sequence of consecutive methods starting at the supplied method, runs of register writes without side effects and constant buffer data loads are applied in bulk rather than individually
+         */
+        void CallMethodBatchInc(u32 method, span<u32> arguments);
+
         void CallMethodFromMacro(u32 method, u32 argument) override;
 
         u32 ReadMethodFromMacro(u32 method) override;
@@ -450,5 +485,9 @@ namespace skyline::soc::gm20b::engine::maxwell3d {
         void DrawInstanced(bool setRegs, u32 drawTopology, u32 vertexArrayCount, u32 instanceCount, u32 vertexArrayStart, u32 globalBaseInstanceIndex) override;
 
         void DrawIndexedInstanced(bool setRegs, u32 drawTopology, u32 indexBufferCount, u32 instanceCount, u32 globalBaseVertexIndex, u32 indexBufferFirst, u32 globalBaseInstanceIndex) override;
+
+        void BeginMacroExecution() override;
+
+        void EndMacroExecution() override;
     };
 }
@@ -39,7 +39,7 @@ namespace skyline::soc::gm20b::engine {
         }
 
         if (registers.launchDma->multiLineEnable) {
-            channelCtx.executor.Submit();
+            channelCtx.Submit();
             if (registers.launchDma->srcMemoryLayout == Registers::LaunchDma::MemoryLayout::Pitch &&
                 registers.launchDma->dstMemoryLayout == Registers::LaunchDma::MemoryLayout::BlockLinear)
                 CopyPitchToBlockLinear();
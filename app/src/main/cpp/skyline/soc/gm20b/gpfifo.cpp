@@ -153,10 +153,22 @@ namespace skyline::soc::gm20b {
         }
     }
 
+    void ChannelGpfifo::SendPureBatchInc(u32 method, span<u32> arguments, SubchannelId subChannel) {
+        switch (subChannel) {
+            case SubchannelId::ThreeD:
+                channelCtx.maxwell3D.CallMethodBatchInc(method, arguments);
+                break;
+            default:
+                for (u32 argument : arguments)
+                    SendPure(method++, argument, subChannel);
+                break;
+        }
+    }
+
     void ChannelGpfifo::Process(GpEntry gpEntry) {
         // Submit if required by the GpEntry, this is needed as some games dynamically generate pushbuffer contents
         if (gpEntry.sync == GpEntry::Sync::Wait)
-            channelCtx.executor.Submit();
+            channelCtx.Submit();
 
         if (!gpEntry.size) {
             // This is a GPFIFO control entry, all control entries have a zero length and contain no pushbuffers
@@ -181,6 +193,16 @@ namespace skyline::soc::gm20b {
             }
         }()};
 
+        if (auto &capture{state.soc->gpfifoCapture}) [[unlikely]] {
+            if (!captureChannelId)
+                captureChannelId = capture->RegisterChannel(channelCtx.asCtx);
+            capture->Capture(*captureChannelId, channelCtx.asCtx, gpEntry, pushBuffer);
+        }
+
+        ProcessPushBuffer(pushBuffer);
+    }
+
+    void ChannelGpfifo::ProcessPushBuffer(span<u32> pushBuffer) {
         // There will be at least one entry here
         auto entry{pushBuffer.begin()};
 
@@ -261,7 +283,15 @@ namespace skyline::soc::gm20b {
 
                 if (remainingEntries >= methodHeader.methodCount) { [[likely]]
                     if (methodHeader.Pure()) [[likely]] {
-                        if constexpr (State == MethodResumeState::State::NonInc) {
+                        if constexpr (State == MethodResumeState::State::Inc) {
+                            // For pure inc methods we can send all method calls as a span in one go, register blocks and constant buffer updates are then applied in bulk
+                            if (methodHeader.methodCount > BatchCutoff) [[unlikely]] {
+                                SendPureBatchInc(methodHeader.methodAddress, span(&(*++entry), methodHeader.methodCount), methodHeader.methodSubChannel);
+
+                                entry += methodHeader.methodCount - 1;
+                                return false;
+                            }
+                        } else if constexpr (State == MethodResumeState::State::NonInc) {
                             // For pure noninc methods we can send all method calls as a span in one go
                             if (methodHeader.methodCount > BatchCutoff) [[unlikely]] {
                                 SendPureBatchNonInc(methodHeader.methodAddress, span(&(*++entry), methodHeader.methodCount), methodHeader.methodSubChannel);
@@ -345,23 +375,27 @@ namespace skyline::soc::gm20b {
             signal::SetSignalHandler({SIGINT, SIGILL, SIGTRAP, SIGBUS, SIGFPE}, signal::ExceptionalSignalHandler);
             signal::SetSignalHandler({SIGSEGV}, nce::NCE::HostSignalHandler); // We may access NCE trapped memory
 
-            bool channelLocked{};
+            // The channel is only locked lazily by the interconnect when GPU work is recorded, this allows channels to decode pushbuffers and execute macros in parallel
+            bool channelBusy{};
 
-            gpEntries.Process([this, &channelLocked](GpEntry gpEntry) {
+            gpEntries.Process([this, &channelBusy](GpEntry gpEntry) {
                 Logger::Debug("Processing pushbuffer: 0x{:X}, Size: 0x{:X}", gpEntry.Address(), +gpEntry.size);
 
-                if (!channelLocked) {
-                    channelCtx.Lock();
-                    channelLocked = true;
+                if (!channelBusy) {
+                    TRACE_EVENT_BEGIN("gpu", "Busy", channelCtx.track);
+                    channelBusy = true;
                 }
 
                 Process(gpEntry);
-            }, [this, &channelLocked]() {
+            }, [this, &channelBusy]() {
                 // If we run out of GpEntries to process ensure we submit any remaining GPU work before waiting for more to arrive
                 Logger::Debug("Finished processing pushbuffer batch");
-                channelCtx.executor.Submit();
-                channelCtx.Unlock();
-                channelLocked = false;
+                channelCtx.Submit();
+
+                if (channelBusy) {
+                    TRACE_EVENT_END("gpu", channelCtx.track);
+                    channelBusy = false;
+                }
             });
         } catch (const signal::SignalException &e) {
             if (e.signal != SIGINT) {
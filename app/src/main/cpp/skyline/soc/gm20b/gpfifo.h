@@ -102,6 +102,8 @@ namespace skyline::soc::gm20b {
      */
     class ChannelGpfifo {
       private:
+        friend class GpfifoReplayer;
+
         const DeviceState &state;
         ChannelContext &channelCtx;
         engine::GPFIFO gpfifoEngine; //!< The engine for processing GPFIFO method calls
@@ -128,6 +130,7 @@ namespace skyline::soc::gm20b {
         } resumeState{};
 
         std::thread thread; //!< The thread that manages processing of pushbuffers
+        std::optional<u32> captureChannelId; //!< The ID of this channel in the GPFIFO capture, this is assigned when the first GpEntry is captured
 
         /**
          * @brief Sends a method call to the appropriate subchannel and handles macro and GPFIFO methods
@@ -144,11 +147,21 @@ namespace skyline::soc::gm20b {
          */
         void SendPureBatchNonInc(u32 method, span<u32> arguments, SubchannelId subChannel);
 
+        /**
+         * @brief Sends a batch of method calls directed at consecutive methods to the appropriate subchannel, macro and GPFIFO methods are not handled
+         */
+        void SendPureBatchInc(u32 method, span<u32> arguments, SubchannelId subChannel);
+
         /**
          * @brief Processes the pushbuffer contained within the given GpEntry, calling methods as needed
          */
         void Process(GpEntry gpEntry);
 
+        /**
+         * @brief Processes the methods in a pushbuffer, resuming any method split from the previous pushbuffer
+         */
+        void ProcessPushBuffer(span<u32> pushBuffer);
+
         /**
          * @brief Executes all pending entries in the FIFO and polls for more
          */
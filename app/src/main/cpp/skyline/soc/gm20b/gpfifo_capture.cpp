@@ -0,0 +1,140 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <lz4.h>
+#include <vfs/os_filesystem.h>
+#include <common/trace.h>
+#include <soc.h>
+#include "gpfifo_capture.h"
+
+namespace skyline::soc::gm20b {
+    GpfifoCapture::GpfifoCapture(const std::string &path, u64 titleId) {
+        auto filename{fmt::format("{:016X}.bin", titleId)};
+        try {
+            vfs::OsFileSystem filesystem{path};
+            if (!filesystem.FileExists(filename) && !filesystem.CreateFile(filename, 0))
+                throw exception("Failed to create file");
+            backing = filesystem.OpenFile(filename, {true, true, true});
+            backing->Resize(0);
+
+            capture::FileHeader header{
+                .magic = capture::FileHeader::Magic,
+                .version = capture::FileHeader::Version,
+                .titleId = titleId,
+            };
+            backingOffset = backing->Write(span<capture::FileHeader>{header}.cast<u8>());
+
+            Logger::Info("Capturing GPFIFO entries to {}{}", path, filename);
+        } catch (const exception &e) {
+            Logger::Warn("Failed to open GPFIFO capture {}, capturing will be disabled: {}", filename, e.what());
+            backing = nullptr;
+        }
+    }
+
+    GpfifoCapture::~GpfifoCapture() {
+        std::scoped_lock lock{mutex};
+        Flush();
+    }
+
+    void GpfifoCapture::WriteRecord(capture::RecordType type, u32 id, u64 address, u64 size, span<const u8> data) {
+        size_t offset{pendingData.size()};
+        pendingData.resize(offset + sizeof(capture::RecordHeader) + (data.empty() ? 0 : static_cast<size_t>(LZ4_compressBound(static_cast<int>(data.size())))));
+
+        u64 compressedSize{};
+        if (!data.empty())
+            compressedSize = static_cast<u64>(LZ4_compress_default(reinterpret_cast<const char *>(data.data()), reinterpret_cast<char *>(pendingData.data() + offset + sizeof(capture::RecordHeader)), static_cast<int>(data.size()), static_cast<int>(pendingData.size() - offset - sizeof(capture::RecordHeader))));
+
+        capture::RecordHeader header{
+            .type = type,
+            .id = id,
+            .address = address,
+            .size = size,
+            .compressedSize = compressedSize,
+        };
+        std::memcpy(pendingData.data() + offset, &header, sizeof(capture::RecordHeader));
+        pendingData.resize(offset + sizeof(capture::RecordHeader) + compressedSize);
+
+        if (pendingData.size() >= FlushThreshold)
+            Flush();
+    }
+
+    void GpfifoCapture::WriteMemory(u32 asId, u64 address, span<const u8> data) {
+        for (size_t offset{}; offset < data.size(); offset += MaxChunkSize) {
+            auto chunk{data.subspan(offset, std::min(MaxChunkSize, data.size() - offset))};
+            WriteRecord(capture::RecordType::Write, asId, address + offset, chunk.size(), chunk);
+        }
+    }
+
+    void GpfifoCapture::Flush() {
+        if (!backing || pendingData.empty())
+            return;
+
+        TRACE_EVENT("gpu", "GpfifoCapture::Flush");
+
+        try {
+            backingOffset += backing->Write(span{pendingData}, backingOffset);
+        } catch (const exception &e) {
+            Logger::Warn("Failed to write to the GPFIFO capture, capturing will be disabled: {}", e.what());
+            backing = nullptr;
+        }
+        pendingData.clear();
+    }
+
+    GpfifoCapture::AddressSpaceState &GpfifoCapture::GetAddressSpace(const std::shared_ptr<AddressSpaceContext> &asCtx) {
+        auto it{addressSpaces.find(asCtx)};
+        if (it == addressSpaces.end())
+            it = addressSpaces.emplace(asCtx, AddressSpaceState{.id = static_cast<u32>(addressSpaces.size())}).first;
+        return it->second;
+    }
+
+    void GpfifoCapture::CaptureMappings(const std::shared_ptr<AddressSpaceContext> &asCtx, AddressSpaceState &asState) {
+        struct Mapping {
+            u64 virt;
+            span<u8> mapping;
+            bool sparse;
+        };
+        std::vector<Mapping> newMappings;
+
+        // Mappings are only collected while the GMMU is locked, reading their contents with it held would stall any other threads accessing the GMMU for far too long
+        asCtx->gmmu.ForEachMapping([&](u64 virt, span<u8> mapping, bool sparse) {
+            if (asState.capturedMappings.emplace(virt, mapping.data(), mapping.size()).second)
+                newMappings.push_back({virt, mapping, sparse});
+        });
+
+        if (newMappings.empty())
+            return;
+
+        TRACE_EVENT("gpu", "GpfifoCapture::CaptureMappings");
+
+        for (const auto &mapping : newMappings) {
+            if (mapping.sparse) {
+                WriteRecord(capture::RecordType::MapSparse, asState.id, mapping.virt, mapping.mapping.size());
+            } else {
+                WriteRecord(capture::RecordType::Map, asState.id, mapping.virt, mapping.mapping.size());
+                WriteMemory(asState.id, mapping.virt, mapping.mapping);
+            }
+        }
+    }
+
+    u32 GpfifoCapture::RegisterChannel(const std::shared_ptr<AddressSpaceContext> &asCtx) {
+        std::scoped_lock lock{mutex};
+        u32 channelId{nextChannelId++};
+        if (backing)
+            WriteRecord(capture::RecordType::Channel, channelId, GetAddressSpace(asCtx).id, 0);
+        return channelId;
+    }
+
+    void GpfifoCapture::Capture(u32 channelId, const std::shared_ptr<AddressSpaceContext> &asCtx, GpEntry gpEntry, span<const u32> pushBuffer) {
+        std::scoped_lock lock{mutex};
+        if (!backing)
+            return;
+
+        TRACE_EVENT("gpu", "GpfifoCapture::Capture");
+
+        auto &asState{GetAddressSpace(asCtx)};
+        CaptureMappings(asCtx, asState);
+
+        // The pushbuffer is always captured as its memory is commonly reused as a ring buffer by the guest after the mapping was captured
+        WriteRecord(capture::RecordType::GpEntry, channelId, util::BitCast<u64>(gpEntry), pushBuffer.size_bytes(), pushBuffer.cast<const u8>());
+    }
+}
@@ -0,0 +1,109 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <map>
+#include <set>
+#include <vfs/backing.h>
+#include "gmmu.h"
+#include "gpfifo.h"
+
+namespace skyline::soc::gm20b {
+    /**
+     * @brief The on-disk format of GPFIFO captures, a capture is a file header followed by a stream of records in the order they were captured in
+     * @note All record data is LZ4 compressed
+     */
+    namespace capture {
+        struct FileHeader {
+            static constexpr u32 Magic{util::MakeMagic<u32>("SKGC")};
+            static constexpr u32 Version{1}; //!< The version of the capture format, this must be incremented for any changes to the format
+
+            u32 magic;
+            u32 version;
+            u64 titleId;
+        };
+        static_assert(sizeof(FileHeader) == 0x10);
+
+        enum class RecordType : u32 {
+            Channel, //!< A channel was created, `id` is the ID of the channel and `address` is the ID of its address space
+            Map, //!< A region of GPU VA was mapped, `id` is the ID of the address space and `address`/`size` are the mapped region, the contents of the mapping follow as `Write` records
+            MapSparse, //!< A region of GPU VA was sparsely mapped, this has the same layout as `Map` but isn't followed by its contents
+            Write, //!< A region of GPU memory was written to, `id` is the ID of the address space and `address`/`size` are the written region
+            GpEntry, //!< A GpEntry was processed, `id` is the ID of the channel, `address` is the raw GpEntry and `size` is the size of its pushbuffer which follows the header
+        };
+
+        struct RecordHeader {
+            RecordType type;
+            u32 id;
+            u64 address;
+            u64 size;
+            u64 compressedSize; //!< The size of the LZ4 compressed data following the header
+        };
+        static_assert(sizeof(RecordHeader) == 0x20);
+    }
+
+    /**
+     * @brief Records all GpEntries processed by channels alongside their pushbuffers and the GPU memory they might reference into a file, it can be replayed offline with GpfifoReplayer
+     * @note A mapping's contents are only captured the first time it's seen, CPU writes to the mapping after that aren't captured as it'd require hashing all mapped memory for every GpEntry
+     * @note Mappings aliasing the same memory are captured separately and as a result lose their aliasing on replay
+     */
+    class GpfifoCapture {
+      private:
+        static constexpr size_t MaxChunkSize{0x1000000}; //!< The maximum size of the data in a single record, larger writes are split into multiple records
+        static constexpr size_t FlushThreshold{0x400000}; //!< The amount of pending data after which it's written to the file
+
+        struct AddressSpaceState {
+            u32 id;
+            std::set<std::tuple<u64, u8 *, u64>> capturedMappings; //!< The VA, host mapping and size of all mappings that have been captured
+        };
+
+        std::mutex mutex;
+        std::shared_ptr<vfs::Backing> backing;
+        std::vector<u8> pendingData; //!< Records that haven't been written to the backing yet
+        size_t backingOffset{}; //!< The offset in the backing to write pending data at
+        std::map<std::weak_ptr<AddressSpaceContext>, AddressSpaceState, std::owner_less<>> addressSpaces;
+        u32 nextChannelId{};
+
+        /**
+         * @brief Appends a record with the supplied data to the pending data, the data is compressed in the process
+         */
+        void WriteRecord(capture::RecordType type, u32 id, u64 address, u64 size, span<const u8> data = {});
+
+        /**
+         * @brief Appends `Write` records for the supplied data, splitting it into chunks as required
+         */
+        void WriteMemory(u32 asId, u64 address, span<const u8> data);
+
+        /**
+         * @brief Writes all pending data to the backing
+         */
+        void Flush();
+
+        AddressSpaceState &GetAddressSpace(const std::shared_ptr<AddressSpaceContext> &asCtx);
+
+        /**
+         * @brief Captures the contents of all mappings in the address space that weren't captured before
+         */
+        void CaptureMappings(const std::shared_ptr<AddressSpaceContext> &asCtx, AddressSpaceState &asState);
+
+      public:
+        /**
+         * @param path The directory that captures are stored in, any existing capture for the title is overwritten
+         */
+        GpfifoCapture(const std::string &path, u64 titleId);
+
+        ~GpfifoCapture();
+
+        /**
+         * @return The ID of a newly created channel in the capture
+         */
+        u32 RegisterChannel(const std::shared_ptr<AddressSpaceContext> &asCtx);
+
+        /**
+         * @brief Captures a GpEntry alongside its pushbuffer and any new mappings in the channel's address space
+         * @note This must be called prior to the GpEntry being processed as processing may modify the memory it references
+         */
+        void Capture(u32 channelId, const std::shared_ptr<AddressSpaceContext> &asCtx, GpEntry gpEntry, span<const u32> pushBuffer);
+    };
+}
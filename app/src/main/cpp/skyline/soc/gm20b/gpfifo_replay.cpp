@@ -0,0 +1,207 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <sys/mman.h>
+#include <lz4.h>
+#include <vfs/os_filesystem.h>
+#include <common/signal.h>
+#include <common/trace.h>
+#include <soc.h>
+#include <gpu.h>
+#include <nce.h>
+#include "channel.h"
+#include "gpfifo_replay.h"
+
+namespace skyline::soc::gm20b {
+    GpfifoReplayer::GpfifoReplayer(const DeviceState &state, const std::string &path, u64 titleId) : state{state} {
+        TRACE_EVENT("gpu", "GpfifoReplayer::GpfifoReplayer");
+
+        auto filename{fmt::format("{:016X}.bin", titleId)};
+        vfs::OsFileSystem filesystem{path};
+        if (!filesystem.FileExists(filename))
+            throw exception("No GPFIFO capture exists for title {:016X}", titleId);
+
+        auto backing{filesystem.OpenFile(filename)};
+        if (backing->size < sizeof(capture::FileHeader))
+            throw exception("GPFIFO capture is too small: 0x{:X} bytes", backing->size);
+
+        auto header{backing->Read<capture::FileHeader>()};
+        if (header.magic != capture::FileHeader::Magic || header.version != capture::FileHeader::Version || header.titleId != titleId)
+            throw exception("GPFIFO capture is invalid or from an incompatible version: magic: 0x{:X}, version: {}, title: {:016X}", header.magic, header.version, header.titleId);
+
+        contents.resize(backing->size - sizeof(capture::FileHeader));
+        backing->Read(span{contents}, sizeof(capture::FileHeader));
+
+        // All records are parsed and every mapping is assigned a region of host memory upfront so iterations only need to restore the contents of memory
+        size_t memorySize{}, entryCount{}, wordCount{};
+        for (size_t offset{}; contents.size() - offset >= sizeof(capture::RecordHeader);) {
+            Record record{};
+            std::memcpy(&record.header, contents.data() + offset, sizeof(capture::RecordHeader));
+            offset += sizeof(capture::RecordHeader);
+
+            if (contents.size() - offset < record.header.compressedSize) {
+                Logger::Warn("GPFIFO capture is truncated, {} records were loaded", records.size());
+                break;
+            }
+            record.data = span{contents}.subspan(offset, record.header.compressedSize);
+            offset += record.header.compressedSize;
+
+            switch (record.header.type) {
+                case capture::RecordType::Map:
+                    record.mappingOffset = memorySize;
+                    memorySize += util::AlignUp(record.header.size, constant::PageSize);
+                    break;
+
+                case capture::RecordType::GpEntry: {
+                    record.pushBufferOffset = pushBuffers.size();
+                    pushBuffers.resize(pushBuffers.size() + record.header.size / sizeof(u32));
+
+                    auto pushBuffer{span{pushBuffers}.subspan(record.pushBufferOffset).cast<u8>()};
+                    if (LZ4_decompress_safe(reinterpret_cast<char *>(record.data.data()), reinterpret_cast<char *>(pushBuffer.data()), static_cast<int>(record.data.size()), static_cast<int>(pushBuffer.size())) != static_cast<int>(record.header.size))
+                        throw exception("Failed to decompress the pushbuffer of GpEntry record {}", records.size());
+
+                    entryCount++;
+                    wordCount += record.header.size / sizeof(u32);
+                    break;
+                }
+
+                case capture::RecordType::Channel:
+                case capture::RecordType::MapSparse:
+                case capture::RecordType::Write:
+                    break;
+
+                default:
+                    throw exception("Unknown GPFIFO capture record type: {}", static_cast<u32>(record.header.type));
+            }
+
+            records.push_back(record);
+        }
+
+        if (memorySize) {
+            auto pointer{mmap(nullptr, memorySize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0)};
+            if (pointer == MAP_FAILED)
+                throw exception("Failed to allocate 0x{:X} bytes of memory for GPFIFO replay: {}", memorySize, strerror(errno));
+            memory = span{reinterpret_cast<u8 *>(pointer), memorySize};
+        }
+
+        Logger::Info("Loaded GPFIFO capture with {} GpEntries ({} pushbuffer words) and 0x{:X} bytes of mapped memory", entryCount, wordCount, memorySize);
+    }
+
+    GpfifoReplayer::~GpfifoReplayer() {
+        if (memory.valid())
+            munmap(memory.data(), memory.size());
+    }
+
+    i64 GpfifoReplayer::RunIteration() {
+        std::vector<std::shared_ptr<AddressSpaceContext>> addressSpaces;
+        std::vector<std::unique_ptr<ChannelContext>> channels;
+        ChannelContext *activeChannel{}; // The channel that GpEntries were last processed on, it may have recorded work that hasn't been submitted yet
+        std::vector<u8> writeBuffer;
+        std::vector<u32> pushBuffer;
+        i64 processingTime{};
+
+        auto getAddressSpace{[&](u32 id) -> std::shared_ptr<AddressSpaceContext> & {
+            while (addressSpaces.size() <= id)
+                addressSpaces.push_back(std::make_shared<AddressSpaceContext>());
+            return addressSpaces[id];
+        }};
+
+        // Memory may only be modified while no channel is locked as the trap handlers of GPU resources backed by it might need to lock resources that are attached to an execution
+        auto submitChannel{[&] {
+            if (!activeChannel)
+                return;
+
+            auto startTime{util::GetTimeNs()};
+            activeChannel->Submit();
+            processingTime += util::GetTimeNs() - startTime;
+
+            activeChannel = nullptr;
+        }};
+
+        for (const auto &record : records) {
+            const auto &header{record.header};
+            switch (header.type) {
+                case capture::RecordType::Channel: {
+                    if (channels.size() <= header.id)
+                        channels.resize(header.id + 1);
+
+                    auto &channel{channels[header.id]};
+                    channel = std::make_unique<ChannelContext>(state, getAddressSpace(static_cast<u32>(header.address)), ChannelGpEntryCount);
+                    channel->gpfifo.gpfifoEngine.skipWaits = true;
+                    break;
+                }
+
+                case capture::RecordType::Map:
+                    submitChannel();
+                    getAddressSpace(header.id)->gmmu.Map(header.address, memory.data() + record.mappingOffset, header.size);
+                    break;
+
+                case capture::RecordType::MapSparse:
+                    submitChannel();
+                    getAddressSpace(header.id)->gmmu.Map(header.address, GMMU::SparsePlaceholderAddress(), header.size, {true});
+                    break;
+
+                case capture::RecordType::Write: {
+                    submitChannel();
+                    writeBuffer.resize(header.size);
+                    if (LZ4_decompress_safe(reinterpret_cast<char *>(record.data.data()), reinterpret_cast<char *>(writeBuffer.data()), static_cast<int>(record.data.size()), static_cast<int>(writeBuffer.size())) != static_cast<int>(header.size))
+                        throw exception("Failed to decompress GPFIFO capture write at 0x{:X}", header.address);
+                    getAddressSpace(header.id)->gmmu.Write(header.address, writeBuffer.data(), header.size);
+                    break;
+                }
+
+                case capture::RecordType::GpEntry: {
+                    if (channels.size() <= header.id || !channels[header.id])
+                        throw exception("GpEntry record references unknown channel {}", header.id);
+
+                    auto &channel{*channels[header.id]};
+                    if (activeChannel != &channel) {
+                        submitChannel();
+                        activeChannel = &channel;
+                    }
+
+                    // The pushbuffer is copied so any modifications made to it during processing don't affect later iterations
+                    auto source{span{pushBuffers}.subspan(record.pushBufferOffset, header.size / sizeof(u32))};
+                    pushBuffer.assign(source.begin(), source.end());
+
+                    auto gpEntry{util::BitCast<GpEntry>(header.address)};
+                    auto startTime{util::GetTimeNs()};
+                    if (gpEntry.sync == GpEntry::Sync::Wait)
+                        channel.Submit();
+                    channel.gpfifo.ProcessPushBuffer(pushBuffer);
+                    processingTime += util::GetTimeNs() - startTime;
+                    break;
+                }
+            }
+        }
+
+        submitChannel();
+
+        // All work from this iteration is completed prior to destroying the channels so the next iteration doesn't contend with it
+        {
+            std::scoped_lock lock{state.gpu->queueMutex};
+            state.gpu->vkQueue.waitIdle();
+        }
+
+        return processingTime;
+    }
+
+    void GpfifoReplayer::Run(u32 iterations) {
+        TRACE_EVENT("gpu", "GpfifoReplayer::Run");
+
+        signal::SetSignalHandler({SIGSEGV}, nce::NCE::HostSignalHandler); // Memory accesses may hit NCE traps on the host memory backing GPU resources
+
+        std::vector<i64> times;
+        times.reserve(iterations);
+        for (u32 iteration{}; iteration < iterations; iteration++) {
+            times.push_back(RunIteration());
+            Logger::Info("GPFIFO replay iteration {}/{}: {:.2f}ms", iteration + 1, iterations, static_cast<double>(times.back()) / constant::NsInMillisecond);
+        }
+
+        if (times.empty())
+            return;
+
+        std::sort(times.begin(), times.end());
+        Logger::Info("GPFIFO replay finished: min: {:.2f}ms, median: {:.2f}ms, max: {:.2f}ms", static_cast<double>(times.front()) / constant::NsInMillisecond, static_cast<double>(times[times.size() / 2]) / constant::NsInMillisecond, static_cast<double>(times.back()) / constant::NsInMillisecond);
+    }
+}
@@ -0,0 +1,54 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include "gpfifo_capture.h"
+
+namespace skyline::soc::gm20b {
+    /**
+     * @brief Replays a GPFIFO capture through freshly created channels to benchmark the GPU frontend (the engines and the interconnect) with a deterministic workload
+     * @note Every iteration starts from the state at the start of the capture and processes all GpEntries on the calling thread in the order they were captured in
+     * @note Syncpoint waits and semaphore acquires are skipped as the CPU work they would wait on doesn't exist during a replay
+     * @note Only time spent processing GpEntries and submitting the resulting work is measured, restoring memory and waiting for the GPU to finish executing aren't
+     */
+    class GpfifoReplayer {
+      private:
+        static constexpr size_t ChannelGpEntryCount{1}; //!< The amount of entries in the FIFO of replay channels, entries are processed directly rather than pushed to the FIFO
+
+        struct Record {
+            capture::RecordHeader header;
+            span<u8> data; //!< The compressed data of the record
+            size_t mappingOffset{}; //!< The offset of the host memory backing the region in `memory` for `Map` records
+            size_t pushBufferOffset{}; //!< The offset of the decompressed pushbuffer in `pushBuffers` for `GpEntry` records
+        };
+
+        const DeviceState &state;
+        std::vector<u8> contents; //!< The contents of the capture file
+        std::vector<Record> records;
+        std::vector<u32> pushBuffers; //!< The decompressed pushbuffers of all GpEntries, these are decompressed ahead of time so decompression isn't measured
+        span<u8> memory; //!< The host memory backing all mapped regions, it's reused across iterations so host resources created from it can be reused
+
+        /**
+         * @return The time spent processing GpEntries in nanoseconds
+         */
+        i64 RunIteration();
+
+      public:
+        /**
+         * @param path The directory that captures are stored in
+         */
+        GpfifoReplayer(const DeviceState &state, const std::string &path, u64 titleId);
+
+        GpfifoReplayer(const GpfifoReplayer &) = delete;
+
+        GpfifoReplayer &operator=(const GpfifoReplayer &) = delete;
+
+        ~GpfifoReplayer();
+
+        /**
+         * @brief Replays the capture the specified amount of times and logs the time taken by each iteration
+         */
+        void Run(u32 iterations);
+    };
+}
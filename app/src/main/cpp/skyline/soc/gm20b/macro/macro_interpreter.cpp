@@ -22,7 +22,7 @@ namespace skyline::soc::gm20b::engine {
         while (Step());
     }
 
-    __attribute__((always_inline)) bool MacroInterpreter::Step(Opcode *delayedOpcode) {
+    bool MacroInterpreter::Step(Opcode *delayedOpcode) {
         switch (opcode->operation) {
             case Opcode::Operation::AluRegister: {
                 u32 result{HandleAlu(opcode->aluOperation, registers[opcode->srcA], registers[opcode->srcB])};
@@ -13,6 +13,8 @@ namespace skyline::soc::gm20b::engine {
      */
     class MacroInterpreter {
       private:
+        friend class MacroProgram;
+
         #pragma pack(push, 1)
         union Opcode {
             u32 raw;
@@ -116,6 +118,7 @@ namespace skyline::soc::gm20b::engine {
         /**
          * @brief Steps forward one macro instruction, including delay slots
          * @param delayedOpcode The target opcode to be jumped to after executing the instruction
+         * @note This can't be forced inline as it recurses to execute delay slots
          */
         bool Step(Opcode *delayedOpcode = nullptr);
 
@@ -0,0 +1,1255 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <bit>
+#include <sys/mman.h>
+#include "soc/gm20b/engines/engine.h"
+#include "macro_jit.h"
+
+namespace skyline::soc::gm20b::engine {
+    namespace {
+        using Label = size_t; //!< An index into the labels of an assembler
+
+        #if defined(__aarch64__)
+
+        /**
+         * @brief A minimal AArch64 assembler for the instructions used by the macro JIT, all data processing instructions operate on W registers unless they're suffixed with X
+         * @url https://developer.arm.com/documentation/ddi0602/latest/Base-Instructions
+         */
+        class Assembler {
+          private:
+            enum class BranchType {
+                Immediate26, //!< B
+                Immediate19, //!< CBZ/CBNZ
+                Immediate14, //!< TBZ/TBNZ
+            };
+
+            struct Fixup {
+                size_t index; //!< The index of the branch instruction
+                Label label;
+                BranchType type;
+            };
+
+            std::vector<u32> code;
+            std::vector<size_t> labels; //!< The index of the instruction each label is bound to
+            std::vector<Fixup> fixups;
+
+            void Emit(u32 instruction) {
+                code.push_back(instruction);
+            }
+
+            void EmitBranch(u32 instruction, Label label, BranchType type) {
+                fixups.push_back({code.size(), label, type});
+                Emit(instruction);
+            }
+
+            static constexpr u32 Operands(u8 rd, u8 rn, u8 rm = 0) {
+                return (static_cast<u32>(rm) << 16) | (static_cast<u32>(rn) << 5) | rd;
+            }
+
+          public:
+            static constexpr u8 Zr{31}; //!< The zero register, this is only valid for operands that don't encode SP as register 31
+            static constexpr u8 Sp{31}; //!< The stack pointer, this is only valid as the base register of loads/stores and as an operand of immediate ADD/SUB
+
+            Label CreateLabel() {
+                labels.push_back(std::numeric_limits<size_t>::max());
+                return labels.size() - 1;
+            }
+
+            void Bind(Label label) {
+                labels[label] = code.size();
+            }
+
+            void Add(u8 rd, u8 rn, u8 rm) {
+                Emit(0x0B000000 | Operands(rd, rn, rm));
+            }
+
+            void AddX(u8 rd, u8 rn, u8 rm) {
+                Emit(0x8B000000 | Operands(rd, rn, rm));
+            }
+
+            void Sub(u8 rd, u8 rn, u8 rm) {
+                Emit(0x4B000000 | Operands(rd, rn, rm));
+            }
+
+            void And(u8 rd, u8 rn, u8 rm) {
+                Emit(0x0A000000 | Operands(rd, rn, rm));
+            }
+
+            void Bic(u8 rd, u8 rn, u8 rm) {
+                Emit(0x0A200000 | Operands(rd, rn, rm));
+            }
+
+            void Orr(u8 rd, u8 rn, u8 rm) {
+                Emit(0x2A000000 | Operands(rd, rn, rm));
+            }
+
+            void Orn(u8 rd, u8 rn, u8 rm) {
+                Emit(0x2A200000 | Operands(rd, rn, rm));
+            }
+
+            void Eor(u8 rd, u8 rn, u8 rm) {
+                Emit(0x4A000000 | Operands(rd, rn, rm));
+            }
+
+            void Mov(u8 rd, u8 rm) {
+                Orr(rd, Zr, rm);
+            }
+
+            void MovX(u8 rd, u8 rm) {
+                Emit(0xAA000000 | Operands(rd, Zr, rm));
+            }
+
+            void Mvn(u8 rd, u8 rm) {
+                Orn(rd, Zr, rm);
+            }
+
+            void Lslv(u8 rd, u8 rn, u8 rm) {
+                Emit(0x1AC02000 | Operands(rd, rn, rm));
+            }
+
+            void Lsrv(u8 rd, u8 rn, u8 rm) {
+                Emit(0x1AC02400 | Operands(rd, rn, rm));
+            }
+
+            void AddImmediateX(u8 rd, u8 rn, u16 immediate) {
+                Emit(0x91000000 | (static_cast<u32>(immediate) << 10) | Operands(rd, rn));
+            }
+
+            void SubImmediate(u8 rd, u8 rn, u16 immediate) {
+                Emit(0x51000000 | (static_cast<u32>(immediate) << 10) | Operands(rd, rn));
+            }
+
+            /**
+             * @note This is CMP Wn, #0 which is an alias of SUBS WZR, Wn, #0
+             */
+            void CmpZero(u8 rn) {
+                Emit(0x71000000 | Operands(Zr, rn));
+            }
+
+            /**
+             * @note This is CSET Wd, NE which is an alias of CSINC Wd, WZR, WZR, EQ
+             */
+            void CsetNe(u8 rd) {
+                Emit(0x1A9F07E0 | rd);
+            }
+
+            void Ubfm(u8 rd, u8 rn, u8 immr, u8 imms) {
+                Emit(0x53000000 | (static_cast<u32>(immr) << 16) | (static_cast<u32>(imms) << 10) | Operands(rd, rn));
+            }
+
+            void Lsr(u8 rd, u8 rn, u8 shift) {
+                Ubfm(rd, rn, shift, 31);
+            }
+
+            void Lsl(u8 rd, u8 rn, u8 shift) {
+                Ubfm(rd, rn, static_cast<u8>((32 - shift) % 32), static_cast<u8>(31 - shift));
+            }
+
+            void Ubfx(u8 rd, u8 rn, u8 lsb, u8 width) {
+                Ubfm(rd, rn, lsb, static_cast<u8>(lsb + width - 1));
+            }
+
+            void LsrX(u8 rd, u8 rn, u8 shift) {
+                Emit(0xD340FC00 | (static_cast<u32>(shift) << 16) | Operands(rd, rn));
+            }
+
+            /**
+             * @brief Inserts the lowest bits of Wn into the lowest bits of Wd, leaving the rest of Wd unchanged
+             */
+            void Bfxil(u8 rd, u8 rn, u8 width) {
+                Emit(0x33000000 | (static_cast<u32>(width - 1) << 10) | Operands(rd, rn));
+            }
+
+            void MovImmediate(u8 rd, u32 value) {
+                if (value & 0xFFFF || !value) {
+                    Emit(0x52800000 | ((value & 0xFFFF) << 5) | rd); // MOVZ Wd, #lo
+                    if (value >> 16)
+                        Emit(0x72A00000 | ((value >> 16) << 5) | rd); // MOVK Wd, #hi, LSL #16
+                } else {
+                    Emit(0x52A00000 | ((value >> 16) << 5) | rd); // MOVZ Wd, #hi, LSL #16
+                }
+            }
+
+            void MovImmediateX(u8 rd, u64 value) {
+                Emit(0xD2800000 | (static_cast<u32>(value & 0xFFFF) << 5) | rd); // MOVZ Xd, #imm
+                for (u32 hw{1}; hw < 4; hw++)
+                    if (u32 part{static_cast<u32>((value >> (hw * 16)) & 0xFFFF)})
+                        Emit(0xF2800000 | (hw << 21) | (part << 5) | rd); // MOVK Xd, #imm, LSL #(hw * 16)
+            }
+
+            /**
+             * @brief Loads a word from [Xn] and increments Xn by the offset afterwards
+             */
+            void LdrPostIndex(u8 rt, u8 rn, i16 offset) {
+                Emit(0xB8400400 | ((static_cast<u32>(offset) & 0x1FF) << 12) | Operands(rt, rn));
+            }
+
+            void LdrX(u8 rt, u8 rn, u16 offset) {
+                Emit(0xF9400000 | (static_cast<u32>(offset / sizeof(u64)) << 10) | Operands(rt, rn));
+            }
+
+            void StrX(u8 rt, u8 rn, u16 offset) {
+                Emit(0xF9000000 | (static_cast<u32>(offset / sizeof(u64)) << 10) | Operands(rt, rn));
+            }
+
+            void StpX(u8 rt, u8 rt2, u8 rn, i16 offset) {
+                Emit(0xA9000000 | ((static_cast<u32>(offset / 8) & 0x7F) << 15) | Operands(rt, rn, 0) | (static_cast<u32>(rt2) << 10));
+            }
+
+            /**
+             * @brief Decrements Xn by the offset prior to storing to it
+             */
+            void StpXPreIndex(u8 rt, u8 rt2, u8 rn, i16 offset) {
+                Emit(0xA9800000 | ((static_cast<u32>(offset / 8) & 0x7F) << 15) | Operands(rt, rn, 0) | (static_cast<u32>(rt2) << 10));
+            }
+
+            void LdpX(u8 rt, u8 rt2, u8 rn, i16 offset) {
+                Emit(0xA9400000 | ((static_cast<u32>(offset / 8) & 0x7F) << 15) | Operands(rt, rn, 0) | (static_cast<u32>(rt2) << 10));
+            }
+
+            /**
+             * @brief Increments Xn by the offset after loading from it
+             */
+            void LdpXPostIndex(u8 rt, u8 rt2, u8 rn, i16 offset) {
+                Emit(0xA8C00000 | ((static_cast<u32>(offset / 8) & 0x7F) << 15) | Operands(rt, rn, 0) | (static_cast<u32>(rt2) << 10));
+            }
+
+            void Blr(u8 rn) {
+                Emit(0xD63F0000 | Operands(0, rn));
+            }
+
+            void Ret() {
+                Emit(0xD65F03C0);
+            }
+
+            void B(Label label) {
+                EmitBranch(0x14000000, label, BranchType::Immediate26);
+            }
+
+            void Cbz(u8 rt, Label label) {
+                EmitBranch(0x34000000 | rt, label, BranchType::Immediate19);
+            }
+
+            void Cbnz(u8 rt, Label label) {
+                EmitBranch(0x35000000 | rt, label, BranchType::Immediate19);
+            }
+
+            /**
+             * @brief Branches if the specified bit of Xt is zero
+             */
+            void TbzX(u8 rt, u8 bit, Label label) {
+                EmitBranch(0x36000000 | (static_cast<u32>(bit >> 5) << 31) | (static_cast<u32>(bit & 0x1F) << 19) | rt, label, BranchType::Immediate14);
+            }
+
+            /**
+             * @return The assembled code with all branches resolved
+             */
+            std::vector<u8> Finalize() {
+                for (const auto &fixup : fixups) {
+                    if (labels[fixup.label] == std::numeric_limits<size_t>::max())
+                        throw exception("Branch to an unbound label");
+
+                    auto [bits, shift]{[&]() -> std::pair<u8, u8> {
+                        switch (fixup.type) {
+                            case BranchType::Immediate26:
+                                return {26, 0};
+                            case BranchType::Immediate19:
+                                return {19, 5};
+                            case BranchType::Immediate14:
+                                return {14, 5};
+                        }
+                        return {};
+                    }()};
+
+                    auto offset{static_cast<i64>(labels[fixup.label]) - static_cast<i64>(fixup.index)};
+                    if (offset < -(1LL << (bits - 1)) || offset >= (1LL << (bits - 1)))
+                        throw exception("Branch offset is out of range: {}", offset);
+
+                    code[fixup.index] |= (static_cast<u32>(offset) & ((1U << bits) - 1)) << shift;
+                }
+
+                auto bytes{span(code).cast<u8>()};
+                return {bytes.begin(), bytes.end()};
+            }
+        };
+
+        #elif defined(__x86_64__)
+
+        /**
+         * @brief A minimal x86-64 assembler for the instructions used by the macro JIT, all instructions operate on 32-bit registers unless they have a wide parameter
+         * @url https://www.intel.com/content/www/us/en/developer/articles/technical/intel-sdm.html
+         */
+        class Assembler {
+          private:
+            struct Fixup {
+                size_t offset; //!< The offset of the 32-bit relative displacement
+                Label label;
+            };
+
+            std::vector<u8> code;
+            std::vector<size_t> labels; //!< The offset each label is bound to
+            std::vector<Fixup> fixups;
+
+            void Emit(u8 byte) {
+                code.push_back(byte);
+            }
+
+            void Emit32(u32 value) {
+                for (size_t shift{}; shift < 32; shift += 8)
+                    Emit(static_cast<u8>(value >> shift));
+            }
+
+            void Emit64(u64 value) {
+                for (size_t shift{}; shift < 64; shift += 8)
+                    Emit(static_cast<u8>(value >> shift));
+            }
+
+            /**
+             * @brief Emits a REX prefix if one is required for the operand size or the registers
+             */
+            void EmitRex(bool wide, u8 reg, u8 rm) {
+                u8 rex{static_cast<u8>(0x40 | (wide << 3) | ((reg >> 3) << 2) | (rm >> 3))};
+                if (rex != 0x40)
+                    Emit(rex);
+            }
+
+            void EmitModRm(u8 mod, u8 reg, u8 rm) {
+                Emit(static_cast<u8>((mod << 6) | ((reg & 7) << 3) | (rm & 7)));
+            }
+
+            /**
+             * @brief Emits an instruction with a register-direct r/m operand and a register operand
+             */
+            void EmitRegister(u8 opcode, u8 rm, u8 reg, bool wide) {
+                EmitRex(wide, reg, rm);
+                Emit(opcode);
+                EmitModRm(0b11, reg, rm);
+            }
+
+            /**
+             * @brief Emits an instruction with a register-direct r/m operand and an opcode extension in the reg field
+             */
+            void EmitExtension(u8 opcode, u8 extension, u8 rm, bool wide) {
+                EmitRex(wide, 0, rm);
+                Emit(opcode);
+                EmitModRm(0b11, extension, rm);
+            }
+
+            void EmitDisplacement(Label label) {
+                fixups.push_back({code.size(), label});
+                Emit32(0);
+            }
+
+          public:
+            static constexpr u8 Rax{0}, Rcx{1}, Rdx{2}, Rbx{3}, Rsp{4}, Rbp{5}, Rsi{6}, Rdi{7};
+            static constexpr u8 R8{8}, R9{9}, R10{10}, R11{11}, R12{12}, R13{13}, R14{14}, R15{15};
+
+            enum class Condition : u8 {
+                Carry = 0x2,
+                Zero = 0x4,
+                NotZero = 0x5,
+            };
+
+            Label CreateLabel() {
+                labels.push_back(std::numeric_limits<size_t>::max());
+                return labels.size() - 1;
+            }
+
+            void Bind(Label label) {
+                labels[label] = code.size();
+            }
+
+            void Mov(u8 dest, u8 src, bool wide = false) {
+                EmitRegister(0x89, dest, src, wide);
+            }
+
+            void Add(u8 dest, u8 src, bool wide = false) {
+                EmitRegister(0x01, dest, src, wide);
+            }
+
+            void Or(u8 dest, u8 src) {
+                EmitRegister(0x09, dest, src, false);
+            }
+
+            void And(u8 dest, u8 src) {
+                EmitRegister(0x21, dest, src, false);
+            }
+
+            void Sub(u8 dest, u8 src) {
+                EmitRegister(0x29, dest, src, false);
+            }
+
+            void Xor(u8 dest, u8 src) {
+                EmitRegister(0x31, dest, src, false);
+            }
+
+            void Test(u8 dest, u8 src) {
+                EmitRegister(0x85, dest, src, false);
+            }
+
+            void AddImmediate(u8 dest, u32 immediate, bool wide = false) {
+                EmitExtension(0x81, 0, dest, wide);
+                Emit32(immediate);
+            }
+
+            void AndImmediate(u8 dest, u32 immediate) {
+                EmitExtension(0x81, 4, dest, false);
+                Emit32(immediate);
+            }
+
+            void SubImmediate(u8 dest, u32 immediate, bool wide = false) {
+                EmitExtension(0x81, 5, dest, wide);
+                Emit32(immediate);
+            }
+
+            void Not(u8 dest) {
+                EmitExtension(0xF7, 2, dest, false);
+            }
+
+            void ShlImmediate(u8 dest, u8 amount) {
+                EmitExtension(0xC1, 4, dest, false);
+                Emit(amount);
+            }
+
+            void ShrImmediate(u8 dest, u8 amount, bool wide = false) {
+                EmitExtension(0xC1, 5, dest, wide);
+                Emit(amount);
+            }
+
+            /**
+             * @brief Shifts left by the amount in CL
+             */
+            void ShlCl(u8 dest) {
+                EmitExtension(0xD3, 4, dest, false);
+            }
+
+            /**
+             * @brief Shifts right by the amount in CL
+             */
+            void ShrCl(u8 dest) {
+                EmitExtension(0xD3, 5, dest, false);
+            }
+
+            /**
+             * @brief Sets the low byte of a register to 1 if ZF is clear, this only supports registers with a low byte that doesn't require a REX prefix
+             */
+            void Setne(u8 dest) {
+                Emit(0x0F);
+                Emit(0x95);
+                EmitModRm(0b11, 0, dest);
+            }
+
+            /**
+             * @brief Zero-extends the low byte of a register, the source only supports registers with a low byte that doesn't require a REX prefix
+             */
+            void Movzx8(u8 dest, u8 src) {
+                EmitRex(false, dest, src);
+                Emit(0x0F);
+                Emit(0xB6);
+                EmitModRm(0b11, dest, src);
+            }
+
+            void MovImmediate(u8 dest, u32 immediate) {
+                EmitRex(false, 0, dest);
+                Emit(static_cast<u8>(0xB8 | (dest & 7)));
+                Emit32(immediate);
+            }
+
+            void MovImmediate64(u8 dest, u64 immediate) {
+                EmitRex(true, 0, dest);
+                Emit(static_cast<u8>(0xB8 | (dest & 7)));
+                Emit64(immediate);
+            }
+
+            /**
+             * @brief Loads a 32-bit value from [base], this doesn't support bases that require a SIB byte or displacement (RSP/RBP/R12/R13)
+             */
+            void Load(u8 dest, u8 base) {
+                EmitRex(false, dest, base);
+                Emit(0x8B);
+                EmitModRm(0b00, dest, base);
+            }
+
+            /**
+             * @brief Loads a 64-bit value from [RSP + offset]
+             */
+            void LoadStack(u8 dest, u8 offset) {
+                EmitRex(true, dest, Rsp);
+                Emit(0x8B);
+                EmitModRm(0b01, dest, Rsp);
+                Emit(0x24); // SIB: [RSP]
+                Emit(offset);
+            }
+
+            /**
+             * @brief Stores a 64-bit value to [RSP + offset]
+             */
+            void StoreStack(u8 src, u8 offset) {
+                EmitRex(true, src, Rsp);
+                Emit(0x89);
+                EmitModRm(0b01, src, Rsp);
+                Emit(0x24); // SIB: [RSP]
+                Emit(offset);
+            }
+
+            void Push(u8 reg) {
+                EmitRex(false, 0, reg);
+                Emit(static_cast<u8>(0x50 | (reg & 7)));
+            }
+
+            void Pop(u8 reg) {
+                EmitRex(false, 0, reg);
+                Emit(static_cast<u8>(0x58 | (reg & 7)));
+            }
+
+            void Call(u8 reg) {
+                EmitExtension(0xFF, 2, reg, false);
+            }
+
+            /**
+             * @brief Copies the specified bit of a 64-bit register into CF
+             */
+            void Bt(u8 reg, u8 bit) {
+                EmitRex(true, 0, reg);
+                Emit(0x0F);
+                Emit(0xBA);
+                EmitModRm(0b11, 4, reg);
+                Emit(bit);
+            }
+
+            void Jmp(Label label) {
+                Emit(0xE9);
+                EmitDisplacement(label);
+            }
+
+            void J(Condition condition, Label label) {
+                Emit(0x0F);
+                Emit(static_cast<u8>(0x80 | static_cast<u8>(condition)));
+                EmitDisplacement(label);
+            }
+
+            void Ret() {
+                Emit(0xC3);
+            }
+
+            /**
+             * @return The assembled code with all jumps resolved
+             */
+            std::vector<u8> Finalize() {
+                for (const auto &fixup : fixups) {
+                    if (labels[fixup.label] == std::numeric_limits<size_t>::max())
+                        throw exception("Jump to an unbound label");
+
+                    auto displacement{static_cast<u32>(static_cast<i64>(labels[fixup.label]) - static_cast<i64>(fixup.offset + sizeof(u32)))};
+                    std::memcpy(code.data() + fixup.offset, &displacement, sizeof(u32));
+                }
+
+                return std::move(code);
+            }
+        };
+
+        #endif
+
+        /**
+         * @brief A method access made by a macro, this is used for comparing the accesses made by the JIT and the interpreter
+         */
+        struct MethodAccess {
+            bool read;
+            u32 method;
+            u32 value; //!< The argument of a call or the result of a read
+
+            bool operator==(const MethodAccess &) const = default;
+
+            std::string ToString() const {
+                return read ? fmt::format("a read of 0x{:X} (0x{:X})", method, value) : fmt::format("a call to 0x{:X} with 0x{:X}", method, value);
+            }
+        };
+
+        /**
+         * @brief An engine which forwards all method accesses to the target engine while recording them
+         */
+        class RecordingEngine : public MacroEngineBase {
+          private:
+            MacroEngineBase &engine;
+
+          public:
+            std::vector<MethodAccess> accesses;
+
+            RecordingEngine(MacroEngineBase &engine) : MacroEngineBase{engine.macroState}, engine{engine} {}
+
+            void CallMethodFromMacro(u32 method, u32 argument) override {
+                accesses.push_back({false, method, argument});
+                engine.CallMethodFromMacro(method, argument);
+            }
+
+            u32 ReadMethodFromMacro(u32 method) override {
+                u32 value{engine.ReadMethodFromMacro(method)};
+                accesses.push_back({true, method, value});
+                return value;
+            }
+        };
+
+        /**
+         * @brief An engine which checks method accesses against previously recorded ones without forwarding them, reads return the recorded values
+         */
+        class ReplayEngine : public MacroEngineBase {
+          private:
+            span<const MethodAccess> accesses;
+            bool truncated; //!< If the recording was cut short by an exception, accesses past its end are expected and stop execution without a divergence
+
+            /**
+             * @brief Records the divergence and throws to stop execution
+             */
+            [[noreturn]] void Diverge(const MethodAccess &access) {
+                if (index < accesses.size())
+                    divergence = fmt::format("access #{}: the interpreter made {} while the JIT made {}", index, access.ToString(), accesses[index].ToString());
+                else if (truncated)
+                    throw exception("Reached the end of a truncated recording");
+                else
+                    divergence = fmt::format("access #{}: the interpreter made {} after all accesses made by the JIT", index, access.ToString());
+                throw exception("{}", divergence);
+            }
+
+          public:
+            size_t index{}; //!< The index of the next access that's expected
+            std::string divergence; //!< A description of the first divergence from the recorded accesses, this is empty if there was none
+
+            ReplayEngine(MacroEngineBase &engine, span<const MethodAccess> accesses, bool truncated) : MacroEngineBase{engine.macroState}, accesses{accesses}, truncated{truncated} {}
+
+            void CallMethodFromMacro(u32 method, u32 argument) override {
+                MethodAccess access{false, method, argument};
+                if (index >= accesses.size() || accesses[index] != access)
+                    Diverge(access);
+                index++;
+            }
+
+            u32 ReadMethodFromMacro(u32 method) override {
+                if (index >= accesses.size() || !accesses[index].read || accesses[index].method != method)
+                    Diverge({true, method, 0});
+                return accesses[index++].value;
+            }
+        };
+    }
+
+    u64 MacroJit::CallMethodTrampoline(Context *context, u32 method, u32 argument) noexcept {
+        try {
+            context->engine->CallMethodFromMacro(method, argument);
+            return 0;
+        } catch (...) {
+            context->exception = std::current_exception();
+            return ExceptionFlag;
+        }
+    }
+
+    u64 MacroJit::ReadMethodTrampoline(Context *context, u32 method) noexcept {
+        try {
+            return context->engine->ReadMethodFromMacro(method);
+        } catch (...) {
+            context->exception = std::current_exception();
+            return ExceptionFlag;
+        }
+    }
+
+    u64 MacroJit::TrapTrampoline(Context *context, u32 reason, u32 rawOpcode) noexcept {
+        try {
+            MacroProgram::ThrowTrap(static_cast<MacroProgram::TrapReason>(reason), rawOpcode);
+        } catch (...) {
+            context->exception = std::current_exception();
+        }
+        return ExceptionFlag;
+    }
+
+    #if defined(__aarch64__)
+
+    std::vector<u8> MacroJit::Compile(const MacroProgram &program) {
+        using Operation = MacroProgram::Operation;
+        using AssignmentOperation = MacroProgram::Opcode::AssignmentOperation;
+
+        // Guest registers 1-7 are held in X19-X25 and the rest of the state is held in X26-X28, these are all callee-saved so engine calls don't require any spilling
+        constexpr u8 ArgumentPointer{26}, MethodAddress{27}, CarryFlag{28}, FramePointer{29}, LinkRegister{30};
+        constexpr u8 CallTarget{16}; //!< IP0, this is used to hold the address of trampolines as they may be out of range of BL
+        constexpr i16 FrameSize{0x70};
+        constexpr u16 ContextOffset{0x60}; //!< The offset of the context pointer in the stack frame, it's reloaded for every call rather than occupying a register
+
+        auto guestRegister{[](u8 index) -> u8 {
+            return index ? static_cast<u8>(18 + index) : Assembler::Zr;
+        }};
+
+        Assembler assembler;
+        std::vector<Label> instructionLabels(program.instructions.size());
+        for (auto &label : instructionLabels)
+            label = assembler.CreateLabel();
+        Label exitLabel{assembler.CreateLabel()};
+
+        assembler.StpXPreIndex(FramePointer, LinkRegister, Assembler::Sp, -FrameSize);
+        assembler.AddImmediateX(FramePointer, Assembler::Sp, 0);
+        for (u8 index{}; index < 5; index++)
+            assembler.StpX(static_cast<u8>(19 + (index * 2)), static_cast<u8>(20 + (index * 2)), Assembler::Sp, static_cast<i16>(0x10 + (index * 0x10)));
+        assembler.StrX(0, Assembler::Sp, ContextOffset);
+
+        // The first argument is stored in register 1
+        assembler.MovX(ArgumentPointer, 1);
+        assembler.LdrPostIndex(guestRegister(1), ArgumentPointer, sizeof(u32));
+        for (u8 index{2}; index < MacroProgram::RegisterCount; index++)
+            assembler.Mov(guestRegister(index), Assembler::Zr);
+        assembler.Mov(MethodAddress, Assembler::Zr);
+        assembler.Mov(CarryFlag, Assembler::Zr);
+        assembler.B(instructionLabels[program.entryIndex]);
+
+        // Calls a trampoline with the context pointer, the remaining arguments must be in W1/W2 already and the result is returned in W0
+        auto callTrampoline{[&](auto trampoline) {
+            assembler.LdrX(0, Assembler::Sp, ContextOffset);
+            assembler.MovImmediateX(CallTarget, reinterpret_cast<u64>(trampoline));
+            assembler.Blr(CallTarget);
+
+            Label continueLabel{assembler.CreateLabel()};
+            assembler.TbzX(0, std::countr_zero(ExceptionFlag), continueLabel);
+            assembler.B(exitLabel);
+            assembler.Bind(continueLabel);
+        }};
+
+        auto send{[&](u8 value) {
+            if (value != 2)
+                assembler.Mov(2, value);
+            assembler.Ubfx(1, MethodAddress, 0, 12);
+            callTrampoline(&CallMethodTrampoline);
+
+            // Only the 12-bit address is incremented, it wraps around without affecting the increment
+            assembler.Ubfx(1, MethodAddress, 12, 6);
+            assembler.Add(1, MethodAddress, 1);
+            assembler.Bfxil(MethodAddress, 1, 12);
+        }};
+
+        auto fetch{[&](u8 dest) {
+            if (dest != MacroProgram::ScratchRegister)
+                assembler.LdrPostIndex(guestRegister(dest), ArgumentPointer, sizeof(u32));
+            else
+                assembler.AddImmediateX(ArgumentPointer, ArgumentPointer, sizeof(u32));
+        }};
+
+        auto move{[&](u8 dest) {
+            if (dest != MacroProgram::ScratchRegister)
+                assembler.Mov(guestRegister(dest), 0);
+        }};
+
+        for (size_t index{}; index < program.instructions.size(); index++) {
+            const auto &instruction{program.instructions[index]};
+            assembler.Bind(instructionLabels[index]);
+
+            // The result of all operations that have an assignment is calculated into W0, W1 and W2 are used as temporaries
+            u8 srcA{guestRegister(instruction.srcA)}, srcB{guestRegister(instruction.srcB)};
+            switch (instruction.operation) {
+                case Operation::Add:
+                    // Guest registers are always written as W registers so their upper halves are zero and the carry is bit 32 of the 64-bit sum
+                    assembler.AddX(0, srcA, srcB);
+                    assembler.LsrX(CarryFlag, 0, 32);
+                    break;
+
+                case Operation::AddWithCarry:
+                    assembler.AddX(0, srcA, srcB);
+                    assembler.AddX(0, 0, CarryFlag);
+                    assembler.LsrX(CarryFlag, 0, 32);
+                    break;
+
+                case Operation::Subtract:
+                    assembler.Sub(0, srcA, srcB);
+                    assembler.CmpZero(0);
+                    assembler.CsetNe(CarryFlag);
+                    break;
+
+                case Operation::SubtractWithBorrow:
+                    // srcA - srcB - !carry is calculated as srcA - srcB - 1 + carry
+                    assembler.Sub(0, srcA, srcB);
+                    assembler.SubImmediate(0, 0, 1);
+                    assembler.Add(0, 0, CarryFlag);
+                    assembler.CmpZero(0);
+                    assembler.CsetNe(CarryFlag);
+                    break;
+
+                case Operation::BitwiseXor:
+                    assembler.Eor(0, srcA, srcB);
+                    break;
+
+                case Operation::BitwiseOr:
+                    assembler.Orr(0, srcA, srcB);
+                    break;
+
+                case Operation::BitwiseAnd:
+                    assembler.And(0, srcA, srcB);
+                    break;
+
+                case Operation::BitwiseAndNot:
+                    assembler.Bic(0, srcA, srcB);
+                    break;
+
+                case Operation::BitwiseNand:
+                    assembler.And(0, srcA, srcB);
+                    assembler.Mvn(0, 0);
+                    break;
+
+                case Operation::AddImmediate:
+                    assembler.MovImmediate(1, static_cast<u32>(instruction.immediate));
+                    assembler.Add(0, srcA, 1);
+                    break;
+
+                case Operation::BitfieldReplace:
+                    assembler.Lsr(1, srcB, instruction.srcBit);
+                    assembler.MovImmediate(2, instruction.mask);
+                    assembler.And(1, 1, 2);
+                    assembler.Lsl(1, 1, instruction.destBit);
+                    assembler.MovImmediate(2, ~(instruction.mask << instruction.destBit));
+                    assembler.And(0, srcA, 2);
+                    assembler.Orr(0, 0, 1);
+                    break;
+
+                case Operation::BitfieldExtractShiftLeftImmediate:
+                    assembler.Lsrv(1, srcB, srcA);
+                    assembler.MovImmediate(2, instruction.mask);
+                    assembler.And(1, 1, 2);
+                    assembler.Lsl(0, 1, instruction.destBit);
+                    break;
+
+                case Operation::BitfieldExtractShiftLeftRegister:
+                    assembler.Lsr(1, srcB, instruction.srcBit);
+                    assembler.MovImmediate(2, instruction.mask);
+                    assembler.And(1, 1, 2);
+                    assembler.Lslv(0, 1, srcA);
+                    break;
+
+                case Operation::ReadImmediate:
+                    assembler.MovImmediate(1, static_cast<u32>(instruction.immediate));
+                    assembler.Add(1, srcA, 1);
+                    callTrampoline(&ReadMethodTrampoline);
+                    break;
+
+                case Operation::BranchZero:
+                    assembler.Cbz(srcA, instructionLabels[static_cast<size_t>(instruction.immediate)]);
+                    continue;
+
+                case Operation::BranchNonZero:
+                    assembler.Cbnz(srcA, instructionLabels[static_cast<size_t>(instruction.immediate)]);
+                    continue;
+
+                case Operation::Jump:
+                    assembler.B(instructionLabels[static_cast<size_t>(instruction.immediate)]);
+                    continue;
+
+                case Operation::Exit:
+                    assembler.B(exitLabel);
+                    continue;
+
+                case Operation::Trap:
+                    assembler.MovImmediate(1, static_cast<u32>(instruction.trapReason));
+                    assembler.MovImmediate(2, static_cast<u32>(instruction.immediate));
+                    callTrampoline(&TrapTrampoline);
+                    continue;
+            }
+
+            switch (instruction.assignment) {
+                case AssignmentOperation::IgnoreAndFetch:
+                    fetch(instruction.dest);
+                    break;
+
+                case AssignmentOperation::Move:
+                    move(instruction.dest);
+                    break;
+
+                case AssignmentOperation::MoveAndSetMethod:
+                    move(instruction.dest);
+                    assembler.Mov(MethodAddress, 0);
+                    break;
+
+                case AssignmentOperation::FetchAndSend:
+                    fetch(instruction.dest);
+                    send(0);
+                    break;
+
+                case AssignmentOperation::MoveAndSend:
+                    move(instruction.dest);
+                    send(0);
+                    break;
+
+                case AssignmentOperation::FetchAndSetMethod:
+                    fetch(instruction.dest);
+                    assembler.Mov(MethodAddress, 0);
+                    break;
+
+                case AssignmentOperation::MoveAndSetMethodThenFetchAndSend:
+                    move(instruction.dest);
+                    assembler.Mov(MethodAddress, 0);
+                    assembler.LdrPostIndex(2, ArgumentPointer, sizeof(u32));
+                    send(2);
+                    break;
+
+                case AssignmentOperation::MoveAndSetMethodThenSendHigh:
+                    move(instruction.dest);
+                    assembler.Mov(MethodAddress, 0);
+                    assembler.Ubfx(2, MethodAddress, 12, 6);
+                    send(2);
+                    break;
+            }
+        }
+
+        assembler.Bind(exitLabel);
+        for (u8 index{}; index < 5; index++)
+            assembler.LdpX(static_cast<u8>(19 + (index * 2)), static_cast<u8>(20 + (index * 2)), Assembler::Sp, static_cast<i16>(0x10 + (index * 0x10)));
+        assembler.LdpXPostIndex(FramePointer, LinkRegister, Assembler::Sp, FrameSize);
+        assembler.Ret();
+
+        return assembler.Finalize();
+    }
+
+    #elif defined(__x86_64__)
+
+    std::vector<u8> MacroJit::Compile(const MacroProgram &program) {
+        using Operation = MacroProgram::Operation;
+        using AssignmentOperation = MacroProgram::Opcode::AssignmentOperation;
+        using Condition = Assembler::Condition;
+        constexpr u8 Rax{Assembler::Rax}, Rcx{Assembler::Rcx}, Rdx{Assembler::Rdx}, Rsp{Assembler::Rsp}, Rsi{Assembler::Rsi}, Rdi{Assembler::Rdi};
+
+        // There aren't enough callee-saved registers for the entire state, guest register 7 and the rest of the state are held in caller-saved registers which are saved around engine calls
+        constexpr std::array<u8, MacroProgram::RegisterCount> GuestRegisters{0, Assembler::Rbx, Assembler::Rbp, Assembler::R12, Assembler::R13, Assembler::R14, Assembler::R15, Assembler::R8};
+        constexpr std::array<u8, 6> CalleeSavedRegisters{Assembler::Rbx, Assembler::Rbp, Assembler::R12, Assembler::R13, Assembler::R14, Assembler::R15};
+        constexpr std::array<u8, 4> CallerSavedRegisters{Assembler::R8, Assembler::R9, Assembler::R10, Assembler::R11};
+        constexpr u8 MethodAddress{Assembler::R9}, CarryFlag{Assembler::R10}, ArgumentPointer{Assembler::R11};
+        constexpr u8 ContextOffset{0}; //!< The offset of the context pointer in the stack frame, it's reloaded for every call rather than occupying a register
+
+        Assembler assembler;
+        std::vector<Label> instructionLabels(program.instructions.size());
+        for (auto &label : instructionLabels)
+            label = assembler.CreateLabel();
+        Label exitLabel{assembler.CreateLabel()};
+
+        auto loadGuestRegister{[&](u8 dest, u8 index) {
+            if (index)
+                assembler.Mov(dest, GuestRegisters[index]);
+            else
+                assembler.Xor(dest, dest);
+        }};
+
+        // The pushes leave the stack misaligned by 8 bytes, the slot for the context pointer realigns it for calls
+        for (u8 reg : CalleeSavedRegisters)
+            assembler.Push(reg);
+        assembler.SubImmediate(Rsp, sizeof(u64), true);
+        assembler.StoreStack(Rdi, ContextOffset);
+
+        // The first argument is stored in register 1
+        assembler.Mov(ArgumentPointer, Rsi, true);
+        assembler.Load(GuestRegisters[1], ArgumentPointer);
+        assembler.AddImmediate(ArgumentPointer, sizeof(u32), true);
+        for (u8 index{2}; index < MacroProgram::RegisterCount; index++)
+            assembler.Xor(GuestRegisters[index], GuestRegisters[index]);
+        assembler.Xor(MethodAddress, MethodAddress);
+        assembler.Xor(CarryFlag, CarryFlag);
+        assembler.Jmp(instructionLabels[program.entryIndex]);
+
+        // Calls a trampoline with the context pointer, the remaining arguments must be in ESI/EDX already and the result is returned in EAX
+        auto callTrampoline{[&](auto trampoline) {
+            for (u8 reg : CallerSavedRegisters)
+                assembler.Push(reg);
+            assembler.LoadStack(Rdi, static_cast<u8>(ContextOffset + (CallerSavedRegisters.size() * sizeof(u64))));
+            assembler.MovImmediate64(Rax, reinterpret_cast<u64>(trampoline));
+            assembler.Call(Rax);
+            for (auto it{CallerSavedRegisters.rbegin()}; it != CallerSavedRegisters.rend(); it++)
+                assembler.Pop(*it);
+
+            assembler.Bt(Rax, std::countr_zero(ExceptionFlag));
+            assembler.J(Condition::Carry, exitLabel);
+        }};
+
+        auto send{[&](u8 value) {
+            if (value != Rdx)
+                assembler.Mov(Rdx, value);
+            assembler.Mov(Rsi, MethodAddress);
+            assembler.AndImmediate(Rsi, 0xFFF);
+            callTrampoline(&CallMethodTrampoline);
+
+            // Only the 12-bit address is incremented, it wraps around without affecting the increment
+            assembler.Mov(Rcx, MethodAddress);
+            assembler.ShrImmediate(Rcx, 12);
+            assembler.AndImmediate(Rcx, 0x3F);
+            assembler.Add(Rcx, MethodAddress);
+            assembler.AndImmediate(Rcx, 0xFFF);
+            assembler.AndImmediate(MethodAddress, ~0xFFFU);
+            assembler.Or(MethodAddress, Rcx);
+        }};
+
+        auto fetch{[&](u8 dest) {
+            if (dest != MacroProgram::ScratchRegister)
+                assembler.Load(GuestRegisters[dest], ArgumentPointer);
+            assembler.AddImmediate(ArgumentPointer, sizeof(u32), true);
+        }};
+
+        auto move{[&](u8 dest) {
+            if (dest != MacroProgram::ScratchRegister)
+                assembler.Mov(GuestRegisters[dest], Rax);
+        }};
+
+        for (size_t index{}; index < program.instructions.size(); index++) {
+            const auto &instruction{program.instructions[index]};
+            assembler.Bind(instructionLabels[index]);
+
+            // The result of all operations that have an assignment is calculated into EAX, ECX is used as a temporary
+            switch (instruction.operation) {
+                case Operation::Add:
+                    // Guest registers are always written as 32-bit registers so their upper halves are zero and the carry is bit 32 of the 64-bit sum
+                    loadGuestRegister(Rax, instruction.srcA);
+                    loadGuestRegister(Rcx, instruction.srcB);
+                    assembler.Add(Rax, Rcx, true);
+                    assembler.Mov(CarryFlag, Rax, true);
+                    assembler.ShrImmediate(CarryFlag, 32, true);
+                    break;
+
+                case Operation::AddWithCarry:
+                    loadGuestRegister(Rax, instruction.srcA);
+                    loadGuestRegister(Rcx, instruction.srcB);
+                    assembler.Add(Rax, Rcx, true);
+                    assembler.Add(Rax, CarryFlag, true);
+                    assembler.Mov(CarryFlag, Rax, true);
+                    assembler.ShrImmediate(CarryFlag, 32, true);
+                    break;
+
+                case Operation::Subtract:
+                    loadGuestRegister(Rax, instruction.srcA);
+                    loadGuestRegister(Rcx, instruction.srcB);
+                    assembler.Sub(Rax, Rcx);
+                    assembler.Setne(Rcx);
+                    assembler.Movzx8(CarryFlag, Rcx);
+                    break;
+
+                case Operation::SubtractWithBorrow:
+                    // srcA - srcB - !carry is calculated as srcA - srcB - 1 + carry
+                    loadGuestRegister(Rax, instruction.srcA);
+                    loadGuestRegister(Rcx, instruction.srcB);
+                    assembler.Sub(Rax, Rcx);
+                    assembler.SubImmediate(Rax, 1);
+                    assembler.Add(Rax, CarryFlag);
+                    assembler.Setne(Rcx);
+                    assembler.Movzx8(CarryFlag, Rcx);
+                    break;
+
+                case Operation::BitwiseXor:
+                    loadGuestRegister(Rax, instruction.srcA);
+                    loadGuestRegister(Rcx, instruction.srcB);
+                    assembler.Xor(Rax, Rcx);
+                    break;
+
+                case Operation::BitwiseOr:
+                    loadGuestRegister(Rax, instruction.srcA);
+                    loadGuestRegister(Rcx, instruction.srcB);
+                    assembler.Or(Rax, Rcx);
+                    break;
+
+                case Operation::BitwiseAnd:
+                    loadGuestRegister(Rax, instruction.srcA);
+                    loadGuestRegister(Rcx, instruction.srcB);
+                    assembler.And(Rax, Rcx);
+                    break;
+
+                case Operation::BitwiseAndNot:
+                    loadGuestRegister(Rax, instruction.srcA);
+                    loadGuestRegister(Rcx, instruction.srcB);
+                    assembler.Not(Rcx);
+                    assembler.And(Rax, Rcx);
+                    break;
+
+                case Operation::BitwiseNand:
+                    loadGuestRegister(Rax, instruction.srcA);
+                    loadGuestRegister(Rcx, instruction.srcB);
+                    assembler.And(Rax, Rcx);
+                    assembler.Not(Rax);
+                    break;
+
+                case Operation::AddImmediate:
+                    loadGuestRegister(Rax, instruction.srcA);
+                    assembler.AddImmediate(Rax, static_cast<u32>(instruction.immediate));
+                    break;
+
+                case Operation::BitfieldReplace:
+                    loadGuestRegister(Rcx, instruction.srcB);
+                    assembler.ShrImmediate(Rcx, instruction.srcBit);
+                    assembler.AndImmediate(Rcx, instruction.mask);
+                    assembler.ShlImmediate(Rcx, instruction.destBit);
+                    loadGuestRegister(Rax, instruction.srcA);
+                    assembler.AndImmediate(Rax, ~(instruction.mask << instruction.destBit));
+                    assembler.Or(Rax, Rcx);
+                    break;
+
+                case Operation::BitfieldExtractShiftLeftImmediate:
+                    loadGuestRegister(Rax, instruction.srcB);
+                    loadGuestRegister(Rcx, instruction.srcA);
+                    assembler.ShrCl(Rax);
+                    assembler.AndImmediate(Rax, instruction.mask);
+                    assembler.ShlImmediate(Rax, instruction.destBit);
+                    break;
+
+                case Operation::BitfieldExtractShiftLeftRegister:
+                    loadGuestRegister(Rax, instruction.srcB);
+                    assembler.ShrImmediate(Rax, instruction.srcBit);
+                    assembler.AndImmediate(Rax, instruction.mask);
+                    loadGuestRegister(Rcx, instruction.srcA);
+                    assembler.ShlCl(Rax);
+                    break;
+
+                case Operation::ReadImmediate:
+                    loadGuestRegister(Rsi, instruction.srcA);
+                    assembler.AddImmediate(Rsi, static_cast<u32>(instruction.immediate));
+                    callTrampoline(&ReadMethodTrampoline);
+                    break;
+
+                case Operation::BranchZero:
+                case Operation::BranchNonZero: {
+                    bool branchOnZero{instruction.operation == Operation::BranchZero};
+                    auto target{instructionLabels[static_cast<size_t>(instruction.immediate)]};
+                    if (instruction.srcA) {
+                        assembler.Test(GuestRegisters[instruction.srcA], GuestRegisters[instruction.srcA]);
+                        assembler.J(branchOnZero ? Condition::Zero : Condition::NotZero, target);
+                    } else if (branchOnZero) {
+                        assembler.Jmp(target);
+                    }
+                    continue;
+                }
+
+                case Operation::Jump:
+                    assembler.Jmp(instructionLabels[static_cast<size_t>(instruction.immediate)]);
+                    continue;
+
+                case Operation::Exit:
+                    assembler.Jmp(exitLabel);
+                    continue;
+
+                case Operation::Trap:
+                    assembler.MovImmediate(Rsi, static_cast<u32>(instruction.trapReason));
+                    assembler.MovImmediate(Rdx, static_cast<u32>(instruction.immediate));
+                    callTrampoline(&TrapTrampoline);
+                    continue;
+            }
+
+            switch (instruction.assignment) {
+                case AssignmentOperation::IgnoreAndFetch:
+                    fetch(instruction.dest);
+                    break;
+
+                case AssignmentOperation::Move:
+                    move(instruction.dest);
+                    break;
+
+                case AssignmentOperation::MoveAndSetMethod:
+                    move(instruction.dest);
+                    assembler.Mov(MethodAddress, Rax);
+                    break;
+
+                case AssignmentOperation::FetchAndSend:
+                    fetch(instruction.dest);
+                    send(Rax);
+                    break;
+
+                case AssignmentOperation::MoveAndSend:
+                    move(instruction.dest);
+                    send(Rax);
+                    break;
+
+                case AssignmentOperation::FetchAndSetMethod:
+                    fetch(instruction.dest);
+                    assembler.Mov(MethodAddress, Rax);
+                    break;
+
+                case AssignmentOperation::MoveAndSetMethodThenFetchAndSend:
+                    move(instruction.dest);
+                    assembler.Mov(MethodAddress, Rax);
+                    assembler.Load(Rdx, ArgumentPointer);
+                    assembler.AddImmediate(ArgumentPointer, sizeof(u32), true);
+                    send(Rdx);
+                    break;
+
+                case AssignmentOperation::MoveAndSetMethodThenSendHigh:
+                    move(instruction.dest);
+                    assembler.Mov(MethodAddress, Rax);
+                    assembler.Mov(Rdx, MethodAddress);
+                    assembler.ShrImmediate(Rdx, 12);
+                    assembler.AndImmediate(Rdx, 0x3F);
+                    send(Rdx);
+                    break;
+            }
+        }
+
+        assembler.Bind(exitLabel);
+        assembler.AddImmediate(Rsp, sizeof(u64), true);
+        for (auto it{CalleeSavedRegisters.rbegin()}; it != CalleeSavedRegisters.rend(); it++)
+            assembler.Pop(*it);
+        assembler.Ret();
+
+        return assembler.Finalize();
+    }
+
+    #else
+
+    std::vector<u8> MacroJit::Compile(const MacroProgram &program) {
+        throw exception("The macro JIT isn't supported on this host");
+    }
+
+    #endif
+
+    MacroJit::MacroJit(const MacroProgram &program) {
+        auto hostCode{Compile(program)};
+
+        // The code is copied in prior to the mapping being made executable so it's never writable and executable at the same time
+        size_t size{util::AlignUp(hostCode.size(), PAGE_SIZE)};
+        void *mapping{mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)};
+        if (mapping == MAP_FAILED)
+            throw exception("Failed to map memory for JIT code: {}", strerror(errno));
+        code = span<u8>{static_cast<u8 *>(mapping), size};
+
+        std::memcpy(code.data(), hostCode.data(), hostCode.size());
+        if (mprotect(code.data(), code.size(), PROT_READ | PROT_EXEC)) {
+            munmap(code.data(), code.size());
+            throw exception("Failed to make JIT code executable: {}", strerror(errno));
+        }
+        __builtin___clear_cache(reinterpret_cast<char *>(code.data()), reinterpret_cast<char *>(code.data() + hostCode.size()));
+
+        entry = reinterpret_cast<EntryFunction>(code.data());
+    }
+
+    MacroJit::~MacroJit() {
+        munmap(code.data(), code.size());
+    }
+
+    void MacroJit::Execute(span<u32> args, MacroEngineBase *targetEngine) const {
+        Context context{targetEngine};
+        entry(&context, args.data());
+        if (context.exception)
+            std::rethrow_exception(context.exception);
+    }
+
+    void MacroJit::ExecuteVerified(span<u32> args, MacroEngineBase *targetEngine, MacroInterpreter &interpreter, size_t offset) const {
+        RecordingEngine recorder{*targetEngine};
+        std::exception_ptr jitException;
+        try {
+            Execute(args, &recorder);
+        } catch (...) {
+            jitException = std::current_exception();
+        }
+
+        ReplayEngine replayer{*targetEngine, recorder.accesses, static_cast<bool>(jitException)};
+        std::string divergence;
+        try {
+            interpreter.Execute(offset, args, &replayer);
+            if (replayer.index != recorder.accesses.size())
+                divergence = fmt::format("the interpreter made {} accesses while the JIT made {}", replayer.index, recorder.accesses.size());
+            else if (jitException)
+                divergence = "the JIT threw an exception while the interpreter didn't";
+        } catch (const std::exception &e) {
+            if (!replayer.divergence.empty())
+                divergence = replayer.divergence;
+            else if (!jitException)
+                divergence = fmt::format("the interpreter threw an exception while the JIT didn't: {}", e.what());
+        }
+
+        if (!divergence.empty())
+            Logger::Error("Macro at 0x{:X} diverged from the interpreter: {}", offset, divergence);
+
+        if (jitException)
+            std::rethrow_exception(jitException);
+    }
+}
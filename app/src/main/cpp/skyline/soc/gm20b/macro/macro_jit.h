@@ -0,0 +1,77 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include "macro_program.h"
+
+namespace skyline::soc::gm20b {
+    /**
+     * @brief How macros without an HLE implementation are executed
+     */
+    enum class MacroExecutionMode : u32 {
+        Interpreter = 0, //!< Macros are executed from their pre-decoded programs
+        Jit = 1, //!< Macros are compiled into host code
+        JitVerified = 2, //!< Macros are compiled into host code and every execution is checked against the reference interpreter, this is very slow and only intended for debugging the JIT
+    };
+
+    namespace engine {
+        /**
+         * @brief A macro compiled from its pre-decoded program into host code, guest registers are kept in host registers for the entire execution and sends are direct calls into the engine
+         * @note Only AArch64 and x86-64 hosts are supported, IsSupported must be checked prior to construction
+         * @note Exceptions never unwind through JIT code as it has no unwind information, they're caught in the call trampolines and rethrown after the JIT code has returned
+         */
+        class MacroJit {
+          private:
+            struct Context {
+                MacroEngineBase *engine;
+                std::exception_ptr exception; //!< The exception thrown by an engine call or a trap, JIT code returns immediately after one is set
+            };
+
+            using EntryFunction = void (*)(Context *context, const u32 *args);
+
+            static constexpr u64 ExceptionFlag{1ULL << 32}; //!< Set in the return value of a trampoline if it caught an exception, the lower 32 bits hold the result otherwise
+
+            span<u8> code; //!< The executable mapping containing the compiled code
+            EntryFunction entry;
+
+            static u64 CallMethodTrampoline(Context *context, u32 method, u32 argument) noexcept;
+
+            static u64 ReadMethodTrampoline(Context *context, u32 method) noexcept;
+
+            static u64 TrapTrampoline(Context *context, u32 reason, u32 rawOpcode) noexcept;
+
+            /**
+             * @return The host code for the program, the entry point is at the start of it
+             */
+            static std::vector<u8> Compile(const MacroProgram &program);
+
+          public:
+            #if defined(__aarch64__) || defined(__x86_64__)
+            static constexpr bool IsSupported{true};
+            #else
+            static constexpr bool IsSupported{false};
+            #endif
+
+            MacroJit(const MacroProgram &program);
+
+            MacroJit(const MacroJit &) = delete;
+
+            MacroJit &operator=(const MacroJit &) = delete;
+
+            ~MacroJit();
+
+            /**
+             * @brief Executes the macro with the given arguments targeting the specified engine
+             */
+            void Execute(span<u32> args, MacroEngineBase *targetEngine) const;
+
+            /**
+             * @brief Executes the macro and then replays the execution through the reference interpreter, the method calls and reads of both are compared and any divergence is logged
+             * @param offset The offset of the macro in macro code memory
+             * @note The interpreter doesn't call into the engine, its reads are served from the values recorded during JIT execution
+             */
+            void ExecuteVerified(span<u32> args, MacroEngineBase *targetEngine, MacroInterpreter &interpreter, size_t offset) const;
+        };
+    }
+}
@@ -0,0 +1,359 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include "soc/gm20b/engines/engine.h"
+#include "macro_program.h"
+
+namespace skyline::soc::gm20b::engine {
+    MacroProgram::Instruction MacroProgram::MakeTrap(TrapReason reason, u32 rawOpcode) {
+        return Instruction{
+            .operation = Operation::Trap,
+            .trapReason = reason,
+            .immediate = static_cast<i32>(rawOpcode),
+        };
+    }
+
+    void MacroProgram::ThrowTrap(TrapReason reason, u32 rawOpcode) {
+        switch (reason) {
+            case TrapReason::UnknownOperation:
+                throw exception("Unknown MME opcode encountered: 0x{:X}", static_cast<u8>(Opcode{.raw = rawOpcode}.operation));
+            case TrapReason::UnknownAluOperation:
+                throw exception("Unknown MME ALU operation encountered: 0x{:X}", static_cast<u8>(Opcode{.raw = rawOpcode}.aluOperation));
+            case TrapReason::BranchInDelaySlot:
+                throw exception("Cannot branch while inside a delay slot");
+            case TrapReason::OutOfBounds:
+                throw exception("Macro execution went out of the bounds of macro code memory");
+        }
+
+        throw exception("Unknown macro trap reason: {}", static_cast<u8>(reason));
+    }
+
+    MacroProgram::Instruction MacroProgram::LowerInstruction(Opcode opcode) {
+        Instruction instruction{
+            .assignment = opcode.assignmentOperation,
+            .dest = opcode.dest ? opcode.dest : ScratchRegister,
+            .srcA = opcode.srcA,
+            .srcB = opcode.srcB,
+            .srcBit = opcode.bitfield.srcBit,
+            .destBit = opcode.bitfield.destBit,
+            .mask = opcode.bitfield.GetMask(),
+            .immediate = opcode.immediate,
+        };
+
+        switch (opcode.operation) {
+            case Opcode::Operation::AluRegister:
+                switch (opcode.aluOperation) {
+                    case Opcode::AluOperation::Add:
+                        instruction.operation = Operation::Add;
+                        break;
+                    case Opcode::AluOperation::AddWithCarry:
+                        instruction.operation = Operation::AddWithCarry;
+                        break;
+                    case Opcode::AluOperation::Subtract:
+                        instruction.operation = Operation::Subtract;
+                        break;
+                    case Opcode::AluOperation::SubtractWithBorrow:
+                        instruction.operation = Operation::SubtractWithBorrow;
+                        break;
+                    case Opcode::AluOperation::BitwiseXor:
+                        instruction.operation = Operation::BitwiseXor;
+                        break;
+                    case Opcode::AluOperation::BitwiseOr:
+                        instruction.operation = Operation::BitwiseOr;
+                        break;
+                    case Opcode::AluOperation::BitwiseAnd:
+                        instruction.operation = Operation::BitwiseAnd;
+                        break;
+                    case Opcode::AluOperation::BitwiseAndNot:
+                        instruction.operation = Operation::BitwiseAndNot;
+                        break;
+                    case Opcode::AluOperation::BitwiseNand:
+                        instruction.operation = Operation::BitwiseNand;
+                        break;
+                    default:
+                        return MakeTrap(TrapReason::UnknownAluOperation, opcode.raw);
+                }
+                break;
+
+            case Opcode::Operation::AddImmediate:
+                instruction.operation = Operation::AddImmediate;
+                break;
+
+            case Opcode::Operation::BitfieldReplace:
+                instruction.operation = Operation::BitfieldReplace;
+                break;
+
+            case Opcode::Operation::BitfieldExtractShiftLeftImmediate:
+                instruction.operation = Operation::BitfieldExtractShiftLeftImmediate;
+                break;
+
+            case Opcode::Operation::BitfieldExtractShiftLeftRegister:
+                instruction.operation = Operation::BitfieldExtractShiftLeftRegister;
+                break;
+
+            case Opcode::Operation::ReadImmediate:
+                instruction.operation = Operation::ReadImmediate;
+                break;
+
+            default:
+                return MakeTrap(TrapReason::UnknownOperation, opcode.raw);
+        }
+
+        return instruction;
+    }
+
+    MacroProgram::Instruction MacroProgram::LowerDelaySlot(span<u32> macroCode, size_t index) {
+        if (index >= macroCode.size())
+            return MakeTrap(TrapReason::OutOfBounds);
+
+        Opcode opcode{.raw = macroCode[index]};
+        if (opcode.operation == Opcode::Operation::Branch)
+            return MakeTrap(TrapReason::BranchInDelaySlot, opcode.raw);
+
+        return LowerInstruction(opcode);
+    }
+
+    MacroProgram::MacroProgram(span<u32> macroCode, size_t offset) {
+        // Find the range of guest instructions that can be executed as non-delay slot instructions, instructions in delay slots are lowered separately
+        std::vector<bool> reachable(macroCode.size());
+        size_t first{std::numeric_limits<size_t>::max()}, last{};
+        std::vector<size_t> pending{offset};
+        while (!pending.empty()) {
+            size_t index{pending.back()};
+            pending.pop_back();
+            if (index >= macroCode.size() || reachable[index])
+                continue;
+
+            reachable[index] = true;
+            first = std::min(first, index);
+            last = std::max(last, index);
+
+            Opcode opcode{.raw = macroCode[index]};
+            if (opcode.operation == Opcode::Operation::Branch) {
+                auto target{static_cast<i64>(index) + opcode.immediate};
+                if (target >= 0)
+                    pending.push_back(static_cast<size_t>(target));
+                if (!opcode.exit)
+                    pending.push_back(index + 1);
+            } else if (!opcode.exit) {
+                pending.push_back(index + 1);
+            }
+        }
+
+        if (first > last)
+            throw exception("Macro at 0x{:X} is outside of macro code memory", offset);
+
+        struct BranchFixup {
+            size_t instructionIndex; //!< The index of the lowered jump
+            i64 target; //!< The index of the guest instruction being jumped to
+        };
+        std::vector<BranchFixup> fixups;
+
+        struct DelayedBranch {
+            size_t instructionIndex; //!< The index of the lowered conditional branch, this is pointed to the delay slot stub
+            size_t delaySlot; //!< The index of the guest instruction in the delay slot
+            i64 target;
+        };
+        std::vector<DelayedBranch> delayedBranches;
+
+        // Guest instructions are lowered linearly so fallthrough doesn't require any jumps, each one may expand to multiple instructions for delay slots
+        std::vector<u32> loweredIndices(last - first + 1);
+        instructions.reserve(last - first + 2);
+        for (size_t index{first}; index <= last; index++) {
+            loweredIndices[index - first] = static_cast<u32>(instructions.size());
+
+            Opcode opcode{.raw = macroCode[index]};
+            if (opcode.operation == Opcode::Operation::Branch) {
+                instructions.push_back(Instruction{
+                    .operation = opcode.branchCondition == Opcode::BranchCondition::Zero ? Operation::BranchZero : Operation::BranchNonZero,
+                    .srcA = opcode.srcA,
+                });
+
+                auto target{static_cast<i64>(index) + opcode.immediate};
+                if (opcode.noDelay)
+                    fixups.push_back({instructions.size() - 1, target});
+                else
+                    delayedBranches.push_back({instructions.size() - 1, index + 1, target});
+            } else {
+                instructions.push_back(LowerInstruction(opcode));
+            }
+
+            // Exit only takes effect on instructions that don't branch, it executes its delay slot prior to exiting
+            if (opcode.exit) {
+                instructions.push_back(LowerDelaySlot(macroCode, index + 1));
+                instructions.push_back(Instruction{.operation = Operation::Exit});
+            }
+        }
+
+        // The last instruction can only fall through if it's at the end of macro code memory
+        instructions.push_back(MakeTrap(TrapReason::OutOfBounds));
+        u32 outOfBoundsIndex{static_cast<u32>(instructions.size() - 1)};
+
+        // Delayed branches jump to a stub that executes the delay slot prior to jumping to the target
+        for (const auto &branch : delayedBranches) {
+            instructions[branch.instructionIndex].immediate = static_cast<i32>(instructions.size());
+            instructions.push_back(LowerDelaySlot(macroCode, branch.delaySlot));
+            instructions.push_back(Instruction{.operation = Operation::Jump});
+            fixups.push_back({instructions.size() - 1, branch.target});
+        }
+
+        for (const auto &fixup : fixups) {
+            bool inRange{fixup.target >= static_cast<i64>(first) && fixup.target <= static_cast<i64>(last)};
+            instructions[fixup.instructionIndex].immediate = static_cast<i32>(inRange ? loweredIndices[static_cast<size_t>(fixup.target) - first] : outOfBoundsIndex);
+        }
+
+        entryIndex = loweredIndices[offset - first];
+    }
+
+    void MacroProgram::Execute(span<u32> args, MacroEngineBase *targetEngine) const {
+        std::array<u32, RegisterCount + 1> registers{};
+        const u32 *argument{args.data()};
+        MethodAddress methodAddress{};
+        bool carryFlag{};
+        u32 result{};
+
+        // The first argument is stored in register 1
+        registers[1] = *argument++;
+
+        // Instructions are dispatched with computed gotos, this allows the branch predictor to track each dispatch site separately
+        static const void *const OperationLabels[]{
+            &&Add, &&AddWithCarry, &&Subtract, &&SubtractWithBorrow, &&BitwiseXor, &&BitwiseOr, &&BitwiseAnd, &&BitwiseAndNot, &&BitwiseNand,
+            &&AddImmediate, &&BitfieldReplace, &&BitfieldExtractShiftLeftImmediate, &&BitfieldExtractShiftLeftRegister, &&ReadImmediate,
+            &&BranchZero, &&BranchNonZero, &&Jump, &&Exit, &&Trap,
+        };
+        static_assert(std::size(OperationLabels) == static_cast<size_t>(Operation::Trap) + 1);
+
+        static const void *const AssignmentLabels[]{
+            &&IgnoreAndFetch, &&Move, &&MoveAndSetMethod, &&FetchAndSend, &&MoveAndSend, &&FetchAndSetMethod, &&MoveAndSetMethodThenFetchAndSend, &&MoveAndSetMethodThenSendHigh,
+        };
+
+        const Instruction *instruction{&instructions[entryIndex]};
+
+        #define DISPATCH() goto *OperationLabels[static_cast<u8>(instruction->operation)]
+        #define ASSIGN(value) do { result = (value); goto *AssignmentLabels[static_cast<u8>(instruction->assignment)]; } while (false)
+        #define NEXT() do { instruction++; DISPATCH(); } while (false)
+        #define SEND(value) do { targetEngine->CallMethodFromMacro(methodAddress.address, value); methodAddress.address += methodAddress.increment; } while (false)
+
+        DISPATCH();
+
+        Add: {
+            u64 value{static_cast<u64>(registers[instruction->srcA]) + registers[instruction->srcB]};
+            carryFlag = value >> 32;
+            ASSIGN(static_cast<u32>(value));
+        }
+
+        AddWithCarry: {
+            u64 value{static_cast<u64>(registers[instruction->srcA]) + registers[instruction->srcB] + carryFlag};
+            carryFlag = value >> 32;
+            ASSIGN(static_cast<u32>(value));
+        }
+
+        Subtract: {
+            u64 value{static_cast<u64>(registers[instruction->srcA]) - registers[instruction->srcB]};
+            carryFlag = value & 0xFFFFFFFF;
+            ASSIGN(static_cast<u32>(value));
+        }
+
+        SubtractWithBorrow: {
+            u64 value{static_cast<u64>(registers[instruction->srcA]) - registers[instruction->srcB] - !carryFlag};
+            carryFlag = value & 0xFFFFFFFF;
+            ASSIGN(static_cast<u32>(value));
+        }
+
+        BitwiseXor:
+        ASSIGN(registers[instruction->srcA] ^ registers[instruction->srcB]);
+
+        BitwiseOr:
+        ASSIGN(registers[instruction->srcA] | registers[instruction->srcB]);
+
+        BitwiseAnd:
+        ASSIGN(registers[instruction->srcA] & registers[instruction->srcB]);
+
+        BitwiseAndNot:
+        ASSIGN(registers[instruction->srcA] & ~registers[instruction->srcB]);
+
+        BitwiseNand:
+        ASSIGN(~(registers[instruction->srcA] & registers[instruction->srcB]));
+
+        AddImmediate:
+        ASSIGN(static_cast<u32>(static_cast<i32>(registers[instruction->srcA]) + instruction->immediate));
+
+        BitfieldReplace: {
+            u32 src{(registers[instruction->srcB] >> instruction->srcBit) & instruction->mask};
+            u32 dest{registers[instruction->srcA] & ~(instruction->mask << instruction->destBit)};
+            ASSIGN(dest | (src << instruction->destBit));
+        }
+
+        BitfieldExtractShiftLeftImmediate:
+        ASSIGN(((registers[instruction->srcB] >> registers[instruction->srcA]) & instruction->mask) << instruction->destBit);
+
+        BitfieldExtractShiftLeftRegister:
+        ASSIGN(((registers[instruction->srcB] >> instruction->srcBit) & instruction->mask) << registers[instruction->srcA]);
+
+        ReadImmediate:
+        ASSIGN(targetEngine->ReadMethodFromMacro(static_cast<u32>(static_cast<i32>(registers[instruction->srcA]) + instruction->immediate)));
+
+        BranchZero:
+        instruction = registers[instruction->srcA] == 0 ? &instructions[static_cast<size_t>(instruction->immediate)] : instruction + 1;
+        DISPATCH();
+
+        BranchNonZero:
+        instruction = registers[instruction->srcA] != 0 ? &instructions[static_cast<size_t>(instruction->immediate)] : instruction + 1;
+        DISPATCH();
+
+        Jump:
+        instruction = &instructions[static_cast<size_t>(instruction->immediate)];
+        DISPATCH();
+
+        Exit:
+        return;
+
+        Trap:
+        ThrowTrap(instruction->trapReason, static_cast<u32>(instruction->immediate));
+
+        IgnoreAndFetch:
+        registers[instruction->dest] = *argument++;
+        NEXT();
+
+        Move:
+        registers[instruction->dest] = result;
+        NEXT();
+
+        MoveAndSetMethod:
+        registers[instruction->dest] = result;
+        methodAddress.raw = result;
+        NEXT();
+
+        FetchAndSend:
+        registers[instruction->dest] = *argument++;
+        SEND(result);
+        NEXT();
+
+        MoveAndSend:
+        registers[instruction->dest] = result;
+        SEND(result);
+        NEXT();
+
+        FetchAndSetMethod:
+        registers[instruction->dest] = *argument++;
+        methodAddress.raw = result;
+        NEXT();
+
+        MoveAndSetMethodThenFetchAndSend:
+        registers[instruction->dest] = result;
+        methodAddress.raw = result;
+        SEND(*argument++);
+        NEXT();
+
+        MoveAndSetMethodThenSendHigh:
+        registers[instruction->dest] = result;
+        methodAddress.raw = result;
+        SEND(methodAddress.increment);
+        NEXT();
+
+        #undef SEND
+        #undef NEXT
+        #undef ASSIGN
+        #undef DISPATCH
+    }
+}
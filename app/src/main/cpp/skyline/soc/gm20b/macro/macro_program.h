@@ -0,0 +1,101 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include "macro_interpreter.h"
+
+namespace skyline::soc::gm20b::engine {
+    /**
+     * @brief A macro lowered into an array of pre-decoded instructions, this moves all opcode decoding and delay slot handling out of execution into a one-time compilation step
+     * @note Delay slots are lowered by duplicating the instruction in the slot at the point it's executed from, so control flow at runtime is limited to plain jumps
+     * @note Invalid code is lowered into traps which throw the same exceptions as the interpreter, only if they're actually executed
+     */
+    class MacroProgram {
+      private:
+        friend class MacroJit;
+
+        using Opcode = MacroInterpreter::Opcode;
+        using MethodAddress = MacroInterpreter::MethodAddress;
+
+        static constexpr u8 RegisterCount{8};
+        static constexpr u8 ScratchRegister{RegisterCount}; //!< Writes to register 0 are redirected to this register so they don't need to be checked for at runtime
+
+        /**
+         * @note The ALU operations are split into separate operations so they're dispatched alongside the instruction
+         */
+        enum class Operation : u8 {
+            Add,
+            AddWithCarry,
+            Subtract,
+            SubtractWithBorrow,
+            BitwiseXor,
+            BitwiseOr,
+            BitwiseAnd,
+            BitwiseAndNot,
+            BitwiseNand,
+            AddImmediate,
+            BitfieldReplace,
+            BitfieldExtractShiftLeftImmediate,
+            BitfieldExtractShiftLeftRegister,
+            ReadImmediate,
+            BranchZero, //!< Jumps to the target instruction if srcA is zero
+            BranchNonZero, //!< Jumps to the target instruction if srcA isn't zero
+            Jump, //!< Unconditionally jumps to the target instruction
+            Exit,
+            Trap, //!< Throws an exception for the trap reason
+        };
+
+        enum class TrapReason : u8 {
+            UnknownOperation,
+            UnknownAluOperation,
+            BranchInDelaySlot,
+            OutOfBounds, //!< Execution would continue past the end of macro code memory
+        };
+
+        struct Instruction {
+            Operation operation;
+            Opcode::AssignmentOperation assignment;
+            u8 dest;
+            u8 srcA;
+            u8 srcB;
+            u8 srcBit;
+            u8 destBit;
+            TrapReason trapReason;
+            u32 mask; //!< The bitfield mask for bitfield operations
+            i32 immediate; //!< The immediate for immediate operations, the target instruction index for jumps or the raw opcode for traps
+        };
+        static_assert(sizeof(Instruction) == 0x10);
+
+        std::vector<Instruction> instructions;
+        u32 entryIndex{}; //!< The index of the instruction that execution starts at, this isn't the first instruction if the macro branches backwards past its start
+
+        /**
+         * @brief Lowers a single non-branch guest instruction
+         */
+        static Instruction LowerInstruction(Opcode opcode);
+
+        /**
+         * @brief Lowers the guest instruction at the supplied index for execution in a delay slot, where branches aren't allowed
+         */
+        static Instruction LowerDelaySlot(span<u32> macroCode, size_t index);
+
+        static Instruction MakeTrap(TrapReason reason, u32 rawOpcode = 0);
+
+        /**
+         * @brief Throws the exception for a trap, this matches the exceptions thrown by the interpreter
+         */
+        [[noreturn]] static void ThrowTrap(TrapReason reason, u32 rawOpcode);
+
+      public:
+        /**
+         * @brief Compiles the macro starting at the supplied offset, only code reachable from the offset is decoded
+         */
+        MacroProgram(span<u32> macroCode, size_t offset);
+
+        /**
+         * @brief Executes the macro with the given arguments targeting the specified engine
+         */
+        void Execute(span<u32> args, MacroEngineBase *targetEngine) const;
+    };
+}
@@ -2,6 +2,7 @@
 // Copyright © 2022 yuzu Emulator Project (https://yuzu-emu.org/)
 // Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
+#include <common/settings.h>
 #include <soc/gm20b/engines/engine.h>
 #include "macro_state.h"
 
@@ -33,28 +34,52 @@ namespace skyline::soc::gm20b {
 
         struct HleFunctionInfo {
             Function function;
-            u64 size;
-            u32 hash;
+            std::string_view name;
+            u64 size; //!< The size of the macro in words
+            u32 hash; //!< The XXH32 hash of the macro's code
         };
 
+        /**
+         * @note The table is sorted by size so each distinct macro size only needs to be hashed once during a lookup
+         */
         constexpr std::array<HleFunctionInfo, 0x3> functions{{
-            {DrawInstanced, 0x12, 0x6F0DD310},
-            {DrawIndexedInstanced, 0x17, 0x2764C4F},
-            {DrawInstancedIndexedWithConstantBuffer, 0x1F, 0xF2F16988},
+            {DrawInstanced, "DrawInstanced", 0x12, 0x6F0DD310},
+            {DrawIndexedInstanced, "DrawIndexedInstanced", 0x17, 0x2764C4F},
+            {DrawInstancedIndexedWithConstantBuffer, "DrawInstancedIndexedWithConstantBuffer", 0x1F, 0xF2F16988},
         }};
-
-        static Function LookupFunction(span<u32> code) {
-            for (const auto &function : functions) {
+        static_assert(std::is_sorted(functions.begin(), functions.end(), [](const HleFunctionInfo &a, const HleFunctionInfo &b) { return a.size < b.size; }));
+
+        static std::array<std::atomic<u64>, functions.size()> callCounts{}; //!< The amount of times each HLE function has been called across all channels
+
+        /**
+         * @return The index of the HLE function for the macro at the start of the code or the size of the function table if there's no HLE function for it
+         */
+        static size_t LookupFunction(span<u32> code) {
+            u64 hashedSize{};
+            u32 hash{};
+            for (size_t index{}; index < functions.size(); index++) {
+                const auto &function{functions[index]};
                 if (function.size > code.size())
-                    continue;
+                    break;
 
-                auto macro{code.subspan(0, function.size)};
+                // Only the macro's own code is hashed as any code past it is unrelated to it
+                if (function.size != hashedSize) {
+                    hash = XXH32(code.data(), function.size * sizeof(u32), 0);
+                    hashedSize = function.size;
+                }
 
-                if (XXH32(code.data(), code.size_bytes(), 0) == function.hash)
-                    return function.function;
+                if (hash == function.hash)
+                    return index;
             }
 
-            return {};
+            return functions.size();
+        }
+    }
+
+    MacroState::MacroState(const DeviceState &state) : macroInterpreter(macroCode), executionMode{*state.settings->macroExecution} {
+        if (executionMode != MacroExecutionMode::Interpreter && !engine::MacroJit::IsSupported) {
+            Logger::Warn("The macro JIT isn't supported on this host, macros will be interpreted");
+            executionMode = MacroExecutionMode::Interpreter;
         }
     }
 
@@ -67,19 +92,62 @@ namespace skyline::soc::gm20b {
 
         if (invalidatePending) {
             macroHleFunctions.fill({});
+            for (auto &program : macroPrograms)
+                program.reset();
+            for (auto &jitEntry : macroJits)
+                jitEntry = {};
             invalidatePending = false;
         }
 
         auto &hleEntry{macroHleFunctions[position]};
 
         if (!hleEntry.valid) {
-            hleEntry.function = macro_hle::LookupFunction(span(macroCode).subspan(offset));
+            hleEntry.index = macro_hle::LookupFunction(span(macroCode).subspan(offset));
+            hleEntry.function = hleEntry.index < macro_hle::functions.size() ? macro_hle::functions[hleEntry.index].function : nullptr;
             hleEntry.valid = true;
         }
 
-        if (macroHleFunctions[position].function)
-            macroHleFunctions[position].function(offset, args, targetEngine);
-        else
-            macroInterpreter.Execute(offset, args, targetEngine);
+        if (hleEntry.function) {
+            macro_hle::callCounts[hleEntry.index].fetch_add(1, std::memory_order_relaxed);
+            hleEntry.function(offset, args, targetEngine);
+            return;
+        }
+
+        auto &program{macroPrograms[position]};
+        if (!program)
+            program.emplace(macroCode, offset);
+
+        if (executionMode != MacroExecutionMode::Interpreter) {
+            auto &jitEntry{macroJits[position]};
+            if (!jitEntry.valid) {
+                try {
+                    jitEntry.jit = std::make_unique<engine::MacroJit>(*program);
+                } catch (const exception &e) {
+                    Logger::Warn("Failed to compile macro at 0x{:X}, it'll be interpreted: {}", offset, e.what());
+                }
+                jitEntry.valid = true;
+            }
+
+            if (jitEntry.jit) {
+                statistics.jitExecutions.fetch_add(1, std::memory_order_relaxed);
+                if (executionMode == MacroExecutionMode::JitVerified)
+                    jitEntry.jit->ExecuteVerified(args, targetEngine, macroInterpreter, offset);
+                else
+                    jitEntry.jit->Execute(args, targetEngine);
+                return;
+            }
+        }
+
+        statistics.programExecutions.fetch_add(1, std::memory_order_relaxed);
+        program->Execute(args, targetEngine);
+    }
+
+    void MacroState::LogStatistics() {
+        for (size_t index{}; index < macro_hle::functions.size(); index++)
+            if (u64 count{macro_hle::callCounts[index].load(std::memory_order_relaxed)})
+                Logger::Info("Macro HLE {}: {} calls", macro_hle::functions[index].name, count);
+
+        Logger::Info("Macros without HLE: {} executions from programs, {} executions from JIT code", statistics.programExecutions.load(std::memory_order_relaxed), statistics.jitExecutions.load(std::memory_order_relaxed));
+        Logger::Info("Macro multi-draws: {} merging {} draws", statistics.multiDraws.load(std::memory_order_relaxed), statistics.multiDrawDraws.load(std::memory_order_relaxed));
     }
 }
@@ -5,6 +5,7 @@
 
 #include <common.h>
 #include "macro_interpreter.h"
+#include "macro_jit.h"
 
 namespace skyline::soc::gm20b {
     namespace macro_hle {
@@ -17,19 +18,45 @@ namespace skyline::soc::gm20b {
     struct MacroState {
         struct MacroHleEntry {
             macro_hle::Function function;
+            size_t index; //!< The index of the function in the HLE function table
             bool valid;
         };
 
-        engine::MacroInterpreter macroInterpreter; //!< The macro interpreter for handling 3D/2D macros
+        /**
+         * @brief Process-wide counters of how macros are executed, these are logged when emulation ends
+         */
+        struct Statistics {
+            std::atomic<u64> programExecutions; //!< Executions of macros without an HLE implementation from their pre-decoded programs
+            std::atomic<u64> jitExecutions; //!< Executions of macros without an HLE implementation from JIT-compiled code
+            std::atomic<u64> multiDraws; //!< Sets of draws from a single macro execution which were merged into a multi-draw
+            std::atomic<u64> multiDrawDraws; //!< The total amount of draws merged into multi-draws
+        };
+
+        static inline Statistics statistics{};
+
+        struct MacroJitEntry {
+            std::unique_ptr<engine::MacroJit> jit; //!< The compiled macro, this is null if compilation failed
+            bool valid; //!< If compilation has been attempted
+        };
+
+        engine::MacroInterpreter macroInterpreter; //!< The reference macro interpreter, macros are executed from their pre-decoded programs or JIT-compiled code instead and this is only used to verify the JIT
         std::array<u32, 0x2000> macroCode{}; //!< Stores GPU macros, writes to it will wraparound on overflow
         std::array<size_t, 0x80> macroPositions{}; //!< The positions of each individual macro in macro code memory, there can be a maximum of 0x80 macros at any one time
         std::array<MacroHleEntry, 0x80> macroHleFunctions{}; //!< The HLE functions for each macro position, used to optionally override the interpreter
+        std::array<std::optional<engine::MacroProgram>, 0x80> macroPrograms{}; //!< The pre-decoded programs for each macro position, these are compiled on first execution
+        std::array<MacroJitEntry, 0x80> macroJits{}; //!< The JIT-compiled macros for each macro position, these are compiled from the programs on first execution when the JIT is enabled
+        MacroExecutionMode executionMode;
         bool invalidatePending{};
 
-        MacroState() : macroInterpreter(macroCode) {}
+        MacroState(const DeviceState &state);
 
         void Invalidate();
 
         void Execute(u32 position, span<u32> args, engine::MacroEngineBase *targetEngine);
+
+        /**
+         * @brief Logs how often each HLE function was used and how often macros were executed without one
+         */
+        static void LogStatistics();
     };
 }
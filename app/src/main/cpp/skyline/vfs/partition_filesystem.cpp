@@ -16,32 +16,51 @@ namespace skyline::vfs {
             throw exception("Invalid filesystem magic: {}", header.magic);
 
         size_t entrySize{hashed ? sizeof(HashedFileEntry) : sizeof(PartitionFileEntry)};
-        size_t stringTableOffset{sizeof(FsHeader) + (header.numFiles * entrySize)};
-        fileDataOffset = stringTableOffset + header.stringTableSize;
+        size_t entryTableSize{header.numFiles * entrySize};
+        fileDataOffset = sizeof(FsHeader) + entryTableSize + header.stringTableSize;
+        if (fileDataOffset > backing->size)
+            throw exception("Filesystem tables are out of bounds: 0x{:X} (Size: 0x{:X})", fileDataOffset, backing->size);
 
-        std::vector<char> stringTable(header.stringTableSize + 1);
-        backing->Read(span(stringTable).first(header.stringTableSize), stringTableOffset);
-        stringTable[header.stringTableSize] = 0;
+        metadata.resize(entryTableSize + header.stringTableSize);
+        backing->Read(span{metadata}, sizeof(FsHeader));
 
-        for (u32 entryOffset{sizeof(FsHeader)}; entryOffset < header.numFiles * entrySize; entryOffset += entrySize) {
-            auto entry{backing->Read<PartitionFileEntry>(entryOffset)};
+        auto stringTable{span{metadata}.subspan(entryTableSize).cast<char>()};
+        files.reserve(header.numFiles);
+        for (size_t entryOffset{}; entryOffset < entryTableSize; entryOffset += entrySize) {
+            PartitionFileEntry entry;
+            std::memcpy(&entry, metadata.data() + entryOffset, sizeof(PartitionFileEntry));
 
-            std::string name(&stringTable[entry.stringTableOffset]);
-            fileMap.emplace(name, entry);
+            if (entry.stringTableOffset >= stringTable.size())
+                throw exception("File name out of bounds: 0x{:X} (String Table Size: 0x{:X})", entry.stringTableOffset, stringTable.size());
+
+            auto name{stringTable.subspan(entry.stringTableOffset)};
+            files.push_back(FileEntry{
+                .name = std::string_view{name.data(), strnlen(name.data(), name.size())},
+                .offset = entry.offset,
+                .size = entry.size,
+            });
         }
+
+        std::sort(files.begin(), files.end(), [](const FileEntry &a, const FileEntry &b) { return a.name < b.name; });
+    }
+
+    const PartitionFileSystem::FileEntry *PartitionFileSystem::FindFile(std::string_view name) {
+        auto it{std::lower_bound(files.begin(), files.end(), name, [](const FileEntry &entry, std::string_view name) { return entry.name < name; })};
+        if (it == files.end() || it->name != name)
+            return nullptr;
+        return &*it;
     }
 
     std::shared_ptr<Backing> PartitionFileSystem::OpenFileImpl(const std::string &path, Backing::Mode mode) {
-        try {
-            auto &entry{fileMap.at(path)};
-            return std::make_shared<RegionBacking>(backing, fileDataOffset + entry.offset, entry.size, mode);
-        } catch (std::out_of_range &e) {
+        auto entry{FindFile(path)};
+        if (!entry)
             return nullptr;
-        }
+
+        return std::make_shared<RegionBacking>(backing, fileDataOffset + entry->offset, entry->size, mode);
     }
 
     std::optional<Directory::EntryType> PartitionFileSystem::GetEntryTypeImpl(const std::string &path) {
-        if (fileMap.count(path))
+        if (FindFile(path))
             return Directory::EntryType::File;
 
         return std::nullopt;
@@ -53,8 +72,9 @@ namespace skyline::vfs {
             return nullptr;
 
         std::vector<Directory::Entry> fileList;
-        for (const auto &file : fileMap)
-            fileList.emplace_back(Directory::Entry{file.first, Directory::EntryType::File, file.second.size});
+        fileList.reserve(files.size());
+        for (const auto &file : files)
+            fileList.emplace_back(Directory::Entry{std::string{file.name}, Directory::EntryType::File, file.size});
 
         return std::make_shared<PartitionFileSystemDirectory>(fileList, listMode);
     }
@@ -8,6 +8,7 @@
 namespace skyline::vfs {
     /**
      * @brief The PartitionFileSystem class abstracts a partition filesystem using the vfs::FileSystem api
+     * @note The entry and string tables are read in a single read and files are looked up through a sorted index into them
      */
     class PartitionFileSystem : public FileSystem {
       private:
@@ -34,10 +35,25 @@ namespace skyline::vfs {
         };
         static_assert(sizeof(HashedFileEntry) == 0x40);
 
+        /**
+         * @brief A file in the filesystem with its name pointing into the string table
+         */
+        struct FileEntry {
+            std::string_view name;
+            u64 offset; //!< The offset of the file from the base of the file data
+            u64 size;
+        };
+
         bool hashed; //!< Whether the filesystem contains hash data
         size_t fileDataOffset; //!< The offset from the backing to the base of the file data
         std::shared_ptr<Backing> backing; //!< The backing file of the filesystem
-        std::unordered_map<std::string, PartitionFileEntry> fileMap; //!< A map that maps file names to their corresponding entry
+        std::vector<u8> metadata; //!< The contents of the entry and string tables
+        std::vector<FileEntry> files; //!< All files in the filesystem sorted by their name
+
+        /**
+         * @return The entry of the file with the supplied name or nullptr if it doesn't exist
+         */
+        const FileEntry *FindFile(std::string_view name);
 
       protected:
         std::shared_ptr<Backing> OpenFileImpl(const std::string &path, Backing::Mode mode) override;
@@ -5,116 +5,202 @@
 #include "rom_filesystem.h"
 
 namespace skyline::vfs {
-    RomFileSystem::RomFileSystem(std::shared_ptr<Backing> pBacking) : FileSystem(), backing(std::move(pBacking)) {
-        header = backing->Read<RomFsHeader>();
-        TraverseDirectory(0, "");
+    RomFileSystem::MetadataTables::MetadataTables(Backing &backing, const RomFsHeader &header) {
+        std::array<std::pair<u64, u64>, 4> regions{{
+            {header.dirHashTableOffset, header.dirHashTableSize},
+            {header.dirMetaTableOffset, header.dirMetaTableSize},
+            {header.fileHashTableOffset, header.fileHashTableSize},
+            {header.fileMetaTableOffset, header.fileMetaTableSize},
+        }};
+
+        u64 regionStart{std::numeric_limits<u64>::max()}, regionEnd{}, tablesSize{};
+        for (const auto &[offset, size] : regions) {
+            if (offset + size < offset || offset + size > backing.size)
+                throw exception("RomFS table out of bounds: 0x{:X} - 0x{:X} (Size: 0x{:X})", offset, offset + size, backing.size);
+
+            regionStart = std::min(regionStart, offset);
+            regionEnd = std::max(regionEnd, offset + size);
+            tablesSize += size;
+        }
+
+        std::array<size_t, 4> positions{}; //!< The position of each table in the metadata vector
+        if (regionEnd - regionStart <= tablesSize + constant::PageSize) {
+            metadata.resize(regionEnd - regionStart);
+            backing.Read(span{metadata}, regionStart);
+
+            for (size_t index{}; index < regions.size(); index++)
+                positions[index] = regions[index].first - regionStart;
+        } else {
+            metadata.resize(tablesSize);
+
+            size_t position{};
+            for (size_t index{}; index < regions.size(); index++) {
+                positions[index] = position;
+                backing.Read(span{metadata}.subspan(position, regions[index].second), regions[index].first);
+                position += regions[index].second;
+            }
+        }
+
+        dirHashTable = span{metadata}.subspan(positions[0], regions[0].second);
+        dirMetaTable = span{metadata}.subspan(positions[1], regions[1].second);
+        fileHashTable = span{metadata}.subspan(positions[2], regions[2].second);
+        fileMetaTable = span{metadata}.subspan(positions[3], regions[3].second);
     }
 
-    void RomFileSystem::TraverseFiles(u32 offset, const std::string &path) {
-        RomFsFileEntry entry;
-        do {
-            entry = backing->Read<RomFsFileEntry>(header.fileMetaTableOffset + offset);
+    template<typename EntryType>
+    EntryType RomFileSystem::MetadataTables::ReadEntry(span<u8> table, u32 offset, std::string_view *name) {
+        if (static_cast<size_t>(offset) + sizeof(EntryType) > table.size())
+            throw exception("RomFS entry out of bounds: 0x{:X} (Table Size: 0x{:X})", offset, table.size());
 
-            if (entry.nameSize) {
-                std::vector<char> name(entry.nameSize);
-                backing->Read(span(name), header.fileMetaTableOffset + offset + sizeof(RomFsFileEntry));
+        EntryType entry;
+        std::memcpy(&entry, table.data() + offset, sizeof(EntryType)); // Entries are only guaranteed to be 4-byte aligned
 
-                std::string fullPath{path + (path.empty() ? "" : "/") + std::string(name.data(), entry.nameSize)};
-                fileMap.emplace(fullPath, entry);
-            }
+        if (name) {
+            if (static_cast<size_t>(offset) + sizeof(EntryType) + entry.nameSize > table.size())
+                throw exception("RomFS entry name out of bounds: 0x{:X} (Size: 0x{:X}, Table Size: 0x{:X})", offset, entry.nameSize, table.size());
+            *name = std::string_view{reinterpret_cast<const char *>(table.data() + offset + sizeof(EntryType)), entry.nameSize};
+        }
 
-            offset = entry.siblingOffset;
-        } while (offset != constant::RomFsEmptyEntry);
+        return entry;
     }
 
-    void RomFileSystem::TraverseDirectory(u32 offset, const std::string &path) {
-        auto entry{backing->Read<RomFsDirectoryEntry>(header.dirMetaTableOffset + offset)};
+    template<typename EntryType>
+    u32 RomFileSystem::MetadataTables::FindEntry(span<u8> hashTable, span<u8> metaTable, u32 firstChildOffset, u32 parentOffset, std::string_view name) {
+        u32 offset;
+        u32 EntryType::*nextMember;
+        if (size_t bucketCount{hashTable.size() / sizeof(u32)}) {
+            // https://switchbrew.org/wiki/RomFs#Hash_Table
+            u32 hash{parentOffset ^ 123456789};
+            for (char character : name) {
+                hash = (hash >> 5) | (hash << 27);
+                hash ^= static_cast<u8>(character);
+            }
+
+            offset = hashTable.cast<u32>()[hash % bucketCount];
+            nextMember = &EntryType::hashSiblingOffset;
+        } else {
+            offset = firstChildOffset;
+            nextMember = &EntryType::siblingOffset;
+        }
 
-        std::string childPath(path);
-        if (entry.nameSize) {
-            std::vector<char> name(entry.nameSize);
-            backing->Read(span(name), header.dirMetaTableOffset + offset + sizeof(RomFsDirectoryEntry));
-            childPath = path + (path.empty() ? "" : "/") + std::string(name.data(), entry.nameSize);
+        // The amount of iterations is bounded by the amount of entries that could fit in the table to avoid looping infinitely on a cyclic chain
+        for (size_t iterations{metaTable.size() / sizeof(EntryType)}; offset != constant::RomFsEmptyEntry && iterations; iterations--) {
+            std::string_view entryName;
+            auto entry{ReadEntry<EntryType>(metaTable, offset, &entryName)};
+            if (entry.parentOffset == parentOffset && entryName == name)
+                return offset;
+            offset = entry.*nextMember;
         }
 
-        directoryMap.emplace(childPath, entry);
+        return constant::RomFsEmptyEntry;
+    }
+
+    RomFileSystem::RomFsDirectoryEntry RomFileSystem::MetadataTables::GetDirectory(u32 offset, std::string_view *name) const {
+        return ReadEntry<RomFsDirectoryEntry>(dirMetaTable, offset, name);
+    }
 
-        if (entry.fileOffset != constant::RomFsEmptyEntry)
-            TraverseFiles(entry.fileOffset, childPath);
+    RomFileSystem::RomFsFileEntry RomFileSystem::MetadataTables::GetFile(u32 offset, std::string_view *name) const {
+        return ReadEntry<RomFsFileEntry>(fileMetaTable, offset, name);
+    }
 
-        if (entry.childOffset != constant::RomFsEmptyEntry)
-            TraverseDirectory(entry.childOffset, childPath);
+    u32 RomFileSystem::MetadataTables::FindDirectory(u32 parentOffset, std::string_view name) const {
+        u32 firstChildOffset{dirHashTable.empty() ? GetDirectory(parentOffset).childOffset : constant::RomFsEmptyEntry};
+        return FindEntry<RomFsDirectoryEntry>(dirHashTable, dirMetaTable, firstChildOffset, parentOffset, name);
+    }
 
-        if (entry.siblingOffset != constant::RomFsEmptyEntry)
-            TraverseDirectory(entry.siblingOffset, path);
+    u32 RomFileSystem::MetadataTables::FindFile(u32 parentOffset, std::string_view name) const {
+        u32 firstChildOffset{fileHashTable.empty() ? GetDirectory(parentOffset).fileOffset : constant::RomFsEmptyEntry};
+        return FindEntry<RomFsFileEntry>(fileHashTable, fileMetaTable, firstChildOffset, parentOffset, name);
+    }
+
+    RomFileSystem::RomFileSystem(std::shared_ptr<Backing> pBacking) : FileSystem(), backing(std::move(pBacking)) {
+        header = backing->Read<RomFsHeader>();
+        tables = std::make_shared<MetadataTables>(*backing, header);
+    }
+
+    std::optional<std::pair<u32, std::string_view>> RomFileSystem::ResolveParent(std::string_view path) {
+        u32 directoryOffset{}; // The root directory is always the first entry in the directory table
+        while (true) {
+            auto separator{path.find('/')};
+            if (separator == std::string_view::npos)
+                return std::make_pair(directoryOffset, path);
+
+            if (separator != 0) {
+                directoryOffset = tables->FindDirectory(directoryOffset, path.substr(0, separator));
+                if (directoryOffset == constant::RomFsEmptyEntry)
+                    return std::nullopt;
+            }
+            path.remove_prefix(separator + 1);
+        }
     }
 
     std::shared_ptr<Backing> RomFileSystem::OpenFileImpl(const std::string &path, Backing::Mode mode) {
-        try {
-            const auto &entry{fileMap.at(path)};
-            return std::make_shared<RegionBacking>(backing, header.dataOffset + entry.offset, entry.size, mode);
-        } catch (std::out_of_range &e) {
+        auto parent{ResolveParent(path)};
+        if (!parent || parent->second.empty())
             return nullptr;
-        }
+
+        u32 offset{tables->FindFile(parent->first, parent->second)};
+        if (offset == constant::RomFsEmptyEntry)
+            return nullptr;
+
+        auto entry{tables->GetFile(offset)};
+        return std::make_shared<RegionBacking>(backing, header.dataOffset + entry.offset, entry.size, mode);
     }
 
     std::optional<Directory::EntryType> RomFileSystem::GetEntryTypeImpl(const std::string &path) {
-        if (fileMap.count(path))
+        auto parent{ResolveParent(path)};
+        if (!parent)
+            return std::nullopt;
+
+        auto [parentOffset, name]{*parent};
+        if (name.empty())
+            return Directory::EntryType::Directory;
+        else if (tables->FindFile(parentOffset, name) != constant::RomFsEmptyEntry)
             return Directory::EntryType::File;
-        else if (directoryMap.count(path))
+        else if (tables->FindDirectory(parentOffset, name) != constant::RomFsEmptyEntry)
             return Directory::EntryType::Directory;
 
         return std::nullopt;
     }
 
     std::shared_ptr<Directory> RomFileSystem::OpenDirectoryImpl(const std::string &path, Directory::ListMode listMode) {
-        try {
-            auto &entry{directoryMap.at(path)};
-            return std::make_shared<RomFileSystemDirectory>(backing, header, entry, listMode);
-        } catch (std::out_of_range &e) {
+        auto parent{ResolveParent(path)};
+        if (!parent)
             return nullptr;
-        }
+
+        auto [parentOffset, name]{*parent};
+        u32 offset{name.empty() ? parentOffset : tables->FindDirectory(parentOffset, name)};
+        if (offset == constant::RomFsEmptyEntry)
+            return nullptr;
+
+        return std::make_shared<RomFileSystemDirectory>(tables, tables->GetDirectory(offset), listMode);
     }
 
-    RomFileSystemDirectory::RomFileSystemDirectory(std::shared_ptr<Backing> backing, const RomFileSystem::RomFsHeader &header, const RomFileSystem::RomFsDirectoryEntry &ownEntry, ListMode listMode) : Directory(listMode), backing(std::move(backing)), header(header), ownEntry(ownEntry) {}
+    RomFileSystemDirectory::RomFileSystemDirectory(std::shared_ptr<RomFileSystem::MetadataTables> tables, const RomFileSystem::RomFsDirectoryEntry &ownEntry, ListMode listMode) : Directory(listMode), tables(std::move(tables)), ownEntry(ownEntry) {}
 
     std::vector<RomFileSystemDirectory::Entry> RomFileSystemDirectory::Read() {
         std::vector<Entry> contents;
 
         if (listMode.file) {
-            RomFileSystem::RomFsFileEntry romFsFileEntry;
-            u32 offset{ownEntry.fileOffset};
-
-            do {
-                romFsFileEntry = backing->Read<RomFileSystem::RomFsFileEntry>(header.fileMetaTableOffset + offset);
-
-                if (romFsFileEntry.nameSize) {
-                    std::vector<char> name(romFsFileEntry.nameSize);
-                    backing->Read(span(name), header.fileMetaTableOffset + offset + sizeof(RomFileSystem::RomFsFileEntry));
-
-                    contents.emplace_back(Entry{std::string(name.data(), romFsFileEntry.nameSize), EntryType::File, romFsFileEntry.size});
-                }
+            for (u32 offset{ownEntry.fileOffset}; offset != constant::RomFsEmptyEntry;) {
+                std::string_view name;
+                auto romFsFileEntry{tables->GetFile(offset, &name)};
+                if (!name.empty())
+                    contents.emplace_back(Entry{std::string(name), EntryType::File, romFsFileEntry.size});
 
                 offset = romFsFileEntry.siblingOffset;
-            } while (offset != constant::RomFsEmptyEntry);
+            }
         }
 
         if (listMode.directory) {
-            RomFileSystem::RomFsDirectoryEntry romFsDirectoryEntry;
-            u32 offset{ownEntry.childOffset};
-
-            do {
-                romFsDirectoryEntry = backing->Read<RomFileSystem::RomFsDirectoryEntry>(header.dirMetaTableOffset + offset);
-
-                if (romFsDirectoryEntry.nameSize) {
-                    std::vector<char> name(romFsDirectoryEntry.nameSize);
-                    backing->Read(span(name), header.dirMetaTableOffset + offset + sizeof(RomFileSystem::RomFsDirectoryEntry));
-
-                    contents.emplace_back(Entry{std::string(name.data(), romFsDirectoryEntry.nameSize), EntryType::Directory});
-                }
+            for (u32 offset{ownEntry.childOffset}; offset != constant::RomFsEmptyEntry;) {
+                std::string_view name;
+                auto romFsDirectoryEntry{tables->GetDirectory(offset, &name)};
+                if (!name.empty())
+                    contents.emplace_back(Entry{std::string(name), EntryType::Directory});
 
                 offset = romFsDirectoryEntry.siblingOffset;
-            } while (offset != constant::RomFsEmptyEntry);
+            }
         }
 
         return contents;
@@ -13,32 +13,9 @@ namespace skyline {
     namespace vfs {
         /**
          * @brief The RomFileSystem class abstracts access to a RomFS image using the vfs::FileSystem api
+         * @note The metadata tables are read into memory in bulk and lookups are performed through the hash tables of the image, names are only turned into strings when a directory is enumerated
          */
         class RomFileSystem : public FileSystem {
-          private:
-            std::shared_ptr<Backing> backing;
-
-            /**
-             * @brief Traverses the sibling files of the given file and adds them to the file map
-             * @param offset The offset of the file entry to traverses the siblings of
-             * @param path The path to the parent directory of the supplied file entry
-             */
-            void TraverseFiles(u32 offset, const std::string &path);
-
-            /**
-             * @brief Traverses the directories within the given directory, adds them to the directory map and calls TraverseFiles on them
-             * @param offset The offset of the directory entry to traverses the directories in
-             * @param path The path to the supplied directory entry
-             */
-            void TraverseDirectory(u32 offset, const std::string &path);
-
-          protected:
-            std::shared_ptr<Backing> OpenFileImpl(const std::string &path, Backing::Mode mode) override;
-
-            std::optional<Directory::EntryType> GetEntryTypeImpl(const std::string &path) override;
-
-            std::shared_ptr<Directory> OpenDirectoryImpl(const std::string &path, Directory::ListMode listMode) override;
-
           public:
             struct RomFsHeader {
                 u64 headerSize; //!< The size of the header
@@ -59,22 +36,88 @@ namespace skyline {
                 u32 siblingOffset; //!< The offset from the directory metadata base of a sibling directory
                 u32 childOffset; //!< The offset from the directory metadata base of a child directory
                 u32 fileOffset; //!< The offset from the file metadata base of a child file
-                u32 hash; //!< The hash of the directory
+                u32 hashSiblingOffset; //!< The offset from the directory metadata base of the next directory in the same hash bucket
                 u32 nameSize; //!< The size of the directory's name in bytes
             };
+            static_assert(sizeof(RomFsDirectoryEntry) == 0x18);
 
             struct RomFsFileEntry {
                 u32 parentOffset; //!< The offset from the directory metadata base of the parent directory
                 u32 siblingOffset; //!< The offset from the file metadata base of a sibling file
                 u64 offset; //!< The offset from the file data base of the file contents
                 u64 size; //!< The size of the file in bytes
-                u32 hash; //!< The hash of the file
+                u32 hashSiblingOffset; //!< The offset from the file metadata base of the next file in the same hash bucket
                 u32 nameSize; //!< The size of the file's name in bytes
             };
+            static_assert(sizeof(RomFsFileEntry) == 0x20);
+
+            /**
+             * @brief The directory and file tables of a RomFS image, these are shared with any directories opened from the filesystem
+             */
+            class MetadataTables {
+              private:
+                std::vector<u8> metadata; //!< The contents of all the hash and metadata tables
+                span<u8> dirHashTable;
+                span<u8> dirMetaTable;
+                span<u8> fileHashTable;
+                span<u8> fileMetaTable;
+
+                /**
+                 * @brief Reads an entry from a metadata table after validating that it's in bounds
+                 * @param name If non-null, this is set to the name of the entry which points into the table
+                 */
+                template<typename EntryType>
+                static EntryType ReadEntry(span<u8> table, u32 offset, std::string_view *name);
+
+                /**
+                 * @brief Looks up an entry with the supplied parent and name through a hash table, the sibling chain of the parent is used if the image has no hash table
+                 */
+                template<typename EntryType>
+                static u32 FindEntry(span<u8> hashTable, span<u8> metaTable, u32 firstChildOffset, u32 parentOffset, std::string_view name);
+
+              public:
+                /**
+                 * @note The tables are read with a single read if they're contiguous (which is always the case for images created by Nintendo's tools), otherwise every table is read separately
+                 */
+                MetadataTables(Backing &backing, const RomFsHeader &header);
+
+                MetadataTables(const MetadataTables &) = delete;
+
+                MetadataTables &operator=(const MetadataTables &) = delete;
+
+                RomFsDirectoryEntry GetDirectory(u32 offset, std::string_view *name = nullptr) const;
+
+                RomFsFileEntry GetFile(u32 offset, std::string_view *name = nullptr) const;
+
+                /**
+                 * @return The offset of the subdirectory of the supplied directory with a matching name or RomFsEmptyEntry if there's none
+                 */
+                u32 FindDirectory(u32 parentOffset, std::string_view name) const;
+
+                /**
+                 * @return The offset of the file in the supplied directory with a matching name or RomFsEmptyEntry if there's none
+                 */
+                u32 FindFile(u32 parentOffset, std::string_view name) const;
+            };
 
-            std::unordered_map<std::string, RomFsFileEntry> fileMap; //!< A map that maps file names to their corresponding entry
-            std::unordered_map<std::string, RomFsDirectoryEntry> directoryMap; //!< A map that maps directory names to their corresponding entry
+          private:
+            std::shared_ptr<Backing> backing;
+            std::shared_ptr<MetadataTables> tables;
 
+            /**
+             * @brief Resolves all directories in a path aside from the last component
+             * @return The offset of the directory containing the last component of the path and the name of the last component, this'll be empty for the root directory
+             */
+            std::optional<std::pair<u32, std::string_view>> ResolveParent(std::string_view path);
+
+          protected:
+            std::shared_ptr<Backing> OpenFileImpl(const std::string &path, Backing::Mode mode) override;
+
+            std::optional<Directory::EntryType> GetEntryTypeImpl(const std::string &path) override;
+
+            std::shared_ptr<Directory> OpenDirectoryImpl(const std::string &path, Directory::ListMode listMode) override;
+
+          public:
             RomFileSystem(std::shared_ptr<Backing> backing);
         };
 
@@ -84,11 +127,10 @@ namespace skyline {
         class RomFileSystemDirectory : public Directory {
           private:
             RomFileSystem::RomFsDirectoryEntry ownEntry; //!< This directory's entry in the RomFS header
-            RomFileSystem::RomFsHeader header; //!< A header of this files parent RomFS image
-            std::shared_ptr<Backing> backing;
+            std::shared_ptr<RomFileSystem::MetadataTables> tables; //!< The tables of the parent RomFS image
 
           public:
-            RomFileSystemDirectory(std::shared_ptr<Backing> backing, const RomFileSystem::RomFsHeader &header, const RomFileSystem::RomFsDirectoryEntry &ownEntry, ListMode listMode);
+            RomFileSystemDirectory(std::shared_ptr<RomFileSystem::MetadataTables> tables, const RomFileSystem::RomFsDirectoryEntry &ownEntry, ListMode listMode);
 
             std::vector<Entry> Read();
         };
@@ -462,6 +462,19 @@ class EmulationActivity : AppCompatActivity(), SurfaceHolder.Callback, View.OnTo
         return if (validatorResult.get()) 0 else 1
     }
 
+    /**
+     * Shows the progress of compiling the pipelines recorded in prior runs before the title starts, this is hidden once all of them are compiled
+     */
+    @Suppress("unused")
+    fun updatePipelineWarmupProgress(compiled : Int, total : Int) {
+        runOnUiThread {
+            binding.pipelineWarmupProgress.apply {
+                isGone = compiled == total
+                text = getString(R.string.pipeline_warmup_progress, compiled, total)
+            }
+        }
+    }
+
     /**
      * @return A version code in Vulkan's format with 14-bit patch + 10-bit major and minor components
      */
@@ -123,7 +123,7 @@ data class AppEntry(
 /**
  * This class is used as interface between libskyline and Kotlin for loaders
  */
-internal class RomFile(context : Context, format : RomFormat, uri : Uri, systemLanguage : Int) {
+internal class RomFile private constructor(private val format : RomFormat, private val uri : Uri) {
     /**
      * @note This field is filled in by native code
      */
@@ -144,18 +144,15 @@ internal class RomFile(context : Context, format : RomFormat, uri : Uri, systemL
      */
     private var rawIcon : ByteArray? = null
 
-    val appEntry : AppEntry
+    lateinit var appEntry : AppEntry
+        private set
 
     var result = LoaderResult.Success
 
     val valid : Boolean
         get() = result == LoaderResult.Success
 
-    init {
-        context.contentResolver.openFileDescriptor(uri, "r")!!.use {
-            result = LoaderResult.get(populate(format.ordinal, it.fd, "${context.filesDir.canonicalPath}/keys/", systemLanguage))
-        }
-
+    private fun createAppEntry(context : Context) {
         appEntry = applicationName?.let { name ->
             applicationVersion?.let { version ->
                 applicationAuthor?.let { author ->
@@ -167,12 +164,47 @@ internal class RomFile(context : Context, format : RomFormat, uri : Uri, systemL
         } ?: AppEntry(context, format, uri, result)
     }
 
-    /**
-     * Parses ROM and writes its metadata to [applicationName], [applicationAuthor] and [rawIcon]
-     * @param format The format of the ROM
-     * @param romFd A file descriptor of the ROM
-     * @param appFilesPath Path to internal app data storage, needed to read imported keys
-     * @return A pointer to the newly allocated object, or 0 if the ROM is invalid
-     */
-    private external fun populate(format : Int, romFd : Int, appFilesPath : String, systemLanguage : Int) : Int
+    companion object {
+        /**
+         * The maximum amount of ROMs that are passed to native code at once, this bounds the amount of file descriptors which are open simultaneously
+         */
+        private const val BatchSize = 64
+
+        private fun getAppFilesPath(context : Context) = "${context.filesDir.canonicalPath}/"
+
+        /**
+         * Parses the metadata of all supplied ROMs concurrently, this is significantly faster than creating a [RomFile] for each ROM
+         * @return The [AppEntry] of each ROM in the same order as [roms]
+         */
+        fun populateAll(context : Context, roms : List<Pair<RomFormat, Uri>>, systemLanguage : Int) : List<AppEntry> = roms.chunked(BatchSize).flatMap { batch ->
+            val romFiles = batch.map { (format, uri) -> RomFile(format, uri) }
+            val descriptors = batch.map { (_, uri) ->
+                try {
+                    context.contentResolver.openFileDescriptor(uri, "r")
+                } catch (e : Exception) {
+                    null
+                }
+            }
+
+            try {
+                val results = populateBatch(romFiles.toTypedArray(), batch.map { it.first.ordinal }.toIntArray(), descriptors.map { it?.fd ?: -1 }.toIntArray(), getAppFilesPath(context), systemLanguage)
+                romFiles.forEachIndexed { index, romFile ->
+                    romFile.result = LoaderResult.get(results[index])
+                    romFile.createAppEntry(context)
+                }
+            } finally {
+                descriptors.forEach { it?.close() }
+            }
+
+            romFiles.map { it.appEntry }
+        }
+
+        /**
+         * Parses the supplied ROMs on a pool of native worker threads and writes their metadata to the corresponding [RomFile]
+         * @param romFds File descriptors of the ROMs, a negative value denotes a ROM that couldn't be opened
+         * @return The [LoaderResult] value of each ROM
+         */
+        @JvmStatic
+        private external fun populateBatch(romFiles : Array<RomFile>, formats : IntArray, romFds : IntArray, appFilesPath : String, systemLanguage : Int) : IntArray
+    }
 }
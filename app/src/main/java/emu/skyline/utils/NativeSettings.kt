@@ -22,14 +22,26 @@ class NativeSettings(context : Context, pref : PreferenceSettings) {
     var forceTripleBuffering : Boolean = pref.forceTripleBuffering
     var disableFrameThrottling : Boolean = pref.disableFrameThrottling
 
+    // Audio
+    var highQualityResampling : Boolean = pref.highQualityResampling
+    var audioSink : Int = pref.audioSink
+
     // GPU
     var gpuDriver : String = if (pref.gpuDriver == PreferenceSettings.SYSTEM_GPU_DRIVER) "" else pref.gpuDriver
     var gpuDriverLibraryName : String = if (pref.gpuDriver == PreferenceSettings.SYSTEM_GPU_DRIVER) "" else GpuDriverHelper.getLibraryName(context, pref.gpuDriver)
     var executorSlotCount : Int = pref.executorSlotCount
     var enableTextureReadbackHack : Boolean = pref.enableTextureReadbackHack
+    var pipelineCompilation : Int = pref.pipelineCompilation
+    var macroExecution : Int = pref.macroExecution
 
     // Debug
     var validationLayer : Boolean = BuildConfig.BUILD_TYPE != "release" && pref.validationLayer
+    var guestProfiler : Boolean = pref.guestProfiler
+    var guestProfilerFrequency : Int = pref.guestProfilerFrequency
+    var guestProfilerThreadFilter : String = pref.guestProfilerThreadFilter
+    var gpfifoCapture : Boolean = pref.gpfifoCapture
+    var gpfifoReplay : Boolean = pref.gpfifoReplay
+    var gpfifoReplayIterations : Int = pref.gpfifoReplayIterations
 
     /**
      * Updates settings in libskyline during emulation
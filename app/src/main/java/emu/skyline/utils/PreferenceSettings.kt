@@ -36,13 +36,25 @@ class PreferenceSettings @Inject constructor(@ApplicationContext private val con
     var orientation by sharedPreferences(context, ActivityInfo.SCREEN_ORIENTATION_SENSOR_LANDSCAPE)
     var respectDisplayCutout by sharedPreferences(context, false)
 
+    // Audio
+    var highQualityResampling by sharedPreferences(context, false)
+    var audioSink by sharedPreferences(context, 0)
+
     // GPU
     var gpuDriver by sharedPreferences(context, SYSTEM_GPU_DRIVER)
     var executorSlotCount by sharedPreferences(context, 6)
     var enableTextureReadbackHack by sharedPreferences(context, false)
+    var pipelineCompilation by sharedPreferences(context, 0)
+    var macroExecution by sharedPreferences(context, 0)
 
     // Debug
     var validationLayer by sharedPreferences(context, false)
+    var guestProfiler by sharedPreferences(context, false)
+    var guestProfilerFrequency by sharedPreferences(context, 1000)
+    var guestProfilerThreadFilter by sharedPreferences(context, "")
+    var gpfifoCapture by sharedPreferences(context, false)
+    var gpfifoReplay by sharedPreferences(context, false)
+    var gpfifoReplayIterations by sharedPreferences(context, 5)
 
     // Input
     var onScreenControl by sharedPreferences(context, true)
@@ -0,0 +1,66 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <chrono>
+#include <cstdio>
+#include <audio/adpcm_decoder.h>
+
+using namespace skyline;
+using namespace skyline::audio;
+
+/**
+ * @brief Measures the throughput of the sample-at-a-time reference decoder, the unrolled frame decoder and the batched decoder on voice-sized streams
+ */
+int main() {
+    constexpr size_t VoiceCount{96}; //!< The amount of voices that are decoded together, this is the limit of voices in a renderer
+    constexpr size_t FramesPerUpdate{18}; //!< The amount of frames a voice decodes in a single renderer update, 240 samples at 48 kHz
+    constexpr size_t Updates{20000};
+
+    std::array<std::array<i16, 2>, 8> coefficients{{{0x04AB, -0x01F6}, {0x0789, -0x0345}, {0x0512, -0x0021}, {0x0F00, -0x0700}, {0x0400, 0x0000}, {0x0100, 0x0100}, {0x0800, -0x0400}, {0x0C00, -0x0600}}};
+    std::vector<AdpcmDecoder> decoders(VoiceCount, AdpcmDecoder{coefficients});
+
+    std::vector<u8> data(VoiceCount * FramesPerUpdate * AdpcmDecoder::BytesPerFrame);
+    u32 seed{1};
+    for (auto &byte : data) {
+        seed = seed * 1664525 + 1013904223;
+        byte = static_cast<u8>(seed >> 24);
+    }
+    std::vector<i16> output(VoiceCount * FramesPerUpdate * AdpcmDecoder::SamplesPerFrame);
+
+    auto voiceData{[&](size_t voice) { return span<const u8>{data}.subspan(voice * FramesPerUpdate * AdpcmDecoder::BytesPerFrame, FramesPerUpdate * AdpcmDecoder::BytesPerFrame); }};
+    auto voiceOutput{[&](size_t voice) { return span{output}.subspan(voice * FramesPerUpdate * AdpcmDecoder::SamplesPerFrame, FramesPerUpdate * AdpcmDecoder::SamplesPerFrame); }};
+
+    auto measure{[&](const char *name, auto &&decode) {
+        for (auto &decoder : decoders)
+            decoder.Reset();
+
+        auto start{std::chrono::steady_clock::now()};
+        for (size_t update{}; update < Updates; update++)
+            decode();
+        double seconds{std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()};
+
+        u32 checksum{};
+        for (i16 sample : output)
+            checksum = (checksum * 31) + static_cast<u16>(sample);
+        std::printf("%-16s %7.2f Mframes/s (checksum %08X)\n", name, (VoiceCount * FramesPerUpdate * Updates) / seconds / 1e6, checksum);
+    }};
+
+    measure("DecodeReference", [&] {
+        for (size_t voice{}; voice < VoiceCount; voice++)
+            decoders[voice].DecodeReference(voiceData(voice), voiceOutput(voice));
+    });
+
+    measure("Decode", [&] {
+        for (size_t voice{}; voice < VoiceCount; voice++)
+            decoders[voice].Decode(voiceData(voice), voiceOutput(voice));
+    });
+
+    std::vector<AdpcmDecoder::BatchFrame> batch(VoiceCount);
+    measure("DecodeFrames", [&] {
+        for (size_t frame{}; frame < FramesPerUpdate; frame++) {
+            for (size_t voice{}; voice < VoiceCount; voice++)
+                batch[voice] = {&decoders[voice], voiceData(voice).data() + (frame * AdpcmDecoder::BytesPerFrame), voiceOutput(voice).data() + (frame * AdpcmDecoder::SamplesPerFrame)};
+            AdpcmDecoder::DecodeFrames(batch);
+        }
+    });
+}
@@ -0,0 +1,100 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <cstdio>
+#include <random>
+#include <audio/adpcm_decoder.h>
+
+using namespace skyline;
+using namespace skyline::audio;
+
+/**
+ * @return A set of coefficients spanning the entire range of i16 so the prediction can saturate, a random amount of pairs are supplied to cover headers addressing pairs the guest didn't supply
+ */
+static std::vector<std::array<i16, 2>> RandomCoefficients(std::mt19937 &generator) {
+    std::uniform_int_distribution<i32> coefficientDistribution{std::numeric_limits<i16>::min(), std::numeric_limits<i16>::max()};
+    std::vector<std::array<i16, 2>> coefficients(generator() % 9);
+    for (auto &pair : coefficients)
+        pair = {static_cast<i16>(coefficientDistribution(generator)), static_cast<i16>(coefficientDistribution(generator))};
+    return coefficients;
+}
+
+static void RandomFrames(std::mt19937 &generator, span<u8> data) {
+    for (auto &byte : data)
+        byte = static_cast<u8>(generator());
+}
+
+/**
+ * @brief Checks that the frame decoders are bit-exact with the sample-at-a-time reference decoder
+ * @note The streams are decoded over several calls with arbitrary output sizes to cover partial frames and the continuity of the history
+ */
+int main() {
+    constexpr size_t Iterations{2000};
+    constexpr size_t MaxFrames{64};
+    std::mt19937 generator{0xAD9C};
+    size_t failures{};
+
+    for (size_t iteration{}; iteration < Iterations; iteration++) {
+        auto coefficients{RandomCoefficients(generator)};
+        AdpcmDecoder decoder{coefficients}, reference{coefficients};
+
+        std::vector<u8> data((generator() % MaxFrames + 1) * AdpcmDecoder::BytesPerFrame);
+        RandomFrames(generator, data);
+
+        // The stream is consumed in chunks of whole frames with the output of each chunk being truncated to an arbitrary amount of samples
+        size_t offset{};
+        while (offset < data.size()) {
+            size_t chunkFrames{std::min(generator() % 8 + 1, (data.size() - offset) / AdpcmDecoder::BytesPerFrame)};
+            size_t outputSamples{generator() % (chunkFrames * AdpcmDecoder::SamplesPerFrame) + 1};
+            auto chunk{span<const u8>{data}.subspan(offset, chunkFrames * AdpcmDecoder::BytesPerFrame)};
+
+            std::vector<i16> output(outputSamples), expectedOutput(outputSamples);
+            size_t written{decoder.Decode(chunk, output)}, expectedWritten{reference.DecodeReference(chunk, expectedOutput)};
+            if (written != expectedWritten || output != expectedOutput || decoder.GetHistory() != reference.GetHistory()) {
+                std::printf("Decode mismatch: iteration %zu, offset 0x%zX, %zu frames into %zu samples\n", iteration, offset, chunkFrames, outputSamples);
+                failures++;
+                break;
+            }
+            offset += chunk.size();
+        }
+
+        // A batch of independent streams which covers every amount of streams that isn't a multiple of the lane count
+        size_t streamCount{iteration % 11 + 1};
+        std::vector<AdpcmDecoder> decoders, references;
+        std::vector<std::vector<u8>> streams(streamCount);
+        for (size_t stream{}; stream < streamCount; stream++) {
+            auto streamCoefficients{RandomCoefficients(generator)};
+            decoders.emplace_back(streamCoefficients);
+            references.emplace_back(streamCoefficients);
+
+            std::array<i32, 2> history{static_cast<i16>(generator()), static_cast<i16>(generator())};
+            decoders.back().SetHistory(history);
+            references.back().SetHistory(history);
+
+            streams[stream].resize(4 * AdpcmDecoder::BytesPerFrame);
+            RandomFrames(generator, streams[stream]);
+        }
+
+        for (size_t frame{}; frame < 4; frame++) {
+            std::vector<std::array<i16, AdpcmDecoder::SamplesPerFrame>> outputs(streamCount);
+            std::vector<AdpcmDecoder::BatchFrame> batch;
+            for (size_t stream{}; stream < streamCount; stream++)
+                batch.push_back({&decoders[stream], streams[stream].data() + (frame * AdpcmDecoder::BytesPerFrame), outputs[stream].data()});
+            AdpcmDecoder::DecodeFrames(batch);
+
+            for (size_t stream{}; stream < streamCount; stream++) {
+                std::array<i16, AdpcmDecoder::SamplesPerFrame> expectedOutput;
+                references[stream].DecodeReference(span<const u8>{streams[stream]}.subspan(frame * AdpcmDecoder::BytesPerFrame, AdpcmDecoder::BytesPerFrame), expectedOutput);
+                if (outputs[stream] != expectedOutput || decoders[stream].GetHistory() != references[stream].GetHistory()) {
+                    std::printf("DecodeFrames mismatch: iteration %zu, %zu streams, stream %zu, frame %zu\n", iteration, streamCount, stream, frame);
+                    failures++;
+                    frame = 4;
+                    break;
+                }
+            }
+        }
+    }
+
+    std::printf("adpcm_check: %zu iterations, %zu failures\n", Iterations, failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,22 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <cstdio>
+#include <common.h>
+
+namespace skyline {
+    /**
+     * @brief Host replacement for the libunwind-based implementation in exception.cpp, stack traces aren't needed by the host tools
+     */
+    std::vector<void *> exception::GetStackFrames() {
+        return {};
+    }
+
+    /**
+     * @brief Host replacement for the implementation in logger.cpp which writes to logcat and the log file, this writes to stderr instead
+     */
+    void Logger::Write(LogLevel level, const std::string &str) {
+        constexpr std::array<char, 5> levelCharacter{'E', 'W', 'I', 'D', 'V'};
+        std::fprintf(stderr, "%c: %s\n", levelCharacter[static_cast<u8>(level)], str.c_str());
+    }
+}
@@ -0,0 +1,423 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <lz4.h>
+#include <soc/gm20b/engines/engine.h>
+#include <soc/gm20b/gpfifo_capture.h>
+#include <soc/gm20b/macro/macro_jit.h>
+
+using namespace skyline;
+using namespace skyline::soc::gm20b;
+using namespace skyline::soc::gm20b::engine;
+
+namespace skyline::soc::gm20b::engine {
+    // engine.cpp isn't linked as the rest of it depends on MacroState::Execute, the executors are driven directly instead
+    MacroEngineBase::MacroEngineBase(MacroState &macroState) : macroState(macroState) {}
+}
+
+/**
+ * @brief The Maxwell 3D methods that load macros into macro memory
+ */
+namespace mme {
+    constexpr u32 InstructionRamPointer{0x45};
+    constexpr u32 InstructionRamLoad{0x46};
+    constexpr u32 StartAddressRamPointer{0x47};
+    constexpr u32 StartAddressRamLoad{0x48};
+}
+
+/**
+ * @brief The contents of macro memory at the time of a macro call, a new one is created whenever macro memory is modified between calls which would invalidate any cached state in MacroState
+ */
+struct MacroMemory {
+    std::array<u32, 0x2000> code{};
+    std::array<size_t, 0x80> positions{};
+};
+
+/**
+ * @brief An operation on the 3D engine of a channel extracted from the pushbuffers of a capture
+ */
+struct Event {
+    enum class Type : u8 {
+        Method, //!< A 3D method was written to directly, `method` and `argument` are the method and its argument
+        Macro, //!< A macro was executed, `method` is its position, `argument` is the offset of its arguments in `Trace::arguments`
+    } type;
+    u32 channel;
+    u32 method;
+    u32 argument;
+    u32 argumentCount; //!< The amount of arguments to a macro
+    u32 memory; //!< The index of the macro memory a macro was executed with in `Trace::memories`
+};
+
+/**
+ * @brief All 3D engine operations across the channels of a capture in the order they were captured in
+ */
+struct Trace {
+    std::vector<Event> events;
+    std::vector<u32> arguments;
+    std::vector<std::unique_ptr<MacroMemory>> memories;
+    size_t channelCount{};
+    size_t gpEntryCount{};
+    size_t macroCount{};
+};
+
+/**
+ * @brief Decodes the pushbuffers of a single channel into events, this mirrors ChannelGpfifo::ProcessPushBuffer and MacroEngineBase::HandleMacroCall for the 3D engine
+ * @note Methods on other engines don't affect macros and are skipped
+ */
+class ChannelDecoder {
+  private:
+    enum class SecOp : u8 {
+        Grp0UseTert = 0,
+        IncMethod = 1,
+        NonIncMethod = 3,
+        ImmdDataMethod = 4,
+        OneInc = 5,
+        EndPbSegment = 7,
+    };
+
+    static constexpr u32 ThreeDSubchannel{0};
+    static constexpr u32 Grp0SetSubDevMask{1};
+
+    enum class MethodState : u8 {
+        Inc,
+        OneInc,
+        NonInc,
+    };
+
+    struct {
+        u32 remaining;
+        u32 address;
+        u32 subChannel;
+        MethodState state;
+    } resumeState{}; //!< The state of a method which may continue into the pushbuffer of the next GpEntry
+
+    Trace &trace;
+    u32 channel;
+    MacroMemory memory{};
+    bool memoryModified{true}; //!< If macro memory was modified since the last macro call and needs a new snapshot
+    u32 memoryIndex{};
+    u32 instructionRamPointer{}, startAddressRamPointer{};
+
+    struct {
+        u32 index{std::numeric_limits<u32>::max()};
+        std::vector<u32> arguments;
+    } macroInvocation; //!< Data for a macro that is pending execution
+
+    void ExecutePendingMacro() {
+        if (memoryModified) {
+            trace.memories.push_back(std::make_unique<MacroMemory>(memory));
+            memoryIndex = static_cast<u32>(trace.memories.size() - 1);
+            memoryModified = false;
+        }
+
+        trace.events.push_back(Event{
+            .type = Event::Type::Macro,
+            .channel = channel,
+            .method = macroInvocation.index,
+            .argument = static_cast<u32>(trace.arguments.size()),
+            .argumentCount = static_cast<u32>(macroInvocation.arguments.size()),
+            .memory = memoryIndex,
+        });
+        trace.arguments.insert(trace.arguments.end(), macroInvocation.arguments.begin(), macroInvocation.arguments.end());
+        trace.macroCount++;
+
+        macroInvocation.index = std::numeric_limits<u32>::max();
+        macroInvocation.arguments.clear();
+    }
+
+    void Send(u32 method, u32 argument, u32 subChannel, bool lastCall) {
+        if (subChannel != ThreeDSubchannel || method < engine::GPFIFO::RegisterCount)
+            return;
+
+        if (method < EngineMethodsEnd) {
+            switch (method) {
+                case mme::InstructionRamPointer:
+                    instructionRamPointer = argument;
+                    break;
+                case mme::InstructionRamLoad:
+                    memory.code[instructionRamPointer++ % memory.code.size()] = argument;
+                    instructionRamPointer %= memory.code.size();
+                    memoryModified = true;
+                    break;
+                case mme::StartAddressRamPointer:
+                    startAddressRamPointer = argument;
+                    break;
+                case mme::StartAddressRamLoad:
+                    memory.positions[startAddressRamPointer++ % memory.positions.size()] = argument;
+                    memoryModified = true;
+                    break;
+                default:
+                    break;
+            }
+
+            trace.events.push_back(Event{.type = Event::Type::Method, .channel = channel, .method = method, .argument = argument});
+            return;
+        }
+
+        u32 macroMethodOffset{method - EngineMethodsEnd};
+        if (!(macroMethodOffset & 1)) {
+            if (macroInvocation.index != std::numeric_limits<u32>::max())
+                ExecutePendingMacro();
+            macroInvocation.index = (macroMethodOffset / 2) % memory.positions.size();
+        }
+
+        macroInvocation.arguments.push_back(argument);
+
+        if (lastCall && macroInvocation.index != std::numeric_limits<u32>::max())
+            ExecutePendingMacro();
+    }
+
+    /**
+     * @brief Sends the arguments of the current method until it's complete or the pushbuffer ends
+     */
+    void Resume(span<const u32> pushBuffer, size_t &index) {
+        while (index < pushBuffer.size() && resumeState.remaining) {
+            Send(resumeState.address, pushBuffer[index++], resumeState.subChannel, --resumeState.remaining == 0);
+            if (resumeState.state == MethodState::Inc) {
+                resumeState.address++;
+            } else if (resumeState.state == MethodState::OneInc) {
+                resumeState.address++;
+                resumeState.state = MethodState::NonInc;
+            }
+        }
+    }
+
+  public:
+    ChannelDecoder(Trace &trace, u32 channel) : trace{trace}, channel{channel} {}
+
+    void Decode(span<const u32> pushBuffer) {
+        size_t index{};
+        Resume(pushBuffer, index);
+
+        while (index < pushBuffer.size()) {
+            u32 header{pushBuffer[index++]};
+            if (!header)
+                continue; // Entries containing all zeroes are NOPs
+
+            u32 address{header & 0xFFF}, subChannel{(header >> 13) & 0x7}, count{(header >> 16) & 0x1FFF};
+            switch (static_cast<SecOp>(header >> 29)) {
+                case SecOp::IncMethod:
+                    resumeState = {count, address, subChannel, MethodState::Inc};
+                    break;
+                case SecOp::NonIncMethod:
+                    resumeState = {count, address, subChannel, MethodState::NonInc};
+                    break;
+                case SecOp::OneInc:
+                    resumeState = {count, address, subChannel, MethodState::OneInc};
+                    break;
+                case SecOp::ImmdDataMethod:
+                    Send(address, count, subChannel, true);
+                    continue;
+                case SecOp::EndPbSegment:
+                    return;
+                case SecOp::Grp0UseTert:
+                    if (count == Grp0SetSubDevMask)
+                        continue;
+                    [[fallthrough]];
+                default:
+                    throw exception("Unsupported pushbuffer method header: 0x{:08X}", header);
+            }
+
+            Resume(pushBuffer, index);
+        }
+    }
+};
+
+/**
+ * @brief Reads a GPFIFO capture and decodes the pushbuffers of all its GpEntries into a trace
+ */
+static Trace LoadTrace(const char *path) {
+    std::ifstream file{path, std::ios::binary};
+    if (!file)
+        throw exception("Failed to open GPFIFO capture: {}", path);
+    std::vector<u8> contents{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+
+    capture::FileHeader header{};
+    if (contents.size() < sizeof(header))
+        throw exception("GPFIFO capture is too small: 0x{:X} bytes", contents.size());
+    std::memcpy(&header, contents.data(), sizeof(header));
+    if (header.magic != capture::FileHeader::Magic || header.version != capture::FileHeader::Version)
+        throw exception("GPFIFO capture is invalid or from an incompatible version: magic: 0x{:X}, version: {}", header.magic, header.version);
+
+    Trace trace;
+    std::vector<std::unique_ptr<ChannelDecoder>> decoders;
+    std::vector<u32> pushBuffer;
+    for (size_t offset{sizeof(header)}; contents.size() - offset >= sizeof(capture::RecordHeader);) {
+        capture::RecordHeader record;
+        std::memcpy(&record, contents.data() + offset, sizeof(record));
+        offset += sizeof(record);
+        if (contents.size() - offset < record.compressedSize) {
+            Logger::Warn("GPFIFO capture is truncated, {} GpEntries were loaded", trace.gpEntryCount);
+            break;
+        }
+        auto data{span{contents}.subspan(offset, record.compressedSize)};
+        offset += record.compressedSize;
+
+        if (record.type == capture::RecordType::Channel) {
+            if (decoders.size() <= record.id)
+                decoders.resize(record.id + 1);
+            decoders[record.id] = std::make_unique<ChannelDecoder>(trace, record.id);
+            trace.channelCount = std::max<size_t>(trace.channelCount, record.id + 1);
+        } else if (record.type == capture::RecordType::GpEntry) {
+            if (decoders.size() <= record.id || !decoders[record.id])
+                throw exception("GpEntry record references unknown channel {}", record.id);
+
+            pushBuffer.resize(record.size / sizeof(u32));
+            if (LZ4_decompress_safe(reinterpret_cast<char *>(data.data()), reinterpret_cast<char *>(pushBuffer.data()), static_cast<int>(data.size()), static_cast<int>(record.size)) != static_cast<int>(record.size))
+                throw exception("Failed to decompress the pushbuffer of GpEntry {}", trace.gpEntryCount);
+
+            decoders[record.id]->Decode(pushBuffer);
+            trace.gpEntryCount++;
+        }
+    }
+
+    return trace;
+}
+
+/**
+ * @brief A 3D engine which only holds registers, every method call from a macro is folded into a hash so the method streams of executors can be compared
+ */
+struct ReplayEngine : MacroEngineBase {
+    std::array<u32, 0x1000> registers{};
+    u64 hash{0xCBF29CE484222325};
+
+    ReplayEngine(MacroState &state) : MacroEngineBase{state} {}
+
+    void CallMethodFromMacro(u32 method, u32 argument) override {
+        hash = (hash ^ method) * 0x100000001B3;
+        hash = (hash ^ argument) * 0x100000001B3;
+        registers[method & 0xFFF] = argument;
+    }
+
+    u32 ReadMethodFromMacro(u32 method) override {
+        return registers[method & 0xFFF];
+    }
+};
+
+enum class Executor {
+    None, //!< Macros aren't executed, this measures the cost of the replay itself
+    Interpreter,
+    Program,
+    Jit,
+};
+
+struct ReplayResult {
+    double nanoseconds;
+    u64 hash; //!< A combination of the method stream hashes of all channels
+};
+
+/**
+ * @brief Replays a trace with the supplied executor, programs and JIT code are cached for each macro memory in the same way as MacroState and compiled on their first execution
+ */
+static ReplayResult Replay(Trace &trace, Executor executor, size_t iterations) {
+    alignas(MacroState) std::array<u8, sizeof(MacroState)> stateStorage{}; // The macro state is never accessed as the executors are driven directly
+    auto &macroState{*reinterpret_cast<MacroState *>(stateStorage.data())};
+
+    std::vector<MacroInterpreter> interpreters;
+    std::vector<std::array<std::optional<MacroProgram>, 0x80>> programs(trace.memories.size());
+    std::vector<std::array<MacroState::MacroJitEntry, 0x80>> jits(trace.memories.size());
+    for (auto &memory : trace.memories)
+        interpreters.emplace_back(memory->code);
+
+    double bestNanoseconds{std::numeric_limits<double>::max()};
+    u64 hash{};
+    for (size_t iteration{}; iteration < iterations; iteration++) {
+        std::vector<std::unique_ptr<ReplayEngine>> engines;
+        for (size_t channel{}; channel < trace.channelCount; channel++)
+            engines.push_back(std::make_unique<ReplayEngine>(macroState));
+
+        auto start{std::chrono::steady_clock::now()};
+        for (const auto &event : trace.events) {
+            auto &engine{*engines[event.channel]};
+            if (event.type == Event::Type::Method) {
+                engine.registers[event.method] = event.argument;
+                continue;
+            }
+
+            span<u32> args{trace.arguments.data() + event.argument, event.argumentCount};
+            auto &memory{*trace.memories[event.memory]};
+            size_t offset{memory.positions[event.method] % memory.code.size()};
+            switch (executor) {
+                case Executor::None:
+                    break;
+
+                case Executor::Interpreter:
+                    interpreters[event.memory].Execute(offset, args, &engine);
+                    break;
+
+                case Executor::Program:
+                case Executor::Jit: {
+                    auto &program{programs[event.memory][event.method]};
+                    if (!program)
+                        program.emplace(memory.code, offset);
+
+                    if (executor == Executor::Jit) {
+                        auto &jitEntry{jits[event.memory][event.method]};
+                        if (!jitEntry.valid) {
+                            try {
+                                jitEntry.jit = std::make_unique<MacroJit>(*program);
+                            } catch (const exception &e) {
+                                Logger::Warn("Failed to compile macro at 0x{:X}, it'll be interpreted: {}", offset, e.what());
+                            }
+                            jitEntry.valid = true;
+                        }
+
+                        if (jitEntry.jit) {
+                            jitEntry.jit->Execute(args, &engine);
+                            break;
+                        }
+                    }
+
+                    program->Execute(args, &engine);
+                    break;
+                }
+            }
+        }
+        bestNanoseconds = std::min(bestNanoseconds, std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+
+        hash = 0;
+        for (auto &engine : engines)
+            hash = (hash * 0x100000001B3) ^ engine->hash;
+    }
+
+    return {bestNanoseconds, hash};
+}
+
+/**
+ * @brief Replays the macro calls from a GPFIFO capture through the reference interpreter, the pre-decoded programs and the JIT and compares their performance and method streams
+ * @note Only macros called on the 3D engine are replayed, the 3D registers they read are tracked from the pushbuffers and the methods called by macros but no other engine state is
+ */
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "Usage: %s <GPFIFO capture> [iterations]\n", argv[0]);
+        return 1;
+    }
+    size_t iterations{argc > 2 ? std::strtoul(argv[2], nullptr, 0) : 10};
+
+    try {
+        auto trace{LoadTrace(argv[1])};
+        std::printf("%zu GpEntries on %zu channels, %zu events with %zu macro calls over %zu macro memories\n", trace.gpEntryCount, trace.channelCount, trace.events.size(), trace.macroCount, trace.memories.size());
+        if (!trace.macroCount)
+            return 0;
+
+        auto baseline{Replay(trace, Executor::None, iterations)};
+        auto interpreter{Replay(trace, Executor::Interpreter, iterations)};
+        auto report{[&](const char *name, const ReplayResult &result) {
+            double macroNanoseconds{std::max(result.nanoseconds - baseline.nanoseconds, 0.0)};
+            std::printf("%-12s %8.3f ms (%7.1f ns/call, %.2fx the interpreter), method streams %s\n", name, macroNanoseconds / 1e6, macroNanoseconds / trace.macroCount, (interpreter.nanoseconds - baseline.nanoseconds) / macroNanoseconds, result.hash == interpreter.hash ? "match" : "DIFFER");
+            return result.hash == interpreter.hash;
+        }};
+
+        bool match{report("Interpreter", interpreter)};
+        match &= report("Program", Replay(trace, Executor::Program, iterations));
+        if constexpr (MacroJit::IsSupported)
+            match &= report("JIT", Replay(trace, Executor::Jit, iterations));
+        return match ? 0 : 1;
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+}
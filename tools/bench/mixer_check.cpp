@@ -0,0 +1,82 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <audio/mixer.h>
+
+/**
+ * @brief Checks that the vectorised mixing kernels are bit-exact with their scalar references
+ * @note The lengths cover every tail which isn't a multiple of the vector width and the volumes cover ramps in both directions
+ */
+int main() {
+    using namespace skyline;
+    using namespace skyline::audio;
+
+    constexpr size_t Iterations{2000};
+    constexpr size_t MaxSamples{258}; //!< An even amount of samples that covers several iterations of the vectorised kernels
+    std::mt19937 generator{0x5C7A11E};
+    std::uniform_int_distribution<i32> sampleDistribution{std::numeric_limits<i16>::min(), std::numeric_limits<i16>::max()};
+    std::uniform_real_distribution<float> volumeDistribution{0.0f, 2.0f};
+    std::uniform_real_distribution<float> deltaDistribution{-0.01f, 0.01f};
+    std::uniform_real_distribution<float> mixDistribution{-100000.0f, 100000.0f};
+    size_t failures{};
+
+    std::vector<i16> samples(MaxSamples);
+    std::vector<float> mix(MaxSamples), expectedMix(MaxSamples);
+    std::vector<i16> output(MaxSamples), expectedOutput(MaxSamples);
+
+    for (size_t iteration{}; iteration < Iterations; iteration++) {
+        size_t sampleCount{(iteration % (MaxSamples / 2 + 1)) * 2}; // MixStereo operates on whole stereo frames
+        float volume{volumeDistribution(generator)};
+        float volumeDelta{(iteration % 4 == 0) ? 0.0f : deltaDistribution(generator)};
+
+        for (size_t index{}; index < sampleCount; index++) {
+            samples[index] = static_cast<i16>(sampleDistribution(generator));
+            mix[index] = expectedMix[index] = mixDistribution(generator);
+        }
+
+        MixStereo(span{mix}.first(sampleCount), span<const i16>{samples}.first(sampleCount), volume, volumeDelta);
+        MixStereoReference(span{expectedMix}.first(sampleCount), span<const i16>{samples}.first(sampleCount), volume, volumeDelta);
+        if (std::memcmp(mix.data(), expectedMix.data(), sampleCount * sizeof(float)) != 0) {
+            for (size_t index{}; index < sampleCount; index++) {
+                if (std::memcmp(&mix[index], &expectedMix[index], sizeof(float)) != 0) {
+                    std::printf("MixStereo mismatch: %zu samples, volume %g, delta %g, sample %zu: %.9g != %.9g\n", sampleCount, volume, volumeDelta, index, mix[index], expectedMix[index]);
+                    break;
+                }
+            }
+            failures++;
+        }
+
+        // The accumulated mix is reused as input to the conversion with some values pushed outside the range of i16 or set to exact boundaries
+        for (size_t index{}; index < sampleCount; index++) {
+            switch (generator() % 8) {
+                case 0:
+                    mix[index] = std::numeric_limits<float>::infinity() * ((generator() & 1) ? 1.0f : -1.0f);
+                    break;
+                case 1:
+                    mix[index] = (generator() & 1) ? 32767.5f : -32768.5f;
+                    break;
+                case 2:
+                    mix[index] = mixDistribution(generator) / 100000.0f;
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        SaturateMix(span{output}.first(sampleCount), span<const float>{mix}.first(sampleCount));
+        SaturateMixReference(span{expectedOutput}.first(sampleCount), span<const float>{mix}.first(sampleCount));
+        for (size_t index{}; index < sampleCount; index++) {
+            if (output[index] != expectedOutput[index]) {
+                std::printf("SaturateMix mismatch: %zu samples, sample %zu (%.9g): %d != %d\n", sampleCount, index, mix[index], output[index], expectedOutput[index]);
+                failures++;
+                break;
+            }
+        }
+    }
+
+    std::printf("mixer_check: %zu iterations, %zu failures\n", Iterations, failures);
+    return failures ? 1 : 0;
+}
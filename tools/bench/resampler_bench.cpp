@@ -0,0 +1,111 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <audio/resampler.h>
+
+using namespace skyline;
+using namespace skyline::audio;
+
+/**
+ * @brief Fits DC and a sine/cosine pair at a known frequency to a signal with least squares
+ * @return The SNR in dB, which is the power of the fitted tone over the power of the residual
+ */
+static double MeasureSnr(const std::vector<double> &signal, double frequency, double rate) {
+    double ss{}, sc{}, cc{}, s1{}, c1{}, ys{}, yc{}, y1{}, n{static_cast<double>(signal.size())};
+    for (size_t i{}; i < signal.size(); i++) {
+        double s{std::sin(2 * M_PI * frequency * i / rate)}, c{std::cos(2 * M_PI * frequency * i / rate)};
+        ss += s * s;
+        sc += s * c;
+        cc += c * c;
+        s1 += s;
+        c1 += c;
+        ys += signal[i] * s;
+        yc += signal[i] * c;
+        y1 += signal[i];
+    }
+
+    // The 3x3 normal equations are solved with Cramer's rule
+    double m[3][3]{{ss, sc, s1}, {sc, cc, c1}, {s1, c1, n}}, v[3]{ys, yc, y1};
+    auto determinant{[](double a[3][3]) {
+        return a[0][0] * (a[1][1] * a[2][2] - a[1][2] * a[2][1]) - a[0][1] * (a[1][0] * a[2][2] - a[1][2] * a[2][0]) + a[0][2] * (a[1][0] * a[2][1] - a[1][1] * a[2][0]);
+    }};
+    double d{determinant(m)}, x[3];
+    for (int k{}; k < 3; k++) {
+        double t[3][3];
+        for (int r{}; r < 3; r++)
+            for (int c{}; c < 3; c++)
+                t[r][c] = c == k ? v[r] : m[r][c];
+        x[k] = determinant(t) / d;
+    }
+
+    double signalPower{}, noisePower{};
+    for (size_t i{}; i < signal.size(); i++) {
+        double fit{x[0] * std::sin(2 * M_PI * frequency * i / rate) + x[1] * std::cos(2 * M_PI * frequency * i / rate) + x[2]};
+        signalPower += (fit - x[2]) * (fit - x[2]);
+        noisePower += (signal[i] - fit) * (signal[i] - fit);
+    }
+    return 10 * std::log10(signalPower / noisePower);
+}
+
+/**
+ * @brief Measures the SNR and throughput of Resampler at both qualities for common sample rates to 48 kHz
+ */
+int main() {
+    constexpr u32 OutputRate{48000};
+    constexpr size_t ChunkFrames{240}; //!< The amount of input frames supplied in every call, this is roughly a renderer period
+
+    for (u32 inputRate : {32000U, 22050U, 44100U}) {
+        u32 step{Resampler::GetStep(inputRate, OutputRate)};
+        for (auto quality : {ResamplerQuality::Standard, ResamplerQuality::High}) {
+            const char *qualityName{quality == ResamplerQuality::High ? "High" : "Standard"};
+            for (double frequency : {1000.0, inputRate * 0.4}) {
+                // 2 seconds of a stereo tone at -6 dBFS, the right channel is inverted so both channels are exercised independently
+                size_t inputFrames{inputRate * 2};
+                std::vector<i16> input(inputFrames * 2);
+                for (size_t i{}; i < inputFrames; i++) {
+                    auto sample{static_cast<i16>(std::lround(16384.0 * std::sin(2 * M_PI * frequency * i / inputRate)))};
+                    input[2 * i] = sample;
+                    input[2 * i + 1] = static_cast<i16>(-sample);
+                }
+
+                Resampler resampler{quality};
+                std::vector<double> left, right;
+                for (size_t offset{}; offset < input.size(); offset += ChunkFrames * 2) {
+                    auto output{resampler.ResampleChunk(span(input).subspan(offset, std::min(ChunkFrames * 2, input.size() - offset)), step, 2)};
+                    for (size_t i{}; i + 1 < output.size(); i += 2) {
+                        left.push_back(output[i]);
+                        right.push_back(output[i + 1]);
+                    }
+                }
+
+                // The first and last 50ms are skipped to exclude the silence preceding the stream and the settling of the filter
+                constexpr size_t Skip{OutputRate / 20};
+                std::vector<double> steadyLeft(left.begin() + Skip, left.end() - Skip), steadyRight(right.begin() + Skip, right.end() - Skip);
+
+                // The step is truncated to 17.15 fixed point so the tone is output at a slightly different frequency which the fit has to use
+                double outputFrequency{frequency * (static_cast<double>(step) / (1 << 15)) * OutputRate / inputRate};
+                std::printf("%5u Hz -> 48000 Hz %-8s tone %7.1f Hz (pitch error %+.2f cents): SNR L %6.2f dB, R %6.2f dB\n", inputRate, qualityName, frequency, 1200 * std::log2(outputFrequency / frequency), MeasureSnr(steadyLeft, outputFrequency, OutputRate), MeasureSnr(steadyRight, outputFrequency, OutputRate));
+            }
+
+            // Throughput over 60 seconds of stereo white noise
+            size_t inputFrames{inputRate * 60};
+            std::vector<i16> input(inputFrames * 2);
+            u32 seed{1};
+            for (auto &sample : input) {
+                seed = seed * 1664525 + 1013904223;
+                sample = static_cast<i16>(seed >> 16);
+            }
+
+            Resampler resampler{quality};
+            size_t outputFrames{};
+            auto start{std::chrono::steady_clock::now()};
+            for (size_t offset{}; offset < input.size(); offset += ChunkFrames * 2)
+                outputFrames += resampler.ResampleChunk(span(input).subspan(offset, std::min(ChunkFrames * 2, input.size() - offset)), step, 2).size() / 2;
+            double seconds{std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()};
+            std::printf("%5u Hz -> 48000 Hz %-8s throughput: %.1f Mframes/s (%.0fx real-time)\n", inputRate, qualityName, outputFrames / seconds / 1e6, (outputFrames / static_cast<double>(OutputRate)) / seconds);
+        }
+    }
+}